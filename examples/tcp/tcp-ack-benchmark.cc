@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of the processing of a TCP ACK.
+//
+// The first part removes the header of n pure ACKs carrying a timestamp
+// (and, with --sack, a SACK block) and reads their options the way
+// TcpSocketBase does.
+//
+// The second part runs a bulk transfer between two nodes
+//
+//       n0 ----------- n1
+//            10 Gbps
+//             50 us
+//
+// and reports the wall clock time spent for each ACK received by the
+// sender, which includes the segments sent in response to the ACK.
+//
+// Connecting a sink to the Tx/Rx traces of the sockets (--trace) shows
+// the cost of the trace dispatch.
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpAckBenchmark");
+
+static uint32_t g_acks = 0; //!< ACKs received by the sender
+
+/**
+ * Count the packets received by the sender.
+ * \param p the packet
+ * \param ipv4 the IPv4 protocol
+ * \param interface the interface
+ */
+static void
+CountAck (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  ++g_acks;
+}
+
+/**
+ * Sink of the TCP Tx/Rx traces.
+ * \param p the packet
+ * \param h the TCP header
+ * \param socket the socket
+ */
+static void
+TcpTrace (Ptr<const Packet> p, const TcpHeader &h, Ptr<const TcpSocketBase> socket)
+{
+}
+
+/**
+ * Time the parsing of the options of pure ACKs.
+ * \param n the number of ACKs
+ * \param sack whether the ACKs carry a SACK block
+ * \return the elapsed time, in ms
+ */
+static int64_t
+BenchHeader (uint32_t n, bool sack)
+{
+  TcpHeader header;
+  header.SetFlags (TcpHeader::ACK);
+  header.SetAckNumber (SequenceNumber32 (1000));
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (1234);
+  ts->SetEcho (5678);
+  header.AppendOption (ts);
+  if (sack)
+    {
+      Ptr<TcpOptionSack> sackOption = CreateObject<TcpOptionSack> ();
+      sackOption->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (2000),
+                                                          SequenceNumber32 (3000)));
+      header.AppendOption (sackOption);
+    }
+  Ptr<Packet> ack = Create<Packet> ();
+  ack->AddHeader (header);
+
+  uint32_t sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Ptr<Packet> p = ack->Copy ();
+      TcpHeader received;
+      p->RemoveHeader (received);
+      uint32_t timestamp;
+      uint32_t echo;
+      if (received.GetTimestamp (timestamp, echo))
+        {
+          sum += echo;
+        }
+      if (received.HasOption (TcpOption::SACK))
+        {
+          sum += received.GetOptionList ().size ();
+        }
+    }
+  int64_t elapsed = clock.End ();
+  NS_ABORT_MSG_IF (sum == 0, "Options not found");
+  return elapsed;
+}
+
+/**
+ * Time a bulk transfer.
+ * \param bytes the bytes to transfer
+ * \param bufSize the size of the socket buffers
+ * \param sack whether SACK is enabled
+ * \param trace whether to connect the socket traces
+ * \return the elapsed time, in ms
+ */
+static int64_t
+BenchTransfer (uint32_t bytes, uint32_t bufSize, bool sack, bool trace)
+{
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (bufSize));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (bufSize));
+  Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (sack));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("50us"));
+  NetDeviceContainer devices = pointToPoint.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (interfaces.GetAddress (1), port));
+  source.SetAttribute ("MaxBytes", UintegerValue (bytes));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (0.0));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (1));
+  sinkApps.Start (Seconds (0.0));
+
+  g_acks = 0;
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&CountAck));
+  if (trace)
+    {
+      // The sockets are created when the applications start; the sockets
+      // forked by the listening socket of the sink inherit its sinks
+      Simulator::Schedule (Seconds (0.0), &Config::ConnectWithoutContext,
+                           "/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/Tx",
+                           MakeCallback (&TcpTrace));
+      Simulator::Schedule (Seconds (0.0), &Config::ConnectWithoutContext,
+                           "/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/Rx",
+                           MakeCallback (&TcpTrace));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  Ptr<PacketSink> packetSink = DynamicCast<PacketSink> (sinkApps.Get (0));
+  NS_ABORT_MSG_IF (packetSink->GetTotalRx () != bytes, "Transfer not completed");
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t bytes = 100000000;
+  uint32_t bufSize = 1 << 21;
+  bool sack = false;
+  bool trace = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the processing of TCP ACKs");
+  cmd.AddValue ("n", "number of ACKs to parse", n);
+  cmd.AddValue ("bytes", "bytes of the bulk transfer", bytes);
+  cmd.AddValue ("buffer", "size of the socket buffers", bufSize);
+  cmd.AddValue ("sack", "enable SACK", sack);
+  cmd.AddValue ("trace", "connect a sink to the socket traces", trace);
+  cmd.Parse (argc, argv);
+
+  int64_t headerMs = std::max<int64_t> (BenchHeader (n, sack), 1);
+  std::cout << "Option parsing: " << n << " ACKs in " << headerMs << " ms, "
+            << headerMs * 1e6 / n << " ns per ACK" << std::endl;
+
+  int64_t transferMs = std::max<int64_t> (BenchTransfer (bytes, bufSize, sack, trace), 1);
+  std::cout << "Bulk transfer: " << g_acks << " ACKs in " << transferMs << " ms, "
+            << transferMs * 1e3 / std::max<uint32_t> (g_acks, 1) << " us per ACK" << std::endl;
+
+  return 0;
+}
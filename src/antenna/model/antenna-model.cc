@@ -21,6 +21,7 @@
 
 #include <ns3/log.h>
 #include <cmath>
+#include <limits>
 #include "antenna-model.h"
 
 
@@ -49,6 +50,12 @@ AntennaModel::GetTypeId ()
   return tid;
 }
 
+double
+AntennaModel::GetMaxGainDb (void)
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 
 
 }
@@ -66,6 +66,14 @@ public:
    */
   virtual double GetGainDb (Angles a) = 0;
 
+  /**
+   * The default implementation returns infinity, i.e., no bound.
+   *
+   * \return an upper bound, in dBi, of the gain returned by GetGainDb
+   * for any angles
+   */
+  virtual double GetMaxGainDb (void);
+
 };
 
 
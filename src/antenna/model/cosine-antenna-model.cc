@@ -123,6 +123,13 @@ CosineAntennaModel::GetGainDb (Angles a)
   return gainDb + m_maxGain;
 }
 
+double
+CosineAntennaModel::GetMaxGainDb (void)
+{
+  // the element factor is at most 1
+  return m_maxGain;
+}
+
 
 }
 
@@ -49,6 +49,7 @@ public:
 
   // inherited from AntennaModel
   virtual double GetGainDb (Angles a);
+  virtual double GetMaxGainDb (void);
 
 
   // attribute getters/setters
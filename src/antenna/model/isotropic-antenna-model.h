@@ -42,6 +42,7 @@ public:
 
   // inherited from AntennaModel
   virtual double GetGainDb (Angles a);
+  virtual double GetMaxGainDb (void);
 
 protected:
 
@@ -113,6 +113,13 @@ ParabolicAntennaModel::GetGainDb (Angles a)
   return gainDb;
 }
 
+double
+ParabolicAntennaModel::GetMaxGainDb (void)
+{
+  // the attenuation is the minimum of a non-negative term and m_maxAttenuation
+  return std::max (0.0, -m_maxAttenuation);
+}
+
 
 }
 
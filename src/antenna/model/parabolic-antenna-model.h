@@ -51,6 +51,7 @@ public:
 
   // inherited from AntennaModel
   virtual double GetGainDb (Angles a);
+  virtual double GetMaxGainDb (void);
 
 
   // attribute getters/setters
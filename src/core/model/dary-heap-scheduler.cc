@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DaryHeapScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+const std::size_t DaryHeapScheduler::ARITY;
+const std::size_t DaryHeapScheduler::CACHE_LINE;
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<DaryHeapScheduler> ()
+  ;
+  return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+  : m_keys (0),
+    m_size (0),
+    m_capacity (0)
+{
+  NS_LOG_FUNCTION (this);
+  Reserve (CACHE_LINE);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DaryHeapScheduler::Reserve (std::size_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ASSERT (capacity >= m_size);
+
+  // Place the keys so that the first child of the root, and hence
+  // the first child of every node, starts on a cache line.
+  std::vector<EventKey> storage (capacity + CACHE_LINE / sizeof (EventKey));
+  uintptr_t address = reinterpret_cast<uintptr_t> (&storage[1]);
+  std::size_t shift = (CACHE_LINE - address % CACHE_LINE) % CACHE_LINE;
+  if (shift % sizeof (EventKey) == 0)
+    {
+      shift /= sizeof (EventKey);
+    }
+  else
+    {
+      // The allocator alignment does not allow it; stay correct anyway.
+      shift = 0;
+    }
+  EventKey *keys = &storage[shift];
+  std::copy (m_keys, m_keys + m_size, keys);
+  m_keyStorage.swap (storage);
+  m_keys = keys;
+  m_impls.resize (capacity);
+  m_capacity = capacity;
+}
+
+void
+DaryHeapScheduler::SiftUp (std::size_t hole, const EventKey &key, EventImpl *impl)
+{
+  while (hole > 0)
+    {
+      std::size_t parent = (hole - 1) / ARITY;
+      if (!(key < m_keys[parent]))
+        {
+          break;
+        }
+      m_keys[hole] = m_keys[parent];
+      m_impls[hole] = m_impls[parent];
+      hole = parent;
+    }
+  m_keys[hole] = key;
+  m_impls[hole] = impl;
+}
+
+void
+DaryHeapScheduler::SiftDown (std::size_t hole, const EventKey &key, EventImpl *impl)
+{
+  for (;;)
+    {
+      std::size_t first = ARITY * hole + 1;
+      if (first >= m_size)
+        {
+          break;
+        }
+      std::size_t last = std::min (first + ARITY, m_size);
+      std::size_t smallest = first;
+      for (std::size_t child = first + 1; child < last; ++child)
+        {
+          if (m_keys[child] < m_keys[smallest])
+            {
+              smallest = child;
+            }
+        }
+      if (!(m_keys[smallest] < key))
+        {
+          break;
+        }
+      m_keys[hole] = m_keys[smallest];
+      m_impls[hole] = m_impls[smallest];
+      hole = smallest;
+    }
+  m_keys[hole] = key;
+  m_impls[hole] = impl;
+}
+
+void
+DaryHeapScheduler::RemoveAt (std::size_t index)
+{
+  NS_ASSERT (index < m_size);
+  m_size--;
+  if (index == m_size)
+    {
+      return;
+    }
+  EventKey key = m_keys[m_size];
+  EventImpl *impl = m_impls[m_size];
+  // the former last item can belong above the hole when it comes
+  // from another subtree, or below it.
+  if (index > 0 && key < m_keys[(index - 1) / ARITY])
+    {
+      SiftUp (index, key, impl);
+    }
+  else
+    {
+      SiftDown (index, key, impl);
+    }
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_size == m_capacity)
+    {
+      Reserve (2 * m_capacity);
+    }
+  m_size++;
+  SiftUp (m_size - 1, ev.key, ev.impl);
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next;
+  next.impl = m_impls[0];
+  next.key = m_keys[0];
+  return next;
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next;
+  next.impl = m_impls[0];
+  next.key = m_keys[0];
+  RemoveAt (0);
+  return next;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  for (std::size_t i = 0; i < m_size; i++)
+    {
+      if (m_keys[i].m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (m_impls[i] == ev.impl);
+          RemoveAt (i);
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-friendly d-ary heap event scheduler
+ *
+ * This is an implicit heap in which each node has ARITY (4) children
+ * instead of two, so the tree is half as deep as the binary heap
+ * used by HeapScheduler.
+ *
+ * What is different from HeapScheduler ?
+ *  - the EventKey of each event is stored inline in a contiguous
+ *    array, and the EventImpl pointers are held in a parallel array
+ *    which is only touched when items move.  All comparisons read
+ *    the key array only.
+ *  - the key array is laid out so that the ARITY children of a node,
+ *    which are compared together when sifting down, start on a cache
+ *    line boundary: with 16-byte keys, the four children of a node
+ *    fill exactly one 64-byte cache line.
+ *  - items are moved into a hole instead of swapped, which halves
+ *    the number of stores while sifting.
+ *
+ * The root is at index 0 and the children of \c i are at
+ * <tt>ARITY * i + 1 ... ARITY * i + ARITY</tt>.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DaryHeapScheduler ();
+  /** Destructor. */
+  virtual ~DaryHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Number of children of each node. */
+  static const std::size_t ARITY = 4;
+  /** Size of a cache line, in bytes. */
+  static const std::size_t CACHE_LINE = 64;
+
+  /**
+   * Move an item up from a hole to its place.
+   *
+   * \param [in] hole The index to start from.
+   * \param [in] key The key of the item to place.
+   * \param [in] impl The implementation of the item to place.
+   */
+  void SiftUp (std::size_t hole, const EventKey &key, EventImpl *impl);
+  /**
+   * Move an item down from a hole to its place.
+   *
+   * \param [in] hole The index to start from.
+   * \param [in] key The key of the item to place.
+   * \param [in] impl The implementation of the item to place.
+   */
+  void SiftDown (std::size_t hole, const EventKey &key, EventImpl *impl);
+  /**
+   * Remove the item at an index, and fill the hole with the last item.
+   *
+   * \param [in] index The index of the item to remove.
+   */
+  void RemoveAt (std::size_t index);
+  /**
+   * Grow the key and implementation arrays.
+   *
+   * \param [in] capacity The new capacity, in items.
+   */
+  void Reserve (std::size_t capacity);
+
+  /**
+   * Raw storage for the keys, over-allocated so that the aligned
+   * array m_keys fits inside it.
+   */
+  std::vector<EventKey> m_keyStorage;
+  /** The keys, in heap order, positioned within m_keyStorage. */
+  EventKey *m_keys;
+  /** The event implementations, parallel to m_keys. */
+  std::vector<EventImpl *> m_impls;
+  /** Number of items in the heap. */
+  std::size_t m_size;
+  /** Number of items which fit in the arrays. */
+  std::size_t m_capacity;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
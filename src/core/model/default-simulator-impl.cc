@@ -22,13 +22,19 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "string.h"
+#include "uinteger.h"
 
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -46,6 +52,13 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+/**
+ * \ingroup simulator
+ * Number of cells in the lock-free inbox of events scheduled from
+ * other threads.
+ */
+static const uint32_t EVENTS_WITH_CONTEXT_INBOX_SIZE = 4096;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,11 +66,30 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "If not empty, time the events and write the profile, "
+                   "in the collapsed stack format used by flame graph tools, "
+                   "to this file when the simulator is destroyed.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileTopN",
+                   "The number of callbacks with the largest cost to "
+                   "print when the simulator is destroyed, if profiling.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileTopN),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileSamplePeriod",
+                   "Time only one in this many events, if profiling.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileSamplePeriod),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContextInbox (EVENTS_WITH_CONTEXT_INBOX_SIZE)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -73,12 +105,15 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
+  m_eventsWithContextOverflow = false;
   m_main = SystemThread::Self();
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -109,6 +144,29 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  WriteProfile ();
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_profiler == 0)
+    {
+      return;
+    }
+  std::ofstream os (m_profileFile.c_str ());
+  if (os.is_open ())
+    {
+      m_profiler->WriteCollapsed (os);
+    }
+  else
+    {
+      NS_LOG_WARN ("Unable to open event profile file " << m_profileFile);
+    }
+  m_profiler->PrintTop (std::cout, m_profileTopN);
+  delete m_profiler;
+  m_profiler = 0;
 }
 
 void
@@ -148,7 +206,18 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler != 0 && m_profiler->Sample ())
+    {
+      uint32_t callback = m_profiler->GetCallback (next.impl);
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::nanoseconds ns = std::chrono::steady_clock::now () - start;
+      m_profiler->Record (callback, m_currentContext, ns.count ());
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -167,29 +236,56 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
     {
       return;
     }
+  m_eventsWithContextEmpty = true;
+
+  EventWithContext event;
+  while (m_eventsWithContextInbox.Pop (event))
+    {
+      InsertEventWithContext (event);
+    }
+
+  if (!m_eventsWithContextOverflow)
+    {
+      return;
+    }
 
   // swap queues
   EventsWithContext eventsWithContext;
   {
     CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
+    // Events which made it into the inbox before the overflow started
+    // must be inserted first.  Producers can't add to the inbox forever
+    // while we hold the lock: once it is full they block on the mutex.
+    while (!m_eventsWithContextInbox.IsEmpty ())
+      {
+        if (m_eventsWithContextInbox.Pop (event))
+          {
+            InsertEventWithContext (event);
+          }
+      }
+    m_eventsWithContext.swap (eventsWithContext);
+    m_eventsWithContextOverflow = false;
   }
   while (!eventsWithContext.empty ())
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
+      InsertEventWithContext (eventsWithContext.front ());
+      eventsWithContext.pop_front ();
     }
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -198,6 +294,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profiler == 0 && !m_profileFile.empty ())
+    {
+      m_profiler = new EventProfiler (m_profileSamplePeriod);
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -270,11 +370,13 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      if (m_eventsWithContextOverflow || !m_eventsWithContextInbox.Push (ev))
+        {
+          CriticalSection cs (m_eventsWithContextMutex);
+          m_eventsWithContext.push_back (ev);
+          m_eventsWithContextOverflow = true;
+        }
+      m_eventsWithContextEmpty = false;
     }
 }
 
@@ -26,10 +26,13 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -39,6 +42,8 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
@@ -86,6 +91,8 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /** Write the event profile, if profiling, and stop profiling. */
+  void WriteProfile (void);
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -96,16 +103,34 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event from a different context into the main event queue.
+   * \param [in] event The event to insert, with its relative timestamp.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
+
+  /**
+   * Lock-free inbox for the events scheduled from other threads.
+   * Producers only fall back to the locked list below when it is full.
+   */
+  MpscQueue<EventWithContext> m_eventsWithContextInbox;
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
+  /** Overflow container for the events from a different context. */
   EventsWithContext m_eventsWithContext;
   /**
    * Flag \c true if all events with context have been moved to the
    * primary event queue.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
+  std::atomic<bool> m_eventsWithContextEmpty;
+  /**
+   * Flag \c true while the overflow list holds events.  Producers keep
+   * appending to the list until it has been drained, so the events from
+   * each thread are moved to the event queue in the order they were
+   * scheduled.
+   */
+  std::atomic<bool> m_eventsWithContextOverflow;
+  /** Mutex to control access to the overflow list of events with context. */
   SystemMutex m_eventsWithContextMutex;
 
   /** Container type for the events to run at Simulator::Destroy() */
@@ -135,6 +160,15 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event profile file name; profiling is disabled if empty. */
+  std::string m_profileFile;
+  /** Number of callback types to print at the end of the profiled run. */
+  uint32_t m_profileTopN;
+  /** Time one in this many events. */
+  uint32_t m_profileSamplePeriod;
+  /** The event profiler, while profiling. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
@@ -21,6 +21,8 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +33,148 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/**
+ * \ingroup events
+ * Event pool size class granularity, in bytes.
+ */
+static const std::size_t EVENT_POOL_GRANULE = 16;
+/**
+ * \ingroup events
+ * Number of event pool size classes; larger events bypass the pool.
+ */
+static const std::size_t EVENT_POOL_CLASSES = 16;
+/**
+ * \ingroup events
+ * Maximum number of free cells kept per size class and thread.
+ */
+static const uint32_t EVENT_POOL_MAX_FREE = 4096;
+
+/**
+ * \ingroup events
+ * The per-thread event allocation pool.
+ *
+ * Each cell is a separate allocation of its size class, so cells can
+ * be released to the system one at a time, and memory allocated from
+ * one thread's pool can be released to another thread's pool.
+ */
+struct EventPool
+{
+  /** A free cell: the link to the next free cell of its class. */
+  struct Cell
+  {
+    Cell *next; /**< Next free cell. */
+  };
+
+  /** Constructor. */
+  EventPool ();
+  /** Destructor: release all the free cells. */
+  ~EventPool ();
+
+  Cell *m_free[EVENT_POOL_CLASSES];          /**< Free lists. */
+  uint32_t m_nFree[EVENT_POOL_CLASSES];      /**< Length of the free lists. */
+  EventImpl::PoolStatistics m_statistics;   /**< Counters. */
+};
+
+/**
+ * \ingroup events
+ * Flag \c true once the pool of this thread has been destroyed, so
+ * events released later, during static destruction, bypass it.
+ */
+static thread_local bool g_eventPoolDestroyed = false;
+/**
+ * \ingroup events
+ * The event allocation pool of this thread.
+ */
+static thread_local EventPool g_eventPool;
+
+EventPool::EventPool ()
+{
+  for (std::size_t i = 0; i < EVENT_POOL_CLASSES; i++)
+    {
+      m_free[i] = 0;
+      m_nFree[i] = 0;
+    }
+  m_statistics.hits = 0;
+  m_statistics.misses = 0;
+  m_statistics.unpooled = 0;
+}
+
+EventPool::~EventPool ()
+{
+  for (std::size_t i = 0; i < EVENT_POOL_CLASSES; i++)
+    {
+      while (m_free[i] != 0)
+        {
+          Cell *cell = m_free[i];
+          m_free[i] = cell->next;
+          ::operator delete (cell);
+        }
+      m_nFree[i] = 0;
+    }
+  g_eventPoolDestroyed = true;
+}
+
+EventImpl::PoolStatistics
+EventImpl::GetPoolStatistics (void)
+{
+  if (g_eventPoolDestroyed)
+    {
+      PoolStatistics empty = { 0, 0, 0 };
+      return empty;
+    }
+  return g_eventPool.m_statistics;
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULE;
+  if (sizeClass >= EVENT_POOL_CLASSES || g_eventPoolDestroyed)
+    {
+      if (!g_eventPoolDestroyed)
+        {
+          g_eventPool.m_statistics.unpooled++;
+        }
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  EventPool::Cell *cell = pool.m_free[sizeClass];
+  if (cell != 0)
+    {
+      pool.m_free[sizeClass] = cell->next;
+      pool.m_nFree[sizeClass]--;
+      pool.m_statistics.hits++;
+      return cell;
+    }
+  pool.m_statistics.misses++;
+  return ::operator new ((sizeClass + 1) * EVENT_POOL_GRANULE);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULE;
+  if (sizeClass >= EVENT_POOL_CLASSES || g_eventPoolDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPool &pool = g_eventPool;
+  if (pool.m_nFree[sizeClass] >= EVENT_POOL_MAX_FREE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPool::Cell *cell = static_cast<EventPool::Cell *> (p);
+  cell->next = pool.m_free[sizeClass];
+  pool.m_free[sizeClass] = cell;
+  pool.m_nFree[sizeClass]++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +210,10 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const void *
+EventImpl::GetFunction (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,13 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Since events are allocated and released at a very high rate,
+ * EventImpl provides class-specific allocation functions: the memory
+ * of released events is kept in per-thread free lists, one per size
+ * class, and reused for the next event of the same size class.  As
+ * the lists are private to each thread, events created by the
+ * realtime or emulation threads never contend for a lock.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +73,45 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the address of the function or class method which this event
+   * calls, to tell apart in profiles the events of the same type.
+   *
+   * \returns The address of the function, or 0 if unknown.
+   */
+  virtual const void * GetFunction (void) const;
+
+  /**
+   * Counters of the event allocation pool of the calling thread.
+   */
+  struct PoolStatistics
+  {
+    uint64_t hits;      /**< Allocations served from a free list. */
+    uint64_t misses;    /**< Allocations of a pooled size which found the free list empty. */
+    uint64_t unpooled;  /**< Allocations too large for the pool. */
+  };
+  /**
+   * Get the event allocation pool counters of the calling thread.
+   * \returns The pool counters.
+   */
+  static PoolStatistics GetPoolStatistics (void);
+  /**
+   * Allocate the memory for an event, from the free list of its
+   * size class if possible.
+   * \param [in] size The size of the event, in bytes.
+   * \returns The allocated memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event to the free list of its size class.
+   *
+   * Since the destructor is virtual, \p size is the size of the
+   * most derived class, which matches the size it was allocated with.
+   *
+   * \param [in] p The memory to release.
+   * \param [in] size The size of the event, in bytes.
+   */
+  static void operator delete (void *p, std::size_t size);
 
 protected:
   /**
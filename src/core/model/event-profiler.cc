@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+EventProfiler::EventProfiler (uint32_t samplePeriod)
+  : m_samplePeriod (std::max (samplePeriod, (uint32_t)1)),
+    m_countdown (1)
+{
+  NS_LOG_FUNCTION (this << samplePeriod);
+}
+
+uint32_t
+EventProfiler::GetCallback (const EventImpl *event)
+{
+  const void *function = event->GetFunction ();
+  if (function != 0)
+    {
+      std::unordered_map<const void *, uint32_t>::const_iterator i = m_functions.find (function);
+      if (i != m_functions.end ())
+        {
+          return i->second;
+        }
+      uint32_t index = AddName (GetFunctionName (event, function));
+      m_functions.insert (std::make_pair (function, index));
+      return index;
+    }
+
+  std::type_index type (typeid (*event));
+  std::unordered_map<std::type_index, uint32_t>::const_iterator i = m_types.find (type);
+  if (i != m_types.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = AddName (GetReadableName (typeid (*event).name ()));
+  m_types.insert (std::make_pair (type, index));
+  return index;
+}
+
+void
+EventProfiler::Record (uint32_t callback, uint32_t context, uint64_t ns)
+{
+  NS_ASSERT (callback < m_names.size ());
+  uint64_t key = ((uint64_t)callback << 32) | context;
+  Cost &cost = m_costs[key];
+  cost.count++;
+  cost.ns += ns * m_samplePeriod;
+}
+
+uint32_t
+EventProfiler::AddName (const std::string &name)
+{
+  std::unordered_map<std::string, uint32_t>::const_iterator i = m_indexes.find (name);
+  if (i != m_indexes.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = static_cast<uint32_t> (m_names.size ());
+  m_names.push_back (name);
+  m_indexes.insert (std::make_pair (name, index));
+  NS_LOG_LOGIC ("new callback " << index << ": " << name);
+  return index;
+}
+
+std::string
+EventProfiler::GetFunctionName (const EventImpl *event, const void *function)
+{
+  std::ostringstream oss;
+#ifdef HAVE_DLFCN_H
+  Dl_info info;
+  if (dladdr (function, &info) != 0)
+    {
+      if (info.dli_sname != 0 && info.dli_saddr == function)
+        {
+          std::string name = info.dli_sname;
+#if (__GNUC__ >= 3)
+          int status;
+          char *demangled = abi::__cxa_demangle (info.dli_sname, 0, 0, &status);
+          if (status == 0)
+            {
+              name = demangled;
+            }
+          std::free (demangled);
+#endif
+          std::replace (name.begin (), name.end (), ';', ':');
+          return name;
+        }
+      // The function has no exported symbol, like the static functions:
+      // locate it in its object file, as addr2line expects it.
+      std::string file = info.dli_fname != 0 ? info.dli_fname : "";
+      std::string::size_type slash = file.find_last_of ('/');
+      if (slash != std::string::npos)
+        {
+          file = file.substr (slash + 1);
+        }
+      oss << GetReadableName (typeid (*event).name ()) << " [" << file << "+0x" << std::hex
+          << (reinterpret_cast<const char *> (function) - reinterpret_cast<const char *> (info.dli_fbase))
+          << "]";
+      return oss.str ();
+    }
+#endif
+  oss << GetReadableName (typeid (*event).name ()) << " [" << function << "]";
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetReadableName (const char *mangled)
+{
+  std::string name = mangled;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, 0, 0, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+
+  // The events built by MakeEvent are local classes of the MakeEvent
+  // template: keep only its first argument, the scheduled function.
+  const std::string prefix = "ns3::MakeEvent<";
+  if (name.compare (0, prefix.size (), prefix) == 0)
+    {
+      int depth = 0;
+      for (std::string::size_type i = prefix.size (); i < name.size (); i++)
+        {
+          char c = name[i];
+          if (c == '<' || c == '(')
+            {
+              depth++;
+            }
+          else if ((c == '>' || c == ')') && depth > 0)
+            {
+              depth--;
+            }
+          else if ((c == ',' || c == '>') && depth == 0)
+            {
+              name = name.substr (prefix.size (), i - prefix.size ());
+              break;
+            }
+        }
+    }
+
+  // ';' separates the frames in the collapsed stack format.
+  std::replace (name.begin (), name.end (), ';', ':');
+  return name;
+}
+
+void
+EventProfiler::WriteCollapsed (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  for (std::unordered_map<uint64_t, Cost>::const_iterator i = m_costs.begin ();
+       i != m_costs.end (); ++i)
+    {
+      uint32_t type = static_cast<uint32_t> (i->first >> 32);
+      uint32_t context = static_cast<uint32_t> (i->first);
+      os << "ns3::Simulator::Run;";
+      if (context == Simulator::NO_CONTEXT)
+        {
+          os << "no context";
+        }
+      else
+        {
+          os << "node " << context;
+        }
+      os << ";" << m_names[type] << " " << i->second.ns << std::endl;
+    }
+}
+
+void
+EventProfiler::PrintTop (std::ostream &os, uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << n);
+  std::vector<Cost> costs (m_names.size ());
+  uint64_t total = 0;
+  for (std::unordered_map<uint64_t, Cost>::const_iterator i = m_costs.begin ();
+       i != m_costs.end (); ++i)
+    {
+      Cost &cost = costs[i->first >> 32];
+      cost.count += i->second.count;
+      cost.ns += i->second.ns;
+      total += i->second.ns;
+    }
+
+  std::vector<uint32_t> order (costs.size ());
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      order[i] = i;
+    }
+  std::sort (order.begin (), order.end (),
+             [&costs] (uint32_t a, uint32_t b) { return costs[a].ns > costs[b].ns; });
+  if (order.size () > n)
+    {
+      order.resize (n);
+    }
+
+  std::ios_base::fmtflags flags = os.flags ();
+  os << "Event profile: " << total << " ns in " << m_names.size ()
+     << " callbacks (sampling 1 in " << m_samplePeriod << " events)"
+     << std::endl;
+  os << std::setw (14) << "total (ns)" << std::setw (8) << "%"
+     << std::setw (12) << "samples" << std::setw (12) << "mean (ns)"
+     << "  callback" << std::endl;
+  for (std::vector<uint32_t>::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      const Cost &cost = costs[*i];
+      double percent = total ? 100.0 * cost.ns / total : 0;
+      uint64_t mean = cost.count ? cost.ns / m_samplePeriod / cost.count : 0;
+      os << std::setw (14) << cost.ns
+         << std::setw (8) << std::fixed << std::setprecision (2) << percent
+         << std::setw (12) << cost.count
+         << std::setw (12) << mean
+         << "  " << m_names[*i] << std::endl;
+    }
+  os.flags (flags);
+}
+
+} // namespace ns3
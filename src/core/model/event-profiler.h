@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "non-copyable.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Attribute the wall-clock time spent in events to their
+ * callback and context.
+ *
+ * The simulator implementation times EventImpl::Invoke for one in
+ * every \c samplePeriod events, and reports each measurement with
+ * Record().  The cost is attributed to the function or class method
+ * which the event calls, named after its symbol, and to the event
+ * context (normally the node id).  The callbacks without a symbol are
+ * named after the dynamic type of the event, which for events created
+ * by MakeEvent is reduced to the signature of the scheduled function,
+ * followed by their address when it is known.  Sampled costs are
+ * scaled by the sampling period.
+ *
+ * At the end of the run, the profile can be written as a collapsed
+ * stack file, one line per (context, callback) pair:
+ * \verbatim
+   ns3::Simulator::Run;node 3;ns3::PointToPointNetDevice::TransmitComplete() 1234567 \endverbatim
+ * which can be fed to \c flamegraph.pl, and as a table of the callbacks
+ * with the largest total cost.
+ */
+class EventProfiler : private NonCopyable
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] samplePeriod Time one in every \p samplePeriod events.
+   */
+  EventProfiler (uint32_t samplePeriod);
+
+  /**
+   * Check whether the next event should be timed, and count it.
+   * \returns \c true if the next event should be timed.
+   */
+  inline bool Sample (void);
+  /**
+   * Identify the callback of an event.
+   *
+   * Since the event may destroy the object of its callback, this must
+   * be called before the event is invoked.
+   *
+   * \param [in] event The event.
+   * \returns The index of the callback.
+   */
+  uint32_t GetCallback (const EventImpl *event);
+  /**
+   * Record the cost of one event.
+   * \param [in] callback The index of the callback of the event.
+   * \param [in] context The context of the event.
+   * \param [in] ns The wall-clock time spent in the event, in ns.
+   */
+  void Record (uint32_t callback, uint32_t context, uint64_t ns);
+
+  /**
+   * Write the profile in the collapsed stack format.
+   * \param [in,out] os The output stream.
+   */
+  void WriteCollapsed (std::ostream &os) const;
+  /**
+   * Print the callbacks with the largest total cost.
+   * \param [in,out] os The output stream.
+   * \param [in] n The number of callbacks to print.
+   */
+  void PrintTop (std::ostream &os, uint32_t n) const;
+
+private:
+  /** Accumulated cost of a (context, callback) pair. */
+  struct Cost
+  {
+    uint64_t count;  /**< Number of timed events. */
+    uint64_t ns;     /**< Total time of the timed events, in ns. */
+  };
+
+  /**
+   * Build a readable name for an event type.
+   * \param [in] mangled The mangled type name.
+   * \returns The readable name.
+   */
+  static std::string GetReadableName (const char *mangled);
+  /**
+   * Build a readable name for the function called by an event.
+   * \param [in] event The event.
+   * \param [in] function The address of the function.
+   * \returns The name of the symbol of the function, or the readable
+   * name of the event type followed by the address of the function.
+   */
+  static std::string GetFunctionName (const EventImpl *event, const void *function);
+  /**
+   * Add a callback name.
+   * \param [in] name The name.
+   * \returns The index of the callback.
+   */
+  uint32_t AddName (const std::string &name);
+
+  /** The sampling period. */
+  uint32_t m_samplePeriod;
+  /** Events left before the next timed one. */
+  uint32_t m_countdown;
+  /** The callback index of each function seen so far. */
+  std::unordered_map<const void *, uint32_t> m_functions;
+  /** The callback index of each event type without function seen so far. */
+  std::unordered_map<std::type_index, uint32_t> m_types;
+  /** The readable name of each callback. */
+  std::vector<std::string> m_names;
+  /** The index of each callback name, since functions may share a name. */
+  std::unordered_map<std::string, uint32_t> m_indexes;
+  /** The cost per (callback index << 32 | context). */
+  std::unordered_map<uint64_t, Cost> m_costs;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the inline methods declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+bool
+EventProfiler::Sample (void)
+{
+  if (--m_countdown == 0)
+    {
+      m_countdown = m_samplePeriod;
+      return true;
+    }
+  return false;
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -237,6 +237,14 @@ HeapScheduler::Remove (const Event &ev)
           Exch (i, Last ());
           m_heap.pop_back ();
           TopDown (i);
+          // the former last item can also belong above i,
+          // when it came from another subtree.
+          while (i < m_heap.size () && !IsRoot (i)
+                 && IsLessStrictly (i, Parent (i)))
+            {
+              Exch (i, Parent (i));
+              i = Parent (i);
+            }
           return;
         }
     }
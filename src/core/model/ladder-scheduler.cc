@@ -0,0 +1,328 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+const uint32_t LadderScheduler::THRESHOLD;
+const uint32_t LadderScheduler::MAX_RUNGS;
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events, to keep Bottom in decreasing order.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+static bool
+EventGreater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (UINT64_MAX),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (uint32_t rung) const
+{
+  const Rung &r = m_rungs[rung];
+  return r.start + r.current * r.width;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= GetCurrentStart (i))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+uint64_t
+LadderScheduler::GetBottomEnd (void) const
+{
+  if (m_nRungs == 0)
+    {
+      return m_topStart;
+    }
+  return GetCurrentStart (m_nRungs - 1);
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (end > start && !events.empty ());
+
+  uint64_t n = events.size ();
+  uint64_t range = end - start;
+  uint64_t width = std::max ((range + n - 1) / n, (uint64_t)1);
+
+  Rung &rung = m_rungs[m_nRungs];
+  rung.start = start;
+  rung.width = width;
+  rung.nBuckets = static_cast<uint32_t> ((range + width - 1) / width);
+  rung.current = 0;
+  rung.count = static_cast<uint32_t> (n);
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint64_t bucket = (i->key.m_ts - start) / width;
+      NS_ASSERT (bucket < rung.nBuckets);
+      rung.buckets[bucket].push_back (*i);
+    }
+  events.clear ();
+  m_nRungs++;
+  NS_LOG_LOGIC ("rung " << m_nRungs - 1 << " width=" << width <<
+                ", nBuckets=" << rung.nBuckets);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0 && !m_top.empty ());
+
+  SpawnRung (m_top, m_topMin, m_topMax + 1);
+  const Rung &rung = m_rungs[0];
+  m_topStart = rung.start + rung.nBuckets * rung.width;
+  m_topMin = UINT64_MAX;
+  m_topMax = 0;
+}
+
+void
+LadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (),
+                                         ev, &EventGreater);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () > THRESHOLD
+      && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // Bottom is getting expensive to keep sorted: spread it over
+      // a new rung spanning up to the current lowest bucket.
+      SpawnRung (m_bottom, m_bottom.back ().key.m_ts, GetBottomEnd ());
+    }
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  if (!m_bottom.empty ())
+    {
+      return;
+    }
+  NS_ASSERT (!IsEmpty ());
+
+  for (;;)
+    {
+      while (m_nRungs > 0 && m_rungs[m_nRungs - 1].count == 0)
+        {
+          m_nRungs--;
+        }
+      if (m_nRungs == 0)
+        {
+          TransferTop ();
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = GetCurrentStart (m_nRungs - 1);
+      rung.current++;
+      rung.count -= bucket.size ();
+
+      if (bucket.size () > THRESHOLD && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t minTs = UINT64_MAX;
+          uint64_t maxTs = 0;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              minTs = std::min (minTs, i->key.m_ts);
+              maxTs = std::max (maxTs, i->key.m_ts);
+            }
+          if (minTs != maxTs)
+            {
+              SpawnRung (bucket, bucketStart, bucketStart + rung.width);
+              continue;
+            }
+        }
+
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end (), &EventGreater);
+      return;
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          uint64_t bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.nBuckets);
+          rung.buckets[bucket].push_back (ev);
+          rung.count++;
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  m_qSize++;
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Refilling Bottom does not change the set of events.
+  const_cast<LadderScheduler *> (this)->FillBottom ();
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i == m_nRungs)
+        {
+          Bucket::iterator j = std::lower_bound (m_bottom.begin (), m_bottom.end (),
+                                                 ev, &EventGreater);
+          NS_ASSERT (j != m_bottom.end () && j->key.m_uid == ev.key.m_uid);
+          NS_ASSERT (ev.impl == j->impl);
+          m_bottom.erase (j);
+          m_qSize--;
+          return;
+        }
+      Rung &rung = m_rungs[i];
+      bucket = &rung.buckets[(ts - rung.start) / rung.width];
+      rung.count--;
+    }
+
+  // Buckets are unsorted: swap the event with the last one.
+  for (Bucket::iterator j = bucket->begin (); j != bucket->end (); ++j)
+    {
+      if (j->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == j->impl);
+          *j = bucket->back ();
+          bucket->pop_back ();
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
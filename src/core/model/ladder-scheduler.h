@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * Events are kept in three tiers:
+ *  - Top: an unsorted list of the events far in the future, with
+ *    its minimum and maximum timestamps.
+ *  - Ladder: a small stack of rungs, each an array of unsorted
+ *    buckets of equal width.  Each rung spans exactly one bucket of
+ *    the rung above it.
+ *  - Bottom: a short sorted list of the earliest events.
+ *
+ * Events are dequeued from Bottom.  When Bottom is empty, the next
+ * non-empty bucket of the lowest rung is sorted into Bottom, or, if
+ * it holds more than THRESHOLD events, is spread over a new, finer
+ * rung.  When the ladder is exhausted, Top is spread over a new
+ * first rung whose width is derived from the Top timestamp range.
+ *
+ * Unlike CalendarScheduler, the bucket width adapts locally: only
+ * the events of one bucket are ever moved at a time, so there is no
+ * global resize pause when the event density changes.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket type: an unsorted vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;      /**< Timestamp at the start of the first bucket. */
+    uint64_t width;      /**< Duration of a bucket. */
+    uint32_t nBuckets;   /**< Number of buckets in use. */
+    uint32_t current;    /**< Index of the first unconsumed bucket. */
+    uint32_t count;      /**< Number of events in the rung. */
+    std::vector<Bucket> buckets; /**< The buckets. */
+  };
+
+  /**
+   * Maximum number of events sorted directly into Bottom; larger
+   * buckets are spread over a new rung.
+   */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /**
+   * Get the start of the first unconsumed bucket of a rung.
+   *
+   * \param [in] rung The rung index.
+   * \returns The timestamp at the start of the current bucket.
+   */
+  uint64_t GetCurrentStart (uint32_t rung) const;
+  /**
+   * Find the rung which holds, or would hold, a timestamp.
+   *
+   * \param [in] ts The timestamp.
+   * \returns The rung index, or \c m_nRungs if the timestamp belongs
+   *          to Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Get the end of the time range covered by the ladder, which is
+   * the start of the current bucket of the lowest rung, or the start
+   * of Top if the ladder is empty.
+   *
+   * \returns The timestamp at the start of the range above Bottom.
+   */
+  uint64_t GetBottomEnd (void) const;
+  /**
+   * Add a new rung below the current lowest rung, and spread some
+   * events over it.
+   *
+   * \param [in] events The events to spread; cleared on return.
+   * \param [in] start The start of the new rung.
+   * \param [in] end The end of the new rung.
+   */
+  void SpawnRung (Bucket &events, uint64_t start, uint64_t end);
+  /** Spread all the events in Top over a new first rung. */
+  void TransferTop (void);
+  /**
+   * Insert an event in Bottom, keeping it sorted.
+   *
+   * \param [in] ev The new Event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Refill Bottom from the ladder or Top, if it is empty. */
+  void FillBottom (void);
+
+  /** Top tier: unsorted far-future events. */
+  Bucket m_top;
+  /** Smallest timestamp in Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in Top. */
+  uint64_t m_topMax;
+  /** Events with timestamps at or past this go into Top. */
+  uint64_t m_topStart;
+  /** The rungs; only the first \c m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Bottom tier: sorted in decreasing order, so the next event is last. */
+  Bucket m_bottom;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
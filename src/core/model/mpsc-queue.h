@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "non-copyable.h"
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief A bounded, lock-free, multi-producer single-consumer queue.
+ *
+ * The queue is a ring of preallocated cells, each tagged with a
+ * sequence number (D. Vyukov's bounded queue).  Producers claim a cell
+ * with a single compare-and-swap on the tail index and publish it by
+ * storing the next sequence number; the consumer reads the head cell
+ * and recycles it by advancing its sequence number by one lap.
+ * Neither side takes a lock or calls the allocator after construction.
+ *
+ * Push() may be called concurrently from any number of threads.
+ * Pop() must only be called from a single thread at a time.
+ *
+ * The queue is bounded: Push() returns \c false instead of blocking
+ * when all cells are in use, and the caller is expected to provide a
+ * fallback path.
+ *
+ * \tparam T \explicit The item type.  It should be cheap to copy,
+ *           since items are copied in and out of the ring.
+ */
+template <typename T>
+class MpscQueue : private NonCopyable
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] capacity The number of cells, rounded up to the next
+   *             power of two.
+   */
+  MpscQueue (uint32_t capacity);
+  /** Destructor. */
+  ~MpscQueue ();
+
+  /**
+   * Append an item to the queue.  Safe to call from any thread.
+   * \param [in] item The item to add.
+   * \return \c true if the item was added, \c false if the queue is full.
+   */
+  bool Push (const T &item);
+  /**
+   * Remove the item at the head of the queue.  Only one thread may
+   * consume from the queue.
+   *
+   * An item which has been claimed by a producer but not yet published
+   * is not visible, so a \c false return does not prove the queue is
+   * empty when producers are still running.
+   *
+   * \param [out] item The removed item.
+   * \return \c true if an item was removed.
+   */
+  bool Pop (T &item);
+  /**
+   * Check whether all claimed cells up to now have been consumed.
+   * Only meaningful from the consumer thread.
+   * \return \c true if the queue holds no claimed cells.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Get the number of cells in the ring.
+   * \return The queue capacity.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  /** A ring cell: the stored item and its sequence number. */
+  struct Cell
+  {
+    /** Lap-tagged sequence number, see the class documentation. */
+    std::atomic<uint64_t> sequence;
+    /** The stored item. */
+    T data;
+  };
+
+  /** The ring of cells. */
+  Cell *m_cells;
+  /** Index mask, \c capacity - 1. */
+  uint64_t m_mask;
+  /** Next cell to be claimed by a producer. */
+  std::atomic<uint64_t> m_tail;
+  /**
+   * Padding, to keep the producer and consumer indices in different
+   * cache lines.
+   */
+  char m_pad[64];
+  /** Next cell to be read by the consumer. */
+  uint64_t m_head;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_tail (0),
+    m_head (0)
+{
+  uint32_t size = 2;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_cells = new Cell [size];
+  m_mask = size - 1;
+  for (uint64_t i = 0; i < size; ++i)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Push (const T &item)
+{
+  Cell *cell;
+  uint64_t pos = m_tail.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      cell = &m_cells[pos & m_mask];
+      uint64_t seq = cell->sequence.load (std::memory_order_acquire);
+      int64_t dif = (int64_t)seq - (int64_t)pos;
+      if (dif == 0)
+        {
+          // The cell is free for this lap: try to claim it.
+          if (m_tail.compare_exchange_weak (pos, pos + 1,
+                                            std::memory_order_relaxed))
+            {
+              break;
+            }
+          // pos has been reloaded by the failed exchange.
+        }
+      else if (dif < 0)
+        {
+          // The consumer has not recycled this cell yet: full.
+          return false;
+        }
+      else
+        {
+          // Another producer claimed this cell first.
+          pos = m_tail.load (std::memory_order_relaxed);
+        }
+    }
+  cell->data = item;
+  cell->sequence.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &item)
+{
+  Cell *cell = &m_cells[m_head & m_mask];
+  uint64_t seq = cell->sequence.load (std::memory_order_acquire);
+  if (seq != m_head + 1)
+    {
+      // Either empty, or claimed but not yet published.
+      return false;
+    }
+  item = cell->data;
+  cell->sequence.store (m_head + m_mask + 1, std::memory_order_release);
+  ++m_head;
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  return m_tail.load (std::memory_order_acquire) == m_head;
+}
+
+template <typename T>
+uint32_t
+MpscQueue<T>::GetCapacity (void) const
+{
+  return static_cast<uint32_t> (m_mask + 1);
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
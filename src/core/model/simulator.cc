@@ -150,6 +150,13 @@ Simulator::Destroy (void)
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+
+  EventImpl::PoolStatistics pool = EventImpl::GetPoolStatistics ();
+  uint64_t pooled = pool.hits + pool.misses;
+  NS_LOG_INFO ("event pool: " << pool.hits << " hits, " <<
+               pool.misses << " misses (" <<
+               (pooled > 0 ? 100.0 * pool.hits / pooled : 0.0) <<
+               "% hit rate), " << pool.unpooled << " unpooled");
 }
 
 void
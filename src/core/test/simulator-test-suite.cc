@@ -19,10 +19,18 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <sstream>
 
 using namespace ns3;
 
@@ -170,6 +178,248 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check event ordering under a hold model with removals with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // Reference schedule, mapping each pending key to its fake impl.
+  std::map<Scheduler::EventKey, EventImpl *> expected;
+  uint32_t uid = 4;
+  uint64_t now = 0;
+
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = reinterpret_cast<EventImpl *> (static_cast<uintptr_t> (uid));
+      ev.key.m_ts = rng->GetInteger (0, 1000000);
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      expected[ev.key] = ev.impl;
+    }
+
+  for (uint32_t i = 0; i < 20000; ++i)
+    {
+      uint32_t op = rng->GetInteger (0, 9);
+      if (op < 5 || expected.empty ())
+        {
+          // Mix short and long delays, and bursts of equal timestamps,
+          // to change the event density along the run.
+          uint64_t delay;
+          if (op == 0)
+            {
+              delay = 0;
+            }
+          else if (op == 1)
+            {
+              delay = rng->GetInteger (0, 1000000);
+            }
+          else
+            {
+              delay = rng->GetInteger (0, 100);
+            }
+          Scheduler::Event ev;
+          ev.impl = reinterpret_cast<EventImpl *> (static_cast<uintptr_t> (uid));
+          ev.key.m_ts = now + delay;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          expected[ev.key] = ev.impl;
+        }
+      else if (op < 9)
+        {
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          std::map<Scheduler::EventKey, EventImpl *>::iterator next = expected.begin ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, next->first.m_uid, "Event dequeued out of order");
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, next->first.m_ts, "Event dequeued with the wrong timestamp");
+          now = ev.key.m_ts;
+          expected.erase (next);
+        }
+      else
+        {
+          std::map<Scheduler::EventKey, EventImpl *>::iterator victim = expected.begin ();
+          std::advance (victim, rng->GetInteger (0, expected.size () - 1));
+          Scheduler::Event ev;
+          ev.impl = victim->second;
+          ev.key = victim->first;
+          scheduler->Remove (ev);
+          expected.erase (victim);
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), expected.empty (), "Wrong IsEmpty () result");
+      if (!expected.empty ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, expected.begin ()->first.m_uid, "Wrong PeekNext () result");
+        }
+    }
+
+  while (!expected.empty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->first.m_uid, "Event dequeued out of order");
+      expected.erase (expected.begin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler not empty after draining");
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event (int i);
+  int m_count;
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that released events are reused by the event pool")
+{
+}
+
+void
+EventPoolTestCase::Event (int i)
+{
+  m_count += i;
+}
+
+void
+EventPoolTestCase::DoRun (void)
+{
+  m_count = 0;
+  for (int i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Event, this, 1);
+    }
+  Simulator::Run ();
+
+  EventImpl::PoolStatistics before = EventImpl::GetPoolStatistics ();
+  for (int i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Event, this, 1);
+    }
+  EventImpl::PoolStatistics after = EventImpl::GetPoolStatistics ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, 200, "Events did not run");
+  NS_TEST_EXPECT_MSG_EQ (after.hits - before.hits, (uint64_t)100, "Released events were not reused");
+  NS_TEST_EXPECT_MSG_EQ (after.misses, before.misses, "Unexpected allocations");
+}
+
+class EventProfilerTestBase
+{
+public:
+  virtual ~EventProfilerTestBase ();
+  virtual void Event (void);
+};
+
+EventProfilerTestBase::~EventProfilerTestBase ()
+{
+}
+
+void
+EventProfilerTestBase::Event (void)
+{
+}
+
+class EventProfilerTestDerived : public EventProfilerTestBase
+{
+public:
+  virtual void Event (void);
+};
+
+void
+EventProfilerTestDerived::Event (void)
+{
+}
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  void Event (int i);
+  void OtherEvent (int i);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the event profiler attribution and output")
+{
+}
+
+void
+EventProfilerTestCase::Event (int i)
+{
+}
+
+void
+EventProfilerTestCase::OtherEvent (int i)
+{
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  EventImpl *event = MakeEvent (&EventProfilerTestCase::Event, this, 1);
+  EventImpl *other = MakeEvent (&EventProfilerTestCase::OtherEvent, this, 1);
+  EventProfilerTestDerived derived;
+  EventImpl *virtualEvent = MakeEvent (&EventProfilerTestBase::Event, static_cast<EventProfilerTestBase *> (&derived));
+  EventProfiler profiler (2);
+  uint32_t callback = profiler.GetCallback (event);
+  uint32_t sampled = 0;
+  for (int i = 0; i < 10; i++)
+    {
+      if (profiler.Sample ())
+        {
+          sampled++;
+          profiler.Record (callback, 3, 100);
+        }
+    }
+  profiler.Record (profiler.GetCallback (event), Simulator::NO_CONTEXT, 50);
+  profiler.Record (profiler.GetCallback (other), 3, 10);
+  profiler.Record (profiler.GetCallback (virtualEvent), 3, 20);
+  event->Unref ();
+  other->Unref ();
+  virtualEvent->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (sampled, 5, "Wrong sampling period");
+
+  // The callbacks of the same signature are told apart by their symbol,
+  // and the virtual methods are resolved on the object.
+  std::ostringstream collapsed;
+  profiler.WriteCollapsed (collapsed);
+  std::string name = "EventProfilerTestCase::Event(int)";
+  NS_TEST_EXPECT_MSG_NE (collapsed.str ().find ("ns3::Simulator::Run;node 3;" + name + " 1000\n"),
+                         std::string::npos, "Missing node line in " << collapsed.str ());
+  NS_TEST_EXPECT_MSG_NE (collapsed.str ().find ("ns3::Simulator::Run;no context;" + name + " 100\n"),
+                         std::string::npos, "Missing no context line in " << collapsed.str ());
+  NS_TEST_EXPECT_MSG_NE (collapsed.str ().find ("ns3::Simulator::Run;node 3;EventProfilerTestCase::OtherEvent(int) 20\n"),
+                         std::string::npos, "Missing other callback in " << collapsed.str ());
+  NS_TEST_EXPECT_MSG_NE (collapsed.str ().find ("ns3::Simulator::Run;node 3;EventProfilerTestDerived::Event() 40\n"),
+                         std::string::npos, "Missing virtual callback in " << collapsed.str ());
+
+  std::ostringstream top;
+  profiler.PrintTop (top, 1);
+  NS_TEST_EXPECT_MSG_NE (top.str ().find (name), std::string::npos,
+                         "Missing callback in " << top.str ());
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,7 +725,27 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (HeapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -21,17 +21,21 @@
 #include "ns3/simulator.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/mpsc-queue.h"
 
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
 #include <list>
 #include <thread>  // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +230,87 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class MpscQueueTestCase : public TestCase
+{
+public:
+  MpscQueueTestCase (unsigned int threads);
+  /** An item in the queue: producer number and sequence number. */
+  struct Item
+  {
+    unsigned int threadno;
+    uint32_t seq;
+  };
+  static void ProducerThread (std::pair<MpscQueueTestCase *, unsigned int> context);
+  static const uint32_t ITEMS = 100000;
+  unsigned int m_threads;
+  MpscQueue<Item> m_queue;
+
+private:
+  virtual void DoRun (void);
+};
+
+MpscQueueTestCase::MpscQueueTestCase (unsigned int threads)
+  : TestCase ("Check lock-free queue ordering with " +
+              std::to_string (threads) + " producer threads"),
+    m_threads (threads),
+    m_queue (16)
+{
+}
+
+void
+MpscQueueTestCase::ProducerThread (std::pair<MpscQueueTestCase *, unsigned int> context)
+{
+  MpscQueueTestCase *me = context.first;
+  Item item;
+  item.threadno = context.second;
+  for (item.seq = 0; item.seq < ITEMS; ++item.seq)
+    {
+      while (!me->m_queue.Push (item))
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MpscQueueTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      threads.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+            &MpscQueueTestCase::ProducerThread,
+                std::pair<MpscQueueTestCase *, unsigned int> (this, i) )) );
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+
+  std::vector<uint32_t> next (m_threads, 0);
+  uint64_t received = 0;
+  bool inOrder = true;
+  Item item;
+  while (received < (uint64_t)m_threads * ITEMS)
+    {
+      if (m_queue.Pop (item))
+        {
+          inOrder = inOrder && item.seq == next[item.threadno];
+          next[item.threadno] = item.seq + 1;
+          ++received;
+        }
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (inOrder, true, "Items from one producer were reordered");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.IsEmpty (), true, "Queue not empty after all items were consumed");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Pop (item), false, "Pop from an empty queue succeeded");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,8 +326,10 @@ public:
     std::string schedulerTypes[] = {
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
+      "ns3::DaryHeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -263,5 +350,7 @@ public:
               }
           }
       }
+    AddTestCase (new MpscQueueTestCase (1), TestCase::QUICK);
+    AddTestCase (new MpscQueueTestCase (4), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -67,6 +67,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New trace is not empty");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -75,6 +76,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Trace with callbacks is empty");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -95,6 +97,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // If we now disconnect callback two then neither callback should be called.
   //
   trace.DisconnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "Trace without callbacks is not empty");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -66,7 +66,8 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_index ()
 {
   NS_LOG_FUNCTION (this);
 }
@@ -99,6 +100,7 @@ CandidateQueue::Push (SPFVertex *vNew)
       &CandidateQueue::CompareSPFVertex
       );
   m_candidates.insert (i, vNew);
+  m_index[vNew->GetVertexId ()] = vNew;
 }
 
 SPFVertex *
@@ -112,6 +114,11 @@ CandidateQueue::Pop (void)
 
   SPFVertex *v = m_candidates.front ();
   m_candidates.pop_front ();
+  std::map<Ipv4Address, SPFVertex*>::iterator i = m_index.find (v->GetVertexId ());
+  if (i != m_index.end () && i->second == v)
+    {
+      m_index.erase (i);
+    }
   return v;
 }
 
@@ -145,15 +152,10 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::map<Ipv4Address, SPFVertex*>::const_iterator i = m_index.find (addr);
+  if (i != m_index.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return i->second;
     }
 
   return 0;
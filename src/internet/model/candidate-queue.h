@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -186,6 +187,7 @@ private:
 
   typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
   CandidateList_t m_candidates;  //!< SPFVertex candidates
+  std::map<Ipv4Address, SPFVertex*> m_index; //!< SPFVertex candidates, by vertex ID
 
   /**
    * \brief Stream insertion operator.
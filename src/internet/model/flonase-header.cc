@@ -22,6 +22,7 @@
 #include <iostream>
 #include "flonase-header.h"
 #include "flonase-option.h"
+#include "flonase-option-ts.h"
 #include "ns3/buffer.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
@@ -43,7 +44,8 @@ FlonaseHeader::FlonaseHeader ()
     m_urgentPointer (0),
     m_calcChecksum (false),
     m_goodChecksum (true),
-    m_optionsLen (0)
+    m_optionsLen (0),
+    m_rawOptionsLen (0)
 {
 }
 
@@ -295,6 +297,7 @@ FlonaseHeader::Print (std::ostream &os)  const
 
   os << " Seq=" << m_sequenceNumber << " Ack=" << m_ackNumber << " Win=" << m_windowSize;
 
+  DecodeOptions ();
   FlonaseOptionList::const_iterator op;
 
   for (op = m_options.begin (); op != m_options.end (); ++op)
@@ -328,6 +331,11 @@ FlonaseHeader::Serialize (Buffer::Iterator start)  const
   // This implementation does not presently try to align options on word
   // boundaries using NOP options
   uint32_t optionLen = 0;
+  if (m_rawOptionsLen > 0)
+    {
+      i.Write (m_rawOptions, m_rawOptionsLen);
+      optionLen = m_rawOptionsLen;
+    }
   FlonaseOptionList::const_iterator op;
   for (op = m_options.begin (); op != m_options.end (); ++op)
     {
@@ -372,14 +380,47 @@ FlonaseHeader::Deserialize (Buffer::Iterator start)
   i.Next (2);
   m_urgentPointer = i.ReadNtohU16 ();
 
-  // Deserialize options if they exist
+  // Store the options if they exist; they are decoded only when needed,
+  // so that segments carrying just a timestamp do not allocate anything
   m_options.clear ();
+  m_rawOptionsLen = 0;
   uint32_t optionLen = (m_length - 5) * 4;
   if (optionLen > m_maxOptionsLen)
     {
       NS_LOG_ERROR ("Illegal FLONASE option length " << optionLen << "; options discarded");
       return 20;
     }
+  i.Read (m_rawOptions, optionLen);
+  m_rawOptionsLen = optionLen;
+  m_optionsLen = optionLen;
+
+  // Do checksum
+  if (m_calcChecksum)
+    {
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+      m_goodChecksum = (checksum == 0);
+    }
+
+  return GetSerializedSize ();
+}
+
+void
+FlonaseHeader::DecodeOptions (void) const
+{
+  if (m_rawOptionsLen == 0)
+    {
+      return;
+    }
+
+  Buffer buffer;
+  buffer.AddAtStart (m_rawOptionsLen);
+  buffer.Begin ().Write (m_rawOptions, m_rawOptionsLen);
+  Buffer::Iterator i = buffer.Begin ();
+  uint32_t optionLen = m_rawOptionsLen;
+  m_rawOptionsLen = 0;
+
   while (optionLen)
     {
       uint8_t kind = i.PeekU8 ();
@@ -405,7 +446,6 @@ FlonaseHeader::Deserialize (Buffer::Iterator start)
           optionLen -= optionSize;
           i.Next (optionSize);
           m_options.push_back (op);
-          m_optionsLen += optionSize;
         }
       else
         {
@@ -414,37 +454,80 @@ FlonaseHeader::Deserialize (Buffer::Iterator start)
         }
       if (op->GetKind () == FlonaseOption::END)
         {
-          while (optionLen)
-            {
-              // Discard padding bytes without adding to option list
-              i.Next (1);
-              --optionLen;
-              ++m_optionsLen;
-            }
+          // Discard padding bytes without adding to option list
+          break;
         }
     }
+}
 
-  if (m_length != CalculateHeaderLength ())
+uint8_t
+FlonaseHeader::FindRawOption (uint8_t kind) const
+{
+  uint8_t i = 0;
+  while (i < m_rawOptionsLen)
     {
-      NS_LOG_ERROR ("Mismatch between calculated length and in-header value");
-    }
+      uint8_t rawKind = m_rawOptions[i];
+      if (rawKind == FlonaseOption::END)
+        {
+          // Only padding follows
+          return kind == FlonaseOption::END ? i : m_rawOptionsLen;
+        }
+      if (rawKind == FlonaseOption::NOP)
+        {
+          if (kind == FlonaseOption::NOP)
+            {
+              return i;
+            }
+          ++i;
+          continue;
+        }
 
-  // Do checksum
-  if (m_calcChecksum)
-    {
-      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-      m_goodChecksum = (checksum == 0);
+      // Stop where DecodeOptions would stop, i.e. at a malformed option
+      if (i + 1 >= m_rawOptionsLen)
+        {
+          break;
+        }
+      uint8_t size = m_rawOptions[i + 1];
+      bool sizeOk;
+      switch (rawKind)
+        {
+        case FlonaseOption::MSS:
+          sizeOk = (size == 4);
+          break;
+        case FlonaseOption::WINSCALE:
+          sizeOk = (size == 3);
+          break;
+        case FlonaseOption::SACKPERMITTED:
+          sizeOk = (size == 2);
+          break;
+        case FlonaseOption::SACK:
+          sizeOk = (size >= 2 && (size - 2) % 8 == 0);
+          break;
+        case FlonaseOption::TS:
+          sizeOk = (size == 10);
+          break;
+        default:
+          sizeOk = (size >= 2);
+          break;
+        }
+      if (!sizeOk || i + size > m_rawOptionsLen)
+        {
+          break;
+        }
+      if (rawKind == kind)
+        {
+          return i;
+        }
+      i += size;
     }
 
-  return GetSerializedSize ();
+  return m_rawOptionsLen;
 }
 
 uint8_t
 FlonaseHeader::CalculateHeaderLength () const
 {
-  uint32_t len = 20;
+  uint32_t len = 20 + m_rawOptionsLen;
   FlonaseOptionList::const_iterator i;
 
   for (i = m_options.begin (); i != m_options.end (); ++i)
@@ -462,6 +545,7 @@ FlonaseHeader::CalculateHeaderLength () const
 bool
 FlonaseHeader::AppendOption (Ptr<const FlonaseOption> option)
 {
+  DecodeOptions ();
   if (m_optionsLen + option->GetSerializedSize () <= m_maxOptionsLen)
     {
       if (!FlonaseOption::IsKindKnown (option->GetKind ()))
@@ -488,12 +572,14 @@ FlonaseHeader::AppendOption (Ptr<const FlonaseOption> option)
 const FlonaseHeader::FlonaseOptionList&
 FlonaseHeader::GetOptionList () const
 {
+  DecodeOptions ();
   return m_options;
 }
 
 Ptr<const FlonaseOption>
 FlonaseHeader::GetOption(uint8_t kind) const
 {
+  DecodeOptions ();
   FlonaseOptionList::const_iterator i;
 
   for (i = m_options.begin (); i != m_options.end (); ++i)
@@ -510,6 +596,12 @@ FlonaseHeader::GetOption(uint8_t kind) const
 bool
 FlonaseHeader::HasOption (uint8_t kind) const
 {
+  if (m_rawOptionsLen > 0 && FlonaseOption::IsKindKnown (kind))
+    {
+      return FindRawOption (kind) < m_rawOptionsLen;
+    }
+
+  DecodeOptions ();
   FlonaseOptionList::const_iterator i;
 
   for (i = m_options.begin (); i != m_options.end (); ++i)
@@ -523,6 +615,34 @@ FlonaseHeader::HasOption (uint8_t kind) const
   return false;
 }
 
+bool
+FlonaseHeader::GetTimestamp (uint32_t &timestamp, uint32_t &echo) const
+{
+  if (m_rawOptionsLen > 0)
+    {
+      uint8_t i = FindRawOption (FlonaseOption::TS);
+      if (i == m_rawOptionsLen)
+        {
+          return false;
+        }
+      const uint8_t *value = m_rawOptions + i + 2;
+      timestamp = (static_cast<uint32_t> (value[0]) << 24) | (value[1] << 16)
+        | (value[2] << 8) | value[3];
+      echo = (static_cast<uint32_t> (value[4]) << 24) | (value[5] << 16)
+        | (value[6] << 8) | value[7];
+      return true;
+    }
+
+  Ptr<const FlonaseOptionTS> ts = DynamicCast<const FlonaseOptionTS> (GetOption (FlonaseOption::TS));
+  if (ts == 0)
+    {
+      return false;
+    }
+  timestamp = ts->GetTimestamp ();
+  echo = ts->GetEcho ();
+  return true;
+}
+
 bool
 operator== (const FlonaseHeader &lhs, const FlonaseHeader &rhs)
 {
@@ -96,10 +96,32 @@ FlonaseTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 FlonaseTxBuffer::FlonaseTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_scoreboard (m_sentList)
 {
 }
 
+FlonaseTxBuffer::FlonaseTxBuffer (const FlonaseTxBuffer &other)
+  : Object (other),
+    m_appList (other.m_appList),
+    m_sentList (other.m_sentList),
+    m_maxBuffer (other.m_maxBuffer),
+    m_size (other.m_size),
+    m_sentSize (other.m_sentSize),
+    m_firstByteSeq (other.m_firstByteSeq),
+    m_highestSack (std::make_pair (m_sentList.end (), SequenceNumber32 (0))),
+    m_scoreboard (m_sentList),
+    m_dupAckThresh (other.m_dupAckThresh),
+    m_segmentSize (other.m_segmentSize),
+    m_renoSack (other.m_renoSack)
+{
+  // The index refers to the items of this sent list, not to the other one
+  for (PacketList::iterator it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      m_scoreboard.Add (it);
+    }
+}
+
 FlonaseTxBuffer::~FlonaseTxBuffer (void)
 {
   PacketList::iterator it;
@@ -294,7 +316,7 @@ FlonaseTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_scoreboard.Add (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,46 +330,38 @@ FlonaseTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber3
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  auto it = m_scoreboard.Find (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if (it != m_sentList.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
   FlonaseTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, s, seq, &listEdited);
 
-  if (! item->m_retrans)
-    {
-      m_retrans += item->m_packet->GetSize ();
-      item->m_retrans = true;
-    }
+  m_scoreboard.SetRetrans (item, true);
 
   return item;
 }
@@ -398,7 +412,7 @@ FlonaseTxBuffer::SplitItems (FlonaseTxItem *t1, FlonaseTxItem *t2, uint32_t size
 FlonaseTxItem*
 FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +448,23 @@ FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &li
   FlonaseTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool indexed = &list == &m_sentList;
+
+  if (indexed)
+    {
+      // Jump to the item containing seq
+      it = m_scoreboard.FindContaining (seq);
+      if (it != list.end ())
+        {
+          beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!indexed || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -466,10 +491,19 @@ FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &li
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               FlonaseTxItem *firstPart = new FlonaseTxItem ();
+              if (indexed)
+                {
+                  m_scoreboard.Remove (it);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  m_scoreboard.Add (firstIt);
+                  m_scoreboard.Add (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -532,10 +566,19 @@ FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &li
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               FlonaseTxItem *firstPart = new FlonaseTxItem ();
+              if (indexed)
+                {
+                  m_scoreboard.Remove (it);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  m_scoreboard.Add (firstIt);
+                  m_scoreboard.Add (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -548,6 +591,7 @@ FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &li
         {
           // The end isn't inside current packet, but there is an exception for
           // the merge and recurse strategy...
+          PacketList::iterator currentIt = it;
           if (++it == list.end ())
             {
               // ...current is the last packet we sent. We have not more data;
@@ -563,8 +607,17 @@ FlonaseTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &li
           FlonaseTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
 
+          if (indexed)
+            {
+              m_scoreboard.Remove (currentIt);
+              m_scoreboard.Remove (it);
+            }
           MergeItems (currentItem, next);
           list.erase (it);
+          if (indexed)
+            {
+              m_scoreboard.Add (currentIt);
+            }
 
           delete next;
 
@@ -599,22 +652,12 @@ FlonaseTxBuffer::MergeItems (FlonaseTxItem *t1, FlonaseTxItem *t2) const
 
   // If one is retrans and the other is not, cancel the retransmitted flag.
   // We are merging this segment for the retransmit, so the count will
-  // be updated in GetTransmittedSegment.
+  // be updated in GetTransmittedSegment. The items are out of the
+  // scoreboard while they are merged.
   if (! AreEquals (t1->m_retrans, t2->m_retrans))
     {
-      if (t1->m_retrans)
-        {
-          FlonaseTxBuffer *self = const_cast<FlonaseTxBuffer*> (this);
-          self->m_retrans -= t1->m_packet->GetSize ();
-          t1->m_retrans = false;
-        }
-      else
-        {
-          NS_ASSERT (t2->m_retrans);
-          FlonaseTxBuffer *self = const_cast<FlonaseTxBuffer*> (this);
-          self->m_retrans -= t2->m_packet->GetSize ();
-          t2->m_retrans = false;
-        }
+      t1->m_retrans = false;
+      t2->m_retrans = false;
     }
 
   if (t1->m_lastSent < t2->m_lastSent)
@@ -627,27 +670,6 @@ FlonaseTxBuffer::MergeItems (FlonaseTxItem *t1, FlonaseTxItem *t2) const
   NS_LOG_INFO ("Situation after the merge: " << *t1);
 }
 
-void
-FlonaseTxBuffer::RemoveFromCounts (FlonaseTxItem *item, uint32_t size)
-{
-  NS_LOG_FUNCTION (this << *item << size);
-  if (item->m_sacked)
-    {
-      NS_ASSERT (m_sackedOut >= size);
-      m_sackedOut -= size;
-    }
-  if (item->m_retrans)
-    {
-      NS_ASSERT (m_retrans >= size);
-      m_retrans -= size;
-    }
-  if (item->m_lost)
-    {
-      NS_ASSERT_MSG (m_lostOut >= size, "Trying to remove " << size <<
-                     " bytes from " << m_lostOut);
-      m_lostOut -= size;
-    }
-}
 void
 FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 {
@@ -659,8 +681,8 @@ FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       NS_LOG_DEBUG ("Seq " << seq << " already discarded.");
       return;
     }
-  NS_LOG_DEBUG ("Remove up to " << seq << " lost: " << m_lostOut <<
-                " retrans: " << m_retrans << " sacked: " << m_sackedOut);
+  NS_LOG_DEBUG ("Remove up to " << seq << " lost: " << GetLost () <<
+                " retrans: " << GetRetransmitsCount () << " sacked: " << GetSacked ());
 
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
@@ -691,11 +713,11 @@ FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           offset -= pktSize;
           m_firstByteSeq += pktSize;
 
-          RemoveFromCounts (item, pktSize);
+          m_scoreboard.Remove (i);
 
           i = m_sentList.erase (i);
-          NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
-                       " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
+          NS_LOG_INFO ("Removed " << *item << " lost: " << GetLost () <<
+                       " retrans: " << GetRetransmitsCount () << " sacked: " << GetSacked () <<
                        ". Remaining data " << m_size);
           delete item;
         }
@@ -703,14 +725,14 @@ FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          m_scoreboard.Remove (i);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
-
-          RemoveFromCounts (item, offset);
+          m_scoreboard.Add (i);
 
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize << " resulting item is " <<
@@ -733,8 +755,7 @@ FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
-          head->m_sacked = false;
-          m_sackedOut -= head->m_packet->GetSize ();
+          m_scoreboard.SetSacked (head, false);
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -750,11 +771,11 @@ FlonaseTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
 
-  NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
-                " retrans: " << m_retrans << " sacked: " << m_sackedOut);
+  NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << GetLost () <<
+                " retrans: " << GetRetransmitsCount () << " sacked: " << GetSacked ());
   NS_LOG_LOGIC ("Buffer status after discarding data " << *this);
   NS_ASSERT (m_firstByteSeq >= seq);
-  NS_ASSERT (m_sentSize >= m_sackedOut + m_lostOut);
+  NS_ASSERT (m_sentSize >= GetSacked () + GetLost ());
   ConsistencyCheck ();
 }
 
@@ -768,68 +789,68 @@ FlonaseTxBuffer::Update (const FlonaseOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Jump to the first packet starting inside the block
+      PacketList::iterator item_it = m_scoreboard.LowerBound ((*option_it).first);
+
       while (item_it != m_sentList.end ())
         {
-          uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          FlonaseTxItem *item = *item_it;
+          uint32_t pktSize = item->m_packet->GetSize ();
+          SequenceNumber32 beginOfCurrentPacket = item->m_startSeq;
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
           // is reporting as sacked single range bytes that are not mapped 1:1
           // in what we have, the option is discarded. There's room for improvement
           // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
+          if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
-              if ((*item_it)->m_sacked)
-                {
-                  NS_ASSERT (!(*item_it)->m_lost);
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard already sacked");
-                }
-              else
-                {
-                  if ((*item_it)->m_lost)
-                    {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
-                    }
-
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
+              // We already passed the received block end. Exit from the loop
+              NS_LOG_INFO ("Received block [" << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           "], not found, breaking loop");
+              break;
+            }
 
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
-                    }
+          modified = true;
 
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
+          if (item->m_sacked)
+            {
+              NS_ASSERT (!item->m_lost);
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           ", found in the sackboard already sacked");
+
+              // Jump over the run of sacked packets, if it ends inside the block
+              SequenceNumber32 start;
+              SequenceNumber32 end;
+              m_scoreboard.GetSackedRanges ().FindFrom (beginOfCurrentPacket, &start, &end);
+              if (end > (*option_it).second)
+                {
+                  break;
                 }
-              modified = true;
+              item_it = m_scoreboard.LowerBound (end);
+              continue;
             }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+
+          m_scoreboard.SetSacked (item, true);
+
+          if (m_highestSack.first == m_sentList.end()
+              || m_highestSack.second <= beginOfCurrentPacket + pktSize)
             {
-              // We already passed the received block end. Exit from the loop
-              NS_LOG_INFO ("Received block [" << *option_it <<
-                           ", checking sentList for block " << *(*item_it) <<
-                           "], not found, breaking loop");
-              break;
+              m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
             }
 
-          beginOfCurrentPacket += pktSize;
+          NS_LOG_INFO ("Received block " << *option_it <<
+                       ", checking sentList for block " << *item <<
+                       ", found in the sackboard, sacking, current highSack: " <<
+                       m_highestSack.second);
           ++item_it;
         }
     }
@@ -841,7 +862,7 @@ FlonaseTxBuffer::Update (const FlonaseOptionSack::SackList &list)
     }
 
   NS_ASSERT ((*(m_sentList.begin ()))->m_sacked == false);
-  NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
+  NS_ASSERT_MSG (m_sentSize >= GetSacked () + GetLost (), *this);
   //NS_ASSERT (list.size () == 0 || modified);   // Assert for duplicated SACK or
                                                  // impossiblity to map the option into the sent blocks
   ConsistencyCheck ();
@@ -852,45 +873,55 @@ void
 FlonaseTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+                   ", nothing sacked");
+      return;
     }
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*m_highestSack.first));
+
+  // The packets below the m_dupAckThresh-th sacked one, counting down from
+  // the highest sacked, are lost. Count the sacked packets run by run.
+  const FlonaseTxItem *highest = *m_highestSack.first;
+  SequenceNumber32 lostEnd = highest->m_startSeq + highest->m_packet->GetSize ();
+  SequenceNumber32 runEnd = lostEnd;
+  SequenceNumber32 start;
+  SequenceNumber32 end;
+  uint32_t sacked = 0;
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  while (sacked < m_dupAckThresh
+         && m_scoreboard.GetSackedRanges ().FindBefore (runEnd, &start, &end))
     {
-      FlonaseTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
+      PacketList::iterator it = m_scoreboard.FindContaining (std::min (end, runEnd) - 1);
+      NS_ASSERT (it != m_sentList.end ());
+      while (true)
         {
-          if (!item->m_sacked && !item->m_lost)
+          if (++sacked >= m_dupAckThresh)
+            {
+              lostEnd = (*it)->m_startSeq;
+              break;
+            }
+          if ((*it)->m_startSeq == start)
             {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
+              break;
             }
+          --it;
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      runEnd = start;
     }
 
   if (sacked >= m_dupAckThresh)
     {
-      FlonaseTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      // The packets before the starting point have been marked already
+      for (PacketList::iterator it = m_scoreboard.GetLossMarkStart (lostEnd);
+           it != m_sentList.end () && (*it)->m_startSeq < lostEnd; ++it)
         {
-          item->m_lost = true;
-          m_lostOut += item->m_packet->GetSize ();
+          if (!(*it)->m_sacked)
+            {
+              m_scoreboard.SetLost (*it, true);
+            }
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,38 +933,38 @@ FlonaseTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first packet starting at or after seq which is lost or sacked
+  // decides: find the first lost and sacked sequences after its start.
+  PacketList::iterator it = m_scoreboard.LowerBound (seq);
+  if (it == m_sentList.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
+      return false;
+    }
+  SequenceNumber32 beginOfCurrentPacket = (*it)->m_startSeq;
+  SequenceNumber32 lost;
+  SequenceNumber32 sacked;
+  SequenceNumber32 end;
 
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
+  if (!m_scoreboard.GetLostRanges ().FindFrom (beginOfCurrentPacket, &lost, &end))
+    {
+      return false;
+    }
+  lost = std::max (lost, beginOfCurrentPacket);
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+  if (m_scoreboard.GetSackedRanges ().FindFrom (beginOfCurrentPacket, &sacked, &end)
+      && std::max (sacked, beginOfCurrentPacket) < lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+      return false;
     }
 
-  return false;
+  NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+  return true;
 }
 
 bool
@@ -954,35 +985,13 @@ FlonaseTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  FlonaseTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  SequenceNumber32 lostSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (m_scoreboard.FindLostNotRetransmitted (&lostSeq))
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << lostSeq);
+      *seq = lostSeq;
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,7 +1017,9 @@ FlonaseTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  SequenceNumber32 seqPerRule3;
+
+  if (isRecovery && m_scoreboard.FindNotMarked (&seqPerRule3))
     {
       NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
       *seq = seqPerRule3;
@@ -1034,12 +1045,12 @@ FlonaseTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
 uint32_t
 FlonaseTxBuffer::BytesInFlight () const
 {
-  NS_ASSERT_MSG (m_sackedOut + m_lostOut <= m_sentSize,
-                 "Count of sacked " << m_sackedOut << " and lost " << m_lostOut <<
+  NS_ASSERT_MSG (GetSacked () + GetLost () <= m_sentSize,
+                 "Count of sacked " << GetSacked () << " and lost " << GetLost () <<
                  " is out of sync with sent list size " << m_sentSize <<
                  " " << *this);
-  uint32_t leftOut = m_sackedOut + m_lostOut;
-  uint32_t retrans = m_retrans;
+  uint32_t leftOut = GetSacked () + GetLost ();
+  uint32_t retrans = GetRetransmitsCount ();
 
   NS_LOG_INFO ("Sent size: " << m_sentSize << " leftOut: " << leftOut <<
                " retrans: " << retrans);
@@ -1105,12 +1116,12 @@ FlonaseTxBuffer::BytesInFlightRFC () const
       beginOfCurrentPkt += item->m_packet->GetSize ();
     }
 
-  NS_ASSERT_MSG(lostOut == m_lostOut, "Lost counted: " << lostOut << " " <<
-                m_lostOut << "\n" << *this);
-  NS_ASSERT_MSG(retrans == m_retrans, "Retrans Counted: " << retrans << " " <<
-                m_retrans << "\n" << *this);
-  NS_ASSERT_MSG(sackedOut == m_sackedOut, "Sacked counted: " << sackedOut <<
-                " " << m_sackedOut << *this);
+  NS_ASSERT_MSG(lostOut == GetLost (), "Lost counted: " << lostOut << " " <<
+                GetLost () << "\n" << *this);
+  NS_ASSERT_MSG(retrans == GetRetransmitsCount (), "Retrans Counted: " << retrans << " " <<
+                GetRetransmitsCount () << "\n" << *this);
+  NS_ASSERT_MSG(sackedOut == GetSacked (), "Sacked counted: " << sackedOut <<
+                " " << GetSacked () << *this);
   NS_ASSERT_MSG(totalSize == m_sentSize,
                 "Sent size counted: " << totalSize << " " << m_sentSize << *this);
 
@@ -1179,10 +1190,16 @@ FlonaseTxBuffer::ResetRenoSack ()
 {
   NS_LOG_FUNCTION (this);
 
-  m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Walk only the runs of sacked items
+  SequenceNumber32 start;
+  SequenceNumber32 end;
+  while (m_scoreboard.GetSackedRanges ().FindFrom (m_firstByteSeq, &start, &end))
     {
-      (*it)->m_sacked = false;
+      for (auto it = m_scoreboard.Find (start);
+           it != m_sentList.end () && (*it)->m_startSeq < end; ++it)
+        {
+          m_scoreboard.SetSacked (*it, false);
+        }
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
@@ -1194,6 +1211,8 @@ FlonaseTxBuffer::ResetSentList ()
   NS_LOG_FUNCTION (this);
   FlonaseTxItem *item;
 
+  m_scoreboard.Clear ();
+
   // Keep the head items; they will then marked as lost
   while (m_sentList.size () > 0)
     {
@@ -1204,9 +1223,6 @@ FlonaseTxBuffer::ResetSentList ()
     }
 
   m_sentSize = 0;
-  m_lostOut = 0;
-  m_retrans = 0;
-  m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
@@ -1218,12 +1234,10 @@ FlonaseTxBuffer::ResetLastSegmentSent ()
     {
       FlonaseTxItem *item = m_sentList.back ();
 
+      m_scoreboard.Remove (--m_sentList.end ());
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
-      if (item->m_retrans)
-        {
-          m_retrans -= item->m_packet->GetSize ();
-        }
+      item->m_retrans = item->m_sacked = item->m_lost = false;
       m_appList.insert (m_appList.begin (), item);
     }
   ConsistencyCheck ();
@@ -1233,46 +1247,30 @@ void
 FlonaseTxBuffer::SetSentListLost (bool resetSack)
 {
   NS_LOG_FUNCTION (this);
-  m_retrans = 0;
 
   if (resetSack)
     {
-      m_sackedOut = 0;
-      m_lostOut = m_sentSize;
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
-  else
-    {
-      m_lostOut = 0;
-    }
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
       if (resetSack)
         {
-          (*it)->m_sacked = false;
-          (*it)->m_lost = true;
+          m_scoreboard.SetSacked (*it, false);
+          m_scoreboard.SetLost (*it, true);
         }
-      else
+      else if (!(*it)->m_sacked)
         {
-          if ((*it)->m_lost)
-            {
-              // Have to increment it because we set it to 0 at line 1133
-              m_lostOut += (*it)->m_packet->GetSize ();
-            }
-          else if (!(*it)->m_sacked)
-            {
-              // Packet is not marked lost, nor is sacked. Then it becomes lost.
-              (*it)->m_lost = true;
-              m_lostOut += (*it)->m_packet->GetSize ();
-            }
+          // Packet is not sacked. Then it becomes lost, if not already.
+          m_scoreboard.SetLost (*it, true);
         }
 
-      (*it)->m_retrans = false;
+      m_scoreboard.SetRetrans (*it, false);
     }
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
-  NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
+  NS_ASSERT_MSG (m_sentSize >= GetSacked () + GetLost (), *this);
   ConsistencyCheck ();
 }
 
@@ -1299,11 +1297,7 @@ FlonaseTxBuffer::DeleteRetransmittedFlagFromHead ()
       return;
     }
 
-  if (m_sentList.front ()->m_retrans)
-    {
-      m_sentList.front ()->m_retrans = false;
-      m_retrans -= m_sentList.front ()->m_packet->GetSize ();
-    }
+  m_scoreboard.SetRetrans (m_sentList.front (), false);
   ConsistencyCheck ();
 }
 
@@ -1315,23 +1309,9 @@ FlonaseTxBuffer::MarkHeadAsLost ()
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
-      if (m_sentList.front ()->m_sacked)
-        {
-          m_sentList.front ()->m_sacked = false;
-          m_sackedOut -= m_sentList.front ()->m_packet->GetSize ();
-        }
-
-      if (m_sentList.front ()->m_retrans)
-        {
-          m_sentList.front ()->m_retrans = false;
-          m_retrans -= m_sentList.front ()->m_packet->GetSize ();
-        }
-
-      if (! m_sentList.front()->m_lost)
-        {
-          m_sentList.front()->m_lost = true;
-          m_lostOut += m_sentList.front ()->m_packet->GetSize ();
-        }
+      m_scoreboard.SetSacked (m_sentList.front (), false);
+      m_scoreboard.SetRetrans (m_sentList.front (), false);
+      m_scoreboard.SetLost (m_sentList.front (), true);
     }
   ConsistencyCheck ();
 }
@@ -1347,17 +1327,22 @@ FlonaseTxBuffer::AddRenoSack (void)
   // We can _never_ SACK the head, so start from the second segment sent
   auto it = ++m_sentList.begin ();
 
-  // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
+  // Find the "highest sacked" point, that is SND.UNA + m_sackedOut, jumping
+  // over the run of sacked segments following the head
+  SequenceNumber32 start;
+  SequenceNumber32 end;
+  if (it != m_sentList.end ()
+      && m_scoreboard.GetSackedRanges ().FindFrom ((*it)->m_startSeq, &start, &end)
+      && start == (*it)->m_startSeq)
     {
-      ++it;
+      it = m_scoreboard.Find (end);
     }
 
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
-      (*it)->m_sacked = true;
-      m_sackedOut += (*it)->m_packet->GetSize ();
+      NS_ASSERT (!(*it)->m_sacked);
+      m_scoreboard.SetSacked (*it, true);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1400,12 +1385,12 @@ FlonaseTxBuffer::ConsistencyCheck () const
         }
     }
 
-  NS_ASSERT_MSG (sacked == m_sackedOut, "Counted SACK: " << sacked <<
-                 " stored SACK: " << m_sackedOut);
-  NS_ASSERT_MSG (lost == m_lostOut, " Counted lost: " << lost <<
-                 " stored lost: " << m_lostOut);
-  NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
-                 " stored retrans: " << m_retrans);
+  NS_ASSERT_MSG (sacked == GetSacked (), "Counted SACK: " << sacked <<
+                 " stored SACK: " << GetSacked ());
+  NS_ASSERT_MSG (lost == GetLost (), " Counted lost: " << lost <<
+                 " stored lost: " << GetLost ());
+  NS_ASSERT_MSG (retrans == GetRetransmitsCount (), " Counted retrans: " << retrans <<
+                 " stored retrans: " << GetRetransmitsCount ());
 }
 
 std::ostream &
@@ -1443,9 +1428,9 @@ operator<< (std::ostream & os, FlonaseTxBuffer const & flonaseTxBuf)
     " Total size: " << flonaseTxBuf.m_size <<
     " m_firstByteSeq = " << flonaseTxBuf.m_firstByteSeq <<
     " m_sentSize = " << flonaseTxBuf.m_sentSize <<
-    " m_retransOut = " << flonaseTxBuf.m_retrans <<
-    " m_lostOut = " << flonaseTxBuf.m_lostOut <<
-    " m_sackedOut = " << flonaseTxBuf.m_sackedOut;
+    " m_retransOut = " << flonaseTxBuf.GetRetransmitsCount () <<
+    " m_lostOut = " << flonaseTxBuf.GetLost () <<
+    " m_sackedOut = " << flonaseTxBuf.GetSacked ();
 
   NS_ASSERT (sentSize == flonaseTxBuf.m_sentSize);
   NS_ASSERT (flonaseTxBuf.m_size - flonaseTxBuf.m_sentSize == appSize);
@@ -26,11 +26,19 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-thread.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
@@ -44,6 +52,39 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * The number of threads computing the SPF trees.
+ */
+static GlobalValue g_globalRoutingThreads =
+  GlobalValue ("GlobalRoutingThreads",
+               "The number of threads computing the SPF trees of the global "
+               "routing, 0 for one per processor core",
+               UintegerValue (1),
+               MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \ingroup globalrouting
+ * Whether GlobalRouteManager::RecomputeRoutes only computes the trees a
+ * change affects.
+ */
+static GlobalValue g_globalRoutingIncremental =
+  GlobalValue ("GlobalRoutingIncremental",
+               "Whether recomputing the global routes only computes again the "
+               "SPF trees the topology changes can affect",
+               BooleanValue (true),
+               MakeBooleanChecker ());
+
+/**
+ * \param start the start of a phase
+ * \returns the time elapsed since the start, in seconds
+ */
+static double
+GetSecondsSince (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
 /**
  * \brief Stream insertion operator.
  *
@@ -423,7 +464,9 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_linkDataIndex (),
+    m_linkDataIndexValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -471,6 +514,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_linkDataIndexValid = false;
     }
 }
 
@@ -495,13 +539,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,26 +552,64 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Index the LSAs by the Link Data of their Transit Network records, the
+// first LSA of the database winning when several have the same one.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  if (!m_linkDataIndexValid)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      m_linkDataIndex.clear ();
+      LSDBMap_t::const_iterator i;
+      for (i= m_database.begin (); i!= m_database.end (); i++)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          GlobalRoutingLSA* temp = i->second;
+// Iterate among temp's Link Records
+          for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
             {
-              return temp;
+              GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), temp));
+                }
             }
         }
+      m_linkDataIndexValid = true;
+    }
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
+    {
+      return i->second;
     }
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const
+{
+  NS_LOG_FUNCTION (this);
+  lsas.clear ();
+  lsas.reserve (m_database.size ());
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+}
+
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB *lsdb = new GlobalRouteManagerLSDB ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsdb->m_database.insert (LSDBPair_t (i->first, new GlobalRoutingLSA (*i->second)));
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      lsdb->m_extdatabase.push_back (new GlobalRoutingLSA (*m_extdatabase[j]));
+    }
+  return lsdb;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,10 +618,16 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfrootInfo (0),
+    m_stubShortcut (false),
+    m_routesValid (false),
+    m_workRoots (0),
+    m_workNext (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
+  m_times = PhaseTimes ();
 }
 
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
@@ -563,12 +648,14 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_routesValid = false;
 }
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -579,18 +666,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      gr->RemoveAllRoutes ();
     }
   if (m_lsdb)
     {
@@ -598,6 +675,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_routesValid = false;
+  m_times = PhaseTimes ();
+  m_times.deleteRoutes = GetSecondsSince (start);
+  NS_LOG_INFO ("Deleted the global routes in " << m_times.deleteRoutes << "s");
 }
 
 //
@@ -613,6 +694,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -657,6 +739,11 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
         }
     }
+  double deleteRoutes = m_times.deleteRoutes;
+  m_times = PhaseTimes ();
+  m_times.deleteRoutes = deleteRoutes;
+  m_times.buildDatabase = GetSecondsSince (start);
+  NS_LOG_INFO ("Built the routing database in " << m_times.buildDatabase << "s");
 }
 
 //
@@ -693,41 +780,781 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 // list becomes empty. 
 //
 void
-GlobalRouteManagerImpl::InitializeRoutes ()
+GlobalRouteManagerImpl::InitializeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFRoot> roots;
+  CollectRoots (roots);
+  m_times.fullTrees += roots.size ();
+  ComputeRoutes (roots);
+  m_routesValid = true;
+  LogMemoryUsage ();
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+//
+// Walk the list of nodes in the system, and take a snapshot of the routers
+// the SPF calculation will be run for: the nodes which have a global router
+// interface, with some LSAs.
+//
+void
+GlobalRouteManagerImpl::CollectRoots (std::vector<SPFRoot> &roots) const
+{
+  NS_LOG_FUNCTION (this);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+//
+// Look for the GlobalRouter interface that indicates that the node is
+// participating in routing.
+//
+      Ptr<GlobalRouter> rtr = 
+        node->GetObject<GlobalRouter> ();
+
+      uint32_t systemId = MpiInterface::GetSystemId ();
+      // Ignore nodes that are not assigned to our systemId (distributed sim),
+      // unless all the systems are simulated by this process.
+      if (MpiInterface::GetSize () > 1 && node->GetSystemId () != systemId) 
+        {
+          continue;
+        }
+
+//
+// if the node has a global router interface, then run the global routing
+// algorithms.
+//
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          roots.push_back (SPFRoot ());
+          FillRoot (node, rtr, roots.back ());
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::FillRoot (Ptr<Node> node, Ptr<GlobalRouter> rtr, SPFRoot &root)
+{
+  NS_LOG_FUNCTION (node << rtr);
+  root.routerId = rtr->GetRouterId ();
+  root.routing = rtr->GetRoutingProtocol ();
+  NS_ASSERT (root.routing);
+  root.filter = 0;
+  root.nRoutes.assign (3, 0);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FillRoot (): "
+                 "GetObject for <Ipv4> interface failed");
+  root.addresses.resize (ipv4->GetNInterfaces ());
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          root.addresses[i].push_back (ipv4->GetAddress (i, j).GetLocal ());
+        }
+    }
+}
+
+//
+// Run the SPF calculations of the routers, either in this thread or on a
+// pool of worker threads.  The calculations only read the LSDB and the
+// router snapshots, so that each worker just needs its own copy of the LSDB,
+// whose LSAs hold the SPF status; the routes are installed afterwards from
+// this thread.
+//
+void
+GlobalRouteManagerImpl::ComputeRoutes (std::vector<SPFRoot> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  m_stubShortcut = NodeList::GetNNodes () > 0;
+  UintegerValue threadsValue;
+  g_globalRoutingThreads.GetValue (threadsValue);
+  uint32_t nThreads = threadsValue.Get ();
+  if (nThreads == 0)
+    {
+      nThreads = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  nThreads = std::min<uint32_t> (nThreads, roots.size ());
+
+  if (nThreads <= 1)
+    {
+      for (std::vector<SPFRoot>::iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+          ComputeRoot (*i);
+          m_times.computeTrees += GetSecondsSince (start);
+          start = std::chrono::steady_clock::now ();
+          InstallRoutes (*i);
+          m_times.installRoutes += GetSecondsSince (start);
+        }
+    }
+  else
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      std::atomic<uint32_t> next (0);
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          worker->DebugUseLsdb (m_lsdb->Copy ());
+          worker->m_stubShortcut = m_stubShortcut;
+          worker->m_workRoots = &roots;
+          worker->m_workNext = &next;
+          workers.push_back (worker);
+        }
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::RunWorker, workers[i])));
+          threads.back ()->Start ();
+        }
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          threads[i]->Join ();
+          delete workers[i];
+        }
+      m_times.computeTrees += GetSecondsSince (start);
+      start = std::chrono::steady_clock::now ();
+      for (std::vector<SPFRoot>::iterator i = roots.begin (); i != roots.end (); i++)
+        {
+          InstallRoutes (*i);
+        }
+      m_times.installRoutes += GetSecondsSince (start);
+    }
+  NS_LOG_INFO ("Computed " << roots.size () << " SPF trees with " << std::max (nThreads, 1U) <<
+               " threads in " << m_times.computeTrees << "s, installed the routes in " <<
+               m_times.installRoutes << "s");
+}
+
+void
+GlobalRouteManagerImpl::RunWorker (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (;;)
+    {
+      uint32_t i = (*m_workNext)++;
+      if (i >= m_workRoots->size ())
+        {
+          break;
+        }
+      ComputeRoot ((*m_workRoots)[i]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::ComputeRoot (SPFRoot &root)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  m_spfrootInfo = &root;
+  SPFCalculate (root.routerId);
+  m_spfrootInfo = 0;
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (SPFRoot &root)
+{
+  NS_LOG_FUNCTION (root.routerId << root.routes.size ());
+  if (root.routing)
+    {
+      // The routes kept by a partial calculation are in the order of the
+      // full one: the routes computed again, in increasing positions, are
+      // inserted at their place.
+      bool partial = root.filter != 0;
+      for (std::vector<SPFRoute>::const_iterator i = root.routes.begin (); i != root.routes.end (); i++)
+        {
+          switch (i->kind)
+            {
+            case SPFRoute::HOST:
+              if (partial)
+                {
+                  root.routing->InsertHostRouteTo (i->dest, i->nextHop, i->interface, i->position);
+                }
+              else
+                {
+                  root.routing->AddHostRouteTo (i->dest, i->nextHop, i->interface);
+                }
+              break;
+            case SPFRoute::NETWORK:
+              if (partial)
+                {
+                  root.routing->InsertNetworkRouteTo (i->dest, i->mask, i->nextHop, i->interface, i->position);
+                }
+              else
+                {
+                  root.routing->AddNetworkRouteTo (i->dest, i->mask, i->nextHop, i->interface);
+                }
+              break;
+            case SPFRoute::EXTERNAL:
+              if (partial)
+                {
+                  root.routing->InsertASExternalRouteTo (i->dest, i->mask, i->nextHop, i->interface, i->position);
+                }
+              else
+                {
+                  root.routing->AddASExternalRouteTo (i->dest, i->mask, i->nextHop, i->interface);
+                }
+              break;
+            }
+        }
+      root.routing->ShareRoutes ();
+    }
+  std::vector<SPFRoute> ().swap (root.routes);
+}
+
+void
+GlobalRouteManagerImpl::SPFAddRoute (SPFRoute::Kind kind, Ipv4Address dest, Ipv4Mask mask,
+                                     Ipv4Address nextHop, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << kind << dest << mask << nextHop << interface);
+  NS_ASSERT_MSG (m_spfrootInfo, 
+                 "GlobalRouteManagerImpl::SPFAddRoute (): Root router not set");
+  uint32_t position = m_spfrootInfo->nRoutes[kind]++;
+  if (m_spfrootInfo->filter != 0
+      && m_spfrootInfo->filter->find (Destination_t (dest.Get (), mask.Get ())) == m_spfrootInfo->filter->end ())
+    {
+      return;
+    }
+  SPFRoute route;
+  route.kind = kind;
+  route.dest = dest;
+  route.mask = mask;
+  route.nextHop = nextHop;
+  route.interface = interface;
+  route.position = position;
+  m_spfrootInfo->routes.push_back (route);
+}
+
+//
+// Incremental SPF.  After a topology change, the new LSDB is compared with
+// the one the routes were computed from.  Given the shortest distances of the
+// old topology, the SPF tree of a root R is unchanged if none of the removed
+// links lies on a shortest path from R (d(R,u) + cost < d(R,v) would make it
+// useless) and none of the added links offers a path as short as the existing
+// ones (d(R,u) + cost > d(R,v)): the old distances are then still the
+// shortest ones, through the same parents.  Such a root only needs its routes
+// to the destinations whose LSA records changed, which are computed again
+// and inserted among the routes kept at the position a full calculation
+// gives them, so that the tables do not depend on the kind of computation.
+// The other roots get their whole routing table computed again.
+//
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  if (!incremental.Get () || !m_routesValid)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  m_times.deleteRoutes = 0;
+  BuildGlobalRoutingDatabase ();
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  SPFChanges changes;
+  CompareDatabases (oldLsdb, m_lsdb, changes);
+  std::vector<SPFRoot> roots;
+  CollectRoots (roots);
+
+//
+// Compute the distances of the old topology from every vertex to the end
+// points of the changed links, on the reversed graph.
+//
+  std::set<Ipv4Address> endPoints;
+  for (std::vector<SPFEdge>::const_iterator e = changes.removed.begin (); e != changes.removed.end (); e++)
+    {
+      endPoints.insert (e->from);
+      endPoints.insert (e->to);
+    }
+  for (std::vector<SPFEdge>::const_iterator e = changes.added.begin (); e != changes.added.end (); e++)
+    {
+      endPoints.insert (e->from);
+      endPoints.insert (e->to);
+    }
+  if (endPoints.size () > roots.size ())
+    {
+      changes.global = true;
+    }
+  const uint64_t infinity = std::numeric_limits<uint64_t>::max ();
+  std::map<Ipv4Address, uint32_t> index;
+  std::map<Ipv4Address, std::vector<uint64_t> > distances;
+  if (!changes.global && !endPoints.empty ())
+    {
+      std::vector<GlobalRoutingLSA*> lsas;
+      oldLsdb->GetLSAs (lsas);
+      for (uint32_t i = 0; i < lsas.size (); i++)
+        {
+          index[lsas[i]->GetLinkStateId ()] = i;
+        }
+      std::vector<std::vector<std::pair<uint32_t, uint32_t> > > reverse (lsas.size ());
+      for (uint32_t i = 0; i < lsas.size (); i++)
+        {
+          std::vector<SPFEdge> edges;
+          GetEdges (oldLsdb, lsas[i], edges);
+          for (std::vector<SPFEdge>::const_iterator e = edges.begin (); e != edges.end (); e++)
+            {
+              std::map<Ipv4Address, uint32_t>::const_iterator to = index.find (e->to);
+              if (to != index.end ())
+                {
+                  reverse[to->second].push_back (std::make_pair (i, e->cost));
+                }
+            }
+        }
+      for (std::set<Ipv4Address>::const_iterator p = endPoints.begin (); p != endPoints.end (); p++)
+        {
+          std::vector<uint64_t> &d = distances[*p];
+          d.assign (lsas.size (), infinity);
+          std::map<Ipv4Address, uint32_t>::const_iterator source = index.find (*p);
+          if (source == index.end ())
+            {
+              continue;
+            }
+          typedef std::pair<uint64_t, uint32_t> Item;
+          std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+          d[source->second] = 0;
+          queue.push (Item (0, source->second));
+          while (!queue.empty ())
+            {
+              Item item = queue.top ();
+              queue.pop ();
+              if (item.first != d[item.second])
+                {
+                  continue;
+                }
+              for (uint32_t k = 0; k < reverse[item.second].size (); k++)
+                {
+                  uint32_t from = reverse[item.second][k].first;
+                  uint64_t distance = item.first + reverse[item.second][k].second;
+                  if (distance < d[from])
+                    {
+                      d[from] = distance;
+                      queue.push (Item (distance, from));
+                    }
+                }
+            }
+        }
+    }
+
+//
+// Sort the roots by the work they need.
+//
+  bool changed = changes.global || !changes.vertices.empty () || !changes.destinations.empty ();
+  std::set<Ipv4Address> rootIds;
+  std::vector<SPFRoot> computed;
+  for (std::vector<SPFRoot>::iterator r = roots.begin (); r != roots.end (); r++)
+    {
+      rootIds.insert (r->routerId);
+      if (!changed)
+        {
+          m_times.unchangedTrees++;
+          continue;
+        }
+      bool full = changes.global || changes.vertices.count (r->routerId) != 0;
+      std::map<Ipv4Address, uint32_t>::const_iterator rootIndex = index.find (r->routerId);
+      if (!full && !endPoints.empty () && rootIndex == index.end ())
+        {
+          full = true;
+        }
+      if (!full)
+        {
+//
+// The default route of a stub router, and the next hops of any router, depend
+// on the links of its neighbors back to it, which are not part of its tree.
+//
+          std::set<Ipv4Address> adjacent;
+          adjacent.insert (r->routerId);
+          GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (r->routerId);
+          uint32_t transits = 0;
+          for (uint32_t i = 0; rlsa && i < rlsa->GetNLinkRecords (); i++)
+            {
+              GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  adjacent.insert (l->GetLinkId ());
+                  transits++;
+                }
+              else if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  transits++;
+                }
+            }
+          full = transits <= 1;
+          for (std::vector<SPFEdge>::const_iterator e = changes.removed.begin (); !full && e != changes.removed.end (); e++)
+            {
+              uint64_t du = distances[e->from][rootIndex->second];
+              full = adjacent.count (e->from) != 0 || adjacent.count (e->to) != 0
+                || (du != infinity && du + e->cost == distances[e->to][rootIndex->second]);
+            }
+          for (std::vector<SPFEdge>::const_iterator e = changes.added.begin (); !full && e != changes.added.end (); e++)
+            {
+              uint64_t du = distances[e->from][rootIndex->second];
+              full = adjacent.count (e->from) != 0 || adjacent.count (e->to) != 0
+                || (du != infinity && du + e->cost <= distances[e->to][rootIndex->second]);
+            }
+        }
+      if (full)
+        {
+          r->routing->RemoveAllRoutes ();
+          m_times.fullTrees++;
+        }
+      else if (!changes.destinations.empty ())
+        {
+          for (DestinationSet_t::const_iterator d = changes.destinations.begin (); d != changes.destinations.end (); d++)
+            {
+              r->routing->RemoveRoutesTo (Ipv4Address (d->first), Ipv4Mask (d->second));
+            }
+          r->filter = &changes.destinations;
+          m_times.partialTrees++;
+        }
+      else
+        {
+          m_times.unchangedTrees++;
+          continue;
+        }
+      computed.push_back (SPFRoot ());
+      std::swap (computed.back (), *r);
+    }
+
+//
+// The routers which are no longer roots keep no global route, as after
+// DeleteGlobalRoutes ().
+//
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rootIds.count (rtr->GetRouterId ()) == 0)
+        {
+          rtr->GetRoutingProtocol ()->RemoveAllRoutes ();
+        }
+    }
+  delete oldLsdb;
+  m_times.compareDatabases = GetSecondsSince (start);
+  NS_LOG_INFO ("Compared the routing databases in " << m_times.compareDatabases << "s: " <<
+               m_times.fullTrees << " full, " << m_times.partialTrees << " partial, " <<
+               m_times.unchangedTrees << " unchanged SPF trees");
+
+  ComputeRoutes (computed);
+  m_routesValid = true;
+  LogMemoryUsage ();
+}
+
+bool
+GlobalRouteManagerImpl::SPFEdge::operator< (const SPFEdge &o) const
+{
+  if (from != o.from)
+    {
+      return from < o.from;
+    }
+  if (to != o.to)
+    {
+      return to < o.to;
+    }
+  if (cost != o.cost)
+    {
+      return cost < o.cost;
+    }
+  return data < o.data;
+}
+
+bool
+GlobalRouteManagerImpl::SPFEdge::operator== (const SPFEdge &o) const
+{
+  return from == o.from && to == o.to && cost == o.cost && data == o.data;
+}
+
+//
+// The links followed by SPFNext (): the point-to-point and transit network
+// records of a router, and the attached routers of a network.
+//
+void
+GlobalRouteManagerImpl::GetEdges (GlobalRouteManagerLSDB *lsdb, GlobalRoutingLSA *lsa,
+                                  std::vector<SPFEdge> &edges)
+{
+  NS_LOG_FUNCTION (lsdb << lsa);
+  edges.clear ();
+  if (lsa == 0)
+    {
+      return;
+    }
+  SPFEdge edge;
+  edge.from = lsa->GetLinkStateId ();
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+              || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              edge.to = l->GetLinkId ();
+              edge.cost = l->GetMetric ();
+              edge.data = l->GetLinkData ();
+              edges.push_back (edge);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+          if (w_lsa)
+            {
+              edge.to = w_lsa->GetLinkStateId ();
+              edge.cost = 0;
+              edge.data = lsa->GetAttachedRouter (i);
+              edges.push_back (edge);
+            }
+        }
+    }
+}
+
+//
+// The destinations of the routes added by SPFIntraAddRouter (),
+// SPFIntraAddTransit () and SPFIntraAddStub () for a vertex.
+//
+void
+GlobalRouteManagerImpl::GetDestinations (GlobalRoutingLSA *lsa, std::vector<Destination_t> &destinations)
+{
+  NS_LOG_FUNCTION (lsa);
+  destinations.clear ();
+  if (lsa == 0)
+    {
+      return;
+    }
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              destinations.push_back (Destination_t (l->GetLinkData ().Get (), Ipv4Mask::GetOnes ().Get ()));
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              Ipv4Mask mask (l->GetLinkData ().Get ());
+              destinations.push_back (Destination_t (l->GetLinkId ().CombineMask (mask).Get (), mask.Get ()));
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+      destinations.push_back (Destination_t (lsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ()));
+    }
+}
+
+void
+GlobalRouteManagerImpl::CompareDatabases (GlobalRouteManagerLSDB *oldLsdb,
+                                          GlobalRouteManagerLSDB *newLsdb,
+                                          SPFChanges &changes)
+{
+  NS_LOG_FUNCTION (oldLsdb << newLsdb);
+  changes.global = false;
+  std::vector<GlobalRoutingLSA*> oldLsas;
+  std::vector<GlobalRoutingLSA*> newLsas;
+  oldLsdb->GetLSAs (oldLsas);
+  newLsdb->GetLSAs (newLsas);
+
+//
+// Walk both databases in Link State ID order.
+//
+  std::vector<GlobalRoutingLSA*>::const_iterator i = oldLsas.begin ();
+  std::vector<GlobalRoutingLSA*>::const_iterator j = newLsas.begin ();
+  while (i != oldLsas.end () || j != newLsas.end ())
+    {
+      GlobalRoutingLSA *o = 0;
+      GlobalRoutingLSA *n = 0;
+      if (j == newLsas.end () || (i != oldLsas.end () && (*i)->GetLinkStateId () < (*j)->GetLinkStateId ()))
+        {
+          o = *i++;
+        }
+      else if (i == oldLsas.end () || (*j)->GetLinkStateId () < (*i)->GetLinkStateId ())
+        {
+          n = *j++;
+        }
+      else
+        {
+          o = *i++;
+          n = *j++;
+        }
+      if (o && n && (o->GetLSType () != n->GetLSType ()
+                     || o->GetNetworkLSANetworkMask () != n->GetNetworkLSANetworkMask ()))
+        {
+          changes.global = true;
+          return;
+        }
+
+//
+// The links kept must be in the same order, which decides the order of the
+// equal cost candidates.
+//
+      std::vector<SPFEdge> oldEdges;
+      std::vector<SPFEdge> newEdges;
+      GetEdges (oldLsdb, o, oldEdges);
+      GetEdges (newLsdb, n, newEdges);
+      std::map<SPFEdge, uint32_t> available;
+      for (std::vector<SPFEdge>::const_iterator e = newEdges.begin (); e != newEdges.end (); e++)
+        {
+          available[*e]++;
+        }
+      std::vector<SPFEdge> oldKept;
+      bool edgesChanged = false;
+      for (std::vector<SPFEdge>::const_iterator e = oldEdges.begin (); e != oldEdges.end (); e++)
+        {
+          if (available[*e] > 0)
+            {
+              available[*e]--;
+              oldKept.push_back (*e);
+            }
+          else
+            {
+              changes.removed.push_back (*e);
+              edgesChanged = true;
+            }
+        }
+      available.clear ();
+      for (std::vector<SPFEdge>::const_iterator e = oldKept.begin (); e != oldKept.end (); e++)
+        {
+          available[*e]++;
+        }
+      std::vector<SPFEdge> newKept;
+      for (std::vector<SPFEdge>::const_iterator e = newEdges.begin (); e != newEdges.end (); e++)
+        {
+          if (available[*e] > 0)
+            {
+              available[*e]--;
+              newKept.push_back (*e);
+            }
+          else
+            {
+              changes.added.push_back (*e);
+              edgesChanged = true;
+            }
+        }
+      if (oldKept != newKept)
+        {
+          changes.global = true;
+          return;
+        }
+
+      std::vector<Destination_t> oldDestinations;
+      std::vector<Destination_t> newDestinations;
+      GetDestinations (o, oldDestinations);
+      GetDestinations (n, newDestinations);
+      bool destinationsChanged = oldDestinations != newDestinations;
+      if (destinationsChanged)
+        {
+          changes.destinations.insert (oldDestinations.begin (), oldDestinations.end ());
+          changes.destinations.insert (newDestinations.begin (), newDestinations.end ());
+        }
+      if (edgesChanged || destinationsChanged || o == 0 || n == 0)
+        {
+          changes.vertices.insert (o ? o->GetLinkStateId () : n->GetLinkStateId ());
+        }
+    }
+
+//
+// The external routes only depend on the path to their advertising router.
+//
+  std::vector<std::pair<Ipv4Address, Destination_t> > oldExternals;
+  std::vector<std::pair<Ipv4Address, Destination_t> > newExternals;
+  for (uint32_t k = 0; k < oldLsdb->GetNumExtLSAs (); k++)
+    {
+      GlobalRoutingLSA *extlsa = oldLsdb->GetExtLSA (k);
+      Ipv4Mask mask = extlsa->GetNetworkLSANetworkMask ();
+      oldExternals.push_back (std::make_pair (extlsa->GetAdvertisingRouter (),
+                                              Destination_t (extlsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ())));
+    }
+  for (uint32_t k = 0; k < newLsdb->GetNumExtLSAs (); k++)
+    {
+      GlobalRoutingLSA *extlsa = newLsdb->GetExtLSA (k);
+      Ipv4Mask mask = extlsa->GetNetworkLSANetworkMask ();
+      newExternals.push_back (std::make_pair (extlsa->GetAdvertisingRouter (),
+                                              Destination_t (extlsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ())));
+    }
+  if (oldExternals != newExternals)
+    {
+      for (uint32_t k = 0; k < oldExternals.size (); k++)
+        {
+          changes.destinations.insert (oldExternals[k].second);
+        }
+      for (uint32_t k = 0; k < newExternals.size (); k++)
+        {
+          changes.destinations.insert (newExternals[k].second);
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::PrintPhaseTimes (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "Delete routes:     " << m_times.deleteRoutes << "s" << std::endl
+     << "Build database:    " << m_times.buildDatabase << "s" << std::endl
+     << "Compare databases: " << m_times.compareDatabases << "s" << std::endl
+     << "Compute SPF trees: " << m_times.computeTrees << "s" << std::endl
+     << "Install routes:    " << m_times.installRoutes << "s" << std::endl
+     << "SPF trees:         " << m_times.fullTrees << " full, " << m_times.partialTrees
+     << " partial, " << m_times.unchangedTrees << " unchanged" << std::endl;
+}
+
+uint32_t
+GlobalRouteManagerImpl::GetNPartialTrees (void) const
 {
   NS_LOG_FUNCTION (this);
-//
-// Walk the list of nodes in the system.
-//
-  NS_LOG_INFO ("About to start SPF calculation");
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// Look for the GlobalRouter interface that indicates that the node is
-// participating in routing.
-//
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+  return m_times.partialTrees;
+}
 
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+void
+GlobalRouteManagerImpl::PrintMemoryUsage (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  uint32_t nRouters = 0;
+  uint64_t nRoutes = 0;
+  uint64_t bytes = 0;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+      if (router == 0)
         {
           continue;
         }
-
-//
-// if the node has a global router interface, then run the global routing
-// algorithms.
-//
-      if (rtr && rtr->GetNumLSAs () )
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      nRouters++;
+      nRoutes += gr->GetNRoutes ();
+      bytes += gr->GetMemoryUsage ();
+      os << "Node " << (*i)->GetId () << ": " << gr->GetNRoutes () << " routes, "
+         << gr->GetNNextHops () << " next hops, " << gr->GetMemoryUsage () << " bytes";
+      if (gr->GetNSharingRouters () > 1)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          os << ", shared by " << gr->GetNSharingRouters () << " routers";
         }
+      os << std::endl;
+    }
+  os << "Total: " << nRouters << " routers, " << nRoutes << " routes, " << bytes
+     << " bytes, and " << Ipv4GlobalRouting::GetSharedMemoryUsage ()
+     << " bytes for the shared next hop table" << std::endl;
+}
+
+void
+GlobalRouteManagerImpl::LogMemoryUsage (void) const
+{
+  if (g_log.IsEnabled (LOG_INFO))
+    {
+      std::ostringstream oss;
+      PrintMemoryUsage (oss);
+      NS_LOG_INFO ("Routing table memory usage:" << std::endl << oss.str ());
     }
-  NS_LOG_INFO ("Finished SPF calculation");
 }
 
 //
@@ -1124,7 +1951,8 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
         }
       else 
         {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
+// The network may be reached through several equal cost paths.
+          w->InheritAllRootExitDirections (v);
         }
     }
   else 
@@ -1247,7 +2075,23 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  SPFRoot spfRoot;
+  spfRoot.routerId = root;
+  spfRoot.filter = 0;
+  spfRoot.nRoutes.assign (3, 0);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          FillRoot (*i, rtr, spfRoot);
+          break;
+        }
+    }
+  m_stubShortcut = NodeList::GetNNodes () > 0;
+  ComputeRoot (spfRoot);
+  InstallRoutes (spfRoot);
 }
 
 //
@@ -1320,12 +2164,8 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  SPFAddRoute (SPFRoute::NETWORK, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                               FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1369,7 +2209,6 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
-
 //
 // Optimize SPF calculation, for ns-3.
 // We do not need to calculate SPF for every node in the network if this
@@ -1377,7 +2216,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_stubShortcut && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
@@ -1484,6 +2323,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // candidate vertices.
 
     }  // end for loop
+//
+// The remaining candidates refer to their parents in the tree: delete them
+// before the tree.
+//
+  candidate.Clear ();
 
 // Second stage of SPF calculation procedure
   SPFProcessStubs (m_spfroot);
@@ -1560,105 +2404,45 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
+// The routes are written to the route list of the router at the root of
+// the SPF tree, and installed in its routing table once the calculation
+// is over.
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
 //
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
+// The vertex <v> (the advertising router) has the next hop addresses and the
+// outbound interfaces precalculated for us: where the root node should send
+// packets to be forwarded to the external network.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          SPFAddRoute (SPFRoute::EXTERNAL, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1720,116 +2504,48 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  The routes are added to
+// its route list, and installed in its routing table once the calculation
+// is over.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> (corresponding to the node that has the stub network) has
+// the next hop addresses and the outbound interfaces precalculated for us:
+// where the root node should send packets to be forwarded to the stub
+// network.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          SPFAddRoute (SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1844,69 +2560,27 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
+// We have an IP address <a> and the router at the root of the SPF tree.
 // The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The snapshot of the router holds the addresses of its interfaces: look
+// for the first one in the prefix, as Ipv4::GetInterfaceForPrefix () does.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootInfo == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node");
+      return -1;
+    }
+  const std::vector<std::vector<Ipv4Address> > &addresses = m_spfrootInfo->addresses;
+  for (uint32_t i = 0; i < addresses.size (); i++)
+    {
+      for (uint32_t j = 0; j < addresses[i].size (); j++)
         {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
+          if (addresses[i][j].CombineMask (amask) == a.CombineMask (amask))
             {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
+              return i;
             }
-#endif 
-          return interface;
         }
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
   return -1;
 }
 
@@ -1935,69 +2609,25 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  The routes are added to
+// its route list, and installed in its routing table once the calculation
+// is over.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2636,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,44 +2661,30 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              SPFAddRoute (SPFRoute::HOST, lr->GetLinkData (), Ipv4Mask::GetOnes (), nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2080,104 +2696,49 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  The routes are added to
+// its route list, and installed in its routing table once the calculation
+// is over.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to: the network LSA of the transit network.
+//
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-      if (rtr == 0)
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          SPFAddRoute (SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -23,9 +23,12 @@
 #define GLOBAL_ROUTE_MANAGER_IMPL_H
 
 #include <stdint.h>
+#include <atomic>
 #include <list>
 #include <queue>
 #include <map>
+#include <ostream>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -674,6 +677,24 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Get the Router and Network Link State Advertisements, sorted by
+ * Link State ID.
+ *
+ * @param lsas [out] the Link State Advertisements.
+ */
+  void GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const;
+
+/**
+ * @brief Copy the database, for the SPF calculations of another thread.
+ *
+ * The copy holds its own Link State Advertisements, whose SPF status can
+ * change independently of the original ones.
+ *
+ * @returns a new database.
+ */
+  GlobalRouteManagerLSDB* Copy (void) const;
+
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +702,8 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  mutable LSDBMap_t m_linkDataIndex; //!< Router-LSAs by the Link Data of their Transit Network records
+  mutable bool m_linkDataIndexValid; //!< whether m_linkDataIndex matches the database
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -732,6 +755,9 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF trees are computed by the number of threads given by the
+ * "GlobalRoutingThreads" global value.
  */
   virtual void InitializeRoutes ();
 
@@ -746,6 +772,31 @@ public:
  */
   void DebugSPFCalculate (Ipv4Address root);
 
+/**
+ * @brief Update the routes after a topology change, computing again only
+ * the SPF trees that the changed links can affect.
+ */
+  virtual void RecomputeRoutes ();
+
+/**
+ * @brief Print the duration of each phase of the last route computation
+ * @param os the output stream
+ */
+  void PrintPhaseTimes (std::ostream &os) const;
+
+/**
+ * @brief Get the number of SPF trees which the last route computation
+ * only computed for the destinations which changed
+ * @returns the number of partial SPF trees
+ */
+  uint32_t GetNPartialTrees (void) const;
+
+/**
+ * @brief Print the memory used by the routing table of each router
+ * @param os the output stream
+ */
+  void PrintMemoryUsage (std::ostream &os) const;
+
 private:
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
@@ -766,8 +817,193 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * \brief A route computed for the root of an SPF tree.
+   */
+  struct SPFRoute
+  {
+    /** The kind of route. */
+    enum Kind
+    {
+      HOST,     //!< Host route
+      NETWORK,  //!< Network route
+      EXTERNAL  //!< AS external route
+    };
+    Kind kind;            //!< The kind of route
+    Ipv4Address dest;     //!< The destination host or network
+    Ipv4Mask mask;        //!< The destination mask
+    Ipv4Address nextHop;  //!< The next hop
+    uint32_t interface;   //!< The outgoing interface
+    uint32_t position;    //!< The number of routes of the same kind computed before it
+  };
+
+  typedef std::pair<uint32_t, uint32_t> Destination_t; //!< a destination network and mask
+  typedef std::set<Destination_t> DestinationSet_t;     //!< a set of destinations
+
+  /**
+   * \brief A router whose routes are computed.
+   *
+   * The SPF calculation only reads this snapshot of the router, and
+   * fills its route list, so that it can run outside of the main thread.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;                             //!< The router ID
+    Ptr<Ipv4GlobalRouting> routing;                   //!< The routing protocol to install the routes in
+    std::vector<std::vector<Ipv4Address> > addresses; //!< The local addresses, by interface
+    const DestinationSet_t *filter;                   //!< The destinations to compute, or 0 for all
+    std::vector<uint32_t> nRoutes;                    //!< The number of routes computed by kind, filtered or not
+    std::vector<SPFRoute> routes;                     //!< The computed routes
+  };
+
+  /**
+   * \brief A link between two vertices, as followed by the SPF calculation.
+   */
+  struct SPFEdge
+  {
+    Ipv4Address from;  //!< The vertex ID of the origin
+    Ipv4Address to;    //!< The vertex ID of the destination
+    uint32_t cost;     //!< The link cost
+    Ipv4Address data;  //!< The Link Data (interface address) of the link
+    /**
+     * \param o another edge
+     * \returns true if this edge is ordered before the other one
+     */
+    bool operator< (const SPFEdge &o) const;
+    /**
+     * \param o another edge
+     * \returns true if the edges are equal
+     */
+    bool operator== (const SPFEdge &o) const;
+  };
+
+  /**
+   * \brief The differences between two link state databases.
+   */
+  struct SPFChanges
+  {
+    bool global;                        //!< Whether all the trees must be computed again
+    std::set<Ipv4Address> vertices;     //!< The vertices whose LSA changed
+    std::vector<SPFEdge> removed;       //!< The links removed
+    std::vector<SPFEdge> added;         //!< The links added
+    DestinationSet_t destinations;      //!< The destinations whose routes may change
+  };
+
+  /**
+   * \brief The duration of the phases of the last route computation.
+   */
+  struct PhaseTimes
+  {
+    double deleteRoutes;      //!< Deleting the routes, in seconds
+    double buildDatabase;     //!< Gathering the LSAs, in seconds
+    double compareDatabases;  //!< Finding the trees to compute, in seconds
+    double computeTrees;      //!< Computing the SPF trees, in seconds
+    double installRoutes;     //!< Installing the routes, in seconds
+    uint32_t fullTrees;       //!< The number of trees computed
+    uint32_t partialTrees;    //!< The number of trees computed for some destinations
+    uint32_t unchangedTrees;  //!< The number of trees not computed
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  SPFRoot* m_spfrootInfo; //!< the router of the root node
+  bool m_stubShortcut; //!< whether the stub routers get a default route only
+  bool m_routesValid; //!< whether the installed routes were computed from m_lsdb
+  PhaseTimes m_times; //!< the duration of the phases of the last computation
+  std::vector<SPFRoot>* m_workRoots; //!< the routers to compute, in a worker
+  std::atomic<uint32_t>* m_workNext; //!< the index of the next router to compute, in a worker
+
+  /**
+   * \brief Snapshot the routers whose routes are computed by this process.
+   *
+   * \param roots [out] the routers
+   */
+  void CollectRoots (std::vector<SPFRoot> &roots) const;
+
+  /**
+   * \brief Snapshot a router.
+   *
+   * \param node the node of the router
+   * \param rtr the global router
+   * \param root [out] the router snapshot
+   */
+  static void FillRoot (Ptr<Node> node, Ptr<GlobalRouter> rtr, SPFRoot &root);
+
+  /**
+   * \brief Compute and install the routes of some routers, with the
+   * number of threads of the "GlobalRoutingThreads" global value.
+   *
+   * \param roots the routers
+   */
+  void ComputeRoutes (std::vector<SPFRoot> &roots);
+
+  /**
+   * \brief Compute the routes of a router into its route list.
+   *
+   * \param root the router
+   */
+  void ComputeRoot (SPFRoot &root);
+
+  /**
+   * \brief Compute the routes of the routers of m_workRoots until none is
+   * left; the body of the worker threads.
+   */
+  void RunWorker (void);
+
+  /**
+   * \brief Install the computed routes of a router in its routing table.
+   *
+   * \param root the router
+   */
+  static void InstallRoutes (SPFRoot &root);
+
+  /**
+   * \brief Log the memory used by the routing tables, if the info level
+   * is enabled.
+   */
+  void LogMemoryUsage (void) const;
+
+  /**
+   * \brief Add a route to the route list of the root router, unless it
+   * is filtered out.
+   *
+   * \param kind the kind of route
+   * \param dest the destination host or network
+   * \param mask the destination mask
+   * \param nextHop the next hop
+   * \param interface the outgoing interface
+   */
+  void SPFAddRoute (SPFRoute::Kind kind, Ipv4Address dest, Ipv4Mask mask,
+                    Ipv4Address nextHop, uint32_t interface);
+
+  /**
+   * \brief Find the differences between two link state databases.
+   *
+   * \param oldLsdb the database the routes were computed from
+   * \param newLsdb the new database
+   * \param changes [out] the differences
+   */
+  static void CompareDatabases (GlobalRouteManagerLSDB *oldLsdb,
+                                GlobalRouteManagerLSDB *newLsdb,
+                                SPFChanges &changes);
+
+  /**
+   * \brief Get the links the SPF calculation follows from a vertex.
+   *
+   * \param lsdb the database
+   * \param lsa the LSA of the vertex, or 0
+   * \param edges [out] the links
+   */
+  static void GetEdges (GlobalRouteManagerLSDB *lsdb, GlobalRoutingLSA *lsa,
+                        std::vector<SPFEdge> &edges);
+
+  /**
+   * \brief Get the destinations the routes to a vertex lead to.
+   *
+   * \param lsa the LSA of the vertex, or 0
+   * \param destinations [out] the destinations
+   */
+  static void GetDestinations (GlobalRoutingLSA *lsa, std::vector<Destination_t> &destinations);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -935,8 +1171,8 @@ private:
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is the equivalent of GetInterfaceForPrefix() on the interface
+   * addresses of the snapshot of the root router.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
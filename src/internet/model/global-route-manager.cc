@@ -58,6 +58,38 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::RecomputeRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  RecomputeRoutes ();
+}
+
+void
+GlobalRouteManager::PrintPhaseTimes (std::ostream &os)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  PrintPhaseTimes (os);
+}
+
+uint32_t
+GlobalRouteManager::GetNPartialTrees (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         GetNPartialTrees ();
+}
+
+void
+GlobalRouteManager::PrintMemoryUsage (std::ostream &os)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  PrintMemoryUsage (os);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,6 +22,8 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include <ostream>
+
 namespace ns3 {
 
 /**
@@ -65,6 +67,46 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routes of all the nodes after a topology change.
+ *
+ * The routing database is gathered again and compared with the one the
+ * routes were computed from.  Only the SPF trees that the changed links
+ * can affect are computed again; the other routers only update the
+ * routes to the destinations which have changed.  The
+ * "GlobalRoutingIncremental" global value set to false makes this call
+ * equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes ().
+ */
+  static void RecomputeRoutes ();
+
+/**
+ * @brief Print the duration of each phase of the last route computation,
+ * and how many SPF trees were computed.
+ *
+ * @param os the output stream
+ */
+  static void PrintPhaseTimes (std::ostream &os);
+
+/**
+ * @brief Get the number of SPF trees which the last route computation
+ * only computed for the destinations which changed.
+ *
+ * @returns the number of partial SPF trees
+ */
+  static uint32_t GetNPartialTrees (void);
+
+/**
+ * @brief Print the memory used by the routing table of each router, and
+ * the total.
+ *
+ * The routes shared by several routers count for each of them in
+ * proportion.
+ *
+ * @param os the output stream
+ */
+  static void PrintMemoryUsage (std::ostream &os);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -23,6 +23,7 @@
 
 #include "ip-l4-protocol.h"
 #include "ns3/integer.h"
+#include "ns3/packet.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -68,4 +69,12 @@ IpL4Protocol::ReceiveIcmp (Ipv6Address icmpSource, uint8_t icmpTtl,
   NS_LOG_FUNCTION (this << icmpSource << static_cast<uint32_t> (icmpTtl) << static_cast<uint32_t> (icmpType) << static_cast<uint32_t> (icmpCode) << icmpInfo << payloadSource << payloadDestination << payload);
 }
 
+bool
+IpL4Protocol::Segment (Ptr<const Packet> packet, const Address &source,
+                       const Address &destination, std::list<Ptr<Packet> > &segments) const
+{
+  NS_LOG_FUNCTION (this << packet << source << destination);
+  return false;
+}
+
 } //namespace ns3
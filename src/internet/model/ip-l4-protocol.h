@@ -24,8 +24,10 @@
 #ifndef IP_L4_PROTOCOL_H
 #define IP_L4_PROTOCOL_H
 
+#include <list>
 #include "ns3/object.h"
 #include "ns3/callback.h"
+#include "ns3/address.h"
 #include "ipv4-header.h"
 #include "ipv6-header.h"
 
@@ -177,6 +179,22 @@ public:
    * \return current Callback for the L4 protocol
    */
   virtual DownTargetCallback6 GetDownTarget6 (void) const = 0;
+
+  /**
+   * \brief Split a segmentation-offload super-segment into its segments
+   *
+   * Called by the network layer when the output device does not transmit
+   * the super-segments itself. The default implementation does not split
+   * the packets, which are then fragmented as plain packets.
+   *
+   * \param packet the super-segment, starting with the header of this protocol
+   * \param source the source address of the packet
+   * \param destination the destination address of the packet
+   * \param segments the segments, each one with its own header
+   * \returns true if the packet was split
+   */
+  virtual bool Segment (Ptr<const Packet> packet, const Address &source,
+                        const Address &destination, std::list<Ptr<Packet> > &segments) const;
 };
 
 } // Namespace ns3
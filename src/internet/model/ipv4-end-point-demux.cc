@@ -40,30 +40,152 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
+Ipv4EndPointDemux::FourTuple::FourTuple (Ipv4Address localAddress, uint16_t localPort,
+                                         Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::FourTuple::operator== (const FourTuple &o) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return localAddress == o.localAddress && localPort == o.localPort
+         && peerAddress == o.peerAddress && peerPort == o.peerPort;
+}
+
+bool
+Ipv4EndPointDemux::FourTuple::IsConnected (void) const
+{
+  return localAddress != Ipv4Address::GetAny ()
+         && peerAddress != Ipv4Address::GetAny () && peerPort != 0;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator() (const FourTuple &t) const
+{
+  uint64_t addresses = ((uint64_t)t.localAddress.Get () << 32) | t.peerAddress.Get ();
+  uint32_t ports = ((uint32_t)t.localPort << 16) | t.peerPort;
+  return std::hash<uint64_t> () (addresses ^ ((uint64_t)ports * 0x9e3779b97f4a7c15ULL));
+}
+
+Ipv4EndPointDemux::FourTuple
+Ipv4EndPointDemux::GetFourTuple (Ipv4EndPoint *endPoint)
+{
+  return FourTuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                    endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  Position &position = m_positions[endPoint];
+  position.all = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &portEndPoints = m_ports[port];
+  if (portEndPoints.empty ())
+    {
+      SetEphemeralPortUsed (port, true);
+    }
+  position.port = portEndPoints.insert (portEndPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position &position = m_positions[endPoint];
+  FourTuple tuple = GetFourTuple (endPoint);
+  position.connected = tuple.IsConnected ();
+  if (position.connected)
+    {
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port) 
+      EndPoints &wildcards = m_wildcards[tuple.localPort];
+      position.wildcard = wildcards.insert (wildcards.end (), endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position &position = m_positions[endPoint];
+  FourTuple tuple = GetFourTuple (endPoint);
+  if (position.connected)
+    {
+      typedef std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash>::iterator ConnectedI;
+      std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (tuple);
+      for (ConnectedI i = range.first; i != range.second; ++i)
         {
-          return true;
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              break;
+            }
         }
     }
-  return false;
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (tuple.localPort);
+      wildcards->second.erase (position.wildcard);
+      if (wildcards->second.empty ())
+        {
+          m_wildcards.erase (wildcards);
+        }
+    }
+}
+
+void
+Ipv4EndPointDemux::SetEphemeralPortUsed (uint16_t port, bool used)
+{
+  if (m_ephemeralUsed.empty () || port < m_portFirst || port > m_portLast)
+    {
+      return;
+    }
+  uint32_t index = port - m_portFirst;
+  if (used)
+    {
+      m_ephemeralUsed[index / 32] |= 1U << (index % 32);
+    }
+  else
+    {
+      m_ephemeralUsed[index / 32] &= ~(1U << (index % 32));
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (port);
+  if (portEndPoints == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = portEndPoints->second.begin (); i != portEndPoints->second.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
           (*i)->GetLocalAddress () == addr &&
@@ -85,10 +207,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -101,10 +220,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -124,10 +240,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -136,7 +249,27 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  // An end point with the same four-tuple is in the same index.
+  FourTuple tuple (localAddress, localPort, peerAddress, peerPort);
+  std::vector<Ipv4EndPoint *> candidates;
+  if (tuple.IsConnected ())
+    {
+      typedef std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash>::iterator ConnectedI;
+      std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (tuple);
+      for (ConnectedI i = range.first; i != range.second; ++i)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (localPort);
+      if (wildcards != m_wildcards.end ())
+        {
+          candidates.assign (wildcards->second.begin (), wildcards->second.end ());
+        }
+    }
+  for (std::vector<Ipv4EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -150,26 +283,31 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, Position>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Unindex (endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (port);
+  portEndPoints->second.erase (position->second.port);
+  if (portEndPoints->second.empty ())
+    {
+      m_ports.erase (portEndPoints);
+      SetEphemeralPortUsed (port, false);
+    }
+  m_endPoints.erase (position->second.all);
+  m_positions.erase (position);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -208,7 +346,47 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  // Only the connected end points with the packet four-tuple, or with a
+  // subnet address of the incoming interface as local address, and the
+  // end points which are not connected, can match.
+  std::vector<Ipv4EndPoint *> candidates;
+  typedef std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash>::iterator ConnectedI;
+  std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (FourTuple (daddr, dport, saddr, sport));
+  for (ConnectedI i = range.first; i != range.second; ++i)
+    {
+      candidates.push_back (i->second);
+    }
+  if (!m_connected.empty () && incomingInterface)
+    {
+      for (uint32_t j = 0; j < incomingInterface->GetNAddresses (); j++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (j);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          bool seen = addrNetpart == daddr;
+          for (uint32_t k = 0; k < j && !seen; k++)
+            {
+              Ipv4InterfaceAddress other = incomingInterface->GetAddress (k);
+              seen = addrNetpart == other.GetLocal ().CombineMask (other.GetMask ());
+            }
+          if (seen)
+            {
+              continue;
+            }
+          range = m_connected.equal_range (FourTuple (addrNetpart, dport, saddr, sport));
+          for (ConnectedI i = range.first; i != range.second; ++i)
+            {
+              candidates.push_back (i->second);
+            }
+        }
+    }
+  std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (dport);
+  if (wildcards != m_wildcards.end ())
+    {
+      candidates.insert (candidates.end (), wildcards->second.begin (), wildcards->second.end ());
+    }
+
+  for (std::vector<Ipv4EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -347,7 +525,12 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (dport);
+  if (portEndPoints == m_ports.end ())
+    {
+      return 0;
+    }
+  for (EndPointsI i = portEndPoints->second.begin (); i != portEndPoints->second.end (); i++) 
     {
       if ((*i)->GetLocalPort () != dport) 
         {
@@ -382,22 +565,45 @@ Ipv4EndPointDemux::AllocateEphemeralPort (void)
 {
   // Similar to counting up logic in netinet/in_pcb.c
   NS_LOG_FUNCTION (this);
-  uint16_t port = m_ephemeral;
-  int count = m_portLast - m_portFirst;
-  do 
+  uint32_t count = m_portLast - m_portFirst + 1;
+  if (m_ephemeralUsed.empty ())
     {
-      if (count-- < 0)
+      m_ephemeralUsed.resize ((count + 31) / 32);
+      for (std::unordered_map<uint16_t, EndPoints>::iterator i = m_ports.begin (); i != m_ports.end (); i++)
         {
-          return 0;
+          SetEphemeralPortUsed (i->first, true);
         }
-      ++port;
-      if (port < m_portFirst || port > m_portLast)
+    }
+  // search the first free port after the last one allocated, skipping
+  // the words of the bitmap whose ports are all used.
+  uint32_t index = 0;
+  if (m_ephemeral >= m_portFirst && m_ephemeral < m_portLast)
+    {
+      index = m_ephemeral - m_portFirst + 1;
+    }
+  for (uint32_t checked = 0; checked < count; )
+    {
+      if (index % 32 == 0 && index + 32 <= count && m_ephemeralUsed[index / 32] == 0xffffffff)
         {
-          port = m_portFirst;
+          index += 32;
+          checked += 32;
         }
-    } while (LookupPortLocal (port));
-  m_ephemeral = port;
-  return port;
+      else if (m_ephemeralUsed[index / 32] & (1U << (index % 32)))
+        {
+          index++;
+          checked++;
+        }
+      else
+        {
+          m_ephemeral = m_portFirst + index;
+          return m_ephemeral;
+        }
+      if (index == count)
+        {
+          index = 0;
+        }
+    }
+  return 0;
 }
 
 } // namespace ns3
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,14 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed so that lookups do not depend on the number
+ * of connections: the connected endpoints, whose local address, peer
+ * address and peer port are all set, are kept in a hash table by
+ * four-tuple, and the other ones (e.g., listening or unconnected
+ * sockets) in lists by local port.  The endpoints update the indexes
+ * when their addresses change.  The ephemeral ports in use are tracked
+ * in a bitmap.
  */
 
 class Ipv4EndPointDemux {
@@ -173,6 +183,100 @@ private:
    */
   uint16_t AllocateEphemeralPort (void);
 
+  /**
+   * \brief Add a new end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the lookup indexes.
+   *
+   * Called when the end point is added, and when its addresses change.
+   *
+   * \param endPoint the end point
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the lookup indexes.
+   *
+   * Called when the end point is removed, and before its addresses change.
+   *
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Update the ephemeral port bitmap.
+   * \param port the local port
+   * \param used whether the port is used by an end point
+   */
+  void SetEphemeralPortUsed (uint16_t port, bool used);
+
+  /**
+   * \brief The addresses and ports of a connected end point.
+   */
+  struct FourTuple
+  {
+    Ipv4Address localAddress; //!< The local address.
+    Ipv4Address peerAddress;  //!< The peer address.
+    uint16_t localPort;       //!< The local port.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \brief Constructor
+     * \param localAddress the local address
+     * \param localPort the local port
+     * \param peerAddress the peer address
+     * \param peerPort the peer port
+     */
+    FourTuple (Ipv4Address localAddress, uint16_t localPort,
+               Ipv4Address peerAddress, uint16_t peerPort);
+    /**
+     * \brief Equality operator
+     * \param o the other four-tuple
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &o) const;
+    /**
+     * \return true if the local address, peer address and peer port are set.
+     */
+    bool IsConnected (void) const;
+  };
+
+  /**
+   * \brief Hash of a FourTuple.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple
+     * \param t the four-tuple
+     * \return the hash
+     */
+    size_t operator() (const FourTuple &t) const;
+  };
+
+  /**
+   * \brief Position of an end point in the containers.
+   */
+  struct Position
+  {
+    EndPointsI all;      //!< Position in m_endPoints.
+    EndPointsI port;     //!< Position in m_ports.
+    EndPointsI wildcard; //!< Position in m_wildcards, if not connected.
+    bool connected;      //!< True if the end point is in m_connected.
+  };
+
+  /**
+   * \brief Get the four-tuple of an end point.
+   * \param endPoint the end point
+   * \return the four-tuple
+   */
+  static FourTuple GetFourTuple (Ipv4EndPoint *endPoint);
+
   /**
    * \brief The ephemeral port.
    */
@@ -192,6 +296,34 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points of each local port, in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+
+  /**
+   * \brief The end points which are not connected, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_wildcards;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  std::unordered_multimap<FourTuple, Ipv4EndPoint *, FourTupleHash> m_connected;
+
+  /**
+   * \brief The position of each end point in the containers.
+   */
+  std::unordered_map<Ipv4EndPoint *, Position> m_positions;
+
+  /**
+   * \brief Bitmap of the ephemeral ports in use, built on the first
+   * ephemeral port allocation.
+   */
+  std::vector<uint32_t> m_ephemeralUsed;
+
+  friend class Ipv4EndPoint;
 };
 
 } // namespace ns3
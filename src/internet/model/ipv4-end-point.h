@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \ingroup ipv4
@@ -227,6 +228,12 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  friend class Ipv4EndPointDemux;
+  /**
+   * \brief The demux indexing this endpoint by its addresses and ports (if any).
+   */
+  Ipv4EndPointDemux *m_demux;
 };
 
 } // namespace ns3
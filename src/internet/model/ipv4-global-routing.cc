@@ -16,6 +16,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <algorithm>
 #include <vector>
 #include <iomanip>
 #include "ns3/names.h"
@@ -57,13 +58,54 @@ Ipv4GlobalRouting::GetTypeId (void)
   return tid;
 }
 
+std::vector<Ipv4GlobalRouting::NextHop> Ipv4GlobalRouting::m_allNextHops;
+std::unordered_map<uint64_t, uint32_t> Ipv4GlobalRouting::m_nextHopIds;
+Ipv4GlobalRouting::RouteSets Ipv4GlobalRouting::m_routeSets;
+uint32_t Ipv4GlobalRouting::m_nRouters = 0;
+
+Ipv4GlobalRouting::RouteSet::RouteSet ()
+  : indexesValid (false),
+    shared (false),
+    hash (0)
+{
+}
+
+Ipv4GlobalRouting::RouteSet::RouteSet (const RouteSet &o)
+  : SimpleRefCount<RouteSet> (o),
+    hostRoutes (o.hostRoutes),
+    networkRoutes (o.networkRoutes),
+    externalRoutes (o.externalRoutes),
+    indexesValid (false),
+    shared (false),
+    hash (0)
+{
+}
+
+Ipv4GlobalRouting::RouteSet::~RouteSet ()
+{
+  if (shared)
+    {
+      std::pair<RouteSets::iterator, RouteSets::iterator> range = m_routeSets.equal_range (hash);
+      for (RouteSets::iterator i = range.first; i != range.second; i++)
+        {
+          if (i->second == this)
+            {
+              m_routeSets.erase (i);
+              break;
+            }
+        }
+    }
+}
+
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_routes (Create<RouteSet> ())
 {
   NS_LOG_FUNCTION (this);
 
   m_rand = CreateObject<UniformRandomVariable> ();
+  m_nRouters++;
 }
 
 Ipv4GlobalRouting::~Ipv4GlobalRouting ()
@@ -71,15 +113,67 @@ Ipv4GlobalRouting::~Ipv4GlobalRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4GlobalRouting::PrepareWrite (void)
+{
+  if (m_routes->GetReferenceCount () > 1)
+    {
+      NS_LOG_LOGIC ("Copying the routes shared by " << m_routes->GetReferenceCount () << " routers");
+      m_routes = Create<RouteSet> (*m_routes);
+    }
+  else if (m_routes->shared)
+    {
+      // Nobody else uses the set: take it out of the shared sets.
+      std::pair<RouteSets::iterator, RouteSets::iterator> range = m_routeSets.equal_range (m_routes->hash);
+      for (RouteSets::iterator i = range.first; i != range.second; i++)
+        {
+          if (i->second == PeekPointer (m_routes))
+            {
+              m_routeSets.erase (i);
+              break;
+            }
+        }
+      m_routes->shared = false;
+    }
+  m_routes->indexesValid = false;
+  m_entries.clear ();
+}
+
+Ipv4GlobalRouting::CompactRoute
+Ipv4GlobalRouting::MakeRoute (Ipv4Address dest, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface)
+{
+  uint64_t key = (static_cast<uint64_t> (gateway.Get ()) << 32) | interface;
+  std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> inserted =
+    m_nextHopIds.insert (std::make_pair (key, m_allNextHops.size ()));
+  if (inserted.second)
+    {
+      NextHop nextHop = {gateway, interface};
+      m_allNextHops.push_back (nextHop);
+    }
+  uint32_t id = inserted.first->second;
+  uint32_t slot = std::find (m_nextHops.begin (), m_nextHops.end (), id) - m_nextHops.begin ();
+  if (slot == m_nextHops.size ())
+    {
+      m_nextHops.push_back (id);
+    }
+  CompactRoute route = {dest.Get (), mask.Get (), slot};
+  return route;
+}
+
+const Ipv4GlobalRouting::NextHop &
+Ipv4GlobalRouting::GetNextHop (const CompactRoute &route) const
+{
+  return m_allNextHops[m_nextHops[route.nextHop]];
+}
+
 void 
 Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest, 
                                    Ipv4Address nextHop, 
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
-  m_hostRoutes.push_back (route);
+  PrepareWrite ();
+  m_routes->hostRoutes.push_back (MakeRoute (dest, Ipv4Mask::GetOnes (), nextHop, interface));
 }
 
 void 
@@ -87,9 +181,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
-  m_hostRoutes.push_back (route);
+  PrepareWrite ();
+  m_routes->hostRoutes.push_back (MakeRoute (dest, Ipv4Mask::GetOnes (), Ipv4Address::GetZero (), interface));
 }
 
 void 
@@ -99,12 +192,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        nextHop,
-                                                        interface);
-  m_networkRoutes.push_back (route);
+  PrepareWrite ();
+  m_routes->networkRoutes.push_back (MakeRoute (network, networkMask, nextHop, interface));
 }
 
 void 
@@ -113,11 +202,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        interface);
-  m_networkRoutes.push_back (route);
+  PrepareWrite ();
+  m_routes->networkRoutes.push_back (MakeRoute (network, networkMask, Ipv4Address::GetZero (), interface));
 }
 
 void 
@@ -127,14 +213,86 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                          uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
-  Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
-  *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
-                                                        networkMask,
-                                                        nextHop,
-                                                        interface);
-  m_ASexternalRoutes.push_back (route);
+  PrepareWrite ();
+  m_routes->externalRoutes.push_back (MakeRoute (network, networkMask, nextHop, interface));
+}
+
+void
+Ipv4GlobalRouting::InsertHostRouteTo (Ipv4Address dest,
+                                      Ipv4Address nextHop,
+                                      uint32_t interface,
+                                      uint32_t position)
+{
+  NS_LOG_FUNCTION (this << dest << nextHop << interface << position);
+  PrepareWrite ();
+  NS_ASSERT (position <= m_routes->hostRoutes.size ());
+  m_routes->hostRoutes.insert (m_routes->hostRoutes.begin () + position,
+                               MakeRoute (dest, Ipv4Mask::GetOnes (), nextHop, interface));
+}
+
+void
+Ipv4GlobalRouting::InsertNetworkRouteTo (Ipv4Address network,
+                                         Ipv4Mask networkMask,
+                                         Ipv4Address nextHop,
+                                         uint32_t interface,
+                                         uint32_t position)
+{
+  NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface << position);
+  PrepareWrite ();
+  NS_ASSERT (position <= m_routes->networkRoutes.size ());
+  m_routes->networkRoutes.insert (m_routes->networkRoutes.begin () + position,
+                                  MakeRoute (network, networkMask, nextHop, interface));
+}
+
+void
+Ipv4GlobalRouting::InsertASExternalRouteTo (Ipv4Address network,
+                                            Ipv4Mask networkMask,
+                                            Ipv4Address nextHop,
+                                            uint32_t interface,
+                                            uint32_t position)
+{
+  NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface << position);
+  PrepareWrite ();
+  NS_ASSERT (position <= m_routes->externalRoutes.size ());
+  m_routes->externalRoutes.insert (m_routes->externalRoutes.begin () + position,
+                                   MakeRoute (network, networkMask, nextHop, interface));
+}
+
+void
+Ipv4GlobalRouting::BuildRouteIndex (const CompactRoutes &routes, RouteIndex &index)
+{
+  index.Clear ();
+  uint32_t position = 0;
+  for (CompactRoutesCI i = routes.begin (); i != routes.end (); i++)
+    {
+      uint8_t network[4];
+      uint8_t mask[4];
+      Ipv4Address (i->dest).Serialize (network);
+      Ipv4Address (i->mask).Serialize (mask);
+      index.Insert (network, mask, position++);
+    }
+}
+
+void
+Ipv4GlobalRouting::UpdateRouteIndexes (void)
+{
+  NS_LOG_FUNCTION (this);
+  BuildRouteIndex (m_routes->hostRoutes, m_routes->hostIndex);
+  BuildRouteIndex (m_routes->networkRoutes, m_routes->networkIndex);
+  BuildRouteIndex (m_routes->externalRoutes, m_routes->externalIndex);
+  m_routes->indexesValid = true;
 }
 
+const std::vector<uint32_t> &
+Ipv4GlobalRouting::FindRoutes (const RouteIndex &index, Ipv4Address dest)
+{
+  uint8_t address[4];
+  dest.Serialize (address);
+  m_matches.clear ();
+  index.Lookup (address, m_matches);
+  std::sort (m_matches.begin (), m_matches.end ());
+  return m_matches;
+}
 
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
@@ -143,73 +301,83 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
+  typedef std::vector<const CompactRoute *> RouteVec_t;
   RouteVec_t allRoutes;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
+  // The indexes only return the routes matching the destination, in
+  // the order of their table, so that the routes found and their order
+  // are the same as with a scan of the tables.  The shared route sets
+  // are always indexed.
+  if (!m_routes->indexesValid)
+    {
+      UpdateRouteIndexes ();
+    }
+
+  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_routes->hostRoutes.size ());
+  const std::vector<uint32_t> &hostRoutes = FindRoutes (m_routes->hostIndex, dest);
+  for (std::vector<uint32_t>::const_iterator i = hostRoutes.begin (); 
+       i != hostRoutes.end (); 
        i++) 
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      const CompactRoute *route = &m_routes->hostRoutes[*i];
+      if (route->dest == dest.Get ()) 
         {
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (GetNextHop (*route).interface))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << route); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
+      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_routes->networkRoutes.size ());
+      const std::vector<uint32_t> &networkRoutes = FindRoutes (m_routes->networkIndex, dest);
+      for (std::vector<uint32_t>::const_iterator j = networkRoutes.begin (); 
+           j != networkRoutes.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          const CompactRoute *route = &m_routes->networkRoutes[*j];
+          if ((dest.Get () & route->mask) == (route->dest & route->mask)) 
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (GetNextHop (*route).interface))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              allRoutes.push_back (route);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << route);
             }
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      const std::vector<uint32_t> &externalRoutes = FindRoutes (m_routes->externalIndex, dest);
+      for (std::vector<uint32_t>::const_iterator k = externalRoutes.begin ();
+           k != externalRoutes.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          const CompactRoute *route = &m_routes->externalRoutes[*k];
+          if ((dest.Get () & route->mask) == (route->dest & route->mask))
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
+              NS_LOG_LOGIC ("Found external route" << route);
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (GetNextHop (*route).interface))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              allRoutes.push_back (route);
               break;
             }
         }
@@ -228,15 +396,15 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+      const CompactRoute *route = allRoutes.at (selectIndex); 
+      const NextHop &nextHop = GetNextHop (*route);
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetDestination (Ipv4Address (route->dest));
       /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+      rtentry->SetSource (m_ipv4->GetAddress (nextHop.interface, 0).GetLocal ());
+      rtentry->SetGateway (nextHop.gateway);
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (nextHop.interface));
       return rtentry;
     }
   else 
@@ -250,116 +418,244 @@ Ipv4GlobalRouting::GetNRoutes (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t n = 0;
-  n += m_hostRoutes.size ();
-  n += m_networkRoutes.size ();
-  n += m_ASexternalRoutes.size ();
+  n += m_routes->hostRoutes.size ();
+  n += m_routes->networkRoutes.size ();
+  n += m_routes->externalRoutes.size ();
   return n;
 }
 
+Ipv4RoutingTableEntry
+Ipv4GlobalRouting::GetEntry (uint32_t index) const
+{
+  if (index < m_routes->hostRoutes.size ())
+    {
+      const CompactRoute &route = m_routes->hostRoutes[index];
+      return Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address (route.dest),
+                                                       GetNextHop (route).gateway,
+                                                       GetNextHop (route).interface);
+    }
+  index -= m_routes->hostRoutes.size ();
+  const CompactRoute *route;
+  if (index < m_routes->networkRoutes.size ())
+    {
+      route = &m_routes->networkRoutes[index];
+    }
+  else
+    {
+      index -= m_routes->networkRoutes.size ();
+      NS_ASSERT (index < m_routes->externalRoutes.size ());
+      route = &m_routes->externalRoutes[index];
+    }
+  return Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (route->dest),
+                                                      Ipv4Mask (route->mask),
+                                                      GetNextHop (*route).gateway,
+                                                      GetNextHop (*route).interface);
+}
+
 Ipv4RoutingTableEntry *
 Ipv4GlobalRouting::GetRoute (uint32_t index) const
 {
   NS_LOG_FUNCTION (this << index);
-  if (index < m_hostRoutes.size ())
+  std::unordered_map<uint32_t, Ipv4RoutingTableEntry>::iterator i = m_entries.find (index);
+  if (i == m_entries.end ())
+    {
+      i = m_entries.insert (std::make_pair (index, GetEntry (index))).first;
+    }
+  return &i->second;
+}
+
+void 
+Ipv4GlobalRouting::RemoveRoute (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT (index < GetNRoutes ());
+  PrepareWrite ();
+  if (index < m_routes->hostRoutes.size ())
+    {
+      NS_LOG_LOGIC ("Removing host route " << index << "; size = " << m_routes->hostRoutes.size ());
+      m_routes->hostRoutes.erase (m_routes->hostRoutes.begin () + index);
+      return;
+    }
+  index -= m_routes->hostRoutes.size ();
+  if (index < m_routes->networkRoutes.size ())
+    {
+      NS_LOG_LOGIC ("Removing network route " << index << "; size = " << m_routes->networkRoutes.size ());
+      m_routes->networkRoutes.erase (m_routes->networkRoutes.begin () + index);
+      return;
+    }
+  index -= m_routes->networkRoutes.size ();
+  NS_LOG_LOGIC ("Removing external route " << index << "; size = " << m_routes->externalRoutes.size ());
+  m_routes->externalRoutes.erase (m_routes->externalRoutes.begin () + index);
+}
+
+void
+Ipv4GlobalRouting::RemoveRoutesTo (Ipv4Address network, Ipv4Mask networkMask)
+{
+  NS_LOG_FUNCTION (this << network << networkMask);
+  CompactRoute removed = {network.Get (), networkMask.Get (), 0};
+  bool found = false;
+  const CompactRoutes *tables[3] = {&m_routes->hostRoutes, &m_routes->networkRoutes, &m_routes->externalRoutes};
+  for (uint32_t t = 0; t < 3 && !found; t++)
     {
-      uint32_t tmp = 0;
-      for (HostRoutesCI i = m_hostRoutes.begin (); 
-           i != m_hostRoutes.end (); 
-           i++) 
+      for (CompactRoutesCI i = tables[t]->begin (); i != tables[t]->end () && !found; i++)
         {
-          if (tmp  == index)
-            {
-              return *i;
-            }
-          tmp++;
+          found = i->dest == removed.dest && i->mask == removed.mask;
         }
     }
-  index -= m_hostRoutes.size ();
-  uint32_t tmp = 0;
-  if (index < m_networkRoutes.size ())
+  if (!found)
+    {
+      // Do not copy shared routes which do not change.
+      return;
+    }
+  PrepareWrite ();
+  CompactRoutes *routes[3] = {&m_routes->hostRoutes, &m_routes->networkRoutes, &m_routes->externalRoutes};
+  for (uint32_t t = 0; t < 3; t++)
     {
-      for (NetworkRoutesCI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end ();
-           j++)
+      CompactRoutesI j = routes[t]->begin ();
+      for (CompactRoutesI i = routes[t]->begin (); i != routes[t]->end (); i++)
         {
-          if (tmp == index)
+          if (i->dest != removed.dest || i->mask != removed.mask)
             {
-              return *j;
+              *j++ = *i;
             }
-          tmp++;
         }
+      routes[t]->erase (j, routes[t]->end ());
     }
-  index -= m_networkRoutes.size ();
-  tmp = 0;
-  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); 
-       k != m_ASexternalRoutes.end (); 
-       k++) 
+}
+
+void
+Ipv4GlobalRouting::RemoveAllRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNRoutes () > 0 || m_routes->shared)
+    {
+      m_routes = Create<RouteSet> ();
+    }
+  m_nextHops.clear ();
+  m_entries.clear ();
+}
+
+size_t
+Ipv4GlobalRouting::Hash (const RouteSet &routes)
+{
+  const CompactRoutes *tables[3] = {&routes.hostRoutes, &routes.networkRoutes, &routes.externalRoutes};
+  size_t hash = 0;
+  for (uint32_t t = 0; t < 3; t++)
     {
-      if (tmp == index)
+      hash = hash * 1000003 + tables[t]->size ();
+      for (CompactRoutesCI i = tables[t]->begin (); i != tables[t]->end (); i++)
         {
-          return *k;
+          hash = ((hash * 1000003 + i->dest) * 1000003 + i->mask) * 1000003 + i->nextHop;
         }
-      tmp++;
     }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  return hash;
 }
-void 
-Ipv4GlobalRouting::RemoveRoute (uint32_t index)
+
+bool
+Ipv4GlobalRouting::IsEqual (const RouteSet &a, const RouteSet &b)
 {
-  NS_LOG_FUNCTION (this << index);
-  if (index < m_hostRoutes.size ())
+  const CompactRoutes *tablesA[3] = {&a.hostRoutes, &a.networkRoutes, &a.externalRoutes};
+  const CompactRoutes *tablesB[3] = {&b.hostRoutes, &b.networkRoutes, &b.externalRoutes};
+  for (uint32_t t = 0; t < 3; t++)
     {
-      uint32_t tmp = 0;
-      for (HostRoutesI i = m_hostRoutes.begin (); 
-           i != m_hostRoutes.end (); 
-           i++) 
+      if (tablesA[t]->size () != tablesB[t]->size ())
         {
-          if (tmp  == index)
+          return false;
+        }
+      for (CompactRoutesCI i = tablesA[t]->begin (), j = tablesB[t]->begin (); i != tablesA[t]->end (); i++, j++)
+        {
+          if (i->dest != j->dest || i->mask != j->mask || i->nextHop != j->nextHop)
             {
-              NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
-              delete *i;
-              m_hostRoutes.erase (i);
-              NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
-              return;
+              return false;
             }
-          tmp++;
         }
     }
-  index -= m_hostRoutes.size ();
-  uint32_t tmp = 0;
-  for (NetworkRoutesI j = m_networkRoutes.begin (); 
-       j != m_networkRoutes.end (); 
-       j++) 
+  return true;
+}
+
+void
+Ipv4GlobalRouting::ShareRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_routes->shared)
+    {
+      return;
+    }
+  NS_ASSERT (m_routes->GetReferenceCount () == 1);
+
+  // Number the next hops in the order of their first use, so that the
+  // routers using the same next hops for the same destinations have
+  // the same routes, whatever the order in which they were added.
+  std::vector<uint32_t> slots (m_nextHops.size (), 0xffffffff);
+  std::vector<uint32_t> nextHops;
+  CompactRoutes *tables[3] = {&m_routes->hostRoutes, &m_routes->networkRoutes, &m_routes->externalRoutes};
+  for (uint32_t t = 0; t < 3; t++)
     {
-      if (tmp == index)
+      for (CompactRoutesI i = tables[t]->begin (); i != tables[t]->end (); i++)
         {
-          NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
-          delete *j;
-          m_networkRoutes.erase (j);
-          NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
-          return;
+          if (slots[i->nextHop] == 0xffffffff)
+            {
+              slots[i->nextHop] = nextHops.size ();
+              nextHops.push_back (m_nextHops[i->nextHop]);
+            }
+          i->nextHop = slots[i->nextHop];
         }
-      tmp++;
     }
-  index -= m_networkRoutes.size ();
-  tmp = 0;
-  for (ASExternalRoutesI k = m_ASexternalRoutes.begin (); 
-       k != m_ASexternalRoutes.end ();
-       k++)
+  m_nextHops.swap (nextHops);
+  m_entries.clear ();
+
+  size_t hash = Hash (*m_routes);
+  std::pair<RouteSets::iterator, RouteSets::iterator> range = m_routeSets.equal_range (hash);
+  for (RouteSets::iterator i = range.first; i != range.second; i++)
     {
-      if (tmp == index)
+      if (IsEqual (*i->second, *m_routes))
         {
-          NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
-          delete *k;
-          m_ASexternalRoutes.erase (k);
-          NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
+          NS_LOG_LOGIC ("Sharing the routes of " << i->second->GetReferenceCount () << " routers");
+          m_routes = Ptr<RouteSet> (i->second);
           return;
         }
-      tmp++;
     }
-  NS_ASSERT (false);
+  // Index the routes now, so that the lookups of the routers sharing
+  // them only read them.
+  UpdateRouteIndexes ();
+  CompactRoutes (m_routes->hostRoutes).swap (m_routes->hostRoutes);
+  CompactRoutes (m_routes->networkRoutes).swap (m_routes->networkRoutes);
+  CompactRoutes (m_routes->externalRoutes).swap (m_routes->externalRoutes);
+  m_routes->shared = true;
+  m_routes->hash = hash;
+  m_routeSets.insert (std::make_pair (hash, PeekPointer (m_routes)));
+}
+
+uint64_t
+Ipv4GlobalRouting::GetMemoryUsage (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t routes = sizeof (RouteSet)
+    + (m_routes->hostRoutes.capacity () + m_routes->networkRoutes.capacity ()
+       + m_routes->externalRoutes.capacity ()) * sizeof (CompactRoute)
+    + m_routes->hostIndex.GetMemoryUsage () + m_routes->networkIndex.GetMemoryUsage ()
+    + m_routes->externalIndex.GetMemoryUsage ();
+  return m_nextHops.capacity () * sizeof (uint32_t) + routes / m_routes->GetReferenceCount ();
+}
+
+uint32_t
+Ipv4GlobalRouting::GetNSharingRouters (void) const
+{
+  return m_routes->GetReferenceCount ();
+}
+
+uint32_t
+Ipv4GlobalRouting::GetNNextHops (void) const
+{
+  return m_nextHops.size ();
+}
+
+uint64_t
+Ipv4GlobalRouting::GetSharedMemoryUsage (void)
+{
+  return m_allNextHops.capacity () * sizeof (NextHop)
+    + m_nextHopIds.size () * (sizeof (uint64_t) + sizeof (uint32_t) + 2 * sizeof (void *))
+    + m_nextHopIds.bucket_count () * sizeof (void *);
 }
 
 int64_t
@@ -374,23 +670,15 @@ void
 Ipv4GlobalRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  for (HostRoutesI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i = m_hostRoutes.erase (i)) 
-    {
-      delete (*i);
-    }
-  for (NetworkRoutesI j = m_networkRoutes.begin (); 
-       j != m_networkRoutes.end (); 
-       j = m_networkRoutes.erase (j)) 
-    {
-      delete (*j);
-    }
-  for (ASExternalRoutesI l = m_ASexternalRoutes.begin (); 
-       l != m_ASexternalRoutes.end ();
-       l = m_ASexternalRoutes.erase (l))
+  m_routes = Create<RouteSet> ();
+  m_nextHops.clear ();
+  m_entries.clear ();
+  NS_ASSERT (m_nRouters > 0);
+  if (--m_nRouters == 0)
     {
-      delete (*l);
+      // no router refers to the next hops anymore
+      std::vector<NextHop> ().swap (m_allNextHops);
+      std::unordered_map<uint64_t, uint32_t> ().swap (m_nextHopIds);
     }
 
   Ipv4RoutingProtocol::DoDispose ();
@@ -414,7 +702,7 @@ Ipv4GlobalRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Uni
       for (uint32_t j = 0; j < GetNRoutes (); j++)
         {
           std::ostringstream dest, gw, mask, flags;
-          Ipv4RoutingTableEntry route = GetRoute (j);
+          Ipv4RoutingTableEntry route = GetEntry (j);
           dest << route.GetDest ();
           *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
           gw << route.GetGateway ();
@@ -537,9 +825,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -549,9 +835,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -561,9 +845,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -573,9 +855,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
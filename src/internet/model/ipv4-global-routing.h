@@ -20,14 +20,18 @@
 #ifndef IPV4_GLOBAL_ROUTING_H
 #define IPV4_GLOBAL_ROUTING_H
 
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -36,7 +40,6 @@ class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
 class Ipv4Header;
-class Ipv4RoutingTableEntry;
 class Ipv4MulticastRoutingTableEntry;
 class Node;
 
@@ -65,6 +68,13 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * The routes are stored compactly, as a destination and an index in
+ * a next hop (gateway and interface) table shared by all the routers.
+ * After a computation, the GlobalRouteManager calls ShareRoutes so that
+ * the routers with identical routes, such as the stub routers behind
+ * any gateway, use a single copy of them, which is copied again when
+ * one of these routers changes its routes.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -169,6 +179,61 @@ public:
                              Ipv4Address nextHop,
                              uint32_t interface);
 
+  /**
+   * \brief Add a host route at a given position of the host routes.
+   *
+   * The GlobalRouteManager inserts the routes it computes again after a
+   * topology change at the position a full computation gives them, so
+   * that the first route matching a destination does not depend on the
+   * kind of computation.
+   *
+   * \param dest The Ipv4Address destination for this route.
+   * \param nextHop The Ipv4Address of the next hop in the route.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   * \param position The number of host routes before this one.
+   */
+  void InsertHostRouteTo (Ipv4Address dest,
+                          Ipv4Address nextHop,
+                          uint32_t interface,
+                          uint32_t position);
+
+  /**
+   * \brief Add a network route at a given position of the network routes.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop in the route to the destination network.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   * \param position The number of network routes before this one.
+   *
+   * \see InsertHostRouteTo
+   */
+  void InsertNetworkRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface,
+                             uint32_t position);
+
+  /**
+   * \brief Add an external route at a given position of the external routes.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop Ipv4Address
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   * \param position The number of external routes before this one.
+   *
+   * \see InsertHostRouteTo
+   */
+  void InsertASExternalRouteTo (Ipv4Address network,
+                                Ipv4Mask networkMask,
+                                Ipv4Address nextHop,
+                                uint32_t interface,
+                                uint32_t position);
+
   /**
    * \brief Get the number of individual unicast routes that have been added
    * to the routing table.
@@ -193,7 +258,8 @@ public:
    * \param i The index (into the routing table) of the route to retrieve.  If
    * the default route has been set, it will occupy index zero.
    * \return If route is set, a pointer to that Ipv4RoutingTableEntry is returned, otherwise
-   * a zero pointer is returned.
+   * a zero pointer is returned.  The entry is built from the compact table and
+   * remains valid until the routing table is modified.
    *
    * \see Ipv4RoutingTableEntry
    * \see Ipv4GlobalRouting::RemoveRoute
@@ -218,6 +284,58 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove all the routes to a destination from the global unicast
+   * routing table.
+   *
+   * The host routes are the routes to the host address with an all-ones
+   * mask.
+   *
+   * \param network The Ipv4Address network (or host) of the routes.
+   * \param networkMask The Ipv4Mask of the routes.
+   */
+  void RemoveRoutesTo (Ipv4Address network, Ipv4Mask networkMask);
+
+  /**
+   * \brief Remove all the routes from the global unicast routing table.
+   */
+  void RemoveAllRoutes (void);
+
+  /**
+   * \brief Share the routes of this router with the routers having the
+   * same routes.
+   *
+   * The routes are then copied again before being modified.
+   */
+  void ShareRoutes (void);
+
+  /**
+   * \brief Get the memory used by the routing table.
+   *
+   * The routes shared by n routers count for 1/n of their size; the
+   * shared next hop table is not included.
+   *
+   * \return the number of bytes used by the routing table
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+  /**
+   * \return the number of routers using the routes of this router, including
+   * this one
+   */
+  uint32_t GetNSharingRouters (void) const;
+
+  /**
+   * \return the number of next hops of the routing table
+   */
+  uint32_t GetNNextHops (void) const;
+
+  /**
+   * \return the number of bytes used by the next hop table shared by all
+   * the routers
+   */
+  static uint64_t GetSharedMemoryUsage (void);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -239,26 +357,122 @@ private:
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
-  /// container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator HostRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator HostRoutesI;
+  /// A gateway and an interface, shared by the routes of all the routers
+  struct NextHop
+  {
+    Ipv4Address gateway; //!< The gateway, or 0.0.0.0 for a direct route
+    uint32_t interface;  //!< The output interface
+  };
 
-  /// container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *> NetworkRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator NetworkRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator NetworkRoutesI;
+  /// A route of a routing table
+  struct CompactRoute
+  {
+    uint32_t dest;    //!< The destination host or network address
+    uint32_t mask;    //!< The destination network mask
+    uint32_t nextHop; //!< The index of the next hop in m_nextHops
+  };
+  /// container of CompactRoute
+  typedef std::vector<CompactRoute> CompactRoutes;
+  /// const iterator of container of CompactRoute
+  typedef std::vector<CompactRoute>::const_iterator CompactRoutesCI;
+  /// iterator of container of CompactRoute
+  typedef std::vector<CompactRoute>::iterator CompactRoutesI;
 
-  /// container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *> ASExternalRoutes;
-  /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator ASExternalRoutesCI;
-  /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
-  typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
+  /// Index of a routing table, by prefix, giving the positions of the routes
+  typedef PrefixTrie<uint32_t, 4> RouteIndex;
+
+  /**
+   * \brief The routes of a router, possibly shared with other routers.
+   *
+   * The next hops of the routes are indexes in the m_nextHops table of
+   * each router using the routes.
+   */
+  struct RouteSet : public SimpleRefCount<RouteSet>
+  {
+    RouteSet ();
+    /**
+     * \brief Copy the routes of another set, which are not shared.
+     * \param o the set to copy
+     */
+    RouteSet (const RouteSet &o);
+    ~RouteSet ();
+
+    CompactRoutes hostRoutes;     //!< Routes to hosts
+    CompactRoutes networkRoutes;  //!< Routes to networks
+    CompactRoutes externalRoutes; //!< External routes imported
+    RouteIndex hostIndex;         //!< Index of hostRoutes
+    RouteIndex networkIndex;      //!< Index of networkRoutes
+    RouteIndex externalIndex;     //!< Index of externalRoutes
+    bool indexesValid;            //!< Whether the indexes match the routes
+    bool shared;                  //!< Whether the set is in m_routeSets
+    size_t hash;                  //!< The hash of the routes, if shared
+  };
+  /// The shared route sets, by hash
+  typedef std::unordered_multimap<size_t, RouteSet *> RouteSets;
+
+  /**
+   * \brief Copy the routes if they are shared, before modifying them.
+   */
+  void PrepareWrite (void);
+
+  /**
+   * \brief Build a route.
+   * \param dest the destination host or network address
+   * \param mask the destination network mask
+   * \param gateway the gateway, or 0.0.0.0 for a direct route
+   * \param interface the output interface
+   * \return the route
+   */
+  CompactRoute MakeRoute (Ipv4Address dest, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface);
+
+  /**
+   * \param route a route of the routing table
+   * \return the next hop of the route
+   */
+  const NextHop &GetNextHop (const CompactRoute &route) const;
+
+  /**
+   * \brief Get a route of the routing table.
+   * \param i the index of the route
+   * \return the route
+   */
+  Ipv4RoutingTableEntry GetEntry (uint32_t i) const;
+
+  /**
+   * \brief Compute the hash of a route set.
+   * \param routes the route set
+   * \return the hash
+   */
+  static size_t Hash (const RouteSet &routes);
+
+  /**
+   * \brief Compare the routes of two route sets.
+   * \param a a route set
+   * \param b another route set
+   * \return true if the sets hold the same routes, in the same order
+   */
+  static bool IsEqual (const RouteSet &a, const RouteSet &b);
+
+  /**
+   * \brief Rebuild the index of a routing table.
+   * \param routes the routing table
+   * \param index [out] the index
+   */
+  static void BuildRouteIndex (const CompactRoutes &routes, RouteIndex &index);
+
+  /**
+   * \brief Rebuild the route indexes after a change of the routing tables.
+   */
+  void UpdateRouteIndexes (void);
+
+  /**
+   * \brief Find the routes of a table matching a destination, in the
+   * order of the table.
+   * \param index the index of the table
+   * \param dest the destination address
+   * \return the positions of the matching routes, in m_matches
+   */
+  const std::vector<uint32_t> &FindRoutes (const RouteIndex &index, Ipv4Address dest);
 
   /**
    * \brief Lookup in the forwarding table for destination.
@@ -268,9 +482,21 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
-  HostRoutes m_hostRoutes;             //!< Routes to hosts
-  NetworkRoutes m_networkRoutes;       //!< Routes to networks
-  ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ptr<RouteSet> m_routes;              //!< The routes
+  std::vector<uint32_t> m_nextHops;    //!< Indexes of the next hops of the routes in m_allNextHops
+  std::vector<uint32_t> m_matches;     //!< The routes found by FindRoutes
+  /// The entries returned by GetRoute, until the routes change
+  mutable std::unordered_map<uint32_t, Ipv4RoutingTableEntry> m_entries;
+
+  // The next hops and the route sets are shared by all the routers of
+  // the process: the routes must not be computed while other threads
+  // use the routers.  The next hops are kept until all the routers are
+  // disposed of.
+  static std::vector<NextHop> m_allNextHops;  //!< The next hops of all the routers
+  /// Indexes of the next hops in m_allNextHops, by gateway and interface
+  static std::unordered_map<uint64_t, uint32_t> m_nextHopIds;
+  static RouteSets m_routeSets;               //!< The shared route sets
+  static uint32_t m_nRouters;                 //!< The number of routers not disposed of
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
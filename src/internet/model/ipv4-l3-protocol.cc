@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -924,12 +925,46 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A device supporting segmentation offload splits a super-segment itself:
+  // only its segments have to fit in the MTU. The other devices get the
+  // segments split by the transport protocol.
+  uint32_t size = packet->GetSize () + ipHeader.GetSerializedSize ();
+  SegmentOffloadTag offloadTag;
+  if (packet->PeekPacketTag (offloadTag))
+    {
+      if (outDev->SupportsSegmentOffload ()
+          && offloadTag.GetLargestSegmentSize (size) <= outDev->GetMtu ())
+        {
+          size = offloadTag.GetLargestSegmentSize (size);
+        }
+      else
+        {
+          std::list<Ptr<Packet> > segments;
+          Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol ());
+          if (protocol != 0
+              && protocol->Segment (packet, ipHeader.GetSource (), ipHeader.GetDestination (), segments))
+            {
+              uint16_t identification = ipHeader.GetIdentification ();
+              for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+                {
+                  Ipv4Header segmentHeader = ipHeader;
+                  segmentHeader.SetPayloadSize ((*it)->GetSize ());
+                  segmentHeader.SetIdentification (identification++);
+                  SendRealOut (route, *it, segmentHeader);
+                }
+              return;
+            }
+          // The fragments are sent as plain packets
+          packet->RemovePacketTag (offloadTag);
+        }
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (size > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -956,7 +991,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (size > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
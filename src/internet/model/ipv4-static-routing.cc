@@ -23,6 +23,7 @@
       std::clog << Simulator::Now ().GetSeconds () \
                 << " [node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; }
 
+#include <algorithm>
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/names.h"
@@ -54,7 +55,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_routeIndexValid (false),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +75,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routeIndexValid = false;
 }
 
 void 
@@ -87,6 +90,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routeIndexValid = false;
 }
 
 void 
@@ -144,6 +148,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_routeIndexValid = false;
 }
 
 uint32_t 
@@ -219,6 +224,30 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+bool
+Ipv4StaticRouting::IsBefore (const IndexedRoute &a, const IndexedRoute &b)
+{
+  return a.position < b.position;
+}
+
+void
+Ipv4StaticRouting::UpdateRouteIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeIndex.Clear ();
+  uint32_t position = 0;
+  for (NetworkRoutesCI i = m_networkRoutes.begin (); i != m_networkRoutes.end (); i++)
+    {
+      uint8_t network[4];
+      uint8_t mask[4];
+      i->first->GetDestNetwork ().Serialize (network);
+      Ipv4Address (i->first->GetDestNetworkMask ().Get ()).Serialize (mask);
+      IndexedRoute indexed = {position++, i->first, i->second};
+      m_routeIndex.Insert (network, mask, indexed);
+    }
+  m_routeIndexValid = true;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -240,12 +269,24 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  // Only the routes found in the index can match: check them in the
+  // order of the forwarding table, for the same tie-breaks as a full scan.
+  if (!m_routeIndexValid)
+    {
+      UpdateRouteIndex ();
+    }
+  uint8_t address[4];
+  dest.Serialize (address);
+  m_matches.clear ();
+  m_routeIndex.Lookup (address, m_matches);
+  std::sort (m_matches.begin (), m_matches.end (), &Ipv4StaticRouting::IsBefore);
+
+  for (std::vector<IndexedRoute>::const_iterator i = m_matches.begin (); 
+       i != m_matches.end (); 
        i++) 
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
+      Ipv4RoutingTableEntry *j=i->route;
+      uint32_t metric =i->metric;
       Ipv4Mask mask = (j)->GetDestNetworkMask ();
       uint16_t masklen = mask.GetPrefixLength ();
       Ipv4Address entry = (j)->GetDestNetwork ();
@@ -449,6 +490,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_routeIndexValid = false;
           return;
         }
       tmp++;
@@ -581,6 +623,8 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (*i);
     }
+  m_routeIndex.Clear ();
+  m_routeIndexValid = false;
   m_ipv4 = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -615,6 +659,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
@@ -662,6 +707,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
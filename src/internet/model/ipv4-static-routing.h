@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -395,6 +397,27 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /// A network route, with its position in the forwarding table
+  struct IndexedRoute
+  {
+    uint32_t position;              //!< Position of the route in m_networkRoutes
+    Ipv4RoutingTableEntry *route;   //!< The route
+    uint32_t metric;                //!< The route metric
+  };
+
+  /**
+   * \brief Compare the positions of two routes.
+   * \param a a route
+   * \param b another route
+   * \return true if \p a comes first in the forwarding table
+   */
+  static bool IsBefore (const IndexedRoute &a, const IndexedRoute &b);
+
+  /**
+   * \brief Rebuild the route index after a change of the forwarding table.
+   */
+  void UpdateRouteIndex (void);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -418,6 +441,21 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Index of the forwarding table for network, by prefix.
+   */
+  PrefixTrie<IndexedRoute, 4> m_routeIndex;
+
+  /**
+   * \brief Whether m_routeIndex matches the forwarding table.
+   */
+  bool m_routeIndexValid;
+
+  /**
+   * \brief The routes matching a destination, for LookupStatic.
+   */
+  std::vector<IndexedRoute> m_matches;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -40,28 +40,151 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv6EndPointDemux::FourTuple::FourTuple (Ipv6Address localAddress, uint16_t localPort,
+                                         Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+}
+
+bool
+Ipv6EndPointDemux::FourTuple::operator== (const FourTuple &o) const
+{
+  return localAddress == o.localAddress && localPort == o.localPort
+         && peerAddress == o.peerAddress && peerPort == o.peerPort;
+}
+
+bool
+Ipv6EndPointDemux::FourTuple::IsConnected (void) const
+{
+  return localAddress != Ipv6Address::GetAny ()
+         && peerAddress != Ipv6Address::GetAny () && peerPort != 0;
+}
+
+size_t
+Ipv6EndPointDemux::FourTupleHash::operator() (const FourTuple &t) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t addresses = ((uint64_t)addressHash (t.localAddress) << 32) ^ addressHash (t.peerAddress);
+  uint32_t ports = ((uint32_t)t.localPort << 16) | t.peerPort;
+  return std::hash<uint64_t> () (addresses ^ ((uint64_t)ports * 0x9e3779b97f4a7c15ULL));
+}
+
+Ipv6EndPointDemux::FourTuple
+Ipv6EndPointDemux::GetFourTuple (Ipv6EndPoint *endPoint)
+{
+  return FourTuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                    endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  Position &position = m_positions[endPoint];
+  position.all = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &portEndPoints = m_ports[port];
+  if (portEndPoints.empty ())
+    {
+      SetEphemeralPortUsed (port, true);
+    }
+  position.port = portEndPoints.insert (portEndPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position &position = m_positions[endPoint];
+  FourTuple tuple = GetFourTuple (endPoint);
+  position.connected = tuple.IsConnected ();
+  if (position.connected)
+    {
+      m_connected.insert (std::make_pair (tuple, endPoint));
+    }
+  else
     {
-      if ((*i)->GetLocalPort  () == port)
+      EndPoints &wildcards = m_wildcards[tuple.localPort];
+      position.wildcard = wildcards.insert (wildcards.end (), endPoint);
+    }
+}
+
+void
+Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position &position = m_positions[endPoint];
+  FourTuple tuple = GetFourTuple (endPoint);
+  if (position.connected)
+    {
+      typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash>::iterator ConnectedI;
+      std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (tuple);
+      for (ConnectedI i = range.first; i != range.second; ++i)
         {
-          return true;
+          if (i->second == endPoint)
+            {
+              m_connected.erase (i);
+              break;
+            }
         }
     }
-  return false;
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (tuple.localPort);
+      wildcards->second.erase (position.wildcard);
+      if (wildcards->second.empty ())
+        {
+          m_wildcards.erase (wildcards);
+        }
+    }
+}
+
+void
+Ipv6EndPointDemux::SetEphemeralPortUsed (uint16_t port, bool used)
+{
+  if (m_ephemeralUsed.empty () || port < m_portFirst || port > m_portLast)
+    {
+      return;
+    }
+  uint32_t index = port - m_portFirst;
+  if (used)
+    {
+      m_ephemeralUsed[index / 32] |= 1U << (index % 32);
+    }
+  else
+    {
+      m_ephemeralUsed[index / 32] &= ~(1U << (index % 32));
+    }
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (port);
+  if (portEndPoints == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = portEndPoints->second.begin (); i != portEndPoints->second.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
           (*i)->GetLocalAddress () == addr &&
@@ -82,10 +205,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -97,10 +217,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port)
@@ -118,10 +235,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
@@ -129,7 +243,27 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  // An end point with the same four-tuple is in the same index.
+  FourTuple tuple (localAddress, localPort, peerAddress, peerPort);
+  std::vector<Ipv6EndPoint *> candidates;
+  if (tuple.IsConnected ())
+    {
+      typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash>::iterator ConnectedI;
+      std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (tuple);
+      for (ConnectedI i = range.first; i != range.second; ++i)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (localPort);
+      if (wildcards != m_wildcards.end ())
+        {
+          candidates.assign (wildcards->second.begin (), wildcards->second.end ());
+        }
+    }
+  for (std::vector<Ipv6EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -143,25 +277,30 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<Ipv6EndPoint *, Position>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  Unindex (endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (port);
+  portEndPoints->second.erase (position->second.port);
+  if (portEndPoints->second.empty ())
+    {
+      m_ports.erase (portEndPoints);
+      SetEphemeralPortUsed (port, false);
     }
+  m_endPoints.erase (position->second.all);
+  m_positions.erase (position);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -181,7 +320,23 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  // Only the connected end points with the packet four-tuple, and the
+  // end points which are not connected, can match.
+  std::vector<Ipv6EndPoint *> candidates;
+  typedef std::unordered_multimap<FourTuple, Ipv6EndPoint *, FourTupleHash>::iterator ConnectedI;
+  std::pair<ConnectedI, ConnectedI> range = m_connected.equal_range (FourTuple (daddr, dport, saddr, sport));
+  for (ConnectedI i = range.first; i != range.second; ++i)
+    {
+      candidates.push_back (i->second);
+    }
+  std::unordered_map<uint16_t, EndPoints>::iterator wildcards = m_wildcards.find (dport);
+  if (wildcards != m_wildcards.end ())
+    {
+      candidates.insert (candidates.end (), wildcards->second.begin (), wildcards->second.end ());
+    }
+
+  for (std::vector<Ipv6EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -292,8 +447,13 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
 {
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
+  std::unordered_map<uint16_t, EndPoints>::iterator portEndPoints = m_ports.find (dport);
+  if (portEndPoints == m_ports.end ())
+    {
+      return 0;
+    }
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = portEndPoints->second.begin (); i != portEndPoints->second.end (); i++)
     {
       uint32_t tmp = 0;
 
@@ -331,23 +491,45 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
 uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 {
   NS_LOG_FUNCTION (this);
-  uint16_t port = m_ephemeral;
-  int count = m_portLast - m_portFirst;
-  do
+  uint32_t count = m_portLast - m_portFirst + 1;
+  if (m_ephemeralUsed.empty ())
     {
-      if (count-- < 0)
+      m_ephemeralUsed.resize ((count + 31) / 32);
+      for (std::unordered_map<uint16_t, EndPoints>::iterator i = m_ports.begin (); i != m_ports.end (); i++)
         {
-          return 0;
+          SetEphemeralPortUsed (i->first, true);
+        }
+    }
+  // search the first free port after the last one allocated, skipping
+  // the words of the bitmap whose ports are all used.
+  uint32_t index = 0;
+  if (m_ephemeral >= m_portFirst && m_ephemeral < m_portLast)
+    {
+      index = m_ephemeral - m_portFirst + 1;
+    }
+  for (uint32_t checked = 0; checked < count; )
+    {
+      if (index % 32 == 0 && index + 32 <= count && m_ephemeralUsed[index / 32] == 0xffffffff)
+        {
+          index += 32;
+          checked += 32;
+        }
+      else if (m_ephemeralUsed[index / 32] & (1U << (index % 32)))
+        {
+          index++;
+          checked++;
+        }
+      else
+        {
+          m_ephemeral = m_portFirst + index;
+          return m_ephemeral;
         }
-      ++port;
-      if (port < m_portFirst || port > m_portLast)
+      if (index == count)
         {
-          port = m_portFirst;
+          index = 0;
         }
     }
-  while (LookupPortLocal (port));
-  m_ephemeral = port;
-  return port;
+  return 0;
 }
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
@@ -31,6 +31,7 @@
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "ipv6-l3-protocol.h"
@@ -1125,7 +1126,39 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  // A device supporting segmentation offload splits a super-segment itself:
+  // only its segments have to fit in the MTU. The other devices get the
+  // segments split by the transport protocol.
+  uint32_t size = packet->GetSize ();
+  SegmentOffloadTag offloadTag;
+  if (packet->PeekPacketTag (offloadTag))
+    {
+      if (dev->SupportsSegmentOffload ()
+          && offloadTag.GetLargestSegmentSize (size) <= targetMtu + 40)
+        {
+          size = offloadTag.GetLargestSegmentSize (size);
+        }
+      else
+        {
+          std::list<Ptr<Packet> > segments;
+          Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetNextHeader ());
+          if (protocol != 0
+              && protocol->Segment (packet, ipHeader.GetSourceAddress (), ipHeader.GetDestinationAddress (), segments))
+            {
+              for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+                {
+                  Ipv6Header segmentHeader = ipHeader;
+                  segmentHeader.SetPayloadLength ((*it)->GetSize ());
+                  SendRealOut (route, *it, segmentHeader);
+                }
+              return;
+            }
+          // The fragments are sent as plain packets
+          packet->RemovePacketTag (offloadTag);
+        }
+    }
+
+  if (size > targetMtu + 40) /* 40 => size of IPv6 header */
     {
       // Router => drop
 
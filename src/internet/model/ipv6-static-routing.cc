@@ -18,6 +18,7 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -47,7 +48,8 @@ TypeId Ipv6StaticRouting::GetTypeId ()
 }
 
 Ipv6StaticRouting::Ipv6StaticRouting ()
-  : m_ipv6 (0)
+  : m_routeIndexValid (false),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -152,6 +154,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeIndexValid = false;
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -165,6 +168,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeIndexValid = false;
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -173,6 +177,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeIndexValid = false;
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -197,6 +202,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
   m_networkRoutes.push_back (std::make_pair (route, 0));
+  m_routeIndexValid = false;
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -281,6 +287,28 @@ bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceI
   return false;
 }
 
+bool Ipv6StaticRouting::IsBefore (const IndexedRoute &a, const IndexedRoute &b)
+{
+  return a.position < b.position;
+}
+
+void Ipv6StaticRouting::UpdateRouteIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  m_routeIndex.Clear ();
+  uint32_t position = 0;
+  for (NetworkRoutesCI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+    {
+      uint8_t network[16];
+      uint8_t prefix[16];
+      it->first->GetDestNetwork ().GetBytes (network);
+      it->first->GetDestNetworkPrefix ().GetBytes (prefix);
+      IndexedRoute indexed = {position++, it->first, it->second};
+      m_routeIndex.Insert (network, prefix, indexed);
+    }
+  m_routeIndexValid = true;
+}
+
 Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice> interface)
 {
   NS_LOG_FUNCTION (this << dst << interface);
@@ -300,10 +328,22 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  /* only the routes found in the index can match: check them in the order
+     of the forwarding table, for the same tie-breaks as a full scan */
+  if (!m_routeIndexValid)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
+      UpdateRouteIndex ();
+    }
+  uint8_t address[16];
+  dst.GetBytes (address);
+  m_matches.clear ();
+  m_routeIndex.Lookup (address, m_matches);
+  std::sort (m_matches.begin (), m_matches.end (), &Ipv6StaticRouting::IsBefore);
+
+  for (std::vector<IndexedRoute>::const_iterator it = m_matches.begin (); it != m_matches.end (); it++)
+    {
+      Ipv6RoutingTableEntry* j = it->route;
+      uint32_t metric = it->metric;
       Ipv6Prefix mask = j->GetDestNetworkPrefix ();
       uint16_t maskLen = mask.GetPrefixLength ();
       Ipv6Address entry = j->GetDestNetwork ();
@@ -380,6 +420,8 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_routeIndex.Clear ();
+  m_routeIndexValid = false;
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -530,6 +572,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
           return;
         }
       tmp++;
@@ -549,6 +592,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
           return;
         }
     }
@@ -674,6 +718,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
@@ -719,6 +764,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
@@ -763,6 +809,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
             {
               delete j->first;
               j = m_networkRoutes.erase (j);
+              m_routeIndexValid = false;
             }
           else
             {
@@ -24,12 +24,14 @@
 #include <stdint.h>
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -264,6 +266,27 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /// A network route, with its position in the forwarding table
+  struct IndexedRoute
+  {
+    uint32_t position;              //!< Position of the route in m_networkRoutes
+    Ipv6RoutingTableEntry *route;   //!< The route
+    uint32_t metric;                //!< The route metric
+  };
+
+  /**
+   * \brief Compare the positions of two routes.
+   * \param a a route
+   * \param b another route
+   * \return true if \p a comes first in the forwarding table
+   */
+  static bool IsBefore (const IndexedRoute &a, const IndexedRoute &b);
+
+  /**
+   * \brief Rebuild the route index after a change of the forwarding table.
+   */
+  void UpdateRouteIndex ();
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -286,6 +309,21 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Index of the forwarding table for network, by prefix.
+   */
+  PrefixTrie<IndexedRoute, 16> m_routeIndex;
+
+  /**
+   * \brief Whether m_routeIndex matches the forwarding table.
+   */
+  bool m_routeIndexValid;
+
+  /**
+   * \brief The routes matching a destination, for LookupStatic.
+   */
+  std::vector<IndexedRoute> m_matches;
+
   /**
    * \brief the forwarding table for multicast.
    */
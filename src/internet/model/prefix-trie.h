@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief Path-compressed binary trie (Patricia trie) of address prefixes,
+ * for the longest prefix match lookups of the routing protocols.
+ *
+ * The addresses are N bytes long, in network order (4 for IPv4, 16
+ * for IPv6).  Each prefix holds the values inserted with it; Lookup
+ * returns the values of all the prefixes matching an address, walking
+ * a single path of at most N * 8 + 1 nodes instead of the whole table.
+ *
+ * The masks which are not a run of leading ones, which the address
+ * classes allow, are kept aside and checked one by one.
+ *
+ * \tparam T the type of the values
+ * \tparam N the address length, in bytes
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * \brief Insert a value.
+   * \param network the network address
+   * \param mask the network mask
+   * \param value the value
+   */
+  void Insert (const uint8_t *network, const uint8_t *mask, const T &value);
+
+  /**
+   * \brief Find the values of the prefixes matching an address.
+   *
+   * The values are appended to \p values from the shortest prefix to
+   * the longest one, in insertion order for the same prefix, then
+   * the values of the irregular masks matching the address.
+   *
+   * \param address the address
+   * \param values [out] the values found
+   */
+  void Lookup (const uint8_t *address, std::vector<T> &values) const;
+
+  /**
+   * \brief Remove all the values.
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of bytes allocated by the trie
+   */
+  size_t GetMemoryUsage (void) const;
+
+private:
+  /**
+   * \brief Copy constructor, not implemented.
+   * \param o object to copy
+   */
+  PrefixTrie (const PrefixTrie &o);
+  /**
+   * \brief Assignment operator, not implemented.
+   * \param o object to copy
+   * \returns the copied object
+   */
+  PrefixTrie &operator= (const PrefixTrie &o);
+
+  /** \brief A prefix, branching on the bit following it. */
+  struct Node
+  {
+    uint8_t prefix[N];     //!< The prefix bits, the other ones being 0.
+    uint32_t length;       //!< The prefix length, in bits.
+    std::vector<T> values; //!< The values of the prefix.
+    Node *children[2];     //!< The longer prefixes, by their next bit.
+  };
+
+  /** \brief A value with an irregular mask. */
+  struct Masked
+  {
+    uint8_t network[N];    //!< The masked network address.
+    uint8_t mask[N];       //!< The mask.
+    T value;               //!< The value.
+  };
+
+  /**
+   * \brief Create a node.
+   * \param prefix the address to take the prefix from
+   * \param length the prefix length, in bits
+   * \return the new node
+   */
+  static Node *CreateNode (const uint8_t *prefix, uint32_t length);
+  /**
+   * \brief Delete a node and its descendants.
+   * \param node the node
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * \param address an address
+   * \param index a bit index, 0 being the most significant bit
+   * \return the bit of the address
+   */
+  static uint32_t GetBit (const uint8_t *address, uint32_t index);
+  /**
+   * \param a an address
+   * \param b another address
+   * \param max the maximum length to compare, in bits
+   * \return the length of the common prefix of the addresses, up to \p max
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+  /**
+   * \param node a node
+   * \return the number of bytes allocated by the node and its descendants
+   */
+  static size_t GetMemoryUsage (const Node *node);
+
+  Node *m_root;                  //!< The empty prefix.
+  std::vector<Masked> m_masked;  //!< The values with an irregular mask.
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+  : m_root (CreateNode (0, 0))
+{
+}
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  DeleteNode (m_root);
+}
+
+template <typename T, uint32_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t *prefix, uint32_t length)
+{
+  Node *node = new Node ();
+  std::memset (node->prefix, 0, N);
+  for (uint32_t i = 0; i < length / 8; i++)
+    {
+      node->prefix[i] = prefix[i];
+    }
+  if (length % 8 != 0)
+    {
+      node->prefix[length / 8] = prefix[length / 8] & (0xff << (8 - length % 8));
+    }
+  node->length = length;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  return node;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->children[0]);
+      DeleteNode (node->children[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetBit (const uint8_t *address, uint32_t index)
+{
+  return (address[index / 8] >> (7 - index % 8)) & 1;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; i < N && length < max; i++)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              length++;
+            }
+          break;
+        }
+      length += 8;
+    }
+  return length < max ? length : max;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t *network, const uint8_t *mask, const T &value)
+{
+  uint32_t length = 0;
+  while (length < N * 8 && GetBit (mask, length))
+    {
+      length++;
+    }
+  for (uint32_t i = length; i < N * 8; i++)
+    {
+      if (GetBit (mask, i))
+        {
+          Masked masked;
+          for (uint32_t j = 0; j < N; j++)
+            {
+              masked.network[j] = network[j] & mask[j];
+              masked.mask[j] = mask[j];
+            }
+          masked.value = value;
+          m_masked.push_back (masked);
+          return;
+        }
+    }
+
+  Node *node = m_root;
+  while (node->length != length)
+    {
+      // The node prefix is a strict prefix of the network: go down
+      // the branch of the next network bit.
+      uint32_t bit = GetBit (network, node->length);
+      Node *child = node->children[bit];
+      if (child == 0)
+        {
+          node->children[bit] = CreateNode (network, length);
+          node = node->children[bit];
+          break;
+        }
+      uint32_t common = GetCommonLength (child->prefix, network,
+                                         child->length < length ? child->length : length);
+      if (common < child->length)
+        {
+          // Split the branch at the common part of the prefixes.
+          Node *middle = CreateNode (network, common);
+          middle->children[GetBit (child->prefix, common)] = child;
+          node->children[bit] = middle;
+          child = middle;
+        }
+      node = child;
+    }
+  node->values.push_back (value);
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Lookup (const uint8_t *address, std::vector<T> &values) const
+{
+  const Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->prefix, address, node->length) == node->length)
+    {
+      values.insert (values.end (), node->values.begin (), node->values.end ());
+      if (node->length == N * 8)
+        {
+          break;
+        }
+      node = node->children[GetBit (address, node->length)];
+    }
+  for (typename std::vector<Masked>::const_iterator i = m_masked.begin (); i != m_masked.end (); ++i)
+    {
+      bool match = true;
+      for (uint32_t j = 0; j < N && match; j++)
+        {
+          match = (address[j] & i->mask[j]) == i->network[j];
+        }
+      if (match)
+        {
+          values.push_back (i->value);
+        }
+    }
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteNode (m_root);
+  m_root = CreateNode (0, 0);
+  m_masked.clear ();
+}
+
+template <typename T, uint32_t N>
+size_t
+PrefixTrie<T, N>::GetMemoryUsage (const Node *node)
+{
+  if (node == 0)
+    {
+      return 0;
+    }
+  return sizeof (Node) + node->values.capacity () * sizeof (T)
+    + GetMemoryUsage (node->children[0]) + GetMemoryUsage (node->children[1]);
+}
+
+template <typename T, uint32_t N>
+size_t
+PrefixTrie<T, N>::GetMemoryUsage (void) const
+{
+  return GetMemoryUsage (m_root) + m_masked.capacity () * sizeof (Masked);
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -212,6 +212,18 @@ public:
    */
   bool HasOption (uint8_t kind) const;
 
+  /**
+   * \brief Get the values of the timestamp option
+   *
+   * Unlike GetOption, this does not need a TcpOptionTS object: on a
+   * received header the values are read directly from the option bytes.
+   *
+   * \param timestamp the timestamp value, if the option is present
+   * \param echo the timestamp echo, if the option is present
+   * \return true if the header has the timestamp option, false otherwise
+   */
+  bool GetTimestamp (uint32_t &timestamp, uint32_t &echo) const;
+
   /**
    * \brief Append an option to the TCP header
    * \param option The option to append
@@ -332,6 +344,22 @@ private:
    */
   uint8_t CalculateHeaderLength () const;
 
+  /**
+   * \brief Build the option list from the received option bytes
+   *
+   * Deserialize only stores the option bytes: the TcpOption objects are
+   * created the first time that someone asks for them.
+   */
+  void DecodeOptions (void) const;
+
+  /**
+   * \brief Look for an option in the received option bytes
+   *
+   * \param kind the option kind to look for
+   * \return the offset of the option, or m_rawOptionsLen if it is not present
+   */
+  uint8_t FindRawOption (uint8_t kind) const;
+
   uint16_t m_sourcePort;        //!< Source port
   uint16_t m_destinationPort;   //!< Destination port
   SequenceNumber32 m_sequenceNumber;  //!< Sequence number
@@ -349,8 +377,10 @@ private:
   bool m_goodChecksum;    //!< Flag to indicate that checksum is correct
 
   static const uint8_t m_maxOptionsLen = 40;         //!< Maximum options length
-  TcpOptionList m_options;     //!< TcpOption present in the header
+  mutable TcpOptionList m_options;     //!< TcpOption present in the header
   uint8_t m_optionsLen;        //!< Tcp options length.
+  uint8_t m_rawOptions[m_maxOptionsLen]; //!< Received options, not decoded yet
+  mutable uint8_t m_rawOptionsLen;       //!< Length of m_rawOptions (0 once decoded)
 };
 
 } // namespace ns3
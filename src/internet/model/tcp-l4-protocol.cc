@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -45,6 +46,7 @@
 #include "tcp-recovery-ops.h"
 #include "rtt-estimator.h"
 
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -765,5 +767,43 @@ TcpL4Protocol::GetDownTarget6 (void) const
   return m_downTarget6;
 }
 
+bool
+TcpL4Protocol::Segment (Ptr<const Packet> packet, const Address &source,
+                        const Address &destination, std::list<Ptr<Packet> > &segments) const
+{
+  NS_LOG_FUNCTION (this << packet << source << destination);
+  Ptr<Packet> payload = packet->Copy ();
+  SegmentOffloadTag offloadTag;
+  if (!payload->RemovePacketTag (offloadTag))
+    {
+      return false;
+    }
+  TcpHeader header;
+  payload->RemoveHeader (header);
+
+  // Each segment gets a copy of the header, with its own sequence number and
+  // checksum; only the last one keeps the PSH and FIN flags
+  uint32_t size = payload->GetSize ();
+  for (uint32_t offset = 0; offset < size; offset += offloadTag.GetSegmentSize ())
+    {
+      uint32_t length = std::min (offloadTag.GetSegmentSize (), size - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, length);
+      TcpHeader segmentHeader = header;
+      segmentHeader.SetSequenceNumber (header.GetSequenceNumber () + offset);
+      if (offset + length < size)
+        {
+          segmentHeader.SetFlags (header.GetFlags () & ~(TcpHeader::PSH | TcpHeader::FIN));
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          segmentHeader.EnableChecksums ();
+        }
+      segmentHeader.InitializeChecksum (source, destination, PROT_NUMBER);
+      segment->AddHeader (segmentHeader);
+      segments.push_back (segment);
+    }
+  return true;
+}
+
 } // namespace ns3
 
@@ -268,6 +268,8 @@ public:
   virtual int GetProtocolNumber (void) const;
   virtual IpL4Protocol::DownTargetCallback GetDownTarget (void) const;
   virtual IpL4Protocol::DownTargetCallback6 GetDownTarget6 (void) const;
+  virtual bool Segment (Ptr<const Packet> packet, const Address &source,
+                        const Address &destination, std::list<Ptr<Packet> > &segments) const;
 
 protected:
   virtual void DoDispose (void);
@@ -20,6 +20,7 @@
 
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "tcp-rx-buffer.h"
 
 namespace ns3 {
@@ -155,29 +156,18 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
-    {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
-        {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
-        }
-      ++i;
+  // Remove overlapped bytes from packet: only the runs containing the
+  // head and the tail of the packet can overlap it
+  SequenceNumber32 runStart;
+  SequenceNumber32 runEnd;
+  if (m_runs.FindFrom (headSeq, &runStart, &runEnd) && runStart <= headSeq)
+    { // Incoming head is overlapped
+      headSeq = runEnd;
+    }
+  if (headSeq < tailSeq && m_runs.FindBefore (tailSeq, &runStart, &runEnd)
+      && runEnd >= tailSeq && runStart > headSeq)
+    { // Incoming tail is overlapped
+      tailSeq = runStart;
     }
   // We now know how much we are going to store, trim the packet
   if (headSeq >= tailSeq)
@@ -192,9 +182,18 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       p = p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
+  // Rare case: Existing packets are embedded fully in the new packet
+  BufIterator i = m_data.lower_bound (headSeq);
+  while (i != m_data.end () && i->first < tailSeq)
+    {
+      uint32_t size = i->second->GetSize ();
+      m_size -= size;
+      m_runs.Remove (i->first, i->first + SequenceNumber32 (size));
+      m_data.erase (i++);
+    }
   // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+  m_data.insert (i, std::make_pair (headSeq, p));
+  m_runs.Add (headSeq, tailSeq);
 
   if (headSeq > m_nextRxSeq)
     {
@@ -205,18 +204,11 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  if (m_runs.FindFrom (m_nextRxSeq, &runStart, &runEnd) && runStart <= m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      // The run containing the next sequence is in order up to its end
+      m_availBytes += runEnd - m_nextRxSeq;
+      m_nextRxSeq = runEnd;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -241,9 +233,11 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   NS_LOG_FUNCTION (this << head << tail);
   NS_ASSERT (head > m_nextRxSeq);
 
+  // The block is part of a run of contiguous data
   TcpOptionSack::SackBlock current;
-  current.first = head;
-  current.second = tail;
+  bool found = m_runs.FindFrom (head, &current.first, &current.second);
+  NS_ASSERT (found && current.first <= head && tail <= current.second);
+  NS_UNUSED (found);
 
   // The block "current" has been safely stored. Now we need to build the SACK
   // list, to be advertised. From RFC 2018:
@@ -271,53 +265,20 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
-  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
-  while (it != m_sackList.end ())
+  // The run is reported first: drop the previous blocks it contains, that
+  // is the blocks it has been merged with since they were reported.
+  for (TcpOptionSack::SackList::iterator it = m_sackList.begin (); it != m_sackList.end (); )
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
+      if (current.first <= it->first && it->second <= current.second)
         {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
-        {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          ++it;
         }
-
-      ++it;
     }
+  m_sackList.push_front (current);
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
@@ -325,11 +286,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     {
       m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -371,6 +327,8 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
   BufIterator i;
+  SequenceNumber32 headSeq = m_data.begin ()->first;
+  m_runs.Remove (headSeq, headSeq + SequenceNumber32 (extractSize));
   while (extractSize)
     { // Check the buffered data for delivery
       i = m_data.begin ();
@@ -388,8 +346,10 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       else
         { // Partial is extracted and done
           outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+          SequenceNumber32 restSeq = i->first + SequenceNumber32 (extractSize);
+          Ptr<Packet> rest = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
+          m_data.insert (m_data.begin (), std::make_pair (restSeq, rest));
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
@@ -28,6 +28,7 @@
 #include "ns3/ptr.h"
 #include "ns3/tcp-header.h"
 #include "ns3/tcp-option-sack.h"
+#include "ns3/tcp-sequence-ranges.h"
 
 namespace ns3 {
 class Packet;
@@ -53,6 +54,11 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The segments are stored as they are received, without copying their data,
+ * while the contiguous runs they form are merged as they are added. The
+ * runs bound the overlap checks of Add, give the in-order data at once, and
+ * are the blocks of the SACK list.
+ *
  * SACK list
  * ---------
  *
@@ -183,7 +189,8 @@ public:
 
 private:
   /**
-   * \brief Update the sack list, with the block seq starting at the beginning
+   * \brief Update the sack list, with the run containing the block [head;tail)
+   * at the beginning
    *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accommodate header size; from RFC 2018:
@@ -226,6 +233,7 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  TcpSequenceRanges m_runs;                  //!< Contiguous runs of the data in the buffer
 };
 
 } //namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "tcp-sequence-ranges.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSequenceRanges");
+
+TcpSequenceRanges::TcpSequenceRanges ()
+  : m_length (0)
+{
+}
+
+void
+TcpSequenceRanges::Add (SequenceNumber32 start, SequenceNumber32 end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  NS_ASSERT (start < end);
+  m_length += end - start;
+
+  RangeMap::iterator next = m_ranges.lower_bound (start);
+  NS_ASSERT_MSG (next == m_ranges.end () || end <= next->first,
+                 "Range [" << start << ";" << end << ") overlaps another one");
+  if (next != m_ranges.begin ())
+    {
+      RangeMap::iterator previous = next;
+      --previous;
+      NS_ASSERT_MSG (previous->second <= start,
+                     "Range [" << start << ";" << end << ") overlaps another one");
+      if (previous->second == start)
+        {
+          // Extend the previous range
+          if (next != m_ranges.end () && next->first == end)
+            {
+              previous->second = next->second;
+              m_ranges.erase (next);
+            }
+          else
+            {
+              previous->second = end;
+            }
+          return;
+        }
+    }
+  if (next != m_ranges.end () && next->first == end)
+    {
+      end = next->second;
+      m_ranges.erase (next);
+    }
+  m_ranges.insert (std::make_pair (start, end));
+}
+
+void
+TcpSequenceRanges::Remove (SequenceNumber32 start, SequenceNumber32 end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  NS_ASSERT (start < end);
+
+  RangeMap::iterator it = m_ranges.upper_bound (start);
+  NS_ASSERT_MSG (it != m_ranges.begin (),
+                 "Range [" << start << ";" << end << ") is not in the set");
+  --it;
+  SequenceNumber32 rangeEnd = it->second;
+  NS_ASSERT_MSG (end <= rangeEnd,
+                 "Range [" << start << ";" << end << ") is not in the set");
+  m_length -= end - start;
+
+  if (it->first == start)
+    {
+      m_ranges.erase (it);
+    }
+  else
+    {
+      it->second = start;
+    }
+  if (end < rangeEnd)
+    {
+      m_ranges.insert (std::make_pair (end, rangeEnd));
+    }
+}
+
+bool
+TcpSequenceRanges::FindFrom (SequenceNumber32 seq, SequenceNumber32 *start,
+                             SequenceNumber32 *end) const
+{
+  RangeMap::const_iterator it = m_ranges.upper_bound (seq);
+  if (it != m_ranges.begin ())
+    {
+      RangeMap::const_iterator previous = it;
+      --previous;
+      if (seq < previous->second)
+        {
+          it = previous;
+        }
+    }
+  if (it == m_ranges.end ())
+    {
+      return false;
+    }
+  *start = it->first;
+  *end = it->second;
+  return true;
+}
+
+bool
+TcpSequenceRanges::FindBefore (SequenceNumber32 seq, SequenceNumber32 *start,
+                               SequenceNumber32 *end) const
+{
+  RangeMap::const_iterator it = m_ranges.lower_bound (seq);
+  if (it == m_ranges.begin ())
+    {
+      return false;
+    }
+  --it;
+  *start = it->first;
+  *end = it->second;
+  return true;
+}
+
+bool
+TcpSequenceRanges::Contains (SequenceNumber32 seq) const
+{
+  RangeMap::const_iterator it = m_ranges.upper_bound (seq);
+  if (it == m_ranges.begin ())
+    {
+      return false;
+    }
+  --it;
+  return seq < it->second;
+}
+
+void
+TcpSequenceRanges::Clear (void)
+{
+  m_ranges.clear ();
+  m_length = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_SEQUENCE_RANGES_H
+#define TCP_SEQUENCE_RANGES_H
+
+#include <map>
+#include <stdint.h>
+
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Set of disjoint ranges of sequence numbers, with their total length.
+ *
+ * The adjacent ranges are merged, so that the ranges covering a run of
+ * contiguous segments are walked in a single step.
+ */
+class TcpSequenceRanges
+{
+public:
+  TcpSequenceRanges ();
+
+  /**
+   * \brief Add the range [start, end), which must not overlap the set.
+   * \param start the first sequence of the range
+   * \param end the sequence following the range
+   */
+  void Add (SequenceNumber32 start, SequenceNumber32 end);
+
+  /**
+   * \brief Remove the range [start, end), which must be in the set.
+   * \param start the first sequence of the range
+   * \param end the sequence following the range
+   */
+  void Remove (SequenceNumber32 start, SequenceNumber32 end);
+
+  /**
+   * \brief Find the range containing a sequence, or the first one after it.
+   * \param seq the sequence
+   * \param start [out] the first sequence of the range
+   * \param end [out] the sequence following the range
+   * \return false if there is no such range
+   */
+  bool FindFrom (SequenceNumber32 seq, SequenceNumber32 *start, SequenceNumber32 *end) const;
+
+  /**
+   * \brief Find the last range starting before a sequence.
+   * \param seq the sequence
+   * \param start [out] the first sequence of the range
+   * \param end [out] the sequence following the range
+   * \return false if there is no such range
+   */
+  bool FindBefore (SequenceNumber32 seq, SequenceNumber32 *start, SequenceNumber32 *end) const;
+
+  /**
+   * \param seq a sequence
+   * \return true if a range contains the sequence
+   */
+  bool Contains (SequenceNumber32 seq) const;
+
+  /**
+   * \return the total length of the ranges
+   */
+  uint32_t GetLength (void) const { return m_length; }
+
+  /**
+   * \brief Remove all the ranges.
+   */
+  void Clear (void);
+
+private:
+  /// Ranges, by their first sequence, to the sequence following them
+  typedef std::map<SequenceNumber32, SequenceNumber32> RangeMap;
+
+  RangeMap m_ranges;  //!< The ranges
+  uint32_t m_length;  //!< The total length of the ranges
+};
+
+} // namespace ns3
+
+#endif /* TCP_SEQUENCE_RANGES_H */
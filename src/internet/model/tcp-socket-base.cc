@@ -42,6 +42,7 @@
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/object.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -141,6 +142,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("SegmentOffloadSize",
+                   "Largest amount of data sent as a single super-segment, that "
+                   "the device transmits as the burst of its segments "
+                   "(segmentation offload). 0 disables the offload",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_offloadSize),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -329,6 +337,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_offloadSize (sock.m_offloadSize),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -1255,7 +1264,10 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
         }
     }
 
-  m_rxTrace (packet, tcpHeader, this);
+  if (!m_rxTrace.IsEmpty ())
+    {
+      m_rxTrace (packet, tcpHeader, this);
+    }
 
   if (tcpHeader.GetFlags () & TcpHeader::SYN)
     {
@@ -1284,10 +1296,11 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
         }
 
       // When receiving a <SYN> or <SYN-ACK> we should adapt TS to the other end
-      if (tcpHeader.HasOption (TcpOption::TS) && m_timestampEnabled)
+      uint32_t timestamp;
+      uint32_t echo;
+      if (m_timestampEnabled && tcpHeader.GetTimestamp (timestamp, echo))
         {
-          ProcessOptionTimestamp (tcpHeader.GetOption (TcpOption::TS),
-                                  tcpHeader.GetSequenceNumber ());
+          ProcessOptionTimestamp (timestamp, echo, tcpHeader.GetSequenceNumber ());
         }
       else
         {
@@ -1310,7 +1323,9 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       NS_ASSERT (!(tcpHeader.GetFlags () & TcpHeader::SYN));
       if (m_timestampEnabled)
         {
-          if (!tcpHeader.HasOption (TcpOption::TS))
+          uint32_t timestamp;
+          uint32_t echo;
+          if (!tcpHeader.GetTimestamp (timestamp, echo))
             {
               // Ignoring segment without TS, RFC 7323
               NS_LOG_LOGIC ("At state " << TcpStateName[m_state] <<
@@ -1321,8 +1336,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
             }
           else
             {
-              ProcessOptionTimestamp (tcpHeader.GetOption (TcpOption::TS),
-                                      tcpHeader.GetSequenceNumber ());
+              ProcessOptionTimestamp (timestamp, echo, tcpHeader.GetSequenceNumber ());
             }
         }
 
@@ -1509,8 +1523,16 @@ void
 TcpSocketBase::ReadOptions (const TcpHeader &tcpHeader, bool &scoreboardUpdated)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
+
+  // Pure ACKs carry at most a timestamp: do not build the option list
+  // when there is nothing to read here
+  if (!tcpHeader.HasOption (TcpOption::SACK))
+    {
+      return;
+    }
+
   TcpHeader::TcpOptionList::const_iterator it;
-  const TcpHeader::TcpOptionList options = tcpHeader.GetOptionList ();
+  const TcpHeader::TcpOptionList &options = tcpHeader.GetOptionList ();
 
   for (it = options.begin (); it != options.end (); ++it)
     {
@@ -1581,6 +1603,27 @@ TcpSocketBase::EnterRecovery ()
   // these steps are done after the ProcessAck function (SendPendingData)
 }
 
+void
+TcpSocketBase::IncreaseWindow (uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << segmentsAcked);
+
+  if (m_offloadSize == 0)
+    {
+      m_congestionControl->IncreaseWindow (m_tcb, segmentsAcked);
+      return;
+    }
+
+  uint32_t ackSegments = std::max (m_delAckMaxCount, 1U);
+  do
+    {
+      uint32_t n = std::min (segmentsAcked, ackSegments);
+      m_congestionControl->IncreaseWindow (m_tcb, n);
+      segmentsAcked -= n;
+    }
+  while (segmentsAcked > 0);
+}
+
 void
 TcpSocketBase::DupAck ()
 {
@@ -1873,7 +1916,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
       else if (ackNumber < m_recover && m_tcb->m_congState == TcpSocketState::CA_LOSS)
         {
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          IncreaseWindow (segsAcked);
 
           NS_LOG_DEBUG (" Cong Control Called, cWnd=" << m_tcb->m_cWnd <<
                         " ssTh=" << m_tcb->m_ssThresh);
@@ -1966,7 +2009,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              IncreaseWindow (segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2559,7 +2602,10 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       NS_LOG_INFO ("Sending a pure ACK, acking seq " << m_rxBuffer->NextRxSequence ());
     }
 
-  m_txTrace (p, header, this);
+  if (!m_txTrace.IsEmpty ())
+    {
+      m_txTrace (p, header, this);
+    }
 
   if (m_endPoint != nullptr)
     {
@@ -2888,6 +2934,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   AddSocketTags (p);
 
+  if (sz > m_tcb->m_segmentSize)
+    { // A super-segment is transmitted by the device as its segments
+      p->AddPacketTag (SegmentOffloadTag (m_tcb->m_segmentSize, sz));
+    }
+
   if (m_closeOnEmpty && (remainingData == 0))
     {
       flags |= TcpHeader::FIN;
@@ -2929,7 +2980,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
-  m_txTrace (p, header, this);
+  if (!m_txTrace.IsEmpty ())
+    {
+      m_txTrace (p, header, this);
+    }
 
   if (m_endPoint)
     {
@@ -3076,6 +3130,12 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_offloadSize > m_tcb->m_segmentSize && availableWindow > m_tcb->m_segmentSize)
+            { // Segmentation offload: send the full segments that fit in the
+              // window as a single super-segment
+              s = std::min (availableWindow, m_offloadSize);
+              s -= s % m_tcb->m_segmentSize;
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3282,8 +3342,11 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
         }
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK if delayed ack count allows. A super-segment
+      // counts as its segments, and it is acknowledged as a whole.
+      SegmentOffloadTag offloadTag;
+      m_delAckCount += p->PeekPacketTag (offloadTag) ? offloadTag.GetSegments () : 1;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3331,11 +3394,11 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
       RttHistory& h = m_history.front ();
       if (!h.retx && ackSeq >= (h.seq + SequenceNumber32 (h.count)))
         { // Ok to use this sample
-          if (m_timestampEnabled && tcpHeader.HasOption (TcpOption::TS))
+          uint32_t timestamp;
+          uint32_t echo;
+          if (m_timestampEnabled && tcpHeader.GetTimestamp (timestamp, echo))
             {
-              Ptr<const TcpOptionTS> ts;
-              ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
-              m = TcpOptionTS::ElapsedTimeFromTsValue (ts->GetEcho ());
+              m = TcpOptionTS::ElapsedTimeFromTsValue (echo);
             }
           else
             {
@@ -4007,25 +4070,33 @@ TcpSocketBase::ProcessOptionTimestamp (const Ptr<const TcpOption> option,
   NS_LOG_FUNCTION (this << option);
 
   Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (option);
+  ProcessOptionTimestamp (ts->GetTimestamp (), ts->GetEcho (), seq);
+}
+
+void
+TcpSocketBase::ProcessOptionTimestamp (uint32_t timestamp, uint32_t echo,
+                                       const SequenceNumber32 &seq)
+{
+  NS_LOG_FUNCTION (this << timestamp << echo << seq);
 
   // This is valid only when no overflow occurs. It happens
   // when a connection last longer than 50 days.
-  if (m_tcb->m_rcvTimestampValue > ts->GetTimestamp ())
+  if (m_tcb->m_rcvTimestampValue > timestamp)
     {
       // Do not save a smaller timestamp (probably there is reordering)
       return;
     }
 
-  m_tcb->m_rcvTimestampValue = ts->GetTimestamp ();
-  m_tcb->m_rcvTimestampEchoReply = ts->GetEcho ();
+  m_tcb->m_rcvTimestampValue = timestamp;
+  m_tcb->m_rcvTimestampEchoReply = echo;
 
   if (seq == m_rxBuffer->NextRxSequence () && seq <= m_highTxAck)
     {
-      m_timestampToEcho = ts->GetTimestamp ();
+      m_timestampToEcho = timestamp;
     }
 
   NS_LOG_INFO (m_node->GetId () << " Got timestamp=" <<
-               m_timestampToEcho << " and Echo="     << ts->GetEcho ());
+               m_timestampToEcho << " and Echo="     << echo);
 }
 
 void
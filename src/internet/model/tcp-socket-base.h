@@ -1000,6 +1000,17 @@ protected:
    */
   virtual void NewAck (SequenceNumber32 const& seq, bool resetRTO);
 
+  /**
+   * \brief Grow the congestion window on the ACK of new data
+   *
+   * An ACK of a super-segment sent with segmentation offload stands for the
+   * ACKs its segments would have got, one every DelAckCount segments: the
+   * window grows as it would have on these ACKs.
+   *
+   * \param segmentsAcked the number of segments acknowledged
+   */
+  void IncreaseWindow (uint32_t segmentsAcked);
+
   /**
    * \brief Dupack management
    */
@@ -1136,6 +1147,18 @@ protected:
    */
   void ProcessOptionTimestamp (const Ptr<const TcpOption> option,
                                const SequenceNumber32 &seq);
+
+  /** \brief Process the values of the timestamp option from other side
+   *
+   * Same as the version taking the option, for the values read with
+   * TcpHeader::GetTimestamp on the path of every received segment.
+   *
+   * \param timestamp Timestamp value of the segment
+   * \param echo Timestamp echo of the segment
+   * \param seq Sequence number of the segment
+   */
+  void ProcessOptionTimestamp (uint32_t timestamp, uint32_t echo,
+                               const SequenceNumber32 &seq);
   /**
    * \brief Add the timestamp option to the header
    *
@@ -1248,6 +1271,7 @@ protected:
   SequenceNumber32       m_recover    {0};   //!< Previous highest Tx seqnum for fast recovery (set it to initial seq number)
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
+  uint32_t               m_offloadSize {0};  //!< Largest super-segment sent with segmentation offload (0 if disabled)
 
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
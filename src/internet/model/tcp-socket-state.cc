@@ -105,10 +105,10 @@ TcpSocketState::TcpCongStateName[TcpSocketState::CA_LAST_STATE] =
   "CA_OPEN", "CA_DISORDER", "CA_CWR", "CA_RECOVERY", "CA_LOSS"
 };
 
-// const char* const
-// TcpSocketState::EcnStateName[TcpSocketState::ECN_CWR_SENT + 1] =
-// {
-//   "ECN_DISABLED", "ECN_IDLE", "ECN_CE_RCVD", "ECN_SENDING_ECE", "ECN_ECE_RCVD", "ECN_CWR_SENT"
-// };
+const char* const
+TcpSocketState::EcnStateName[TcpSocketState::ECN_CWR_SENT + 1] =
+{
+  "ECN_DISABLED", "ECN_IDLE", "ECN_CE_RCVD", "ECN_SENDING_ECE", "ECN_ECE_RCVD", "ECN_CWR_SENT"
+};
 
 } //namespace ns3
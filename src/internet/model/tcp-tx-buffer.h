@@ -28,6 +28,7 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
+#include "ns3/tcp-tx-scoreboard.h"
 
 namespace ns3 {
 class Packet;
@@ -102,8 +103,11 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation), set through a TcpTxScoreboard. The scoreboard indexes the
+ * sent items by their first sequence, and keeps the sequences of the sacked,
+ * lost and retransmitted items as sets of ranges: processing a SACK block,
+ * or answering questions such as "Is this sequence lost?", is a matter of a
+ * few searches in these sets instead of a walk of the sent list.
  *
  * Item properties
  * ---------------
@@ -164,6 +168,12 @@ public:
    * \param n initial Sequence number to be transmitted
    */
   TcpTxBuffer (uint32_t n = 0);
+  /**
+   * \brief Copy constructor
+   * \param other the buffer to copy; the scoreboard is rebuilt on the copied
+   * sent list
+   */
+  TcpTxBuffer (const TcpTxBuffer &other);
   virtual ~TcpTxBuffer (void);
 
   // Accessors
@@ -225,7 +235,7 @@ public:
    *
    * \returns number of segments that have been transmitted more than once, without acknowledgment
    */
-  uint32_t GetRetransmitsCount (void) const { return m_retrans; }
+  uint32_t GetRetransmitsCount (void) const { return m_scoreboard.GetRetransBytes (); }
 
   /**
    * \brief Get the number of segments that we believe are lost in the network
@@ -233,13 +243,13 @@ public:
    * It is calculated in UpdateLostCount.
    * \return the number of lost segment
    */
-  uint32_t GetLost (void) const { return m_lostOut; }
+  uint32_t GetLost (void) const { return m_scoreboard.GetLostBytes (); }
 
   /**
    * \brief Get the number of segments that have been explicitly sacked by the receiver.
    * \return the number of sacked segment.
    */
-  uint32_t GetSacked (void) const { return m_sackedOut; }
+  uint32_t GetSacked (void) const { return m_scoreboard.GetSackedBytes (); }
 
   /**
    * \brief Append a data packet to the end of the buffer
@@ -426,22 +436,13 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. It counts the sacked items down from the
+   * highest one through the sacked ranges, and marks only the items which
+   * were not examined by the previous calls.
    *
    */
   void UpdateLostCount ();
 
-  /**
-   * \brief Remove the size specified from the lostOut, retrans, sacked count
-   *
-   * Used only in DiscardUpTo
-   *
-   * \param item Item that will be discarded
-   * \param size size to remove (can be different from pktSize because of fragmentation)
-   */
-  void RemoveFromCounts (TcpTxItem *item, uint32_t size);
-
   /**
    * \brief Decide if a segment is lost based on RFC 6675 algorithm.
    * \param seq Sequence
@@ -551,6 +552,9 @@ private:
    * MSS can change, but it is stable, and retransmissions do not happen for
    * each segment).
    *
+   * In the SentList, the walk starts from the item containing seq, found
+   * through the scoreboard, and the items split or merged are re-indexed.
+   *
    * \param list List to extract block from
    * \param startingSeq Starting sequence of the list
    * \param numBytes Bytes to extract, starting from requestedSeq
@@ -560,7 +564,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -608,9 +612,7 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
-  uint32_t m_lostOut   {0}; //!< Number of lost bytes
-  uint32_t m_sackedOut {0}; //!< Number of sacked bytes
-  uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
+  TcpTxScoreboard<TcpTxItem> m_scoreboard; //!< Index and flags of the SentList
 
   uint32_t m_dupAckThresh {0}; //!< Duplicate Ack threshold from TcpSocketBase
   uint32_t m_segmentSize {0}; //!< Segment size from TcpSocketBase
@@ -0,0 +1,471 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_TX_SCOREBOARD_H
+#define TCP_TX_SCOREBOARD_H
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <stdint.h>
+
+#include "ns3/assert.h"
+#include "ns3/sequence-number.h"
+#include "ns3/tcp-sequence-ranges.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Index of the segments of a sent list, and of their SACK flags.
+ *
+ * The scoreboard indexes the items of a sent list by their first sequence,
+ * and keeps the sequences of the sacked, lost and retransmitted items as
+ * sets of ranges. The byte counts of the flags are the lengths of these
+ * sets, and the searches of the SACK processing (the first lost item not
+ * retransmitted, the first item after a run of sacked ones, ...) jump from
+ * range to range instead of walking the list.
+ *
+ * The items are added to the scoreboard once they are in the sent list,
+ * and removed from it before being erased or modified (split, merged or
+ * trimmed); their flags must then be changed only through the setters of
+ * the scoreboard.
+ *
+ * \tparam Item the type of the items, with the m_startSeq, m_packet,
+ * m_sacked, m_lost and m_retrans fields of TcpTxItem
+ */
+template <typename Item>
+class TcpTxScoreboard
+{
+public:
+  typedef std::list<Item*> ItemList;                 //!< The sent list
+  typedef typename ItemList::iterator Iterator;      //!< Item of the sent list
+
+  /**
+   * \brief Constructor
+   * \param list the sent list
+   */
+  TcpTxScoreboard (ItemList &list);
+
+  /**
+   * \brief Index an item of the sent list, and account its flags
+   * \param it the item
+   */
+  void Add (Iterator it);
+
+  /**
+   * \brief Remove an item from the index, and from the counts of its flags
+   * \param it the item
+   */
+  void Remove (Iterator it);
+
+  /**
+   * \brief Remove all the items.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Set the sacked flag of an item; a sacked item is not lost
+   * \param item the item
+   * \param sacked the value of the flag
+   */
+  void SetSacked (Item *item, bool sacked);
+
+  /**
+   * \brief Set the lost flag of an item
+   * \param item the item
+   * \param lost the value of the flag
+   */
+  void SetLost (Item *item, bool lost);
+
+  /**
+   * \brief Set the retransmitted flag of an item
+   * \param item the item
+   * \param retrans the value of the flag
+   */
+  void SetRetrans (Item *item, bool retrans);
+
+  /**
+   * \param seq a sequence
+   * \return the item starting at the sequence, or the end of the sent list
+   */
+  Iterator Find (SequenceNumber32 seq) const;
+
+  /**
+   * \param seq a sequence
+   * \return the first item starting at or after the sequence, or the end
+   * of the sent list
+   */
+  Iterator LowerBound (SequenceNumber32 seq) const;
+
+  /**
+   * \param seq a sequence
+   * \return the item containing the sequence, or the end of the sent list
+   */
+  Iterator FindContaining (SequenceNumber32 seq) const;
+
+  /**
+   * \brief Find the first lost item which is not retransmitted
+   * \param seq [out] the first sequence of the item
+   * \return false if there is no such item
+   */
+  bool FindLostNotRetransmitted (SequenceNumber32 *seq) const;
+
+  /**
+   * \brief Find the first item which is neither sacked, lost nor retransmitted
+   * \param seq [out] the first sequence of the item
+   * \return false if there is no such item
+   */
+  bool FindNotMarked (SequenceNumber32 *seq) const;
+
+  /**
+   * \brief Find the first item to mark as lost below a sequence
+   *
+   * The items before the returned one, up to the sequence, are sacked or
+   * lost already, so that the loss marking does not walk them again.
+   *
+   * \param end the sequence
+   * \return the first item which may be neither sacked nor lost
+   */
+  Iterator GetLossMarkStart (SequenceNumber32 end);
+
+  /** \return the ranges of the sacked items */
+  const TcpSequenceRanges & GetSackedRanges (void) const { return m_sacked; }
+  /** \return the ranges of the lost items */
+  const TcpSequenceRanges & GetLostRanges (void) const { return m_lost; }
+
+  /** \return the number of sacked bytes */
+  uint32_t GetSackedBytes (void) const { return m_sacked.GetLength (); }
+  /** \return the number of lost bytes */
+  uint32_t GetLostBytes (void) const { return m_lost.GetLength (); }
+  /** \return the number of retransmitted bytes */
+  uint32_t GetRetransBytes (void) const { return m_retrans.GetLength (); }
+
+private:
+  /**
+   * \param item an item
+   * \return the sequence following the item
+   */
+  static SequenceNumber32 GetEnd (const Item *item);
+
+  /**
+   * \brief Lower the search hints to an item which may now match them
+   * \param item the item
+   */
+  void LowerHints (const Item *item);
+
+  ItemList &m_list;                                  //!< The sent list
+  std::map<SequenceNumber32, Iterator> m_index;      //!< The items, by first sequence
+
+  TcpSequenceRanges m_sacked;                        //!< The sacked items
+  TcpSequenceRanges m_lost;                          //!< The lost items
+  TcpSequenceRanges m_retrans;                       //!< The retransmitted items
+
+  // No item before a hint matches its search
+  mutable SequenceNumber32 m_lostHint;               //!< Hint of FindLostNotRetransmitted
+  mutable SequenceNumber32 m_notMarkedHint;          //!< Hint of FindNotMarked
+  SequenceNumber32 m_lossMarkHint;                   //!< Hint of GetLossMarkStart
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename Item>
+TcpTxScoreboard<Item>::TcpTxScoreboard (ItemList &list)
+  : m_list (list)
+{
+}
+
+template <typename Item>
+SequenceNumber32
+TcpTxScoreboard<Item>::GetEnd (const Item *item)
+{
+  return item->m_startSeq + item->m_packet->GetSize ();
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::LowerHints (const Item *item)
+{
+  if (item->m_lost && !item->m_retrans && item->m_startSeq < m_lostHint)
+    {
+      m_lostHint = item->m_startSeq;
+    }
+  if (!item->m_lost && !item->m_sacked && !item->m_retrans
+      && item->m_startSeq < m_notMarkedHint)
+    {
+      m_notMarkedHint = item->m_startSeq;
+    }
+  if (!item->m_lost && !item->m_sacked && item->m_startSeq < m_lossMarkHint)
+    {
+      m_lossMarkHint = item->m_startSeq;
+    }
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::Add (Iterator it)
+{
+  Item *item = *it;
+  NS_ASSERT (item->m_packet->GetSize () > 0);
+  if (m_index.empty ())
+    {
+      m_lostHint = m_notMarkedHint = m_lossMarkHint = item->m_startSeq;
+    }
+  bool inserted = m_index.insert (std::make_pair (item->m_startSeq, it)).second;
+  NS_ASSERT_MSG (inserted, "Item starting at " << item->m_startSeq << " already indexed");
+  (void) inserted;
+
+  if (item->m_sacked)
+    {
+      m_sacked.Add (item->m_startSeq, GetEnd (item));
+    }
+  if (item->m_lost)
+    {
+      m_lost.Add (item->m_startSeq, GetEnd (item));
+    }
+  if (item->m_retrans)
+    {
+      m_retrans.Add (item->m_startSeq, GetEnd (item));
+    }
+  LowerHints (item);
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::Remove (Iterator it)
+{
+  Item *item = *it;
+  SequenceNumber32 end = GetEnd (item);
+  NS_ASSERT (m_index.find (item->m_startSeq) != m_index.end ());
+
+  if (m_index.begin ()->first == item->m_startSeq)
+    {
+      // Nothing is left before the end of the head: keep the hints in
+      // the window, where the sequences compare.
+      m_lostHint = std::max (m_lostHint, end);
+      m_notMarkedHint = std::max (m_notMarkedHint, end);
+      m_lossMarkHint = std::max (m_lossMarkHint, end);
+    }
+  m_index.erase (item->m_startSeq);
+
+  if (item->m_sacked)
+    {
+      m_sacked.Remove (item->m_startSeq, end);
+    }
+  if (item->m_lost)
+    {
+      m_lost.Remove (item->m_startSeq, end);
+    }
+  if (item->m_retrans)
+    {
+      m_retrans.Remove (item->m_startSeq, end);
+    }
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::Clear (void)
+{
+  m_index.clear ();
+  m_sacked.Clear ();
+  m_lost.Clear ();
+  m_retrans.Clear ();
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::SetSacked (Item *item, bool sacked)
+{
+  if (item->m_sacked == sacked)
+    {
+      NS_ASSERT (!item->m_sacked || !item->m_lost);
+      return;
+    }
+  item->m_sacked = sacked;
+  if (sacked)
+    {
+      m_sacked.Add (item->m_startSeq, GetEnd (item));
+      if (item->m_lost)
+        {
+          item->m_lost = false;
+          m_lost.Remove (item->m_startSeq, GetEnd (item));
+        }
+    }
+  else
+    {
+      m_sacked.Remove (item->m_startSeq, GetEnd (item));
+      LowerHints (item);
+    }
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::SetLost (Item *item, bool lost)
+{
+  if (item->m_lost == lost)
+    {
+      return;
+    }
+  item->m_lost = lost;
+  if (lost)
+    {
+      m_lost.Add (item->m_startSeq, GetEnd (item));
+    }
+  else
+    {
+      m_lost.Remove (item->m_startSeq, GetEnd (item));
+    }
+  LowerHints (item);
+}
+
+template <typename Item>
+void
+TcpTxScoreboard<Item>::SetRetrans (Item *item, bool retrans)
+{
+  if (item->m_retrans == retrans)
+    {
+      return;
+    }
+  item->m_retrans = retrans;
+  if (retrans)
+    {
+      m_retrans.Add (item->m_startSeq, GetEnd (item));
+    }
+  else
+    {
+      m_retrans.Remove (item->m_startSeq, GetEnd (item));
+      LowerHints (item);
+    }
+}
+
+template <typename Item>
+typename TcpTxScoreboard<Item>::Iterator
+TcpTxScoreboard<Item>::Find (SequenceNumber32 seq) const
+{
+  typename std::map<SequenceNumber32, Iterator>::const_iterator it = m_index.find (seq);
+  return it == m_index.end () ? m_list.end () : it->second;
+}
+
+template <typename Item>
+typename TcpTxScoreboard<Item>::Iterator
+TcpTxScoreboard<Item>::LowerBound (SequenceNumber32 seq) const
+{
+  typename std::map<SequenceNumber32, Iterator>::const_iterator it = m_index.lower_bound (seq);
+  return it == m_index.end () ? m_list.end () : it->second;
+}
+
+template <typename Item>
+typename TcpTxScoreboard<Item>::Iterator
+TcpTxScoreboard<Item>::FindContaining (SequenceNumber32 seq) const
+{
+  typename std::map<SequenceNumber32, Iterator>::const_iterator it = m_index.upper_bound (seq);
+  if (it == m_index.begin ())
+    {
+      return m_list.end ();
+    }
+  --it;
+  return seq < GetEnd (*it->second) ? it->second : m_list.end ();
+}
+
+template <typename Item>
+bool
+TcpTxScoreboard<Item>::FindLostNotRetransmitted (SequenceNumber32 *seq) const
+{
+  SequenceNumber32 pos = m_lostHint;
+  SequenceNumber32 start;
+  SequenceNumber32 end;
+  while (m_lost.FindFrom (pos, &start, &end))
+    {
+      pos = std::max (pos, start);
+      SequenceNumber32 retransStart;
+      SequenceNumber32 retransEnd;
+      // Skip the retransmitted runs of this lost run
+      while (pos < end && m_retrans.FindFrom (pos, &retransStart, &retransEnd)
+             && retransStart <= pos)
+        {
+          pos = retransEnd;
+        }
+      if (pos < end)
+        {
+          m_lostHint = pos;
+          *seq = pos;
+          return true;
+        }
+    }
+  m_lostHint = pos;
+  return false;
+}
+
+template <typename Item>
+bool
+TcpTxScoreboard<Item>::FindNotMarked (SequenceNumber32 *seq) const
+{
+  if (m_index.empty ())
+    {
+      return false;
+    }
+  SequenceNumber32 tail = GetEnd (*m_index.rbegin ()->second);
+  SequenceNumber32 pos = m_notMarkedHint;
+  const TcpSequenceRanges *sets[3] = { &m_sacked, &m_lost, &m_retrans };
+  bool moved = true;
+  while (moved && pos < tail)
+    {
+      moved = false;
+      for (uint32_t i = 0; i < 3; ++i)
+        {
+          SequenceNumber32 start;
+          SequenceNumber32 end;
+          if (sets[i]->FindFrom (pos, &start, &end) && start <= pos)
+            {
+              pos = end;
+              moved = true;
+            }
+        }
+    }
+  m_notMarkedHint = pos;
+  if (pos < tail)
+    {
+      *seq = pos;
+      return true;
+    }
+  return false;
+}
+
+template <typename Item>
+typename TcpTxScoreboard<Item>::Iterator
+TcpTxScoreboard<Item>::GetLossMarkStart (SequenceNumber32 end)
+{
+  Iterator it = LowerBound (m_lossMarkHint);
+  if (m_lossMarkHint < end)
+    {
+      // The caller marks the items up to the end
+      m_lossMarkHint = end;
+    }
+  return it;
+}
+
+} // namespace ns3
+
+#endif /* TCP_TX_SCOREBOARD_H */
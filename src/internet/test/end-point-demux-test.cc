@@ -0,0 +1,542 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-interface-address.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux indexed lookups test.
+ *
+ * The lookups of a demux under random allocations, changes and
+ * releases of its end points are compared with a linear scan of all
+ * the end points, as done before the end points were indexed.
+ */
+class Ipv4EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Reference Lookup, scanning all the end points.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param incomingInterface the incoming interface
+   * \return the matching end points
+   */
+  static Ipv4EndPointDemux::EndPoints ReferenceLookup (Ipv4EndPointDemux &demux,
+                                                      Ipv4Address daddr, uint16_t dport,
+                                                      Ipv4Address saddr, uint16_t sport,
+                                                      Ptr<Ipv4Interface> incomingInterface);
+  /**
+   * \brief Reference SimpleLookup, scanning all the end points.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \return the best matching end point
+   */
+  static Ipv4EndPoint *ReferenceSimpleLookup (Ipv4EndPointDemux &demux,
+                                              Ipv4Address daddr, uint16_t dport,
+                                              Ipv4Address saddr, uint16_t sport);
+};
+
+Ipv4EndPointDemuxTest::Ipv4EndPointDemuxTest ()
+  : TestCase ("Ipv4EndPointDemux indexed lookups match a linear scan")
+{
+}
+
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemuxTest::ReferenceLookup (Ipv4EndPointDemux &demux,
+                                        Ipv4Address daddr, uint16_t dport,
+                                        Ipv4Address saddr, uint16_t sport,
+                                        Ptr<Ipv4Interface> incomingInterface)
+{
+  Ipv4EndPointDemux::EndPoints retval1, retval2, retval3, retval4;
+  Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+  for (Ipv4EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          continue;
+        }
+      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+      bool localAddressIsAny = false;
+      bool localAddressIsSubnetAny = false;
+      if (!localAddressMatchesExact)
+        {
+          localAddressIsAny = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+        }
+      if (!localAddressMatchesExact && !localAddressIsAny)
+        {
+          for (uint32_t j = 0; j < incomingInterface->GetNAddresses (); j++)
+            {
+              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (j);
+              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+              if (endP->GetLocalAddress () == addrNetpart
+                  && addrNetpart == daddr.CombineMask (addr.GetMask ()))
+                {
+                  localAddressIsSubnetAny = true;
+                }
+            }
+          if (!localAddressIsSubnetAny)
+            {
+              continue;
+            }
+        }
+      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
+      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
+      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+      if (!(remotePortMatchesExact || remotePortMatchesWildCard)
+          || !(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+        {
+          continue;
+        }
+      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
+        {
+          retval4.push_back (endP);
+        }
+      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
+        {
+          retval3.push_back (endP);
+        }
+      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+        {
+          retval2.push_back (endP);
+        }
+      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+        {
+          retval1.push_back (endP);
+        }
+    }
+  if (!retval4.empty ()) return retval4;
+  if (!retval3.empty ()) return retval3;
+  if (!retval2.empty ()) return retval2;
+  return retval1;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTest::ReferenceSimpleLookup (Ipv4EndPointDemux &demux,
+                                              Ipv4Address daddr, uint16_t dport,
+                                              Ipv4Address saddr, uint16_t sport)
+{
+  uint32_t genericity = 3;
+  Ipv4EndPoint *generic = 0;
+  Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+  for (Ipv4EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+    {
+      if ((*i)->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if ((*i)->GetLocalAddress () == daddr && (*i)->GetPeerPort () == sport
+          && (*i)->GetPeerAddress () == saddr)
+        {
+          return *i;
+        }
+      uint32_t tmp = ((*i)->GetLocalAddress () == Ipv4Address::GetAny ())
+        + ((*i)->GetPeerAddress () == Ipv4Address::GetAny ());
+      if (tmp < genericity)
+        {
+          generic = *i;
+          genericity = tmp;
+        }
+    }
+  return generic;
+}
+
+void
+Ipv4EndPointDemuxTest::DoRun (void)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+
+  Ptr<SimpleNetDevice> devices[2] = {CreateObject<SimpleNetDevice> (), CreateObject<SimpleNetDevice> ()};
+  Ptr<Ipv4Interface> interfaces[2] = {CreateObject<Ipv4Interface> (), CreateObject<Ipv4Interface> ()};
+  interfaces[0]->SetDevice (devices[0]);
+  interfaces[0]->AddAddress (Ipv4InterfaceAddress ("10.0.0.1", "255.255.255.0"));
+  interfaces[0]->AddAddress (Ipv4InterfaceAddress ("10.0.1.1", "255.255.255.0"));
+  interfaces[1]->SetDevice (devices[1]);
+  interfaces[1]->AddAddress (Ipv4InterfaceAddress ("10.0.2.1", "255.255.255.0"));
+
+  Ipv4Address locals[] = {Ipv4Address::GetAny (), Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.1.1"),
+                          Ipv4Address ("10.0.0.0"), Ipv4Address ("10.0.2.1")};
+  Ipv4Address destinations[] = {Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.1.1"), Ipv4Address ("10.0.2.1"),
+                                Ipv4Address ("10.0.0.255"), Ipv4Address ("10.0.1.7")};
+  Ipv4Address peers[] = {Ipv4Address::GetAny (), Ipv4Address ("192.168.0.1"), Ipv4Address ("192.168.0.2")};
+  uint16_t localPorts[] = {1000, 1001, 1002};
+  uint16_t peerPorts[] = {0, 2000, 2001};
+
+  Ipv4EndPointDemux demux;
+  std::vector<Ipv4EndPoint *> endPoints;
+  uint16_t lastEphemeral = 49152;
+  uint32_t compared = 0;
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      uint32_t action = rng->GetInteger (0, 9);
+      Ptr<NetDevice> device = rng->GetInteger (0, 2) ? Ptr<NetDevice> () : Ptr<NetDevice> (devices[rng->GetInteger (0, 1)]);
+      Ipv4Address local = locals[rng->GetInteger (0, 4)];
+      Ipv4Address peer = peers[rng->GetInteger (0, 2)];
+      uint16_t localPort = localPorts[rng->GetInteger (0, 2)];
+      uint16_t peerPort = peerPorts[rng->GetInteger (0, 2)];
+      Ipv4EndPoint *endPoint = 0;
+      if (action == 0)
+        {
+          // the next free port after the last ephemeral port allocated
+          uint16_t expected = lastEphemeral == 65535 ? 49152 : lastEphemeral + 1;
+          bool used = true;
+          while (used)
+            {
+              used = false;
+              Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+              for (Ipv4EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+                {
+                  if ((*i)->GetLocalPort () == expected)
+                    {
+                      used = true;
+                      expected = expected == 65535 ? 49152 : expected + 1;
+                      break;
+                    }
+                }
+            }
+          endPoint = demux.Allocate ();
+          NS_TEST_ASSERT_MSG_NE (endPoint, 0, "ephemeral port allocation failed");
+          NS_TEST_ASSERT_MSG_EQ (endPoint->GetLocalPort (), expected, "unexpected ephemeral port");
+          lastEphemeral = expected;
+        }
+      else if (action == 1)
+        {
+          endPoint = demux.Allocate (device, localPort);
+        }
+      else if (action == 2)
+        {
+          endPoint = demux.Allocate (device, local, localPort);
+        }
+      else if (action <= 4)
+        {
+          endPoint = demux.Allocate (device, local, localPort, peer, peerPort);
+        }
+      else if (action == 5 && !endPoints.empty ())
+        {
+          Ipv4EndPoint *changed = endPoints[rng->GetInteger (0, endPoints.size () - 1)];
+          switch (rng->GetInteger (0, 3))
+            {
+            case 0:
+              changed->SetPeer (peer, peerPort);
+              break;
+            case 1:
+              changed->SetLocalAddress (local);
+              break;
+            case 2:
+              changed->BindToNetDevice (device);
+              break;
+            default:
+              changed->SetRxEnabled (!changed->IsRxEnabled ());
+              break;
+            }
+        }
+      else if (action == 6 && !endPoints.empty ())
+        {
+          uint32_t index = rng->GetInteger (0, endPoints.size () - 1);
+          demux.DeAllocate (endPoints[index]);
+          endPoints.erase (endPoints.begin () + index);
+        }
+      if (endPoint)
+        {
+          endPoints.push_back (endPoint);
+        }
+
+      Ipv4Address daddr = destinations[rng->GetInteger (0, 4)];
+      Ptr<Ipv4Interface> incomingInterface = interfaces[rng->GetInteger (0, 1)];
+      Ipv4EndPointDemux::EndPoints expected = ReferenceLookup (demux, daddr, localPort, peer, peerPort,
+                                                               incomingInterface);
+      if (expected.size () <= 1)
+        {
+          Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, localPort, peer, peerPort,
+                                                             incomingInterface);
+          NS_TEST_ASSERT_MSG_EQ ((found == expected), true, "Lookup differs at step " << step);
+          compared++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (daddr, localPort, peer, peerPort),
+                             ReferenceSimpleLookup (demux, daddr, localPort, peer, peerPort),
+                             "SimpleLookup differs at step " << step);
+      bool portUsed = false;
+      bool localUsed = false;
+      Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+      for (Ipv4EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+        {
+          portUsed |= (*i)->GetLocalPort () == localPort;
+          localUsed |= (*i)->GetLocalPort () == localPort && (*i)->GetLocalAddress () == local
+            && (*i)->GetBoundNetDevice () == device;
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (localPort), portUsed,
+                             "LookupPortLocal differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (device, local, localPort), localUsed,
+                             "LookupLocal differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), endPoints.size (), "end point lost");
+    }
+  NS_TEST_ASSERT_MSG_GT (compared, 10000, "too few lookups compared");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux indexed lookups test.
+ *
+ * The Ipv6 counterpart of Ipv4EndPointDemuxTest.
+ */
+class Ipv6EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Reference Lookup, scanning all the end points.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param incomingInterface the incoming interface
+   * \return the matching end points
+   */
+  static Ipv6EndPointDemux::EndPoints ReferenceLookup (Ipv6EndPointDemux &demux,
+                                                      Ipv6Address daddr, uint16_t dport,
+                                                      Ipv6Address saddr, uint16_t sport,
+                                                      Ptr<Ipv6Interface> incomingInterface);
+};
+
+Ipv6EndPointDemuxTest::Ipv6EndPointDemuxTest ()
+  : TestCase ("Ipv6EndPointDemux indexed lookups match a linear scan")
+{
+}
+
+Ipv6EndPointDemux::EndPoints
+Ipv6EndPointDemuxTest::ReferenceLookup (Ipv6EndPointDemux &demux,
+                                        Ipv6Address daddr, uint16_t dport,
+                                        Ipv6Address saddr, uint16_t sport,
+                                        Ptr<Ipv6Interface> incomingInterface)
+{
+  Ipv6EndPointDemux::EndPoints retval1, retval2, retval3, retval4;
+  Ipv6EndPointDemux::EndPoints all = demux.GetEndPoints ();
+  for (Ipv6EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+    {
+      Ipv6EndPoint *endP = *i;
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice ()
+          && (!incomingInterface || endP->GetBoundNetDevice () != incomingInterface->GetDevice ()))
+        {
+          continue;
+        }
+      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+        {
+          continue;
+        }
+      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
+      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard)
+          || !(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+        {
+          continue;
+        }
+      if (localAddressMatchesWildCard && remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+        {
+          retval1.push_back (endP);
+        }
+      if ((localAddressMatchesExact || localAddressMatchesAllRouters)
+          && remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+        {
+          retval2.push_back (endP);
+        }
+      if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
+        {
+          retval3.push_back (endP);
+        }
+      if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
+        {
+          retval4.push_back (endP);
+        }
+    }
+  if (!retval4.empty ()) return retval4;
+  if (!retval3.empty ()) return retval3;
+  if (!retval2.empty ()) return retval2;
+  return retval1;
+}
+
+void
+Ipv6EndPointDemuxTest::DoRun (void)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+
+  Ptr<SimpleNetDevice> devices[2] = {CreateObject<SimpleNetDevice> (), CreateObject<SimpleNetDevice> ()};
+  Ptr<Ipv6Interface> interfaces[3] = {CreateObject<Ipv6Interface> (), CreateObject<Ipv6Interface> (), 0};
+  interfaces[0]->SetDevice (devices[0]);
+  interfaces[1]->SetDevice (devices[1]);
+
+  Ipv6Address locals[] = {Ipv6Address::GetAny (), Ipv6Address ("2001:db8::1"), Ipv6Address ("2001:db8::2"),
+                          Ipv6Address::GetAllRoutersMulticast ()};
+  Ipv6Address peers[] = {Ipv6Address::GetAny (), Ipv6Address ("2001:db8:1::1"), Ipv6Address ("2001:db8:1::2")};
+  uint16_t localPorts[] = {1000, 1001, 1002};
+  uint16_t peerPorts[] = {0, 2000, 2001};
+
+  Ipv6EndPointDemux demux;
+  std::vector<Ipv6EndPoint *> endPoints;
+  uint32_t compared = 0;
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      uint32_t action = rng->GetInteger (0, 9);
+      Ptr<NetDevice> device = rng->GetInteger (0, 2) ? Ptr<NetDevice> () : Ptr<NetDevice> (devices[rng->GetInteger (0, 1)]);
+      Ipv6Address local = locals[rng->GetInteger (0, 3)];
+      Ipv6Address peer = peers[rng->GetInteger (0, 2)];
+      uint16_t localPort = localPorts[rng->GetInteger (0, 2)];
+      uint16_t peerPort = peerPorts[rng->GetInteger (0, 2)];
+      Ipv6EndPoint *endPoint = 0;
+      if (action == 0)
+        {
+          endPoint = demux.Allocate ();
+          NS_TEST_ASSERT_MSG_NE (endPoint, 0, "ephemeral port allocation failed");
+          Ipv6EndPointDemux::EndPoints all = demux.GetEndPoints ();
+          for (Ipv6EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ ((*i == endPoint || (*i)->GetLocalPort () != endPoint->GetLocalPort ()),
+                                     true, "ephemeral port already used");
+            }
+        }
+      else if (action == 1)
+        {
+          endPoint = demux.Allocate (device, localPort);
+        }
+      else if (action == 2)
+        {
+          endPoint = demux.Allocate (device, local, localPort);
+        }
+      else if (action <= 4)
+        {
+          endPoint = demux.Allocate (device, local, localPort, peer, peerPort);
+        }
+      else if (action == 5 && !endPoints.empty ())
+        {
+          Ipv6EndPoint *changed = endPoints[rng->GetInteger (0, endPoints.size () - 1)];
+          switch (rng->GetInteger (0, 3))
+            {
+            case 0:
+              changed->SetPeer (peer, peerPort);
+              break;
+            case 1:
+              changed->SetLocalAddress (local);
+              break;
+            case 2:
+              changed->BindToNetDevice (device);
+              break;
+            default:
+              changed->SetRxEnabled (!changed->IsRxEnabled ());
+              break;
+            }
+        }
+      else if (action == 6 && !endPoints.empty ())
+        {
+          uint32_t index = rng->GetInteger (0, endPoints.size () - 1);
+          demux.DeAllocate (endPoints[index]);
+          endPoints.erase (endPoints.begin () + index);
+        }
+      if (endPoint)
+        {
+          endPoints.push_back (endPoint);
+        }
+
+      Ipv6Address daddr = locals[rng->GetInteger (1, 3)];
+      Ptr<Ipv6Interface> incomingInterface = interfaces[rng->GetInteger (0, 2)];
+      Ipv6EndPointDemux::EndPoints expected = ReferenceLookup (demux, daddr, localPort, peer, peerPort,
+                                                               incomingInterface);
+      if (expected.size () <= 1)
+        {
+          Ipv6EndPointDemux::EndPoints found = demux.Lookup (daddr, localPort, peer, peerPort,
+                                                             incomingInterface);
+          NS_TEST_ASSERT_MSG_EQ ((found == expected), true, "Lookup differs at step " << step);
+          compared++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), endPoints.size (), "end point lost");
+    }
+  NS_TEST_ASSERT_MSG_GT (compared, 10000, "too few lookups compared");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demultiplexer TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTest, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTest, TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -14,9 +14,11 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -1244,6 +1246,291 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental recomputation test
+ *
+ * A mesh of point-to-point links, with a LAN and a stub router, goes
+ * through a series of link failures, repairs and metric changes.  After
+ * each change, the routes recomputed incrementally must be the ones a
+ * full recomputation finds, in the same order, also when the SPF trees
+ * are computed by several threads.
+ */
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The routes of each node, in table order.
+  typedef std::vector<std::vector<std::string> > Tables;
+
+  /**
+   * \brief Get the global routing tables.
+   * \param tables [out] the routes of each node
+   */
+  void GetTables (Tables &tables) const;
+
+  /**
+   * \brief Recompute all the routes from scratch.
+   * \param threads the number of threads computing the SPF trees
+   */
+  void RecomputeAll (uint32_t threads) const;
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Incremental global routing recomputation")
+{
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::GetTables (Tables &tables) const
+{
+  tables.clear ();
+  tables.resize (m_nodes.GetN ());
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          std::ostringstream oss;
+          oss << *route;
+          tables[i].push_back (oss.str ());
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::RecomputeAll (uint32_t threads) const
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  // A 4x4 grid, with two diagonals, a LAN between nodes 15, 16 and 17, a
+  // link between nodes 16 and 17, and the stub node 18 attached to node 0.
+  const uint32_t side = 4;
+  m_nodes.Create (side * side + 3);
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t r = 0; r < side; r++)
+    {
+      for (uint32_t c = 0; c < side; c++)
+        {
+          if (c + 1 < side)
+            {
+              links.push_back (std::make_pair (r * side + c, r * side + c + 1));
+            }
+          if (r + 1 < side)
+            {
+              links.push_back (std::make_pair (r * side + c, (r + 1) * side + c));
+            }
+        }
+    }
+  links.push_back (std::make_pair (0, side + 1));
+  links.push_back (std::make_pair (side + 2, 2 * side + 1));
+  links.push_back (std::make_pair (0, side * side + 2));
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  // The interfaces of each link, as node and interface indexes.
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t> > > interfaces;
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (NodeContainer (m_nodes.Get (links[i].first), m_nodes.Get (links[i].second)), channel);
+      Ipv4InterfaceContainer ifaces = ipv4.Assign (net);
+      ipv4.NewNetwork ();
+      interfaces.push_back (std::make_pair (std::make_pair (links[i].first, ifaces.Get (0).second),
+                                            std::make_pair (links[i].second, ifaces.Get (1).second)));
+    }
+  simpleHelper.SetNetDevicePointToPointMode (false);
+  Ptr<SimpleChannel> lan = CreateObject<SimpleChannel> ();
+  NetDeviceContainer lanDevices = simpleHelper.Install (NodeContainer (m_nodes.Get (side * side - 1),
+                                                                       m_nodes.Get (side * side),
+                                                                       m_nodes.Get (side * side + 1)), lan);
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lanDevices);
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  ipv4.SetBase ("10.3.0.0", "255.255.255.252");
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer net = simpleHelper.Install (NodeContainer (m_nodes.Get (side * side), m_nodes.Get (side * side + 1)), channel);
+  Ipv4InterfaceContainer ifaces = ipv4.Assign (net);
+  interfaces.push_back (std::make_pair (std::make_pair (side * side, ifaces.Get (0).second),
+                                        std::make_pair (side * side + 1, ifaces.Get (1).second)));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint32_t partial = 0;
+  for (uint32_t step = 0; step < 40; step++)
+    {
+      std::pair<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t> > link = interfaces[(step * 7) % interfaces.size ()];
+      Ptr<Ipv4> a = m_nodes.Get (link.first.first)->GetObject<Ipv4> ();
+      Ptr<Ipv4> b = m_nodes.Get (link.second.first)->GetObject<Ipv4> ();
+      switch (step % 4)
+        {
+        case 0:
+          a->SetDown (link.first.second);
+          b->SetDown (link.second.second);
+          break;
+        case 1:
+          a->SetMetric (link.first.second, 1 + step % 3);
+          break;
+        case 2:
+          b->SetDown (link.second.second);
+          break;
+        default:
+          break;
+        }
+      if (step % 5 == 4)
+        {
+          // Repair everything
+          for (uint32_t i = 0; i < interfaces.size (); i++)
+            {
+              m_nodes.Get (interfaces[i].first.first)->GetObject<Ipv4> ()->SetUp (interfaces[i].first.second);
+              m_nodes.Get (interfaces[i].second.first)->GetObject<Ipv4> ()->SetUp (interfaces[i].second.second);
+            }
+        }
+
+      GlobalRouteManager::RecomputeRoutes ();
+      partial += GlobalRouteManager::GetNPartialTrees ();
+      Tables incremental;
+      GetTables (incremental);
+
+      RecomputeAll (1);
+      Tables full;
+      GetTables (full);
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((incremental[i] == full[i]), true,
+                                 "Incremental routes of node " << i << " differ at step " << step);
+        }
+
+      RecomputeAll (3);
+      Tables threaded;
+      GetTables (threaded);
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((threaded[i] == full[i]), true,
+                                 "Threaded routes of node " << i << " differ at step " << step);
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (partial, 0, "No SPF tree was computed incrementally");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting shared routing tables test
+ *
+ * The stub routers behind a gateway have the same routes, through
+ * different gateway addresses: they must share them, keep their own
+ * next hops, and stop sharing them when their routes change.
+ */
+class Ipv4GlobalRoutingSharedTablesTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingSharedTablesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingSharedTablesTestCase::Ipv4GlobalRoutingSharedTablesTestCase ()
+  : TestCase ("Global routing tables shared by stub routers")
+{
+}
+
+void
+Ipv4GlobalRoutingSharedTablesTestCase::DoRun (void)
+{
+  // A gateway (node 0) with 4 stub routers.
+  const uint32_t nStubs = 4;
+  NodeContainer nodes;
+  nodes.Create (nStubs + 1);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<Ipv4Address> gateways;
+  for (uint32_t i = 1; i <= nStubs; i++)
+    {
+      NetDeviceContainer net = simpleHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (i)));
+      Ipv4InterfaceContainer ifaces = ipv4.Assign (net);
+      ipv4.NewNetwork ();
+      gateways.push_back (ifaces.GetAddress (0));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::vector<Ptr<Ipv4GlobalRouting> > routings;
+  for (uint32_t i = 0; i <= nStubs; i++)
+    {
+      routings.push_back (nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (routings[0]->GetNSharingRouters (), 1, "The gateway routes are not shared");
+  for (uint32_t i = 1; i <= nStubs; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (routings[i]->GetNSharingRouters (), nStubs, "The stub routes are not shared");
+      NS_TEST_ASSERT_MSG_EQ (routings[i]->GetNRoutes (), 1, "Expected a default route");
+      Ipv4RoutingTableEntry *route = routings[i]->GetRoute (0);
+      NS_TEST_ASSERT_MSG_EQ (route->GetDestNetwork (), Ipv4Address::GetZero (), "Expected a default route");
+      NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), gateways[i - 1], "Wrong gateway");
+    }
+  NS_TEST_ASSERT_MSG_LT (routings[1]->GetMemoryUsage (), routings[0]->GetMemoryUsage (),
+                         "The shared routes are not counted in proportion");
+
+  // Changing the routes of a stub router copies them.
+  routings[1]->AddHostRouteTo (Ipv4Address ("10.9.0.1"), gateways[0], 1);
+  NS_TEST_ASSERT_MSG_EQ (routings[1]->GetNSharingRouters (), 1, "The changed routes are still shared");
+  NS_TEST_ASSERT_MSG_EQ (routings[1]->GetNRoutes (), 2, "The route was not added");
+  for (uint32_t i = 2; i <= nStubs; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (routings[i]->GetNSharingRouters (), nStubs - 1, "The other stub routes are not shared");
+      NS_TEST_ASSERT_MSG_EQ (routings[i]->GetNRoutes (), 1, "The shared routes were changed");
+    }
+
+  // Once the added route is removed, the routes are identical again.
+  routings[1]->RemoveRoutesTo (Ipv4Address ("10.9.0.1"), Ipv4Mask::GetOnes ());
+  routings[1]->ShareRoutes ();
+  NS_TEST_ASSERT_MSG_EQ (routings[1]->GetNSharingRouters (), nStubs, "The stub routes are not shared again");
+  NS_TEST_ASSERT_MSG_EQ (routings[1]->GetRoute (0)->GetGateway (), gateways[0], "Wrong gateway");
+
+  std::ostringstream oss;
+  GlobalRouteManager::PrintMemoryUsage (oss);
+  NS_TEST_ASSERT_MSG_NE (oss.str ().find ("shared by 4 routers"), std::string::npos, "Sharing not reported");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1554,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingSharedTablesTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
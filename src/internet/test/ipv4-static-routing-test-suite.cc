@@ -16,16 +16,21 @@
 
 // End-to-end tests for Ipv4 static routing
 
+#include <vector>
+
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 #include "ns3/test.h"
@@ -201,6 +206,151 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting longest prefix match Test
+ *
+ * The routes found for random destinations in a random table of
+ * overlapping prefixes and metrics are compared with a scan of the
+ * whole table, while routes are added and removed.
+ */
+class Ipv4StaticRoutingLpmTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLpmTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Find the expected route by a scan of the table.
+   * \param routes the routes of the table, in order
+   * \param metrics the metrics of the routes
+   * \param dest the destination
+   * \param found [out] whether a route was found
+   * \return the route found
+   */
+  static Ipv4RoutingTableEntry Scan (const std::vector<Ipv4RoutingTableEntry> &routes,
+                                     const std::vector<uint32_t> &metrics,
+                                     Ipv4Address dest, bool &found);
+};
+
+Ipv4StaticRoutingLpmTestCase::Ipv4StaticRoutingLpmTestCase ()
+  : TestCase ("Static routing longest prefix match")
+{
+}
+
+Ipv4RoutingTableEntry
+Ipv4StaticRoutingLpmTestCase::Scan (const std::vector<Ipv4RoutingTableEntry> &routes,
+                                    const std::vector<uint32_t> &metrics,
+                                    Ipv4Address dest, bool &found)
+{
+  Ipv4RoutingTableEntry best;
+  uint16_t longestMask = 0;
+  uint32_t shortestMetric = 0xffffffff;
+  found = false;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      const Ipv4RoutingTableEntry &route = routes[i];
+      uint32_t metric = metrics[i];
+      uint16_t masklen = route.GetDestNetworkMask ().GetPrefixLength ();
+      if (!route.GetDestNetworkMask ().IsMatch (dest, route.GetDestNetwork ()) || masklen < longestMask)
+        {
+          continue;
+        }
+      if (masklen > longestMask)
+        {
+          shortestMetric = 0xffffffff;
+        }
+      longestMask = masklen;
+      if (metric > shortestMetric)
+        {
+          continue;
+        }
+      shortestMetric = metric;
+      best = route;
+      found = true;
+      if (masklen == 32)
+        {
+          break;
+        }
+    }
+  return best;
+}
+
+void
+Ipv4StaticRoutingLpmTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (NodeContainer (node, node));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.0.0");
+  ipv4.Assign (devices);
+
+  Ptr<Ipv4> ip = node->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting (ip);
+  routing->SetDefaultRoute (Ipv4Address ("10.1.0.254"), 1, 5);
+
+  for (uint32_t step = 0; step < 1000; step++)
+    {
+      if (routing->GetNRoutes () < 200 || rng->GetInteger (0, 3) != 0)
+        {
+          Ipv4Address network (0x14000000 | (rng->GetInteger (0, 3) << 16) | (rng->GetInteger (0, 3) << 8)
+                               | rng->GetInteger (0, 255));
+          Ipv4Mask mask (0xffffffff << (32 - rng->GetInteger (8, 32)));
+          if (rng->GetInteger (0, 15) == 0)
+            {
+              mask = Ipv4Mask (0xff00ff00);
+            }
+          Ipv4Address gateway (0x0a010000 | rng->GetInteger (1, 0xfffe));
+          routing->AddNetworkRouteTo (network, mask, gateway, rng->GetInteger (1, 2), rng->GetInteger (0, 2));
+        }
+      else
+        {
+          routing->RemoveRoute (rng->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+
+      std::vector<Ipv4RoutingTableEntry> routes;
+      std::vector<uint32_t> metrics;
+      for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+        {
+          routes.push_back (routing->GetRoute (i));
+          metrics.push_back (routing->GetMetric (i));
+        }
+      for (uint32_t i = 0; i < 8; i++)
+        {
+          Ipv4Address dest (0x14000000 | (rng->GetInteger (0, 3) << 16) | (rng->GetInteger (0, 3) << 8)
+                            | rng->GetInteger (0, 255));
+          Ipv4Header header;
+          header.SetDestination (dest);
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+          bool found;
+          Ipv4RoutingTableEntry expected = Scan (routes, metrics, dest, found);
+          NS_TEST_ASSERT_MSG_EQ ((route != 0), found, "Route presence differs for " << dest);
+          if (route != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), expected.GetGateway (),
+                                     "Route gateway differs for " << dest);
+              NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), ip->GetNetDevice (expected.GetInterface ()),
+                                     "Route device differs for " << dest);
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +367,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLpmTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
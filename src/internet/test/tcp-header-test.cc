@@ -24,6 +24,8 @@
 #include "ns3/tcp-header.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-option-rfc793.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/tcp-option-sack.h"
 
 using namespace ns3;
 
@@ -421,6 +423,106 @@ TcpHeaderFlagsToString::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP header received options test.
+ *
+ * The options of a deserialized header are read from the option bytes
+ * until the option list is needed: check that both ways give the same
+ * answers, and that the header is serialized back unchanged.
+ */
+class TcpHeaderReceivedOptionsTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name Test description.
+   */
+  TcpHeaderReceivedOptionsTestCase (std::string name);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHeaderReceivedOptionsTestCase::TcpHeaderReceivedOptionsTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+TcpHeaderReceivedOptionsTestCase::DoRun (void)
+{
+  TcpHeader source;
+  source.SetFlags (TcpHeader::ACK);
+  Ptr<TcpOptionNOP> nop = CreateObject<TcpOptionNOP> ();
+  source.AppendOption (nop);
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (100), SequenceNumber32 (200)));
+  source.AppendOption (sack);
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (0x01020304);
+  ts->SetEcho (0xfffefdfc);
+  source.AppendOption (ts);
+
+  Buffer buffer;
+  buffer.AddAtStart (source.GetSerializedSize ());
+  source.Serialize (buffer.Begin ());
+
+  TcpHeader received;
+  NS_TEST_ASSERT_MSG_EQ (received.Deserialize (buffer.Begin ()), source.GetSerializedSize (),
+                         "Header not entirely deserialized");
+
+  uint32_t timestamp = 0;
+  uint32_t echo = 0;
+  NS_TEST_ASSERT_MSG_EQ (received.GetTimestamp (timestamp, echo), true, "Timestamp not found");
+  NS_TEST_ASSERT_MSG_EQ (timestamp, 0x01020304, "Wrong timestamp");
+  NS_TEST_ASSERT_MSG_EQ (echo, 0xfffefdfc, "Wrong timestamp echo");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::NOP), true, "NOP not found");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::SACK), true, "SACK not found");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::MSS), false, "MSS found");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::END), true, "END not found");
+
+  // Serialize the header with its options still encoded
+  TcpHeader copy = received;
+  Buffer copyBuffer;
+  copyBuffer.AddAtStart (copy.GetSerializedSize ());
+  copy.Serialize (copyBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyBuffer.GetSize (), buffer.GetSize (), "Different serialized size");
+  Buffer::Iterator i = buffer.Begin ();
+  Buffer::Iterator j = copyBuffer.Begin ();
+  for (uint32_t k = 0; k < buffer.GetSize (); ++k)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (j.ReadU8 ()),
+                             static_cast<uint32_t> (i.ReadU8 ()),
+                             "Different byte at offset " << k);
+    }
+
+  // Now through the option objects; the padding starts with an END option
+  NS_TEST_ASSERT_MSG_EQ (received.GetOptionList ().size (), 4, "Wrong number of options");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::END), true, "END not decoded");
+  Ptr<const TcpOptionSack> receivedSack = DynamicCast<const TcpOptionSack> (received.GetOption (TcpOption::SACK));
+  NS_TEST_ASSERT_MSG_NE (receivedSack, 0, "SACK not decoded");
+  NS_TEST_ASSERT_MSG_EQ (receivedSack->GetNumSackBlocks (), 1, "Wrong number of SACK blocks");
+  timestamp = 0;
+  echo = 0;
+  NS_TEST_ASSERT_MSG_EQ (received.GetTimestamp (timestamp, echo), true, "Timestamp not found");
+  NS_TEST_ASSERT_MSG_EQ (timestamp, 0x01020304, "Wrong decoded timestamp");
+  NS_TEST_ASSERT_MSG_EQ (echo, 0xfffefdfc, "Wrong decoded timestamp echo");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOption (TcpOption::MSS), false, "MSS found");
+
+  // A timestamp with a wrong length is not seen by either way
+  i = buffer.Begin ();
+  i.Next (20 + 1 + 10 + 1);
+  i.WriteU8 (9);
+  TcpHeader malformed;
+  malformed.Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (malformed.GetTimestamp (timestamp, echo), false, "Malformed timestamp found");
+  NS_TEST_ASSERT_MSG_EQ (malformed.HasOption (TcpOption::SACK), true, "SACK not found");
+  NS_TEST_ASSERT_MSG_EQ (malformed.GetOption (TcpOption::TS), 0, "Malformed timestamp decoded");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -436,6 +538,7 @@ public:
     AddTestCase (new TcpHeaderGetSetTestCase ("GetSet test cases"), TestCase::QUICK);
     AddTestCase (new TcpHeaderWithRFC793OptionTestCase ("Test for options in RFC 793"), TestCase::QUICK);
     AddTestCase (new TcpHeaderFlagsToString ("Test flags to string function"), TestCase::QUICK);
+    AddTestCase (new TcpHeaderReceivedOptionsTestCase ("Test for the options of a received header"), TestCase::QUICK);
   }
 
 };
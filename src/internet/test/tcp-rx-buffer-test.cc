@@ -15,6 +15,8 @@
  *
  */
 
+#include <vector>
+
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
@@ -44,6 +46,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of overlapping out-of-order segments.
+   */
+  void TestReassembly ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +62,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReassembly ();
 }
 
 void
@@ -338,6 +346,73 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReassembly ()
+{
+  const uint32_t size = 5000;
+  uint8_t data[size];
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      data[i] = static_cast<uint8_t> (i * 7 + 3);
+    }
+
+  TcpRxBuffer rxBuf;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (size);
+  TcpHeader h;
+
+  // The odd segments of 100 bytes, then segments overlapping them, some
+  // embedding whole segments, then the remaining data twice
+  std::vector<std::pair<uint32_t, uint32_t> > segments;
+  for (uint32_t start = 100; start < size; start += 200)
+    {
+      segments.push_back (std::make_pair (start, 100));
+    }
+  segments.push_back (std::make_pair (150, 1900));
+  segments.push_back (std::make_pair (2950, 420));
+  segments.push_back (std::make_pair (4000, 1000));
+  for (uint32_t start = 0; start < size; start += 250)
+    {
+      segments.push_back (std::make_pair (start, 250));
+      segments.push_back (std::make_pair (start, 250));
+    }
+
+  uint32_t extracted = 0;
+  for (uint32_t i = 0; i < segments.size (); ++i)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + segments[i].first));
+      rxBuf.Add (Create<Packet> (data + segments[i].first, segments[i].second), h);
+
+      TcpOptionSack::SackList sackList = rxBuf.GetSackList ();
+      for (TcpOptionSack::SackList::iterator it = sackList.begin (); it != sackList.end (); ++it)
+        {
+          NS_TEST_ASSERT_MSG_GT (it->first, rxBuf.NextRxSequence (),
+                                 "SACK block of data already in order");
+        }
+
+      // Deliver the in-order data in chunks not aligned on the segments
+      Ptr<Packet> p;
+      while ((p = rxBuf.Extract (333)) != nullptr)
+        {
+          uint8_t out[333];
+          uint32_t copied = p->CopyData (out, p->GetSize ());
+          for (uint32_t j = 0; j < copied; ++j)
+            {
+              NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (out[j]),
+                                     static_cast<uint32_t> (data[extracted + j]),
+                                     "Wrong byte " << extracted + j);
+            }
+          extracted += copied;
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (extracted, size, "Data not delivered");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1 + size),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Data left in the buffer");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list not empty");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-header.h"
+#include "ns3/segment-offload-tag.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentOffloadTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Segmentation offload test
+ *
+ * The same bulk transfer is run with and without segmentation offload over
+ * a link which has an MTU of 1500 bytes: the data is delivered in both cases
+ * in about the same time, while the sender hands much fewer packets to the
+ * device with offload.
+ */
+class TcpSegmentOffloadTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param useIpv6 Use IPv6 instead of IPv4.
+   */
+  TcpSegmentOffloadTestCase (bool useIpv6);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the transfer
+   * \param offloadSize the SegmentOffloadSize of the sender
+   */
+  void RunTransfer (uint32_t offloadSize);
+
+  /**
+   * \brief Server: handle connection created.
+   * \param s The socket.
+   * \param addr The other party address.
+   */
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  /**
+   * \brief Server: receive data.
+   * \param sock The socket.
+   */
+  void ServerHandleRecv (Ptr<Socket> sock);
+  /**
+   * \brief Client: send data.
+   * \param sock The socket.
+   * \param available Unused in the test.
+   */
+  void SourceHandleSend (Ptr<Socket> sock, uint32_t available);
+  /**
+   * \brief Client: trace of the transmitted segments
+   * \param p The packet.
+   * \param h The TCP header.
+   * \param sock The socket.
+   */
+  void SourceTx (Ptr<const Packet> p, const TcpHeader &h, Ptr<const TcpSocketBase> sock);
+
+  bool m_useIpv6;          //!< Use IPv6 instead of IPv4.
+  uint32_t m_totalBytes;   //!< Total stream size (in bytes).
+  uint32_t m_txBytes;      //!< Bytes sent by the client.
+  uint32_t m_rxBytes;      //!< Bytes received by the server.
+  bool m_rxCorrupted;      //!< Whether the server received unexpected data.
+  uint32_t m_dataPackets;  //!< Data packets sent by the client.
+  uint32_t m_superSegments; //!< Super-segments sent by the client.
+  Time m_lastRx;           //!< Time of the last reception by the server.
+};
+
+TcpSegmentOffloadTestCase::TcpSegmentOffloadTestCase (bool useIpv6)
+  : TestCase (useIpv6 ? "Bulk transfer with segmentation offload, IPv6"
+                      : "Bulk transfer with segmentation offload, IPv4"),
+    m_useIpv6 (useIpv6),
+    m_totalBytes (2000000)
+{
+}
+
+void
+TcpSegmentOffloadTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  s->SetRecvCallback (MakeCallback (&TcpSegmentOffloadTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpSegmentOffloadTestCase::ServerHandleRecv (Ptr<Socket> sock)
+{
+  Ptr<Packet> p;
+  while ((p = sock->Recv ()))
+    {
+      uint8_t *buf = new uint8_t [p->GetSize ()];
+      p->CopyData (buf, p->GetSize ());
+      for (uint32_t i = 0; i < p->GetSize (); ++i)
+        {
+          if (buf[i] != static_cast<uint8_t> ((m_rxBytes + i) % 251))
+            {
+              m_rxCorrupted = true;
+            }
+        }
+      delete [] buf;
+      m_rxBytes += p->GetSize ();
+      m_lastRx = Simulator::Now ();
+    }
+}
+
+void
+TcpSegmentOffloadTestCase::SourceHandleSend (Ptr<Socket> sock, uint32_t available)
+{
+  uint8_t buf[1000];
+  while (sock->GetTxAvailable () > 0 && m_txBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_txBytes, sock->GetTxAvailable ());
+      toSend = std::min<uint32_t> (toSend, sizeof (buf));
+      for (uint32_t i = 0; i < toSend; ++i)
+        {
+          buf[i] = static_cast<uint8_t> ((m_txBytes + i) % 251);
+        }
+      int sent = sock->Send (buf, toSend, 0);
+      NS_TEST_ASSERT_MSG_EQ ((sent > 0), true, "Error during send");
+      m_txBytes += sent;
+    }
+}
+
+void
+TcpSegmentOffloadTestCase::SourceTx (Ptr<const Packet> p, const TcpHeader &h,
+                                     Ptr<const TcpSocketBase> sock)
+{
+  if (p->GetSize () == 0)
+    {
+      return;
+    }
+  ++m_dataPackets;
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      ++m_superSegments;
+      NS_TEST_EXPECT_MSG_EQ (offloadTag.GetPayloadSize (), p->GetSize (), "Wrong payload in the tag");
+      NS_TEST_EXPECT_MSG_EQ ((p->GetSize () <= 65000), true, "Super-segment too large");
+    }
+}
+
+void
+TcpSegmentOffloadTestCase::RunTransfer (uint32_t offloadSize)
+{
+  m_txBytes = 0;
+  m_rxBytes = 0;
+  m_rxCorrupted = false;
+  m_dataPackets = 0;
+  m_superSegments = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  NetDeviceContainer devices = simple.Install (nodes);
+  for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+      devices.Get (i)->SetMtu (1500);
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Address serverLocal;
+  Address serverRemote;
+  uint16_t port = 50000;
+  if (m_useIpv6)
+    {
+      Ipv6AddressHelper ipv6;
+      ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = ipv6.Assign (devices);
+      serverLocal = Inet6SocketAddress (Ipv6Address::GetAny (), port);
+      serverRemote = Inet6SocketAddress (interfaces.GetAddress (0, 1), port);
+    }
+  else
+    {
+      Ipv4AddressHelper ipv4;
+      ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+      serverLocal = InetSocketAddress (Ipv4Address::GetAny (), port);
+      serverRemote = InetSocketAddress (interfaces.GetAddress (0), port);
+    }
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("SegmentSize", UintegerValue (1400));
+  server->SetAttribute ("RcvBufSize", UintegerValue (2000000));
+  server->Bind (serverLocal);
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                             MakeCallback (&TcpSegmentOffloadTestCase::ServerHandleConnectionCreated, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  source->SetAttribute ("SegmentSize", UintegerValue (1400));
+  source->SetAttribute ("SndBufSize", UintegerValue (2000000));
+  source->SetAttribute ("SegmentOffloadSize", UintegerValue (offloadSize));
+  source->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpSegmentOffloadTestCase::SourceTx, this));
+  source->SetSendCallback (MakeCallback (&TcpSegmentOffloadTestCase::SourceHandleSend, this));
+  Simulator::Schedule (Seconds (0.1), &Socket::Connect, source, serverRemote);
+
+  Simulator::Stop (Seconds (60));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, m_totalBytes, "Server did not receive all the bytes");
+  NS_TEST_EXPECT_MSG_EQ (m_rxCorrupted, false, "Server received unexpected data");
+}
+
+void
+TcpSegmentOffloadTestCase::DoRun (void)
+{
+  RunTransfer (0);
+  uint32_t plainPackets = m_dataPackets;
+  Time plainTime = m_lastRx;
+  NS_TEST_EXPECT_MSG_EQ (m_superSegments, 0, "Super-segments sent without offload");
+
+  RunTransfer (64000);
+  uint32_t offloadPackets = m_dataPackets;
+  Time offloadTime = m_lastRx;
+  NS_TEST_EXPECT_MSG_GT (m_superSegments, 0, "No super-segment sent with offload");
+
+  NS_LOG_DEBUG ("Without offload: " << plainPackets << " packets, done at " << plainTime.As (Time::S)
+                << "; with offload: " << offloadPackets << " packets, done at " << offloadTime.As (Time::S));
+  NS_TEST_EXPECT_MSG_LT (offloadPackets * 10, plainPackets,
+                         "Offload should hand much fewer packets to the device");
+  NS_TEST_EXPECT_MSG_EQ_TOL (offloadTime.GetSeconds (), plainTime.GetSeconds (),
+                             plainTime.GetSeconds () * 0.1,
+                             "Offload should transfer the data in about the same time");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the segmentation offload of TCP
+ */
+class TcpSegmentOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentOffloadTestSuite ()
+    : TestSuite ("tcp-segment-offload", UNIT)
+  {
+    AddTestCase (new TcpSegmentOffloadTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcpSegmentOffloadTestCase (true), TestCase::QUICK);
+  }
+};
+
+static TcpSegmentOffloadTestSuite g_tcpSegmentOffloadTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard of a large window, across the sequence wrap */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -342,6 +346,91 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  const uint32_t segSize = 1000;
+  const uint32_t segments = 1000;
+  // The window wraps around the sequence space at the 400th segment
+  const uint32_t head = 0xffffffff - 400 * segSize + 1;
+  TcpTxBuffer txBuf;
+  txBuf.SetHeadSequence (SequenceNumber32 (head));
+  txBuf.SetSegmentSize (segSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segments * segSize);
+  txBuf.Add (Create<Packet> (segments * segSize));
+
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segSize, SequenceNumber32 (head + i * segSize));
+    }
+
+  // SACK the odd segments, a few blocks at a time
+  TcpOptionSack::SackList list;
+  for (uint32_t i = 1; i < segments; i += 2)
+    {
+      list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (head + i * segSize),
+                                                SequenceNumber32 (head + (i + 1) * segSize)));
+      if (list.size () == 4 || i + 2 >= segments)
+        {
+          NS_TEST_ASSERT_MSG_EQ (txBuf.Update (list), true, "SACK not applied");
+          list.clear ();
+        }
+    }
+
+  // The even segments below the third highest SACKed one are lost
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 500 * segSize, "Wrong sacked count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 498 * segSize, "Wrong lost count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 2 * segSize, "Wrong bytes in flight");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (SequenceNumber32 (head + i * segSize)),
+                             (i % 2 == 0 && i < 995), "Wrong loss of segment " << i);
+    }
+
+  // Retransmit the lost segments, in the order given by NextSeg
+  SequenceNumber32 next;
+  for (uint32_t i = 0; i < 995; i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&next, true), true, "No next segment");
+      NS_TEST_ASSERT_MSG_EQ (next, SequenceNumber32 (head + i * segSize),
+                             "Wrong next segment");
+      txBuf.CopyFromSequence (segSize, next);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 498 * segSize, "Wrong retransmitted count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 500 * segSize, "Wrong bytes in flight");
+
+  // Nothing lost is left: rule 3 returns the first segment neither SACKed
+  // nor retransmitted
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&next, true), true, "No next segment");
+  NS_TEST_ASSERT_MSG_EQ (next, SequenceNumber32 (head + 996 * segSize), "Wrong next segment");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&next, false), false, "Unexpected next segment");
+
+  // A block spanning SACKed and not SACKed segments
+  list.push_back (TcpOptionSack::SackBlock (SequenceNumber32 (head + 996 * segSize),
+                                            SequenceNumber32 (head + segments * segSize)));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Update (list), true, "SACK not applied");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 502 * segSize, "Wrong sacked count");
+
+  // Cumulative ACK of the half of the window, across the wrap
+  txBuf.DiscardUpTo (SequenceNumber32 (head + 500 * segSize));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 252 * segSize, "Wrong sacked count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 248 * segSize, "Wrong lost count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 248 * segSize, "Wrong retransmitted count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 248 * segSize, "Wrong bytes in flight");
+
+  // After an RTO, every segment not SACKed is lost and none is retransmitted
+  txBuf.SetSentListLost ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 248 * segSize, "Wrong lost count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 0, "Wrong retransmitted count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&next, false), true, "No next segment");
+  NS_TEST_ASSERT_MSG_EQ (next, SequenceNumber32 (head + 500 * segSize), "Wrong next segment");
+
+  txBuf.DiscardUpTo (SequenceNumber32 (head + segments * segSize));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Size is different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0, "Wrong bytes in flight");
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-index.h"
+#include "constant-position-mobility-model.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialIndex");
+
+SpatialIndex::SpatialIndex ()
+  : m_cellSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SpatialIndex::~SpatialIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+uint32_t
+SpatialIndex::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  uint32_t id = m_entries.size ();
+  Entry entry;
+  entry.mobility = mobility;
+  entry.inGrid = false;
+  m_entries.push_back (entry);
+  if (mobility != 0)
+    {
+      std::vector<uint32_t> &ids = m_mobilityEntries[PeekPointer (mobility)];
+      if (ids.empty ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&SpatialIndex::CourseChanged, this));
+        }
+      ids.push_back (id);
+    }
+  Insert (id);
+  return id;
+}
+
+void
+SpatialIndex::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<const MobilityModel *, std::vector<uint32_t> >::iterator it = m_mobilityEntries.begin ();
+       it != m_mobilityEntries.end (); ++it)
+    {
+      m_entries[it->second.front ()].mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                                              MakeCallback (&SpatialIndex::CourseChanged, this));
+    }
+  m_entries.clear ();
+  m_mobilityEntries.clear ();
+  m_cells.clear ();
+  m_others.clear ();
+}
+
+uint32_t
+SpatialIndex::GetN (void) const
+{
+  return m_entries.size ();
+}
+
+void
+SpatialIndex::GetNeighbors (const Vector &position, double range, std::vector<uint32_t> &ids)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  NS_ASSERT (range >= 0);
+  ids.clear ();
+
+  // keep the cells about as large as the range, so that a few cells are visited
+  if (range > 0 && (m_cellSize == 0 || range > 4 * m_cellSize || range < m_cellSize / 4))
+    {
+      SetCellSize (range);
+    }
+
+  if (m_cellSize > 0 && !m_cells.empty ())
+    {
+      int64_t xMin = GetCellIndex (position.x - range);
+      int64_t xMax = GetCellIndex (position.x + range);
+      int64_t yMin = GetCellIndex (position.y - range);
+      int64_t yMax = GetCellIndex (position.y + range);
+      if (static_cast<double> (xMax - xMin + 1) * (yMax - yMin + 1) > m_cells.size ())
+        {
+          for (std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator it = m_cells.begin ();
+               it != m_cells.end (); ++it)
+            {
+              AddNeighbors (it->second, position, range, ids);
+            }
+        }
+      else
+        {
+          for (int64_t x = xMin; x <= xMax; ++x)
+            {
+              for (int64_t y = yMin; y <= yMax; ++y)
+                {
+                  std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator it = m_cells.find (GetCellKey (x, y));
+                  if (it != m_cells.end ())
+                    {
+                      AddNeighbors (it->second, position, range, ids);
+                    }
+                }
+            }
+        }
+    }
+
+  for (std::vector<uint32_t>::const_iterator it = m_others.begin (); it != m_others.end (); ++it)
+    {
+      const Entry &entry = m_entries[*it];
+      if (entry.mobility == 0)
+        {
+          ids.push_back (*it);
+          continue;
+        }
+      Vector other = entry.mobility->GetPosition ();
+      double dx = other.x - position.x;
+      double dy = other.y - position.y;
+      if (dx * dx + dy * dy <= range * range)
+        {
+          ids.push_back (*it);
+        }
+    }
+
+  std::sort (ids.begin (), ids.end ());
+  NS_LOG_LOGIC (ids.size () << " of " << m_entries.size () << " entries within " << range << "m");
+}
+
+void
+SpatialIndex::AddNeighbors (const std::vector<uint32_t> &cell, const Vector &position,
+                            double range, std::vector<uint32_t> &ids) const
+{
+  for (std::vector<uint32_t>::const_iterator it = cell.begin (); it != cell.end (); ++it)
+    {
+      const Vector &other = m_entries[*it].position;
+      double dx = other.x - position.x;
+      double dy = other.y - position.y;
+      if (dx * dx + dy * dy <= range * range)
+        {
+          ids.push_back (*it);
+        }
+    }
+}
+
+void
+SpatialIndex::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator it = m_mobilityEntries.find (PeekPointer (mobility));
+  NS_ASSERT (it != m_mobilityEntries.end ());
+  for (std::vector<uint32_t>::const_iterator id = it->second.begin (); id != it->second.end (); ++id)
+    {
+      Remove (*id);
+      Insert (*id);
+    }
+}
+
+void
+SpatialIndex::Insert (uint32_t id)
+{
+  Entry &entry = m_entries[id];
+  // only the models which can not move without a course change are kept in the grid
+  if (m_cellSize > 0 && DynamicCast<ConstantPositionMobilityModel> (entry.mobility) != 0)
+    {
+      entry.position = entry.mobility->GetPosition ();
+      entry.inGrid = true;
+      m_cells[GetCellKey (GetCellIndex (entry.position.x), GetCellIndex (entry.position.y))].push_back (id);
+    }
+  else
+    {
+      entry.inGrid = false;
+      m_others.push_back (id);
+    }
+}
+
+void
+SpatialIndex::Remove (uint32_t id)
+{
+  Entry &entry = m_entries[id];
+  std::vector<uint32_t> *ids = &m_others;
+  std::unordered_map<uint64_t, std::vector<uint32_t> >::iterator cell = m_cells.end ();
+  if (entry.inGrid)
+    {
+      cell = m_cells.find (GetCellKey (GetCellIndex (entry.position.x), GetCellIndex (entry.position.y)));
+      NS_ASSERT (cell != m_cells.end ());
+      ids = &cell->second;
+    }
+  std::vector<uint32_t>::iterator it = std::find (ids->begin (), ids->end (), id);
+  NS_ASSERT (it != ids->end ());
+  *it = ids->back ();
+  ids->pop_back ();
+  if (cell != m_cells.end () && ids->empty ())
+    {
+      m_cells.erase (cell);
+    }
+}
+
+void
+SpatialIndex::SetCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  m_cellSize = cellSize;
+  m_cells.clear ();
+  m_others.clear ();
+  for (uint32_t id = 0; id < m_entries.size (); ++id)
+    {
+      Insert (id);
+    }
+}
+
+int64_t
+SpatialIndex::GetCellIndex (double coordinate) const
+{
+  return static_cast<int64_t> (std::floor (coordinate / m_cellSize));
+}
+
+uint64_t
+SpatialIndex::GetCellKey (int64_t x, int64_t y)
+{
+  return (static_cast<uint64_t> (x) << 32) ^ static_cast<uint32_t> (y);
+}
+
+} // namespace ns3
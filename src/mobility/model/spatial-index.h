@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "ns3/ptr.h"
+#include "ns3/vector.h"
+#include "mobility-model.h"
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ *
+ * \brief Spatial index of a set of mobility models.
+ *
+ * The channels use it to find the receivers which may be within the
+ * range of a transmitter, without looking at the others.  The entries
+ * are identified by the order in which they are added.
+ *
+ * The entries with a ConstantPositionMobilityModel are kept in the cells
+ * of a square grid in the plane (x, y), and moved between the cells when
+ * the CourseChange trace source of their model is fired.  The other
+ * entries may move without notification (e.g., between two course changes
+ * of a ConstantVelocityMobilityModel): they are checked one by one, at
+ * their current position.  The entries without mobility model are always
+ * returned.
+ */
+class SpatialIndex
+{
+public:
+  SpatialIndex ();
+  ~SpatialIndex ();
+
+  /**
+   * Add an entry
+   * \param mobility the mobility model of the entry, possibly null
+   * \return the identifier of the entry
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * Remove all the entries
+   */
+  void Clear (void);
+  /**
+   * \return the number of entries
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Get the entries which may be within a distance of a position.
+   *
+   * All the entries within the distance are returned; the others are
+   * returned only if they have no mobility model.  The distance is
+   * measured in the plane (x, y), so that it does not exceed the
+   * distance in space.
+   *
+   * \param position the position
+   * \param range the distance (in meters)
+   * \param ids the identifiers of the entries, in increasing order
+   */
+  void GetNeighbors (const Vector &position, double range, std::vector<uint32_t> &ids);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  SpatialIndex (const SpatialIndex &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  SpatialIndex &operator = (const SpatialIndex &);
+
+  /// An entry of the index
+  struct Entry
+  {
+    Ptr<MobilityModel> mobility; //!< the mobility model, possibly null
+    Vector position;             //!< the position, for the entries in the grid
+    bool inGrid;                 //!< whether the entry is in the grid
+  };
+
+  /**
+   * Move the entries of a mobility model to their new position
+   * \param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /**
+   * Insert an entry in the grid or in the list of the entries checked one by one
+   * \param id the identifier of the entry
+   */
+  void Insert (uint32_t id);
+  /**
+   * Remove an entry from the grid or from the list of the entries checked one by one
+   * \param id the identifier of the entry
+   */
+  void Remove (uint32_t id);
+  /**
+   * Change the size of the cells of the grid, and move the entries accordingly
+   * \param cellSize the size of the cells (in meters)
+   */
+  void SetCellSize (double cellSize);
+  /**
+   * \param coordinate a coordinate (in meters)
+   * \return the index of the cell containing the coordinate
+   */
+  int64_t GetCellIndex (double coordinate) const;
+  /**
+   * \param x the index of the cell along the x axis
+   * \param y the index of the cell along the y axis
+   * \return the key of the cell
+   */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+  /**
+   * Add the entries of a cell which are within a distance of a position
+   * \param cell the identifiers of the entries of the cell
+   * \param position the position
+   * \param range the distance (in meters)
+   * \param ids the identifiers of the entries found
+   */
+  void AddNeighbors (const std::vector<uint32_t> &cell, const Vector &position,
+                     double range, std::vector<uint32_t> &ids) const;
+
+  std::vector<Entry> m_entries; //!< the entries, by identifier
+  /// the entries of each mobility model
+  std::map<const MobilityModel *, std::vector<uint32_t> > m_mobilityEntries;
+  /// the entries in the grid, by cell
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;
+  std::vector<uint32_t> m_others; //!< the entries checked one by one
+  double m_cellSize;            //!< the size of the cells (in meters), or 0 if not set yet
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_INDEX_H */
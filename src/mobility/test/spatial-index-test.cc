@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/spatial-index.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Spatial index test: the neighbors found in the grid are the
+ * entries found by a scan of all the entries, whatever the range, and they
+ * follow the course changes of the models.
+ */
+class SpatialIndexGridTestCase : public TestCase
+{
+public:
+  SpatialIndexGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the neighbors of a position against a scan of all the models
+   * \param position the position
+   * \param range the range
+   */
+  void CheckNeighbors (const Vector &position, double range);
+
+  SpatialIndex m_index; //!< the index
+  std::vector<Ptr<MobilityModel> > m_models; //!< the models, by identifier in the index
+};
+
+SpatialIndexGridTestCase::SpatialIndexGridTestCase ()
+  : TestCase ("Spatial index of static nodes")
+{
+}
+
+void
+SpatialIndexGridTestCase::CheckNeighbors (const Vector &position, double range)
+{
+  std::vector<uint32_t> ids;
+  m_index.GetNeighbors (position, range, ids);
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < m_models.size (); ++i)
+    {
+      Vector other = m_models[i]->GetPosition ();
+      double dx = other.x - position.x;
+      double dy = other.y - position.y;
+      if (dx * dx + dy * dy <= range * range)
+        {
+          expected.push_back (i);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (ids.size (), expected.size (), "Wrong number of neighbors within " << range << "m");
+  for (uint32_t i = 0; i < ids.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ids[i], expected[i], "Wrong neighbor");
+    }
+}
+
+void
+SpatialIndexGridTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  for (uint32_t i = 0; i < 500; ++i)
+    {
+      Ptr<MobilityModel> model = CreateObject<ConstantPositionMobilityModel> ();
+      model->SetPosition (Vector (random->GetValue (-1000, 1000), random->GetValue (-1000, 1000),
+                                  random->GetValue (0, 10)));
+      NS_TEST_ASSERT_MSG_EQ (m_index.Add (model), i, "Wrong identifier");
+      m_models.push_back (model);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_index.GetN (), 500, "Wrong number of entries");
+
+  // the cells follow the first range, then are resized for much larger or
+  // smaller ranges
+  double ranges[] = {100, 150, 30, 1, 800, 5000, 0};
+  for (uint32_t r = 0; r < sizeof (ranges) / sizeof (ranges[0]); ++r)
+    {
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          CheckNeighbors (Vector (random->GetValue (-1200, 1200), random->GetValue (-1200, 1200), 0),
+                          ranges[r]);
+        }
+      CheckNeighbors (m_models[r]->GetPosition (), ranges[r]);
+    }
+
+  // moved nodes are found at their new position only
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      m_models[i]->SetPosition (Vector (random->GetValue (-50, 50), random->GetValue (-50, 50), 0));
+    }
+  CheckNeighbors (Vector (0, 0, 0), 60);
+  CheckNeighbors (Vector (500, 500, 0), 200);
+
+  // the entries without mobility model are always returned
+  m_index.Add (0);
+  std::vector<uint32_t> ids;
+  m_index.GetNeighbors (Vector (1e6, 1e6, 0), 10, ids);
+  NS_TEST_ASSERT_MSG_EQ (ids.size (), 1, "The entry without mobility model should be returned");
+  NS_TEST_ASSERT_MSG_EQ (ids[0], 500, "Wrong entry returned");
+
+  m_index.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (m_index.GetN (), 0, "The index should be empty");
+  m_models[0]->SetPosition (Vector (0, 0, 0));
+  m_index.GetNeighbors (Vector (0, 0, 0), 10, ids);
+  NS_TEST_ASSERT_MSG_EQ (ids.size (), 0, "The index should be empty");
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Spatial index test: the nodes which move without course change
+ * are found at their current position.
+ */
+class SpatialIndexMovingTestCase : public TestCase
+{
+public:
+  SpatialIndexMovingTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check that the moving node is found within a range of the origin
+   * \param expected whether it should be found
+   */
+  void Check (bool expected);
+
+  SpatialIndex m_index; //!< the index
+};
+
+SpatialIndexMovingTestCase::SpatialIndexMovingTestCase ()
+  : TestCase ("Spatial index of moving nodes")
+{
+}
+
+void
+SpatialIndexMovingTestCase::Check (bool expected)
+{
+  std::vector<uint32_t> ids;
+  m_index.GetNeighbors (Vector (0, 0, 0), 100, ids);
+  NS_TEST_EXPECT_MSG_EQ ((std::find (ids.begin (), ids.end (), 1) != ids.end ()), expected,
+                         "Wrong neighbors at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_EQ ((std::find (ids.begin (), ids.end (), 0) != ids.end ()), true,
+                         "The static node should be found");
+}
+
+void
+SpatialIndexMovingTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> fixed = CreateObject<ConstantPositionMobilityModel> ();
+  fixed->SetPosition (Vector (10, 0, 0));
+  m_index.Add (fixed);
+
+  // moves from x = 1000 m towards the origin, at 10 m/s, without course change
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (1000, 0, 0));
+  moving->SetVelocity (Vector (-10, 0, 0));
+  m_index.Add (moving);
+
+  Simulator::Schedule (Seconds (1), &SpatialIndexMovingTestCase::Check, this, false);
+  Simulator::Schedule (Seconds (95), &SpatialIndexMovingTestCase::Check, this, true);
+  Simulator::Schedule (Seconds (200), &ConstantVelocityMobilityModel::SetVelocity, moving, Vector (0, 0, 0));
+  Simulator::Schedule (Seconds (201), &SpatialIndexMovingTestCase::Check, this, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Spatial index test suite
+ */
+static class SpatialIndexTestSuite : public TestSuite
+{
+public:
+  SpatialIndexTestSuite () : TestSuite ("spatial-index", UNIT)
+  {
+    AddTestCase (new SpatialIndexGridTestCase (), TestCase::QUICK);
+    AddTestCase (new SpatialIndexMovingTestCase (), TestCase::QUICK);
+  }
+} g_spatialIndexTestSuite; ///< the test suite
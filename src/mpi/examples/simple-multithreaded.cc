@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * The dumbbell of simple-distributed, run by two threads of a single
+ * process instead of two MPI tasks.
+ *
+ *                 ---------   ---------
+ *                 THREAD 0    THREAD 1
+ *                 --------- | ---------
+ *                           |
+ * n0 ---------|             |             |---------- n6
+ *             |             |             |
+ * n1 -------\ |             |             | /------- n7
+ *            n4 ------------|------------ n5
+ * n2 -------/ |             |             | \------- n8
+ *             |             |             |
+ * n3 ---------|             |             |---------- n9
+ *
+ *
+ * OnOff clients are placed on each left leaf node. Each right leaf node
+ * is a packet sink for a left leaf node.  The link between n4 and n5
+ * is a remote point-to-point link: the packets crossing it are handed
+ * over to the other thread, and its delay is the lookahead.
+ *
+ * No MPI library is needed.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SimpleMultithreaded");
+
+int
+main (int argc, char *argv[])
+{
+  bool verbose = false;
+  uint32_t nLeaf = 4;
+  double stopTime = 5;
+
+  CommandLine cmd;
+  cmd.AddValue ("verbose", "Log the packets received by the sinks", verbose);
+  cmd.AddValue ("nLeaf", "Number of leaf nodes on each side", nLeaf);
+  cmd.AddValue ("stopTime", "Simulation stop time, in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  // Two partitions, each run by its own thread.  This must be set
+  // before the first node is created, which creates the simulator.
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (2));
+
+  // Needed to create remote links between the partitions.
+  MpiInterface::Enable (&argc, &argv);
+
+  if (verbose)
+    {
+      LogComponentEnable ("PacketSink", LOG_LEVEL_INFO);
+    }
+
+  Config::SetDefault ("ns3::OnOffApplication::PacketSize", UintegerValue (512));
+  Config::SetDefault ("ns3::OnOffApplication::DataRate", StringValue ("1Mbps"));
+
+  // Create leaf nodes on left with system id 0
+  NodeContainer leftLeafNodes;
+  leftLeafNodes.Create (nLeaf, 0);
+
+  // Left router with system id 0, right router with system id 1
+  NodeContainer routerNodes;
+  routerNodes.Add (CreateObject<Node> (0));
+  routerNodes.Add (CreateObject<Node> (1));
+
+  // Create leaf nodes on right with system id 1
+  NodeContainer rightLeafNodes;
+  rightLeafNodes.Create (nLeaf, 1);
+
+  PointToPointHelper routerLink;
+  routerLink.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  routerLink.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  PointToPointHelper leafLink;
+  leafLink.SetDeviceAttribute ("DataRate", StringValue ("1Mbps"));
+  leafLink.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  NetDeviceContainer routerDevices = routerLink.Install (routerNodes);
+
+  NetDeviceContainer leftRouterDevices;
+  NetDeviceContainer leftLeafDevices;
+  NetDeviceContainer rightRouterDevices;
+  NetDeviceContainer rightLeafDevices;
+  for (uint32_t i = 0; i < nLeaf; ++i)
+    {
+      NetDeviceContainer left = leafLink.Install (leftLeafNodes.Get (i), routerNodes.Get (0));
+      leftLeafDevices.Add (left.Get (0));
+      leftRouterDevices.Add (left.Get (1));
+      NetDeviceContainer right = leafLink.Install (rightLeafNodes.Get (i), routerNodes.Get (1));
+      rightLeafDevices.Add (right.Get (0));
+      rightRouterDevices.Add (right.Get (1));
+    }
+
+  InternetStackHelper stack;
+  stack.InstallAll ();
+
+  Ipv4AddressHelper leftAddress;
+  leftAddress.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4AddressHelper routerAddress;
+  routerAddress.SetBase ("10.2.1.0", "255.255.255.0");
+  Ipv4AddressHelper rightAddress;
+  rightAddress.SetBase ("10.3.1.0", "255.255.255.0");
+
+  routerAddress.Assign (routerDevices);
+  Ipv4InterfaceContainer rightLeafInterfaces;
+  for (uint32_t i = 0; i < nLeaf; ++i)
+    {
+      NetDeviceContainer ndc;
+      ndc.Add (leftLeafDevices.Get (i));
+      ndc.Add (leftRouterDevices.Get (i));
+      leftAddress.Assign (ndc);
+      leftAddress.NewNetwork ();
+
+      ndc = NetDeviceContainer ();
+      ndc.Add (rightLeafDevices.Get (i));
+      ndc.Add (rightRouterDevices.Get (i));
+      Ipv4InterfaceContainer ifc = rightAddress.Assign (ndc);
+      rightLeafInterfaces.Add (ifc.Get (0));
+      rightAddress.NewNetwork ();
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Unlike the distributed version, each process holds the whole
+  // topology: install all the applications.
+  uint16_t port = 50000;
+  Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", sinkLocalAddress);
+  ApplicationContainer sinkApps = sinkHelper.Install (rightLeafNodes);
+  sinkApps.Start (Seconds (1.0));
+  sinkApps.Stop (Seconds (stopTime));
+
+  OnOffHelper clientHelper ("ns3::UdpSocketFactory", Address ());
+  clientHelper.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+  clientHelper.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  ApplicationContainer clientApps;
+  for (uint32_t i = 0; i < nLeaf; ++i)
+    {
+      clientHelper.SetAttribute ("Remote", AddressValue (InetSocketAddress (rightLeafInterfaces.GetAddress (i), port)));
+      clientApps.Add (clientHelper.Install (leftLeafNodes.Get (i)));
+    }
+  clientApps.Start (Seconds (1.0));
+  clientApps.Stop (Seconds (stopTime));
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  uint64_t totalRx = 0;
+  for (uint32_t i = 0; i < sinkApps.GetN (); ++i)
+    {
+      totalRx += DynamicCast<PacketSink> (sinkApps.Get (i))->GetTotalRx ();
+    }
+  std::cout << "Received " << totalRx << " bytes in " << Simulator::GetEventCount ()
+            << " events" << std::endl;
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+}
@@ -31,6 +31,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <chrono>
 #include <cmath>
 
 #ifdef NS3_MPI
@@ -376,6 +377,7 @@ DistributedSimulatorImpl::Run (void)
   CalculateLookAhead ();
   m_stop = false;
   m_globalFinished = false;
+  std::chrono::steady_clock::time_point windowStart = std::chrono::steady_clock::now ();
   while (!m_globalFinished)
     {
       Time nextTime = Next ();
@@ -388,6 +390,9 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
+          std::chrono::steady_clock::time_point syncStart = std::chrono::steady_clock::now ();
+          // Release the packets sent through shared memory in this window
+          GrantedTimeWindowMpiInterface::FlushSends ();
           // First receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
@@ -433,6 +438,13 @@ DistributedSimulatorImpl::Run (void)
                   m_grantedTime = smallestTime + m_lookAhead;
                 }
             }
+
+          std::chrono::steady_clock::time_point syncEnd = std::chrono::steady_clock::now ();
+          GrantedTimeWindowMpiInterface::EndWindow
+            (m_grantedTime,
+             std::chrono::duration_cast<std::chrono::nanoseconds> (syncStart - windowStart).count (),
+             std::chrono::duration_cast<std::chrono::nanoseconds> (syncEnd - syncStart).count ());
+          windowStart = syncEnd;
         }
 
       // Execute next event if it is within the current time window.
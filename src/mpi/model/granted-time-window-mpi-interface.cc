@@ -23,10 +23,13 @@
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <sstream>
+#include <unistd.h>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
 #include "mpi-interface.h"
+#include "shared-memory-ring.h"
 
 #include "ns3/node.h"
 #include "ns3/node-list.h"
@@ -34,7 +37,11 @@
 #include "ns3/simulator.h"
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -44,6 +51,26 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
+/**
+ * \ingroup mpi
+ * Whether to use shared memory rings between the tasks on the same host.
+ */
+static GlobalValue g_sharedMemory = GlobalValue ("MpiSharedMemory",
+                                                 "Exchange the packets between the MPI tasks running on the same "
+                                                 "host through shared memory instead of MPI messages",
+                                                 BooleanValue (false),
+                                                 MakeBooleanChecker ());
+
+/**
+ * \ingroup mpi
+ * The file to write the per-window statistics to.
+ */
+static GlobalValue g_windowStatisticsFile = GlobalValue ("MpiWindowStatisticsFile",
+                                                         "If not empty, each MPI task writes the traffic and the time "
+                                                         "of each granted time window to this file, suffixed by its rank",
+                                                         StringValue (""),
+                                                         MakeStringChecker ());
+
 SentBuffer::SentBuffer ()
 {
   m_buffer = 0;
@@ -82,6 +109,11 @@ bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
+std::vector<SharedMemoryRing *> GrantedTimeWindowMpiInterface::m_txRings;
+std::vector<SharedMemoryRing *> GrantedTimeWindowMpiInterface::m_rxRings;
+GrantedTimeWindowMpiInterface::WindowStatistics GrantedTimeWindowMpiInterface::m_window;
+uint32_t              GrantedTimeWindowMpiInterface::m_windowCount = 0;
+std::ofstream         GrantedTimeWindowMpiInterface::m_windowStatistics;
 
 #ifdef NS3_MPI
 MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
@@ -112,6 +144,18 @@ GrantedTimeWindowMpiInterface::Destroy ()
   delete [] m_requests;
 
   m_pendingTx.clear ();
+
+  for (uint32_t i = 0; i < m_txRings.size (); ++i)
+    {
+      delete m_txRings[i];
+      delete m_rxRings[i];
+    }
+  m_txRings.clear ();
+  m_rxRings.clear ();
+  if (m_windowStatistics.is_open ())
+    {
+      m_windowStatistics.close ();
+    }
 #endif
 }
 
@@ -182,6 +226,28 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
       MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
                  MPI_COMM_WORLD, &m_requests[i]);
     }
+
+  BooleanValue sharedMemory;
+  g_sharedMemory.GetValue (sharedMemory);
+  if (sharedMemory.Get ())
+    {
+      SetupSharedMemory ();
+    }
+
+  m_window = WindowStatistics ();
+  m_windowCount = 0;
+  StringValue windowStatisticsFile;
+  g_windowStatisticsFile.GetValue (windowStatisticsFile);
+  if (!windowStatisticsFile.Get ().empty ())
+    {
+      std::ostringstream name;
+      name << windowStatisticsFile.Get () << "-" << m_sid;
+      m_windowStatistics.open (name.str ().c_str ());
+      NS_ABORT_MSG_UNLESS (m_windowStatistics.is_open (), "cannot open " << name.str ());
+      m_windowStatistics << "# window granted-time(ns) compute(ns) sync(ns)"
+                         << " mpi-tx-msgs mpi-tx-bytes shm-tx-msgs shm-tx-bytes"
+                         << " rx-msgs rx-bytes" << std::endl;
+    }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -193,13 +259,31 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
+
+  // Find the system id for the destination node
+  Ptr<Node> destNode = NodeList::GetNode (node);
+  uint32_t nodeSysId = destNode->GetSystemId ();
+
+  // Write to the shared memory ring of the destination task, if any
+  // and if it has room, else to a new MPI message.
+  uint8_t* buffer = 0;
+  bool shared = false;
+  if (nodeSysId < m_txRings.size () && m_txRings[nodeSysId] != 0)
+    {
+      buffer = m_txRings[nodeSysId]->Reserve (serializedSize + 16);
+      shared = (buffer != 0);
+    }
+  std::list<SentBuffer>::reverse_iterator i;
+  if (!shared)
+    {
+      SentBuffer sendBuf;
+      m_pendingTx.push_back (sendBuf);
+      i = m_pendingTx.rbegin (); // Points to the last element
+      buffer = new uint8_t[serializedSize + 16];
+      i->SetBuffer (buffer);
+    }
+
   // Add the time, dest node and dest device
   uint64_t t = rxTime.GetInteger ();
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
@@ -210,12 +294,19 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   // Serialize the packet
   p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
 
-  // Find the system id for the destination node
-  Ptr<Node> destNode = NodeList::GetNode (node);
-  uint32_t nodeSysId = destNode->GetSystemId ();
-
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
+  if (shared)
+    {
+      // Made visible to the receiver by FlushSends at the end of the window
+      m_window.shmTxMessages++;
+      m_window.shmTxBytes += serializedSize + 16;
+    }
+  else
+    {
+      MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
+                 0, MPI_COMM_WORLD, (i->GetRequest ()));
+      m_window.mpiTxMessages++;
+      m_window.mpiTxBytes += serializedSize + 16;
+    }
   m_txCount++;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -242,48 +333,187 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
         }
       int count;
       MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
+      DeliverMessage (reinterpret_cast<uint8_t *> (m_pRxBuffers[index]), count);
 
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
+      // Re-queue the next read
+      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+                 MPI_COMM_WORLD, &m_requests[index]);
+    }
 
-      Time rxTime (time);
+  // Read the batches published by the tasks on this host
+  for (std::vector<SharedMemoryRing *>::iterator ring = m_rxRings.begin (); ring != m_rxRings.end (); ++ring)
+    {
+      if (*ring == 0)
+        {
+          continue;
+        }
+      uint32_t count;
+      const uint8_t* data;
+      while ((data = (*ring)->Read (count)) != 0)
+        {
+          DeliverMessage (data, count);
+        }
+      (*ring)->Release ();
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
 
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
+void
+GrantedTimeWindowMpiInterface::FlushSends ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+  for (std::vector<SharedMemoryRing *>::iterator ring = m_txRings.begin (); ring != m_txRings.end (); ++ring)
+    {
+      if (*ring != 0)
+        {
+          (*ring)->Publish ();
+        }
+    }
+}
+
+void
+GrantedTimeWindowMpiInterface::EndWindow (const Time &grantedTime, uint64_t computeNs, uint64_t syncNs)
+{
+  if (m_windowStatistics.is_open ())
+    {
+      m_windowStatistics << m_windowCount << " " << grantedTime.GetTimeStep ()
+                         << " " << computeNs << " " << syncNs
+                         << " " << m_window.mpiTxMessages << " " << m_window.mpiTxBytes
+                         << " " << m_window.shmTxMessages << " " << m_window.shmTxBytes
+                         << " " << m_window.rxMessages << " " << m_window.rxBytes << "\n";
+    }
+  m_windowCount++;
+  m_window = WindowStatistics ();
+}
+
+void
+GrantedTimeWindowMpiInterface::SetupSharedMemory ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+#if defined (NS3_MPI) && MPI_VERSION >= 3
+  // The tasks on this host
+  MPI_Comm local;
+  MPI_Comm_split_type (MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, m_sid, MPI_INFO_NULL, &local);
+  int localSize;
+  MPI_Comm_size (local, &localSize);
+  std::vector<int> peers (localSize);
+  int sid = m_sid;
+  MPI_Allgather (&sid, 1, MPI_INT, &peers[0], 1, MPI_INT, local);
+
+  // Make the segment names unique to this run
+  int run = getpid ();
+  MPI_Bcast (&run, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  m_txRings.assign (m_size, 0);
+  m_rxRings.assign (m_size, 0);
+  for (int i = 0; i < localSize; ++i)
+    {
+      if (static_cast<uint32_t> (peers[i]) == m_sid)
+        {
+          continue;
+        }
+      std::ostringstream name;
+      name << "/ns3-mpi-" << run << "-" << m_sid << "-" << peers[i];
+      SharedMemoryRing* ring = new SharedMemoryRing ();
+      if (ring->Create (name.str (), SHARED_MEMORY_RING_SIZE))
+        {
+          m_txRings[peers[i]] = ring;
+        }
+      else
+        {
+          delete ring;
+        }
+    }
+  MPI_Barrier (local);
+
+  std::vector<int> opened (localSize, 0);
+  for (int i = 0; i < localSize; ++i)
+    {
+      if (static_cast<uint32_t> (peers[i]) == m_sid)
+        {
+          continue;
+        }
+      std::ostringstream name;
+      name << "/ns3-mpi-" << run << "-" << peers[i] << "-" << m_sid;
+      SharedMemoryRing* ring = new SharedMemoryRing ();
+      if (ring->Open (name.str ()))
+        {
+          m_rxRings[peers[i]] = ring;
+          opened[i] = 1;
+        }
+      else
+        {
+          delete ring;
+        }
+    }
 
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+  // Only keep the rings which the receiver could map; the others
+  // fall back to MPI messages.
+  std::vector<int> accepted (localSize, 0);
+  MPI_Alltoall (&opened[0], 1, MPI_INT, &accepted[0], 1, MPI_INT, local);
+  for (int i = 0; i < localSize; ++i)
+    {
+      SharedMemoryRing* ring = m_txRings[peers[i]];
+      if (ring != 0)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          ring->Unlink ();
+          if (!accepted[i])
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              delete ring;
+              m_txRings[peers[i]] = 0;
             }
         }
+    }
+  MPI_Comm_free (&local);
+  NS_LOG_INFO ("task " << m_sid << " shares memory with " << localSize - 1 << " tasks");
+#else
+  NS_LOG_WARN ("MpiSharedMemory needs MPI 3; using MPI messages only");
+#endif
+}
 
-      NS_ASSERT (pNode && pMpiRec);
+void
+GrantedTimeWindowMpiInterface::DeliverMessage (const uint8_t* data, uint32_t count)
+{
+  m_rxCount++; // Count this receive
+  m_window.rxMessages++;
+  m_window.rxBytes += count;
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+  // Get the meta data first
+  const uint64_t* pTime = reinterpret_cast<const uint64_t *> (data);
+  uint64_t time = *pTime++;
+  const uint32_t* pData = reinterpret_cast<const uint32_t *> (pTime);
+  uint32_t node = *pData++;
+  uint32_t dev  = *pData++;
 
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+  Time rxTime (time);
+
+  count -= sizeof (time) + sizeof (node) + sizeof (dev);
+
+  Ptr<Packet> p = Create<Packet> (reinterpret_cast<const uint8_t *> (pData), count, true);
+
+  // Find the correct node/device to schedule receive event
+  Ptr<Node> pNode = NodeList::GetNode (node);
+  Ptr<MpiReceiver> pMpiRec = 0;
+  uint32_t nDevices = pNode->GetNDevices ();
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+      if (pThisDev->GetIfIndex () == dev)
+        {
+          pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+          break;
+        }
     }
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+
+  NS_ASSERT (pNode && pMpiRec);
+
+  // Schedule the rx event
+  Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                  &MpiReceiver::Receive, pMpiRec, p);
 }
 
 void
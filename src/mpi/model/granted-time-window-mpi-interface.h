@@ -25,6 +25,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <fstream>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -45,6 +47,12 @@ namespace ns3 {
  */
 const uint32_t MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * size of the shared memory ring from one task
+ * to another task on the same host
+ */
+const uint32_t SHARED_MEMORY_RING_SIZE = 1 << 20;
+
 /**
  * \ingroup mpi
  *
@@ -78,6 +86,7 @@ private:
 };
 
 class Packet;
+class SharedMemoryRing;
 
 /**
  * \ingroup mpi
@@ -87,6 +96,18 @@ class Packet;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * When the global value MpiSharedMemory is set, the packets sent to a
+ * task running on the same host are written directly to a shared
+ * memory ring instead of an MPI message, and the records written
+ * during a granted time window are made visible to the receiver as one
+ * batch by FlushSends().  The MPI messages remain the fallback when a
+ * ring is full.
+ *
+ * When the global value MpiWindowStatisticsFile is set, each task
+ * writes one line per synchronization to that file, suffixed by its
+ * rank: the bytes and messages sent and received during the window,
+ * and the wall-clock time spent running events and synchronizing.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -131,6 +152,11 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Make the packets written to the shared memory rings since the
+   * last call visible to their receivers
+   */
+  static void FlushSends ();
   /**
    * Check for received messages complete
    */
@@ -147,8 +173,41 @@ public:
    * \return transmitted count in packets
    */
   static uint32_t GetTxCount ();
+  /**
+   * \param grantedTime the granted time after the synchronization
+   * \param computeNs wall-clock time spent running events since the
+   *        previous synchronization, in ns
+   * \param syncNs wall-clock time spent in this synchronization, in ns
+   *
+   * Record the statistics of the window ending with this
+   * synchronization, and reset them
+   */
+  static void EndWindow (const Time &grantedTime, uint64_t computeNs, uint64_t syncNs);
 
 private:
+  /**
+   * Map the shared memory rings to and from the other tasks on this host
+   */
+  static void SetupSharedMemory ();
+  /**
+   * \param data the received message
+   * \param count the message size
+   *
+   * Schedule the reception of a received packet
+   */
+  static void DeliverMessage (const uint8_t* data, uint32_t count);
+
+  /** Traffic of the current window. */
+  struct WindowStatistics
+  {
+    uint32_t mpiTxMessages;  //!< Messages sent with MPI.
+    uint64_t mpiTxBytes;     //!< Bytes sent with MPI.
+    uint32_t shmTxMessages;  //!< Messages written to shared memory.
+    uint64_t shmTxBytes;     //!< Bytes written to shared memory.
+    uint32_t rxMessages;     //!< Messages received.
+    uint64_t rxBytes;        //!< Bytes received.
+  };
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -168,6 +227,15 @@ private:
 
   // List of pending non-blocking sends
   static std::list<SentBuffer> m_pendingTx;
+
+  // Shared memory rings to and from each task on this host, or 0
+  static std::vector<SharedMemoryRing *> m_txRings;
+  static std::vector<SharedMemoryRing *> m_rxRings;
+
+  // Per-window statistics
+  static WindowStatistics m_window;
+  static uint32_t m_windowCount;
+  static std::ofstream m_windowStatistics;
 };
 
 } // namespace ns3
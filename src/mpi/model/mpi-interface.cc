@@ -27,6 +27,9 @@
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
+#ifdef NS3_MULTITHREADED
+#include "multithreaded-mpi-interface.h"
+#endif
 
 namespace ns3 {
 
@@ -94,6 +97,13 @@ MpiInterface::Enable (int* pargc, char*** pargv)
           g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface ();
           useDefault = false;
         }
+#ifdef NS3_MULTITHREADED
+      else if (simulationType.compare ("ns3::MultithreadedSimulatorImpl") == 0)
+        {
+          g_parallelCommunicationInterface = new MultithreadedMpiInterface ();
+          useDefault = false;
+        }
+#endif
     }
 
   // User did not specify a valid parallel simulator; use the default.
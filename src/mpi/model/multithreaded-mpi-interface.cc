@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-mpi-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedMpiInterface");
+
+bool                                     MultithreadedMpiInterface::m_enabled = false;
+std::vector<std::vector<MpiReceiver *> > MultithreadedMpiInterface::m_receivers;
+std::vector<uint32_t>                    MultithreadedMpiInterface::m_systemIds;
+
+TypeId
+MultithreadedMpiInterface::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedMpiInterface")
+    .SetParent<Object> ()
+    .SetGroupName ("Mpi")
+  ;
+  return tid;
+}
+
+void
+MultithreadedMpiInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_receivers.clear ();
+  m_systemIds.clear ();
+}
+
+uint32_t
+MultithreadedMpiInterface::GetSystemId ()
+{
+  return Simulator::GetSystemId ();
+}
+
+uint32_t
+MultithreadedMpiInterface::GetSize ()
+{
+  return 1;
+}
+
+bool
+MultithreadedMpiInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+void
+MultithreadedMpiInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+  m_enabled = true;
+}
+
+void
+MultithreadedMpiInterface::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = false;
+  m_receivers.clear ();
+  m_systemIds.clear ();
+}
+
+void
+MultithreadedMpiInterface::CollectReceivers (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_receivers.clear ();
+  m_systemIds.clear ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      m_systemIds.push_back (node->GetSystemId ());
+      std::vector<MpiReceiver *> receivers;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          uint32_t ifIndex = device->GetIfIndex ();
+          if (ifIndex >= receivers.size ())
+            {
+              receivers.resize (ifIndex + 1, 0);
+            }
+          receivers[ifIndex] = PeekPointer (device->GetObject<MpiReceiver> ());
+        }
+      m_receivers.push_back (receivers);
+    }
+}
+
+void
+MultithreadedMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
+  NS_ASSERT_MSG (node < m_receivers.size () && dev < m_receivers[node].size ()
+                 && m_receivers[node][dev] != 0,
+                 "no MpiReceiver on device " << dev << " of node " << node);
+
+  if (m_systemIds[node] != Simulator::GetSystemId ())
+    {
+      // The packet shares its buffers with the sender's copy: hand a
+      // private copy over to the destination thread.
+      static thread_local std::vector<uint8_t> buffer;
+      uint32_t size = p->GetSerializedSize ();
+      buffer.resize (size);
+      p->Serialize (&buffer[0], size);
+      p = Create<Packet> (&buffer[0], size, true);
+    }
+
+  Simulator::ScheduleWithContext (node, rxTime - Simulator::Now (),
+                                  &MpiReceiver::Receive, m_receivers[node][dev], p);
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_MPI_INTERFACE_H
+#define NS3_MULTITHREADED_MPI_INTERFACE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+class MpiReceiver;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Parallel communication interface between the threads of
+ * MultithreadedSimulatorImpl.
+ *
+ * The packets sent over a PointToPointRemoteChannel are handed to the
+ * partition of the destination node as an event of that node, through
+ * the simulator implementation.  No MPI call is made.
+ *
+ * Reference counts are not atomic, so a packet which crosses to
+ * another partition is copied through its serialized form, and only
+ * the copy is seen by the destination thread.
+ */
+class MultithreadedMpiInterface : public ParallelCommunicationInterface, Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * Clear the receiver tables.
+   */
+  virtual void Destroy ();
+  /**
+   * \return The partition of the calling thread.
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return 1: all the partitions are simulated by this process.
+   */
+  virtual uint32_t GetSize ();
+  /**
+   * \return true if enabled
+   */
+  virtual bool IsEnabled ();
+  /**
+   * \param pargc number of command line arguments (unused)
+   * \param pargv command line arguments (unused)
+   *
+   * Enable the interface.
+   */
+  virtual void Enable (int* pargc, char*** pargv);
+  /**
+   * Disable the interface.
+   */
+  virtual void Disable ();
+  /**
+   * \param p packet to send
+   * \param rxTime received time at destination node
+   * \param node destination node
+   * \param dev destination device
+   *
+   * Schedule the reception of a packet by the specified node and net device.
+   */
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Record the MpiReceiver of each device and the partition of each
+   * node, so that the partition threads do not have to look them up.
+   * Called by MultithreadedSimulatorImpl::Run from the main thread.
+   */
+  static void CollectReceivers (void);
+
+private:
+  static bool m_enabled;
+
+  // The receiver of each (node, interface index)
+  static std::vector<std::vector<MpiReceiver *> > m_receivers;
+
+  // The system id of each node
+  static std::vector<uint32_t> m_systemIds;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_MPI_INTERFACE_H */
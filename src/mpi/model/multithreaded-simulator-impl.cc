@@ -0,0 +1,731 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "multithreaded-mpi-interface.h"
+#include "mpi-interface.h"
+
+#include "ns3/simulator.h"
+#include "ns3/system-thread.h"
+#include "ns3/uinteger.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of partitions, each run by its own thread. "
+                   "The nodes are assigned to the partitions by their "
+                   "system id.  0 uses the number of hardware threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_threadCount (0),
+    m_lookAhead (0),
+    m_maxLookAhead (GetMaximumSimulationTime ()),
+    m_uid (4),
+    m_stopTs (std::numeric_limits<uint64_t>::max ()),
+    m_currentTs (0),
+    m_running (false),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      for (std::vector<Messages>::iterator box = p->outbox.begin (); box != p->outbox.end (); ++box)
+        {
+          for (Messages::iterator m = box->begin (); m != box->end (); ++m)
+            {
+              m->event->Unref ();
+            }
+          box->clear ();
+        }
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+  if (MpiInterface::IsEnabled ())
+    {
+      MpiInterface::Destroy ();
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemCount (void) const
+{
+  if (!m_partitions.empty ())
+    {
+      return m_partitions.size ();
+    }
+  if (m_threadCount != 0)
+    {
+      return m_threadCount;
+    }
+  return std::max (std::thread::hardware_concurrency (), 1U);
+}
+
+void
+MultithreadedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  NS_LOG_FUNCTION (this << lookAhead);
+  if (lookAhead > Time (0))
+    {
+      m_maxLookAhead = lookAhead;
+    }
+  else
+    {
+      NS_LOG_ERROR ("attempted to set maximum lookahead to a negative time: " << lookAhead);
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  if (m_partitions.empty ())
+    {
+      uint32_t count = GetSystemCount ();
+      m_partitions.resize (count);
+      for (uint32_t i = 0; i < count; i++)
+        {
+          Partition &p = m_partitions[i];
+          p.id = i;
+          p.events = schedulerFactory.Create<Scheduler> ();
+          p.uid = m_uid;
+          p.currentUid = 0;
+          p.currentTs = 0;
+          p.currentContext = Simulator::NO_CONTEXT;
+          p.eventCount = 0;
+          p.unscheduledEvents = 0;
+          p.stop = false;
+          p.nextTs = 0;
+          p.stopRequested = false;
+          p.packetUid = 0;
+          p.outbox.resize (count);
+        }
+      return;
+    }
+
+  NS_ASSERT_MSG (!m_running, "cannot change the scheduler during Run");
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+      p->events = scheduler;
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionId (uint32_t context) const
+{
+  if (context < m_nodePartition.size ())
+    {
+      return m_nodePartition[context];
+    }
+  if (!m_running && context < NodeList::GetNNodes ())
+    {
+      // Before the first Run: only the main thread is running.
+      uint32_t id = NodeList::GetNode (context)->GetSystemId ();
+      NS_ABORT_MSG_UNLESS (id < m_partitions.size (),
+                           "node " << context << " has system id " << id <<
+                           " but there are only " << m_partitions.size () << " partitions");
+      return id;
+    }
+  return m_current ? m_current->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetOwner (const EventId &id) const
+{
+  if (m_current)
+    {
+      return m_current->id;
+    }
+  return GetPartitionId (id.GetContext ());
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition &p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  NS_ASSERT (ts >= p.currentTs);
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  // Outside of Run, the uids are taken from a single counter.  During
+  // Run, each partition takes every n-th uid, n being the number of
+  // partitions, so that the uids of the partitions are disjoint.
+  if (m_current)
+    {
+      ev.key.m_uid = p.uid;
+      p.uid += m_partitions.size ();
+    }
+  else
+    {
+      ev.key.m_uid = m_uid;
+      m_uid++;
+    }
+  p.unscheduledEvents++;
+  p.events->Insert (ev);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_nodePartition.clear ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      uint32_t id = (*i)->GetSystemId ();
+      NS_ABORT_MSG_UNLESS (id < m_partitions.size (),
+                           "node " << (*i)->GetId () << " has system id " << id <<
+                           " but there are only " << m_partitions.size () << " partitions");
+      m_nodePartition.push_back (id);
+    }
+
+  uint64_t lookAhead = m_maxLookAhead.GetTimeStep ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (!device->IsPointToPoint () || channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<Node> peer = channel->GetDevice (k)->GetNode ();
+              if (peer == 0 || m_nodePartition[peer->GetId ()] == m_nodePartition[node->GetId ()])
+                {
+                  continue;
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              lookAhead = std::min (lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (lookAhead == 0, "a zero-delay point-to-point link connects two partitions");
+  m_lookAhead = lookAhead;
+  NS_LOG_LOGIC ("lookahead " << GetLookAhead ());
+}
+
+void
+MultithreadedSimulatorImpl::MoveEvents (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      std::vector<Scheduler::Event> events;
+      while (!p->events->IsEmpty ())
+        {
+          events.push_back (p->events->RemoveNext ());
+        }
+      for (std::vector<Scheduler::Event>::const_iterator ev = events.begin (); ev != events.end (); ++ev)
+        {
+          uint32_t context = ev->key.m_context;
+          uint32_t id = context < m_nodePartition.size () ? m_nodePartition[context] : p->id;
+          Partition &target = m_partitions[id];
+          NS_ASSERT (ev->key.m_ts >= target.currentTs);
+          target.events->Insert (*ev);
+          if (id != p->id)
+            {
+              NS_LOG_LOGIC ("event of node " << context << " moved to partition " << id);
+              p->unscheduledEvents--;
+              target.unscheduledEvents++;
+            }
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveMessages (Partition &p)
+{
+  for (std::vector<Partition>::iterator from = m_partitions.begin (); from != m_partitions.end (); ++from)
+    {
+      Messages &messages = from->outbox[p.id];
+      for (Messages::const_iterator m = messages.begin (); m != messages.end (); ++m)
+        {
+          Insert (p, m->ts, m->context, m->event);
+        }
+      messages.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition &p)
+{
+  Scheduler::Event next = p.events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= p.currentTs);
+  p.unscheduledEvents--;
+  p.eventCount++;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  p.currentTs = next.key.m_ts;
+  p.currentContext = next.key.m_context;
+  p.currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::WaitBarrier (void)
+{
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == m_partitions.size ())
+    {
+      // Last one in: reset the count before releasing the others.
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+    {
+      std::this_thread::yield ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  Partition &p = m_partitions[id];
+  m_current = &p;
+  if (id != 0)
+    {
+      // The worker threads are new at each Run: continue the packet
+      // uids of the partition where its previous thread stopped.
+      Packet::SetUidCounter (p.packetUid);
+    }
+
+  for (;;)
+    {
+      // Window boundary: every partition is idle until the barrier.
+      ReceiveMessages (p);
+      p.nextTs = p.events->IsEmpty () ?
+        std::numeric_limits<uint64_t>::max () : p.events->PeekNext ().key.m_ts;
+      p.stopRequested = p.stop;
+      WaitBarrier ();
+
+      uint64_t next = std::numeric_limits<uint64_t>::max ();
+      bool stop = false;
+      for (std::vector<Partition>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, i->nextTs);
+          stop = stop || i->stopRequested;
+        }
+      if (stop || next >= m_stopTs || next == std::numeric_limits<uint64_t>::max ())
+        {
+          break;
+        }
+
+      // No event of another partition can reach this one before
+      // the earliest pending event plus the lookahead.
+      uint64_t granted = next > std::numeric_limits<uint64_t>::max () - m_lookAhead ?
+        std::numeric_limits<uint64_t>::max () : next + m_lookAhead;
+      granted = std::min (granted, m_stopTs);
+      // A Stop called by an event of this partition ends its window;
+      // the other partitions complete theirs, and all of them stop at
+      // the next barrier, as with DistributedSimulatorImpl.
+      while (!p.events->IsEmpty ()
+             && p.events->PeekNext ().key.m_ts < granted
+             && !p.stop)
+        {
+          ProcessOneEvent (p);
+        }
+      WaitBarrier ();
+    }
+
+  if (id != 0)
+    {
+      p.packetUid = Packet::GetUidCounter ();
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (MultithreadedSimulatorImpl *impl, uint32_t id)
+{
+  impl->RunPartition (id);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_running, "Run is not reentrant");
+
+  CalculateLookAhead ();
+  if (m_partitions.size () > 1)
+    {
+      MoveEvents ();
+    }
+  MultithreadedMpiInterface::CollectReceivers ();
+
+  m_running = true;
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      p->stop = false;
+      p->uid = m_uid + p->id;
+    }
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::RunWorker, this, i));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  RunPartition (0);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_running = false;
+
+  for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      m_currentTs = std::max (m_currentTs, p->currentTs);
+      m_uid = std::max (m_uid, p->uid);
+    }
+  if (m_stopTs != std::numeric_limits<uint64_t>::max ())
+    {
+      m_currentTs = std::max (m_currentTs, m_stopTs);
+      m_stopTs = std::numeric_limits<uint64_t>::max ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_current)
+    {
+      return m_current->events->IsEmpty () || m_current->stop;
+    }
+  for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      if (!p->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current)
+    {
+      m_current->stop = true;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Stop(): Negative delay");
+  if (m_current)
+    {
+      Simulator::Schedule (delay, &Simulator::Stop);
+    }
+  else
+    {
+      m_stopTs = std::min (m_stopTs, m_currentTs + delay.GetTimeStep ());
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Scheduler::EventKey key;
+  if (m_current)
+    {
+      key = Insert (*m_current, m_current->currentTs + delay.GetTimeStep (),
+                    m_current->currentContext, event);
+    }
+  else
+    {
+      NS_ASSERT_MSG (!m_running, "events cannot be scheduled from threads other than the partition threads");
+      key = Insert (m_partitions[0], m_currentTs + delay.GetTimeStep (),
+                    Simulator::NO_CONTEXT, event);
+    }
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::ScheduleWithContext(): Negative delay");
+
+  uint32_t target = GetPartitionId (context);
+  if (m_current == 0)
+    {
+      NS_ASSERT_MSG (!m_running, "events cannot be scheduled from threads other than the partition threads");
+      Insert (m_partitions[target], m_currentTs + delay.GetTimeStep (), context, event);
+      return;
+    }
+
+  Partition &p = *m_current;
+  uint64_t ts = p.currentTs + delay.GetTimeStep ();
+  if (target == p.id)
+    {
+      Insert (p, ts, context, event);
+      return;
+    }
+  NS_ABORT_MSG_IF (static_cast<uint64_t> (delay.GetTimeStep ()) < m_lookAhead,
+                   "event for node " << context << " in partition " << target <<
+                   " scheduled " << delay << " ahead, less than the lookahead " << GetLookAhead ());
+  Message message;
+  message.ts = ts;
+  message.context = context;
+  message.event = event;
+  p.outbox[target].push_back (message);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  return Schedule (Time (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  CriticalSection cs (m_destroyEventsMutex);
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (m_current ? m_current->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  return TimeStep (id.GetTs () - m_partitions[GetOwner (id)].currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition &p = m_partitions[GetOwner (id)];
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p.events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p.unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition &p = m_partitions[GetOwner (id)];
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p.currentTs
+      || (id.GetTs () == p.currentTs && id.GetUid () <= p.currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return m_current ? m_current->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return m_current ? m_current->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  if (m_current)
+    {
+      return m_current->eventCount;
+    }
+  uint64_t count = 0;
+  for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      count += p->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation running the partitions
+ * of the topology as threads of a single process.
+ *
+ * The nodes are partitioned by their system id, as with
+ * DistributedSimulatorImpl, but each partition is run by a thread of
+ * this process instead of an MPI task: partition 0 by the thread
+ * calling Simulator::Run, and each other partition by a worker
+ * thread.  MPI is not needed.
+ *
+ * The partitions are synchronized with the same globally granted time
+ * windows as DistributedSimulatorImpl.  The lookahead is the smallest
+ * delay of the point-to-point channels connecting nodes of different
+ * partitions.  At each window boundary, all the threads meet at a
+ * barrier, drain the events sent to their partition during the window,
+ * and agree on the smallest next event time; each partition then runs
+ * its events earlier than that time plus the lookahead, without any
+ * further synchronization.  Simulator::Stop, called by an event, ends
+ * the window of its partition at once, while the other partitions run
+ * the rest of their window: all of them stop at the next barrier, as
+ * with DistributedSimulatorImpl.
+ *
+ * The uids of the events scheduled during Run are disjoint between the
+ * partitions: each one takes every n-th uid, n being the number of
+ * partitions.  The uids of the packets are made unique by the system
+ * id, and the packet uid counter of each partition is carried over
+ * from one Run to the next.
+ *
+ * Events scheduled with Simulator::ScheduleWithContext for a node of
+ * another partition are handed over through per-partition queues, and
+ * must be at least one lookahead in the future.  The packets crossing
+ * a PointToPointRemoteChannel are handed over this way by
+ * MultithreadedMpiInterface, after MpiInterface::Enable has been
+ * called with this simulator implementation selected.
+ *
+ * The models of each partition are run concurrently: they must not
+ * share objects with the nodes of other partitions except through
+ * remote point-to-point links, and trace sinks shared by several
+ * partitions must be thread-safe.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Default constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \return The number of partitions, and of threads used by Run.
+   */
+  uint32_t GetSystemCount (void) const;
+  /**
+   * Add an upper bound to the lookahead.
+   *
+   * \param [in] lookAhead The maximum lookahead; must be > 0.
+   */
+  void SetMaximumLookAhead (const Time lookAhead);
+  /**
+   * \return The lookahead used by the last call to Run.
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another partition. */
+  struct Message
+  {
+    uint64_t ts;        //!< The absolute event timestamp.
+    uint32_t context;   //!< The event context.
+    EventImpl *event;   //!< The event implementation.
+  };
+  /** Container type for the events sent to a partition. */
+  typedef std::vector<Message> Messages;
+
+  /** The state of a partition. */
+  struct Partition
+  {
+    uint32_t id;                 //!< The partition (system) id.
+    Ptr<Scheduler> events;       //!< The event priority queue.
+    uint32_t uid;                //!< Next event unique id.
+    uint32_t currentUid;         //!< Unique id of the current event.
+    uint64_t currentTs;          //!< Timestamp of the current event.
+    uint32_t currentContext;     //!< Execution context of the current event.
+    uint64_t eventCount;         //!< The event count.
+    int unscheduledEvents;       //!< Events inserted but not yet run.
+    bool stop;                   //!< Stop was called by an event of this partition.
+    uint64_t nextTs;             //!< Next event time, published at the barrier.
+    bool stopRequested;          //!< Stop flag, published at the barrier.
+    uint32_t packetUid;          //!< Packet uid counter, kept between the threads of each Run.
+    std::vector<Messages> outbox; //!< The events sent to each partition.
+    char padding[64];            //!< Keep the partitions on separate cache lines.
+  };
+
+  /**
+   * Get the partition holding an event.
+   * \param [in] id The event.
+   * \return The partition id.
+   */
+  uint32_t GetOwner (const EventId &id) const;
+  /**
+   * Get the partition of a node.
+   * \param [in] context The node id.
+   * \return The partition id, or the current one if \p context is not a node.
+   */
+  uint32_t GetPartitionId (uint32_t context) const;
+  /**
+   * Insert an event in a partition.
+   * \param [in] p The partition.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \return The event key.
+   */
+  Scheduler::EventKey Insert (Partition &p, uint64_t ts, uint32_t context, EventImpl *event);
+  /** Build the node to partition table and compute the lookahead. */
+  void CalculateLookAhead (void);
+  /**
+   * Move the events of the nodes whose system id has changed since
+   * they were scheduled to their new partition.
+   */
+  void MoveEvents (void);
+  /**
+   * Move the events sent by the other partitions to this one.
+   * \param [in] p The partition.
+   */
+  void ReceiveMessages (Partition &p);
+  /**
+   * Process the next event of a partition.
+   * \param [in] p The partition.
+   */
+  void ProcessOneEvent (Partition &p);
+  /**
+   * Run the events of a partition until the end of the simulation.
+   * \param [in] id The partition id.
+   */
+  void RunPartition (uint32_t id);
+  /**
+   * Thread entry point of the worker threads.
+   * \param [in] impl The simulator.
+   * \param [in] id The partition id.
+   */
+  static void RunWorker (MultithreadedSimulatorImpl *impl, uint32_t id);
+  /** Wait until all the threads have reached this point. */
+  void WaitBarrier (void);
+
+  /** The partitions. */
+  std::vector<Partition> m_partitions;
+  /** The partition of each node, built by Run. */
+  std::vector<uint32_t> m_nodePartition;
+  /** The scheduler type. */
+  ObjectFactory m_schedulerFactory;
+  /** Number of partitions requested; 0 for the hardware concurrency. */
+  uint32_t m_threadCount;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** The upper bound of the lookahead. */
+  Time m_maxLookAhead;
+  /**
+   * Next event unique id outside of Run.  At each Run, the partition i
+   * takes the uids m_uid + i + k n, n being the number of partitions,
+   * and m_uid then continues after the largest uid taken.
+   */
+  uint32_t m_uid;
+  /** Absolute time of Stop (delay) called outside of Run. */
+  uint64_t m_stopTs;
+  /** Time of the last event run, for the thread calling Run. */
+  uint64_t m_currentTs;
+  /** Whether Run is in progress. */
+  bool m_running;
+
+  /** Number of threads waiting at the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** Incremented each time all the threads have reached the barrier. */
+  std::atomic<uint32_t> m_barrierGeneration;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the destroy events. */
+  mutable SystemMutex m_destroyEventsMutex;
+
+  /** The partition run by the calling thread, during Run. */
+  static thread_local Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-memory-ring.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryRing");
+
+/** Record size marking the unused end of the record area. */
+static const uint32_t WRAP = 0xffffffff;
+/** Size of the record size prefix; keeps the records aligned on 8 bytes. */
+static const uint32_t PREFIX = 8;
+
+/**
+ * Round a record size up to keep the records aligned on 8 bytes.
+ * \param [in] size The record size.
+ * \return The space used by the record, prefix included.
+ */
+static uint64_t
+RecordSpace (uint32_t size)
+{
+  return PREFIX + ((static_cast<uint64_t> (size) + 7) & ~static_cast<uint64_t> (7));
+}
+
+SharedMemoryRing::SharedMemoryRing ()
+  : m_header (0),
+    m_data (0),
+    m_capacity (0),
+    m_position (0),
+    m_limit (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SharedMemoryRing::~SharedMemoryRing ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_header != 0)
+    {
+      munmap (m_header, sizeof (Header) + m_capacity);
+    }
+}
+
+bool
+SharedMemoryRing::Map (int fd, uint64_t size)
+{
+  void *address = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (address == MAP_FAILED)
+    {
+      NS_LOG_WARN ("cannot map " << m_name << ": " << std::strerror (errno));
+      return false;
+    }
+  m_header = static_cast<Header *> (address);
+  m_data = reinterpret_cast<uint8_t *> (m_header + 1);
+  return true;
+}
+
+bool
+SharedMemoryRing::Create (const std::string &name, uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << name << capacity);
+  NS_ASSERT_MSG (capacity != 0 && (capacity & (capacity - 1)) == 0,
+                 "the capacity must be a power of 2");
+  NS_ASSERT (m_header == 0);
+  m_name = name;
+  int fd = shm_open (name.c_str (), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("cannot create " << name << ": " << std::strerror (errno));
+      return false;
+    }
+  uint64_t size = sizeof (Header) + capacity;
+  if (ftruncate (fd, size) != 0)
+    {
+      NS_LOG_WARN ("cannot size " << name << ": " << std::strerror (errno));
+      close (fd);
+      shm_unlink (name.c_str ());
+      return false;
+    }
+  if (!Map (fd, size))
+    {
+      shm_unlink (name.c_str ());
+      return false;
+    }
+  m_header->tail.store (0, std::memory_order_relaxed);
+  m_header->head.store (0, std::memory_order_relaxed);
+  m_header->capacity = capacity;
+  m_capacity = capacity;
+  m_position = 0;
+  m_limit = 0;
+  return true;
+}
+
+bool
+SharedMemoryRing::Open (const std::string &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ASSERT (m_header == 0);
+  m_name = name;
+  int fd = shm_open (name.c_str (), O_RDWR, 0);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("cannot open " << name << ": " << std::strerror (errno));
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || static_cast<uint64_t> (st.st_size) <= sizeof (Header))
+    {
+      NS_LOG_WARN ("bad segment " << name);
+      close (fd);
+      return false;
+    }
+  if (!Map (fd, st.st_size))
+    {
+      return false;
+    }
+  m_capacity = m_header->capacity;
+  NS_ASSERT (sizeof (Header) + m_capacity == static_cast<uint64_t> (st.st_size));
+  m_position = m_header->head.load (std::memory_order_relaxed);
+  m_limit = m_position;
+  return true;
+}
+
+void
+SharedMemoryRing::Unlink (void)
+{
+  NS_LOG_FUNCTION (this);
+  shm_unlink (m_name.c_str ());
+}
+
+uint8_t *
+SharedMemoryRing::Reserve (uint32_t size)
+{
+  NS_ASSERT (m_header != 0);
+  uint64_t space = RecordSpace (size);
+  uint64_t offset = m_position & (m_capacity - 1);
+  uint64_t skip = (m_capacity - offset < space) ? m_capacity - offset : 0;
+  if (m_position + skip + space - m_limit > m_capacity)
+    {
+      // Maybe the consumer has released some space since.
+      m_limit = m_header->head.load (std::memory_order_acquire);
+      if (m_position + skip + space - m_limit > m_capacity)
+        {
+          return 0;
+        }
+    }
+  if (skip != 0)
+    {
+      *reinterpret_cast<uint32_t *> (m_data + offset) = WRAP;
+      m_position += skip;
+      offset = 0;
+    }
+  *reinterpret_cast<uint32_t *> (m_data + offset) = size;
+  m_position += space;
+  return m_data + offset + PREFIX;
+}
+
+void
+SharedMemoryRing::Publish (void)
+{
+  if (m_header != 0)
+    {
+      m_header->tail.store (m_position, std::memory_order_release);
+    }
+}
+
+const uint8_t *
+SharedMemoryRing::Read (uint32_t &size)
+{
+  NS_ASSERT (m_header != 0);
+  for (;;)
+    {
+      if (m_position == m_limit)
+        {
+          m_limit = m_header->tail.load (std::memory_order_acquire);
+          if (m_position == m_limit)
+            {
+              return 0;
+            }
+        }
+      uint64_t offset = m_position & (m_capacity - 1);
+      uint32_t prefix = *reinterpret_cast<const uint32_t *> (m_data + offset);
+      if (prefix == WRAP)
+        {
+          m_position += m_capacity - offset;
+          continue;
+        }
+      size = prefix;
+      m_position += RecordSpace (size);
+      return m_data + offset + PREFIX;
+    }
+}
+
+void
+SharedMemoryRing::Release (void)
+{
+  if (m_header != 0)
+    {
+      m_header->head.store (m_position, std::memory_order_release);
+    }
+}
+
+} // namespace ns3
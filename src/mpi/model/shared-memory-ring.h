@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_RING_H
+#define NS3_SHARED_MEMORY_RING_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Single-producer single-consumer ring of variable-size records
+ * in a POSIX shared memory segment.
+ *
+ * Used by GrantedTimeWindowMpiInterface to pass the packets between
+ * two MPI tasks running on the same host.  The producer creates the
+ * segment with Create(), the consumer maps it with Open(); once both
+ * have mapped it, the name can be removed with Unlink().
+ *
+ * The producer writes records in place with Reserve(), and makes all
+ * the records reserved so far visible at once with Publish(), so that
+ * the records of a granted time window are transferred as one batch.
+ * The consumer reads the published records in place with Read(), and
+ * gives their space back at once with Release().
+ *
+ * Reserve() never waits for the consumer: when the ring is full it
+ * returns 0, and the caller must send the record another way.
+ */
+class SharedMemoryRing
+{
+public:
+  SharedMemoryRing ();
+  ~SharedMemoryRing ();
+
+  /**
+   * Create and map a new segment, as the producer.
+   * \param [in] name The segment name, starting with '/'.
+   * \param [in] capacity The record area size, in bytes; a power of 2.
+   * \return true on success.
+   */
+  bool Create (const std::string &name, uint32_t capacity);
+  /**
+   * Map an existing segment, as the consumer.
+   * \param [in] name The segment name, starting with '/'.
+   * \return true on success.
+   */
+  bool Open (const std::string &name);
+  /** Remove the segment name; the mappings stay valid. */
+  void Unlink (void);
+
+  /**
+   * Reserve space for a record, not yet visible to the consumer.
+   * \param [in] size The record size, in bytes.
+   * \return A pointer to write the record to, aligned on 8 bytes, or 0
+   * if the ring is full.
+   */
+  uint8_t * Reserve (uint32_t size);
+  /** Make the records reserved so far visible to the consumer. */
+  void Publish (void);
+
+  /**
+   * Read the next published record.  The record stays valid until
+   * the next call to Release().
+   * \param [out] size The record size, in bytes.
+   * \return A pointer to the record, or 0 if there is none.
+   */
+  const uint8_t * Read (uint32_t &size);
+  /** Give the space of the records read so far back to the producer. */
+  void Release (void);
+
+private:
+  /** The segment header, followed by the records. */
+  struct Header
+  {
+    std::atomic<uint64_t> tail;  //!< Published write position.
+    char pad1[56];               //!< Keep tail and head on separate cache lines.
+    std::atomic<uint64_t> head;  //!< Released read position.
+    char pad2[56];               //!< Keep the records off the head cache line.
+    uint64_t capacity;           //!< Size of the record area.
+    char pad3[56];               //!< Align the record area on a cache line.
+  };
+
+  /**
+   * Map the segment.
+   * \param [in] fd The segment file descriptor.
+   * \param [in] size The segment size.
+   * \return true on success.
+   */
+  bool Map (int fd, uint64_t size);
+
+  /** The segment name. */
+  std::string m_name;
+  /** The mapped segment. */
+  Header *m_header;
+  /** The record area. */
+  uint8_t *m_data;
+  /** The record area size. */
+  uint64_t m_capacity;
+  /** Local write or read position. */
+  uint64_t m_position;
+  /** Last head (producer) or tail (consumer) read from the header. */
+  uint64_t m_limit;
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_RING_H */
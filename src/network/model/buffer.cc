@@ -50,17 +50,74 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+// The heuristics and the free lists are per thread, so that packets can
+// be created and destroyed concurrently by the threads of a parallel
+// simulator implementation.
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedEnd = 0;
+thread_local Buffer::FreeListStatistics Buffer::g_statistics = {0, 0, 0, 0};
+
+/// Data size of the smallest size class.
+static const uint32_t BUFFER_MIN_CLASS_SIZE = 64;
+/// Data size of the largest size class; larger storages are not recycled.
+static const uint32_t BUFFER_MAX_CLASS_SIZE = 65536;
+/// Number of size classes: 64, 96, 128, 192, ... 49152, 65536.
+static const uint32_t BUFFER_SIZE_CLASSES = 21;
+/// Maximum number of storages in a free list.
+static const uint32_t BUFFER_MAX_FREE_COUNT = 1000;
+/// Maximum number of bytes in the storages of a free list.
+static const uint32_t BUFFER_MAX_FREE_BYTES = 4 << 20;
+
+/**
+ * \param size a data size, at most BUFFER_MAX_CLASS_SIZE
+ * \return the smallest size class holding \p size bytes
+ */
+static uint32_t
+GetSizeClass (uint32_t size)
+{
+  if (size <= BUFFER_MIN_CLASS_SIZE)
+    {
+      return 0;
+    }
+  // The classes between 2^k and 2^(k+1) are 1.5 * 2^k and 2^(k+1).
+  uint32_t k = 0;
+  while ((size - 1) >> (k + 1))
+    {
+      k++;
+    }
+  uint32_t base = 1 << k;
+  return 2 * (k - 6) + (size - 1 < base + base / 2 ? 1 : 2);
+}
+
+/**
+ * \param sizeClass a size class
+ * \return the data size of the storages of \p sizeClass
+ */
+static uint32_t
+GetClassSize (uint32_t sizeClass)
+{
+  if (sizeClass % 2)
+    {
+      return (BUFFER_MIN_CLASS_SIZE + BUFFER_MIN_CLASS_SIZE / 2) << (sizeClass / 2);
+    }
+  return BUFFER_MIN_CLASS_SIZE << (sizeClass / 2);
+}
+
 #ifdef BUFFER_FREE_LIST
+struct Buffer::FreeLists
+{
+  std::vector<struct Buffer::Data *> sizeClasses[BUFFER_SIZE_CLASSES]; //!< The free storages of each size class
+};
+
 /* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
+ * keep track of 3 possible states for the g_freeLists variable:
  *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
+ *    so no one has created the associated free lists (they are created
  *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
+ *  - initialized means that the free lists exist and are valid
+ *  - destroyed means that the thread-local destructors of this compilation
+ *    unit have run so, the free lists have been cleared from their content
+ * The key is that in destroyed state, we are careful not re-create them
  * which is a typical weakness of lazy evaluation schemes which use 
  * '0' as a special value to indicate both un-initialized and destroyed.
  * Note that it is important to use '0' as the marker for un-initialized state
@@ -70,27 +127,30 @@ uint32_t Buffer::g_recommendedStart = 0;
  * constructor orderings.
  */
 #define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
+#define IS_UNINITIALIZED(x) (x == (Buffer::FreeLists*)0)
+#define IS_DESTROYED(x) (x == (Buffer::FreeLists*)MAGIC_DESTROYED)
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#define DESTROYED ((Buffer::FreeLists*)MAGIC_DESTROYED)
+#define UNINITIALIZED ((Buffer::FreeLists*)0)
+thread_local Buffer::FreeLists *Buffer::g_freeLists = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  if (IS_INITIALIZED (g_freeLists))
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t c = 0; c < BUFFER_SIZE_CLASSES; c++)
         {
-          Buffer::Deallocate (*i);
+          std::vector<struct Buffer::Data *> &freeList = g_freeLists->sizeClasses[c];
+          for (std::vector<struct Buffer::Data *>::iterator i = freeList.begin ();
+               i != freeList.end (); i++)
+            {
+              Buffer::Deallocate (*i);
+            }
         }
-      delete g_freeList;
-      g_freeList = DESTROYED;
+      delete g_freeLists;
+      g_freeLists = DESTROYED;
     }
 }
 
@@ -99,45 +159,50 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  NS_ASSERT (!IS_UNINITIALIZED (g_freeLists));
+  if (data->m_size <= BUFFER_MAX_CLASS_SIZE && IS_INITIALIZED (g_freeLists))
     {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      // Allocate rounds the sizes up to a size class.
+      uint32_t sizeClass = GetSizeClass (data->m_size);
+      NS_ASSERT (GetClassSize (sizeClass) == data->m_size);
+      std::vector<struct Buffer::Data *> &freeList = g_freeLists->sizeClasses[sizeClass];
+      if (freeList.size () < BUFFER_MAX_FREE_COUNT
+          && (freeList.size () + 1) * data->m_size <= BUFFER_MAX_FREE_BYTES)
+        {
+          g_statistics.recycled++;
+          freeList.push_back (data);
+          return;
+        }
     }
+  g_statistics.released++;
+  Buffer::Deallocate (data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  /* try to find a buffer of the right size class. */
+  if (IS_UNINITIALIZED (g_freeLists))
     {
-      g_freeList = new Buffer::FreeList ();
+      g_freeLists = new Buffer::FreeLists ();
+      // make sure the destructor of this thread's free lists will run
+      (void) &g_localStaticDestructor;
     }
-  else if (IS_INITIALIZED (g_freeList))
+  else if (IS_INITIALIZED (g_freeLists) && dataSize <= BUFFER_MAX_CLASS_SIZE)
     {
-      while (!g_freeList->empty ()) 
+      std::vector<struct Buffer::Data *> &freeList = g_freeLists->sizeClasses[GetSizeClass (dataSize)];
+      if (!freeList.empty ())
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          struct Buffer::Data *data = freeList.back ();
+          freeList.pop_back ();
+          NS_ASSERT (data->m_size >= dataSize);
+          g_statistics.hits++;
+          data->m_count = 1;
+          return data;
         }
     }
+  g_statistics.misses++;
   struct Buffer::Data *data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
   return data;
@@ -148,6 +213,7 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  g_statistics.released++;
   Deallocate (data);
 }
 
@@ -155,6 +221,7 @@ Buffer::Data *
 Buffer::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+  g_statistics.misses++;
   return Allocate (size);
 }
 #endif /* BUFFER_FREE_LIST */
@@ -163,9 +230,9 @@ struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
 {
   NS_LOG_FUNCTION (reqSize);
-  if (reqSize == 0) 
+  if (reqSize <= BUFFER_MAX_CLASS_SIZE)
     {
-      reqSize = 1;
+      reqSize = GetClassSize (GetSizeClass (reqSize));
     }
   NS_ASSERT (reqSize >= 1);
   uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
@@ -176,6 +243,21 @@ Buffer::Allocate (uint32_t reqSize)
   return data;
 }
 
+Buffer::FreeListStatistics
+Buffer::GetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_statistics;
+}
+
+void
+Buffer::ResetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeListStatistics zero = {0, 0, 0, 0};
+  g_statistics = zero;
+}
+
 void
 Buffer::Deallocate (struct Buffer::Data *data)
 {
@@ -244,7 +326,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart + g_recommendedEnd);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -285,6 +367,7 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  g_recommendedEnd = std::max (g_recommendedEnd, m_end - m_zeroAreaEnd);
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -38,9 +38,16 @@ namespace ns3 {
  * automatically adjusted to hold any data prepended
  * or appended by the user. Its implementation is optimized
  * to ensure that the number of buffer resizes is minimized,
- * by creating new Buffers of the maximum size ever used.
- * The correct maximum size is learned at runtime during use by 
- * recording the maximum size of each packet.
+ * by creating new Buffers with room for the largest headers and
+ * trailers ever used.
+ * The correct sizes are learned at runtime during use by 
+ * recording the maximum size of the headers and trailers of each packet.
+ *
+ * The underlying data storages are allocated in size classes, each
+ * growing by a factor of 1.5 or 2 from 64 bytes up to 64 KiB, and the
+ * unused storages are kept in one free list per size class and per
+ * thread, so that a storage is always reused for data of a similar
+ * size.  GetFreeListStatistics() reports how often they are reused.
  *
  * \internal
  * The implementation of the Buffer class uses a COW (Copy On Write)
@@ -642,6 +649,25 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Counters of the data storage free lists of a thread.
+   */
+  struct FreeListStatistics
+  {
+    uint64_t hits;     //!< Storages reused from a free list.
+    uint64_t misses;   //!< Storages allocated, no free list holding one.
+    uint64_t recycled; //!< Storages put back in a free list.
+    uint64_t released; //!< Storages freed, their free list being full.
+  };
+  /**
+   * \return the counters of the free lists of the calling thread
+   */
+  static FreeListStatistics GetFreeListStatistics (void);
+  /**
+   * \brief Reset the counters of the free lists of the calling thread.
+   */
+  static void ResetFreeListStatistics (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -767,7 +793,12 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
+  /**
+   * size of the trailers to make room for in a newly-allocated
+   * buffer, after the zero area.
+   */
+  static thread_local uint32_t g_recommendedEnd;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,17 +821,18 @@ private:
    */
   uint32_t m_end;
 
+  static thread_local FreeListStatistics g_statistics; //!< Free list counters
+
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
+  /// Free lists of buffer data, one per size class
+  struct FreeLists;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static thread_local FreeLists *g_freeLists; //!< Buffer data containers
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
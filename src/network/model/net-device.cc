@@ -41,4 +41,11 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SupportsSegmentOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
 } // namespace ns3
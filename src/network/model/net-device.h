@@ -359,6 +359,16 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface transmits a packet marked with a
+   * SegmentOffloadTag as the burst of its segments, false otherwise.
+   *
+   * The network layer splits the super-segments into their segments
+   * before handing them to the other devices.  The default implementation
+   * returns false.
+   */
+  virtual bool SupportsSegmentOffload (void) const;
+
 };
 
 } // namespace ns3
@@ -21,6 +21,7 @@
 #include <list>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "packet-metadata.h"
 #include "buffer.h"
@@ -34,9 +35,10 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +47,7 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -161,78 +163,6 @@ PacketMetadata::IsStateOk (void) const
   return ok;
 }
 
-uint32_t 
-PacketMetadata::GetUleb128Size (uint32_t value) const
-{
-  NS_LOG_FUNCTION (this << value);
-  if (value < 0x80)
-    {
-      return 1;
-    }
-  if (value < 0x4000)
-    {
-      return 2;
-    }
-  if (value < 0x200000)
-    {
-      return 3;
-    }
-  if (value < 0x10000000)
-    {
-      return 4;
-    }
-  return 5;
-}
-uint32_t
-PacketMetadata::ReadUleb128 (const uint8_t **pBuffer) const
-{
-  NS_LOG_FUNCTION (this << &pBuffer);
-  const uint8_t *buffer = *pBuffer;
-  uint32_t result;
-  uint8_t byte;
-
-  byte = buffer[0];
-  result = (byte & (~0x80));
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 1;
-      return result;
-    }
-  byte = buffer[1];
-  result |= (byte & (~0x80)) << 7;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 2;
-      return result;
-    }
-  byte = buffer[2];
-  result |= (byte & (~0x80)) << 14;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 3;
-      return result;
-    }
-  byte = buffer[3];
-  result |= (byte & (~0x80)) << 21;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 4;
-      return result;
-    }
-  byte = buffer[4];
-  result |= (byte & (~0x80)) << 28;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 5;
-      return result;
-    }
-  /* This means that the LEB128 number was not valid.
-   * ie: the last (5th) byte did not have the high-order bit zeroed.
-   */
-  NS_ASSERT (false);
-  return 0;
-}
-
 void
 PacketMetadata::Append16 (uint16_t value, uint8_t *buffer)
 {
@@ -251,70 +181,45 @@ PacketMetadata::Append32 (uint32_t value,  uint8_t *buffer)
   buffer[3] = (value >> 24) & 0xff;
 }
 
-void
-PacketMetadata::AppendValueExtra (uint32_t value, uint8_t *buffer)
+uint16_t
+PacketMetadata::Read16 (const uint8_t *buffer)
 {
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x200000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      buffer[2] = value;
-      return;
-    }
-  if (value < 0x10000000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[2] = 0x80 | byte;
-      value >>= 7;
-      buffer[3] = value;
-      return;
-    }
-  {
-    uint8_t byte = value & (~0x80);
-    buffer[0] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[1] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[2] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[3] = 0x80 | byte;
-    value >>= 7;
-    buffer[4] = value;
-  }
+  return buffer[0] | (buffer[1] << 8);
+}
+uint32_t
+PacketMetadata::Read32 (const uint8_t *buffer)
+{
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
 }
 
-void
-PacketMetadata::AppendValue (uint32_t value, uint8_t *buffer)
+uint16_t
+PacketMetadata::WriteItems (uint8_t *buffer, uint16_t next, uint16_t prev,
+                            const PacketMetadata::SmallItem *item,
+                            const PacketMetadata::ExtraItem *extraItem)
 {
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x80)
-    {
-      buffer[0] = value;
-      return;
-    }
-  if (value < 0x4000)
+  NS_LOG_FUNCTION (this << &buffer << next << prev << item << extraItem);
+  uint32_t typeUid = item->typeUid;
+  if (extraItem != 0)
     {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      buffer[1] = value;
-      return;
+      typeUid |= 0x1;
     }
-  AppendValueExtra (value, buffer);
+  // the fixed-size encoding keeps 15 bits of the TypeId uid, which
+  // optimized builds must not truncate silently either
+  NS_ABORT_MSG_IF (typeUid > 0xffff, "TypeId uid " << (typeUid >> 1) << " too large for the packet metadata");
+  Append16 (next, buffer);
+  Append16 (prev, buffer + 2);
+  Append16 (typeUid, buffer + 4);
+  Append16 (item->chunkUid, buffer + 6);
+  Append32 (item->size, buffer + 8);
+  if (extraItem == 0)
+    {
+      return PACKET_METADATA_SMALL_ITEM_SIZE;
+    }
+  buffer += PACKET_METADATA_SMALL_ITEM_SIZE;
+  Append32 (extraItem->fragmentStart, buffer);
+  Append32 (extraItem->fragmentEnd, buffer + 4);
+  Append32 (extraItem->packetUid, buffer + 8);
+  return PACKET_METADATA_SMALL_ITEM_SIZE + PACKET_METADATA_EXTRA_ITEM_SIZE;
 }
 
 void
@@ -376,9 +281,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_used != item->prev && m_used != item->next);
-  uint32_t typeUidSize = GetUleb128Size (item->typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
+  uint32_t n = PACKET_METADATA_SMALL_ITEM_SIZE;
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
@@ -386,17 +289,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
     {
       ReserveCopy (n);
     }
-  uint8_t *buffer = &m_data->m_data[m_used];
-  Append16 (item->next, buffer);
-  buffer += 2;
-  Append16 (item->prev, buffer);
-  buffer += 2;
-  AppendValue (item->typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  return n;
+  return WriteItems (&m_data->m_data[m_used], item->next, item->prev, item, 0);
 }
 
 uint16_t
@@ -408,14 +301,8 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
                    item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
                    extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
   NS_ASSERT (m_data != 0);
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   NS_ASSERT (m_used != prev && m_used != next);
-
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
+  uint32_t n = PACKET_METADATA_SMALL_ITEM_SIZE + PACKET_METADATA_EXTRA_ITEM_SIZE;
 
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
@@ -425,25 +312,7 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
       ReserveCopy (n);
     }
 
-  uint8_t *buffer = &m_data->m_data[m_used];
-
-  Append16 (next, buffer);
-  buffer += 2;
-  Append16 (prev, buffer);
-  buffer += 2;
-  AppendValue (typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  buffer += 2;
-  AppendValue (extraItem->fragmentStart, buffer);
-  buffer += fragStartSize;
-  AppendValue (extraItem->fragmentEnd, buffer);
-  buffer += fragEndSize;
-  Append32 (extraItem->packetUid, buffer);
-
-  return n;
+  return WriteItems (&m_data->m_data[m_used], next, prev, item, extraItem);
 }
 
 void
@@ -468,33 +337,13 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
       available = m_data->m_size - m_tail;
     }
 
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
+  uint32_t n = PACKET_METADATA_SMALL_ITEM_SIZE + PACKET_METADATA_EXTRA_ITEM_SIZE;
 
   if (available >= n &&
       m_data->m_count == 1)
     {
-      uint8_t *buffer = &m_data->m_data[m_tail];
-      Append16 (item->next, buffer);
-      buffer += 2;
-      Append16 (item->prev, buffer);
-      buffer += 2;
-      AppendValue (typeUid, buffer);
-      buffer += typeUidSize;
-      AppendValue (item->size, buffer);
-      buffer += sizeSize;
-      Append16 (item->chunkUid, buffer);
-      buffer += 2;
-      AppendValue (extraItem->fragmentStart, buffer);
-      buffer += fragStartSize;
-      AppendValue (extraItem->fragmentEnd, buffer);
-      buffer += fragEndSize;
-      Append32 (extraItem->packetUid, buffer);
-      m_used = std::max (m_used, (uint16_t)(buffer - &m_data->m_data[0]));
+      WriteItems (&m_data->m_data[m_tail], item->next, item->prev, item, extraItem);
+      m_used = std::max (m_used, (uint16_t)(m_tail + n));
       m_data->m_dirtyEnd = m_used;
       return;
     }
@@ -534,27 +383,20 @@ PacketMetadata::ReadItems (uint16_t current,
                         extraItem->packetUid);
   NS_ASSERT (current <= m_data->m_size);
   const uint8_t *buffer = &m_data->m_data[current];
-  item->next = buffer[0];
-  item->next |= (buffer[1]) << 8;
-  item->prev = buffer[2];
-  item->prev |= (buffer[3]) << 8;
-  buffer += 4;
-  item->typeUid = ReadUleb128 (&buffer);
-  item->size = ReadUleb128 (&buffer);
-  item->chunkUid = buffer[0];
-  item->chunkUid |= (buffer[1]) << 8;
-  buffer += 2;
+  item->next = Read16 (buffer);
+  item->prev = Read16 (buffer + 2);
+  item->typeUid = Read16 (buffer + 4);
+  item->chunkUid = Read16 (buffer + 6);
+  item->size = Read32 (buffer + 8);
+  buffer += PACKET_METADATA_SMALL_ITEM_SIZE;
 
   bool isExtra = (item->typeUid & 0x1) == 0x1;
   if (isExtra)
     {
-      extraItem->fragmentStart = ReadUleb128 (&buffer);
-      extraItem->fragmentEnd = ReadUleb128 (&buffer);
-      extraItem->packetUid = buffer[0];
-      extraItem->packetUid |= buffer[1] << 8;
-      extraItem->packetUid |= buffer[2] << 16;
-      extraItem->packetUid |= buffer[3] << 24;
-      buffer += 4;
+      extraItem->fragmentStart = Read32 (buffer);
+      extraItem->fragmentEnd = Read32 (buffer + 4);
+      extraItem->packetUid = Read32 (buffer + 8);
+      buffer += PACKET_METADATA_EXTRA_ITEM_SIZE;
     }
   else
     {
@@ -575,7 +417,7 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (!m_freeListDestroyed && !m_freeList.empty ())
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
@@ -596,7 +438,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
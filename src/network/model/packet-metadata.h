@@ -68,12 +68,12 @@ class Trailer;
  * of entries which can be stored in this linked list but it is
  * quite unlikely to hit this limit in practice.
  *
- * Each item of the linked list is a variable-sized byte buffer
- * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit 
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * Each item of the linked list is a fixed-size record made of
+ * 16 and 32 bit integers: a SmallItem for a whole header, trailer,
+ * or payload, followed by an ExtraItem for a fragment. Headers and
+ * trailers are identified by the index of their TypeId, so adding
+ * or removing one writes or reads a record at a known offset,
+ * without any variable-size integer decoding.
  */
 class PacketMetadata 
 {
@@ -407,6 +407,10 @@ private:
    * of PacketMetadata::Data is 16 bytes
    */ 
 #define PACKET_METADATA_DATA_M_DATA_SIZE 8
+  /** the encoded size of a SmallItem */
+#define PACKET_METADATA_SMALL_ITEM_SIZE 12
+  /** the encoded size of an ExtraItem */
+#define PACKET_METADATA_EXTRA_ITEM_SIZE 12
   
   /**
    * Data structure
@@ -449,12 +453,13 @@ private:
        this item: the value zero represents payload.
        If the low bit of this uid is one, an ExtraItem
        structure follows this SmallItem structure.
-       stored as a variable-size 32 bit integer.
+       stored as a fixed-size 16 bit integer, hence the TypeId
+       uids of the headers and trailers must be below 32768.
      */
     uint32_t typeUid;
     /** the size (in bytes) of the header or trailer represented
        by this element.
-       stored as a variable-size 32 bit integer.
+       stored as a fixed-size 32 bit integer.
      */
     uint32_t size;
     /** this field tries to uniquely identify each header or
@@ -478,18 +483,18 @@ private:
   struct ExtraItem {
     /** offset (in bytes) from start of original header to
        the start of the fragment still present.
-       stored as a variable-size 32 bit integer.
+       stored as a fixed-size 32 bit integer.
      */
     uint32_t fragmentStart;
     /** offset (in bytes) from start of original header to
        the end of the fragment still present.
-       stored as a variable-size 32 bit integer.
+       stored as a fixed-size 32 bit integer.
      */
     uint32_t fragmentEnd;
     /** the packetUid of the packet in which this header or trailer
        was first added. It could be different from the m_packetUid
        field if the user has aggregated multiple packets into one.
-       stored as a fixed-size 64 bit integer.
+       stored as a fixed-size 32 bit integer.
      */
     uint64_t packetUid;
   };
@@ -547,18 +552,6 @@ public:
    */
   inline void UpdateTail (uint16_t written);
 
-  /**
-   * \brief Get the ULEB128 (Unsigned Little Endian Base 128) size
-   * \param value the value
-   * \returns the value's ULEB128 size
-   */
-  inline uint32_t GetUleb128Size (uint32_t value) const;
-  /**
-   * \brief Read a ULEB128 (Unsigned Little Endian Base 128) coded number
-   * \param pBuffer the buffer to read from
-   * \returns the value
-   */
-  uint32_t ReadUleb128 (const uint8_t **pBuffer) const;
   /**
    * \brief Append a 16-bit value to the buffer
    * \param value the value to add
@@ -572,20 +565,29 @@ public:
    */
   inline void Append32 (uint32_t value, uint8_t *buffer);
   /**
-   * \brief Append a value to the buffer
-   * \param value the value to add
-   * \param buffer the buffer to write to
+   * \brief Read a 16-bit value from the buffer
+   * \param buffer the buffer to read from
+   * \returns the value
    */
-  inline void AppendValue (uint32_t value, uint8_t *buffer);
+  static inline uint16_t Read16 (const uint8_t *buffer);
   /**
-   * \brief Append a value to the buffer - extra
-   *
-   * This function is called by AppendValue
-   *
-   * \param value the value to add
+   * \brief Read a 32-bit value from the buffer
+   * \param buffer the buffer to read from
+   * \returns the value
+   */
+  static inline uint32_t Read32 (const uint8_t *buffer);
+  /**
+   * \brief Write a SmallItem and an optional ExtraItem
    * \param buffer the buffer to write to
+   * \param next the next field to write
+   * \param prev the prev field to write
+   * \param item the SmallItem to write
+   * \param extraItem the ExtraItem to write, or 0
+   * \returns the written size
    */
-  void AppendValueExtra (uint32_t value, uint8_t *buffer);
+  inline uint16_t WriteItems (uint8_t *buffer, uint16_t next, uint16_t prev,
+                              const PacketMetadata::SmallItem *item,
+                              const PacketMetadata::ExtraItem *extraItem);
 
   /**
    * \brief Reserve space
@@ -661,7 +663,15 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * The metadata data storage.  The free list, the maximum size and
+   * the chunk uid are per thread, so that packets can be created and
+   * destroyed concurrently by the threads of a parallel simulator
+   * implementation.
+   */
+  static thread_local DataFreeList m_freeList;
+  /** Set when the free list of this thread has been destroyed. */
+  static thread_local bool m_freeListDestroyed;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,8 +682,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -692,7 +702,7 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (PacketMetadata::Create (PACKET_METADATA_SMALL_ITEM_SIZE)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
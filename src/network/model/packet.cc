@@ -28,7 +28,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -582,6 +582,20 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+uint32_t
+Packet::GetUidCounter (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_globalUid;
+}
+
+void
+Packet::SetUidCounter (uint32_t counter)
+{
+  NS_LOG_FUNCTION (counter);
+  m_globalUid = counter;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
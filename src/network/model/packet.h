@@ -531,6 +531,28 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * \brief Get the packet uid counter of the calling thread.
+   *
+   * The uid of a packet is made of the system id of the simulator,
+   * in the upper 32 bits, and of this counter.
+   *
+   * \returns the number of packets created by the calling thread
+   */
+  static uint32_t GetUidCounter (void);
+  /**
+   * \brief Set the packet uid counter of the calling thread.
+   *
+   * A parallel simulator implementation which runs a partition on a
+   * new thread at each Simulator::Run must carry the counter of the
+   * partition over from the previous thread, so that the uids of the
+   * packets of this partition stay unique.
+   *
+   * \param [in] counter the counter returned by GetUidCounter on the
+   * previous thread of the partition
+   */
+  static void SetUidCounter (uint32_t counter);
+
   /**
    * \brief Returns number of bytes required for packet
    * serialization.
@@ -766,7 +788,13 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /**
+   * Counter of packets Uid, of the calling thread.  The uids are
+   * only unique if each system id is used by a single thread at a
+   * time, which carries the counter of the system id over from the
+   * previous one (see SetUidCounter).
+   */
+  static thread_local uint32_t m_globalUid;
 };
 
 /**
@@ -22,6 +22,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include "ns3/system-thread.h"
 
 using namespace ns3;
 
@@ -389,6 +390,72 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer data storage free lists test
+ */
+class BufferFreeListTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListTest ();
+private:
+  /**
+   * Check the free list statistics, in a thread whose buffer
+   * heuristics were not grown by the previous tests.
+   */
+  void CheckStatistics (void);
+};
+
+
+BufferFreeListTest::BufferFreeListTest ()
+  : TestCase ("Buffer free lists") {
+}
+
+void
+BufferFreeListTest::DoRun (void)
+{
+  // The heuristics and the free lists are per thread.
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&BufferFreeListTest::CheckStatistics, this));
+  thread->Start ();
+  thread->Join ();
+}
+
+void
+BufferFreeListTest::CheckStatistics (void)
+{
+  // Learn the header size and fill the free list of its size class.
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Buffer buffer;
+      buffer.AddAtStart (100);
+    }
+
+  Buffer::ResetFreeListStatistics ();
+  {
+    Buffer buffer;
+    buffer.AddAtStart (100);
+    buffer.AddAtEnd (4);
+  }
+  Buffer::FreeListStatistics stats = Buffer::GetFreeListStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, 1, "storage reused");
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 0, "no storage allocated");
+  NS_TEST_EXPECT_MSG_EQ (stats.recycled, 1, "storage recycled");
+
+  // Storages shared by copies are recycled once.
+  Buffer::ResetFreeListStatistics ();
+  {
+    Buffer buffer (100);
+    Buffer copy = buffer;
+    copy.AddAtStart (10);
+    Buffer fragment = copy.CreateFragment (0, 50);
+  }
+  stats = Buffer::GetFreeListStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.hits + stats.misses, stats.recycled + stats.released,
+                         "every storage created is recycled or freed");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +472,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFreeListTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
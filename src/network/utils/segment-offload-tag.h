@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENT_OFFLOAD_TAG_H
+#define SEGMENT_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Marks a super-segment handed to the device with segmentation offload
+ *
+ * A transport protocol may send the payload of several segments as a single
+ * packet, instead of one packet per segment. The tag records the size of the
+ * segments the payload stands for, so that the layers below treat the packet
+ * as the burst of these segments, each one carrying a copy of the headers of
+ * the packet: the network layer hands the packet to a device supporting the
+ * offload (see NetDevice::SupportsSegmentOffload) when its segments fit in
+ * the MTU, and the device transmits it in the time of the whole burst; the
+ * other devices get the segments split by the transport protocol.
+ */
+class SegmentOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentOffloadTag ();
+
+  /**
+   * Constructs a SegmentOffloadTag
+   *
+   * \param segmentSize the payload size of a segment
+   * \param payloadSize the payload size of the packet
+   */
+  SegmentOffloadTag (uint32_t segmentSize, uint32_t payloadSize);
+
+  /**
+   * \param segmentSize the payload size of a segment
+   */
+  void SetSegmentSize (uint32_t segmentSize);
+  /**
+   * \returns the payload size of a segment
+   */
+  uint32_t GetSegmentSize (void) const;
+  /**
+   * \param payloadSize the payload size of the packet
+   */
+  void SetPayloadSize (uint32_t payloadSize);
+  /**
+   * \returns the payload size of the packet
+   */
+  uint32_t GetPayloadSize (void) const;
+  /**
+   * \returns the number of segments of the packet
+   */
+  uint32_t GetSegments (void) const;
+  /**
+   * \param size the size of the packet, with the headers added so far
+   * \returns the size of the largest segment of the packet, with the same
+   * headers
+   */
+  uint32_t GetLargestSegmentSize (uint32_t size) const;
+  /**
+   * \param size the size of the packet, with the headers added so far
+   * \returns the size of all the segments of the packet, with the same
+   * headers
+   */
+  uint32_t GetWireSize (uint32_t size) const;
+
+private:
+  uint32_t m_segmentSize; //!< Payload size of a segment
+  uint32_t m_payloadSize; //!< Payload size of the packet
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_OFFLOAD_TAG_H */
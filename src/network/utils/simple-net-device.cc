@@ -30,6 +30,7 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
+#include "ns3/segment-offload-tag.h"
 
 namespace ns3 {
 
@@ -428,7 +429,14 @@ bool
 SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
   NS_LOG_FUNCTION (this << p << source << dest << protocolNumber);
-  if (p->GetSize () > GetMtu ())
+  // A super-segment is sent as its segments: these have to fit in the MTU
+  uint32_t size = p->GetSize ();
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      size = offloadTag.GetLargestSegmentSize (size);
+    }
+  if (size > GetMtu ())
     {
       return false;
     }
@@ -453,7 +461,7 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
           Time txTime = Time (0);
           if (m_bps > DataRate (0))
             {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+              txTime = m_bps.CalculateBytesTxTime (GetWireSize (packet));
             }
           m_channel->Send (p, protocolNumber, to, from, this);
           TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
@@ -493,7 +501,7 @@ SimpleNetDevice::TransmitComplete ()
       Time txTime = Time (0);
       if (m_bps > DataRate (0))
         {
-          txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+          txTime = m_bps.CalculateBytesTxTime (GetWireSize (packet));
         }
       TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
     }
@@ -501,6 +509,17 @@ SimpleNetDevice::TransmitComplete ()
   return;
 }
 
+uint32_t
+SimpleNetDevice::GetWireSize (Ptr<const Packet> packet)
+{
+  SegmentOffloadTag offloadTag;
+  if (packet->PeekPacketTag (offloadTag))
+    {
+      return offloadTag.GetWireSize (packet->GetSize ());
+    }
+  return packet->GetSize ();
+}
+
 Ptr<Node> 
 SimpleNetDevice::GetNode (void) const
 {
@@ -560,4 +579,11 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+bool
+SimpleNetDevice::SupportsSegmentOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 } // namespace ns3
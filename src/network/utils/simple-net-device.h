@@ -134,6 +134,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentOffload (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -164,6 +165,13 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * \param packet a packet
+   * \return the number of bytes the packet takes on the wire, that is the
+   * size of its segments if it is a segmentation-offload super-segment
+   */
+  static uint32_t GetWireSize (Ptr<const Packet> packet);
+
   bool m_linkUp; //!< Flag indicating whether or not the link is up
 
   /**
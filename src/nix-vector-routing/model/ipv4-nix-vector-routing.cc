@@ -18,12 +18,13 @@
  * Authors: Josh Pelkey <jpelkey@gatech.edu>
  */
 
-#include <queue>
+#include <algorithm>
 #include <iomanip>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
+#include "ns3/uinteger.h"
 #include "ns3/ipv4-list-routing.h"
 
 #include "ipv4-nix-vector-routing.h"
@@ -34,7 +35,12 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
-bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+uint64_t Ipv4NixVectorRouting::m_epoch = 0;
+uint64_t Ipv4NixVectorRouting::m_flushEpoch = 0;
+std::vector<uint64_t> Ipv4NixVectorRouting::m_nodeEpochs;
+std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> Ipv4NixVectorRouting::m_nodeIds;
+bool Ipv4NixVectorRouting::m_nodeIdsStale = true;
+uint32_t Ipv4NixVectorRouting::m_nNodesIndexed = 0;
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -43,12 +49,26 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("NixVectorRouting")
     .AddConstructor<Ipv4NixVectorRouting> ()
+    .AddAttribute ("NixCacheSize",
+                   "The maximum number of nix-vectors cached, "
+                   "0 for no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4NixVectorRouting::m_nixCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of Ipv4Routes cached, "
+                   "0 for no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4NixVectorRouting::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_nixCacheSize (0),
+    m_routeCacheSize (0),
+    m_totalNeighbors (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -75,6 +95,8 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  FlushNixCache ();
+  FlushIpv4RouteCache ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -92,6 +114,7 @@ void
 Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_nodeIdsStale = true;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -111,22 +134,26 @@ void
 Ipv4NixVectorRouting::FlushNixCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nixCache.clear ();
+  m_nixCache.entries.clear ();
+  m_nixCache.order.clear ();
 }
 
 void
 Ipv4NixVectorRouting::FlushIpv4RouteCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_ipv4RouteCache.clear ();
+  m_ipv4RouteCache.entries.clear ();
+  m_ipv4RouteCache.order.clear ();
 }
 
 Ptr<NixVector>
-Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif,
+                                    std::vector<uint32_t> & path)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   Ptr<NixVector> nixVector = Create<NixVector> ();
+  path.clear ();
 
   // not in cache, must build the nix vector
   // First, we have to figure out the nodes 
@@ -150,12 +177,14 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     {
       // otherwise proceed as normal 
       // and build the nix vector
-      std::vector< Ptr<Node> > parentVector;
+      std::vector< Ptr<Node> > nodes;
 
-      BFS (NodeList::GetNNodes (), source, destNode, parentVector, oif);
-
-      if (BuildNixVector (parentVector, source->GetId (), destNode->GetId (), nixVector))
+      if (BFS (source, destNode, nodes, oif) && BuildNixVector (nodes, nixVector))
         {
+          for (std::vector< Ptr<Node> >::const_iterator i = nodes.begin (); i != nodes.end (); ++i)
+            {
+              path.push_back ((*i)->GetId ());
+            }
           return nixVector;
         }
       else
@@ -166,40 +195,142 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     }
 }
 
-Ptr<NixVector>
-Ipv4NixVectorRouting::GetNixVectorInCache (Ipv4Address address)
+Ptr<Ipv4Route>
+Ipv4NixVectorRouting::GetIpv4Route (Ipv4Address dest, uint32_t nodeIndex, Ptr<NetDevice> oif)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_FUNCTION (this << dest << nodeIndex << oif);
 
-  CheckCacheStateAndFlush ();
+  // The route depends on the neighbor index extracted from the
+  // nix-vector and on the output interface requested, not only on
+  // the destination.
+  CacheEntry *entry = FindInCache (m_ipv4RouteCache, dest);
+  if (entry != 0 && entry->neighborIndex == nodeIndex && entry->oif == oif)
+    {
+      NS_LOG_LOGIC ("Found Ipv4Route in cache.");
+      return entry->route;
+    }
 
-  NixMap_t::iterator iter = m_nixCache.find (address);
-  if (iter != m_nixCache.end ())
+  NS_LOG_LOGIC ("Ipv4Route not in cache, build: ");
+  Ipv4Address gatewayIp;
+  Ptr<Node> gatewayNode;
+  uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp, gatewayNode);
+  int32_t interfaceIndex = m_ipv4->GetInterfaceForDevice (oif ? oif : m_node->GetDevice (index));
+
+  NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
+
+  Ipv4InterfaceAddress ifAddr = m_ipv4->GetAddress (interfaceIndex, 0);
+
+  // start filling in the Ipv4Route info
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetSource (ifAddr.GetLocal ());
+  rtentry->SetGateway (gatewayIp);
+  rtentry->SetDestination (dest);
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIndex));
+
+  // add rtentry to cache
+  if (entry == 0)
     {
-      NS_LOG_LOGIC ("Found Nix-vector in cache.");
-      return iter->second;
+      entry = &AddToCache (m_ipv4RouteCache, dest, m_routeCacheSize);
+    }
+  entry->route = rtentry;
+  entry->neighborIndex = nodeIndex;
+  entry->oif = oif;
+  entry->path.assign (1, m_node->GetId ());
+  if (gatewayNode)
+    {
+      entry->path.push_back (gatewayNode->GetId ());
     }
+  entry->epoch = m_epoch;
+  return rtentry;
+}
 
-  // not in cache
-  return 0;
+Ipv4NixVectorRouting::CacheEntry *
+Ipv4NixVectorRouting::FindInCache (Cache & cache, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (dest);
+
+  CacheEntries_t::iterator i = cache.entries.find (dest);
+  if (i == cache.entries.end ())
+    {
+      // not in cache
+      return 0;
+    }
+  if (!IsValid (i->second))
+    {
+      NS_LOG_LOGIC ("Dropping cache entry invalidated by a topology change.");
+      cache.order.erase (i->second.position);
+      cache.entries.erase (i);
+      return 0;
+    }
+  cache.order.splice (cache.order.begin (), cache.order, i->second.position);
+  return &i->second;
 }
 
-Ptr<Ipv4Route>
-Ipv4NixVectorRouting::GetIpv4RouteInCache (Ipv4Address address)
+Ipv4NixVectorRouting::CacheEntry &
+Ipv4NixVectorRouting::AddToCache (Cache & cache, Ipv4Address dest, uint32_t maxSize)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_FUNCTION (dest << maxSize);
+  NS_ASSERT (cache.entries.find (dest) == cache.entries.end ());
+
+  if (maxSize != 0 && cache.entries.size () >= maxSize)
+    {
+      NS_LOG_LOGIC ("Evicting the cache entry of " << cache.order.back ());
+      cache.entries.erase (cache.order.back ());
+      cache.order.pop_back ();
+    }
+  cache.order.push_front (dest);
+  CacheEntry &entry = cache.entries[dest];
+  entry.neighborIndex = 0;
+  entry.epoch = m_epoch;
+  entry.position = cache.order.begin ();
+  return entry;
+}
+
+bool
+Ipv4NixVectorRouting::IsValid (CacheEntry & entry)
+{
+  if (entry.epoch == m_epoch)
+    {
+      return true;
+    }
+  if (entry.epoch < m_flushEpoch)
+    {
+      return false;
+    }
+  for (std::vector<uint32_t>::const_iterator i = entry.path.begin (); i != entry.path.end (); ++i)
+    {
+      if (*i < m_nodeEpochs.size () && m_nodeEpochs[*i] > entry.epoch)
+        {
+          return false;
+        }
+    }
+  entry.epoch = m_epoch;
+  return true;
+}
 
-  CheckCacheStateAndFlush ();
+void
+Ipv4NixVectorRouting::InvalidatePathsThrough (void) const
+{
+  NS_LOG_FUNCTION (this);
 
-  Ipv4RouteMap_t::iterator iter = m_ipv4RouteCache.find (address);
-  if (iter != m_ipv4RouteCache.end ())
+  if (m_node == 0)
     {
-      NS_LOG_LOGIC ("Found Ipv4Route in cache.");
-      return iter->second;
+      InvalidateAllPaths ();
+      return;
+    }
+  uint32_t id = m_node->GetId ();
+  if (id >= m_nodeEpochs.size ())
+    {
+      m_nodeEpochs.resize (id + 1, 0);
     }
+  m_nodeEpochs[id] = ++m_epoch;
+}
 
-  // not in cache
-  return 0;
+void
+Ipv4NixVectorRouting::InvalidateAllPaths (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_flushEpoch = ++m_epoch;
 }
 
 bool
@@ -230,75 +361,67 @@ Ipv4NixVectorRouting::BuildNixVectorLocal (Ptr<NixVector> nixVector)
 }
 
 bool
-Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
+Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & path, Ptr<NixVector> nixVector)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  if (source == dest)
+  // The nix-vector is read from its end: add the hops from the
+  // destination back to the source.
+  for (uint32_t hop = path.size () - 1; hop > 0; hop--)
     {
-      return true;
-    }
-
-  if (parentVector.at (dest) == 0)
-    {
-      return false;
-    }
+      Ptr<Node> parentNode = path[hop - 1];
+      uint32_t dest = path[hop]->GetId ();
 
-  Ptr<Node> parentNode = parentVector.at (dest);
-
-  uint32_t numberOfDevices = parentNode->GetNDevices ();
-  uint32_t destId = 0;
-  uint32_t totalNeighbors = 0;
+      uint32_t numberOfDevices = parentNode->GetNDevices ();
+      uint32_t destId = 0;
+      uint32_t totalNeighbors = 0;
 
-  // scan through the net devices on the parent node
-  // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
-    {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
-      if (localNetDevice->IsBridge ())
+      // scan through the net devices on the parent node
+      // and then look at the nodes adjacent to them
+      for (uint32_t i = 0; i < numberOfDevices; i++)
         {
-          continue;
-        }
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
-        {
-          continue;
-        }
-
-      // this function takes in the local net dev, and channel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          // Get a net device from the node
+          // as well as the channel, and figure
+          // out the adjacent net devices
+          Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
+          if (localNetDevice->IsBridge ())
+            {
+              continue;
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
 
-      // Finally we can get the adjacent nodes
-      // and scan through them.  If we find the 
-      // node that matches "dest" then we can add 
-      // the index  to the nix vector.
-      // the index corresponds to the neighbor index
-      uint32_t offset = 0;
-      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
-        {
-          Ptr<Node> remoteNode = (*iter)->GetNode ();
+          // this function takes in the local net dev, and channel, and
+          // writes to the netDeviceContainer the adjacent net devs
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
 
-          if (remoteNode->GetId () == dest)
+          // Finally we can get the adjacent nodes
+          // and scan through them.  If we find the 
+          // node that matches "dest" then we can add 
+          // the index  to the nix vector.
+          // the index corresponds to the neighbor index
+          uint32_t offset = 0;
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
             {
-              destId = totalNeighbors + offset;
+              Ptr<Node> remoteNode = (*iter)->GetNode ();
+
+              if (remoteNode->GetId () == dest)
+                {
+                  destId = totalNeighbors + offset;
+                }
+              offset += 1;
             }
-          offset += 1;
-        }
 
-      totalNeighbors += netDeviceContainer.GetN ();
+          totalNeighbors += netDeviceContainer.GetN ();
+        }
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
     }
-  NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
-                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
-  nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
-
-  // recurse through parent vector, grabbing the path 
-  // and building the nix vector
-  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
   return true;
 }
 
@@ -347,27 +470,58 @@ Ipv4NixVectorRouting::GetNodeByIp (Ipv4Address dest)
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
-  NodeContainer allNodes = NodeContainer::GetGlobal ();
-  Ptr<Node> destNode;
+  // The index is shared by all the nodes, and is not told about the
+  // addresses of the nodes using other routing protocols: check the
+  // node found still has the address.  The index is only rebuilt for
+  // an address not found if nodes or addresses were added since it was
+  // built, so that the lookups of unknown addresses do not rebuild it.
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_nodeIds.find (dest);
+  if (i != m_nodeIds.end () && i->second < NodeList::GetNNodes ())
+    {
+      Ptr<Node> node = NodeList::GetNode (i->second);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (ipv4 && ipv4->GetInterfaceForAddress (dest) != -1)
+        {
+          return node;
+        }
+    }
+  else if (i == m_nodeIds.end () && !m_nodeIdsStale && m_nNodesIndexed == NodeList::GetNNodes ())
+    {
+      NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
+      return 0;
+    }
 
-  for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
+  NS_LOG_LOGIC ("Indexing the node addresses.");
+  m_nodeIds.clear ();
+  m_nodeIdsStale = false;
+  m_nNodesIndexed = NodeList::GetNNodes ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator j = NodeList::Begin (); j != listEnd; j++)
     {
-      Ptr<Node> node = *i;
+      Ptr<Node> node = *j;
       Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetInterfaceForAddress (dest) != -1)
+      if (!ipv4)
         {
-          destNode = node;
-          break;
+          continue;
+        }
+      for (uint32_t k = 0; k < ipv4->GetNInterfaces (); k++)
+        {
+          for (uint32_t l = 0; l < ipv4->GetNAddresses (k); l++)
+            {
+              // the first node holding an address wins
+              m_nodeIds.insert (std::make_pair (ipv4->GetAddress (k, l).GetLocal (), node->GetId ()));
+            }
         }
     }
 
-  if (!destNode)
+  i = m_nodeIds.find (dest);
+  if (i == m_nodeIds.end ())
     {
       NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
       return 0;
     }
 
-  return destNode;
+  return NodeList::GetNode (i->second);
 }
 
 uint32_t
@@ -442,7 +596,7 @@ Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd) const
 }
 
 uint32_t
-Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp)
+Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp, Ptr<Node> & gatewayNode)
 {
   uint32_t numberOfDevices = m_node->GetNDevices ();
   uint32_t index = 0;
@@ -473,7 +627,7 @@ Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address
           // found the proper net device
           index = i;
           Ptr<NetDevice> gatewayDevice = netDeviceContainer.Get (nodeIndex-totalNeighbors);
-          Ptr<Node> gatewayNode = gatewayDevice->GetNode ();
+          gatewayNode = gatewayDevice->GetNode ();
           Ptr<Ipv4> ipv4 = gatewayNode->GetObject<Ipv4> ();
 
           uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (gatewayDevice);
@@ -495,23 +649,29 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
   Ptr<NixVector> nixVectorInCache;
   Ptr<NixVector> nixVectorForPacket;
 
-  CheckCacheStateAndFlush ();
-
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
   // check if cache
-  nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
+  CacheEntry *entry = FindInCache (m_nixCache, header.GetDestination ());
 
-  // not in cache
-  if (!nixVectorInCache)
+  // not in cache, or built for another output interface
+  if (entry == 0 || entry->oif != oif)
     {
       NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+      if (entry == 0)
+        {
+          entry = &AddToCache (m_nixCache, header.GetDestination (), m_nixCacheSize);
+        }
       // Build the nix-vector, given this node and the
-      // dest IP address
-      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
-
-      // cache it
-      m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+      // dest IP address, and cache it
+      entry->nixVector = GetNixVector (m_node, header.GetDestination (), oif, entry->path);
+      entry->oif = oif;
+      entry->epoch = m_epoch;
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Found Nix-vector in cache.");
     }
+  nixVectorInCache = entry->nixVector;
 
   // path exists
   if (nixVectorInCache)
@@ -520,7 +680,6 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 
       // create a new nix vector to be used, 
       // we want to keep the cached version clean
-      nixVectorForPacket = Create<NixVector> ();
       nixVectorForPacket = nixVectorInCache->Copy (); 
 
       // Get the interface number that we go out of, by extracting
@@ -537,59 +696,8 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 
       // Search here in a cache for this node index 
       // and look for a Ipv4Route
-      rtentry = GetIpv4RouteInCache (header.GetDestination ());
-
-      if (!rtentry || !(rtentry->GetOutputDevice () == oif))
-        {
-          // not in cache or a different specified output
-          // device is to be used
-
-          // first, make sure we erase existing (incorrect)
-          // rtentry from the map
-          if (rtentry)
-            {
-              m_ipv4RouteCache.erase (header.GetDestination ());
-            }
-
-          NS_LOG_LOGIC ("Ipv4Route not in cache, build: ");
-          Ipv4Address gatewayIp;
-          uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
-          int32_t interfaceIndex = 0;
-
-          if (!oif)
-            {
-              interfaceIndex = (m_ipv4)->GetInterfaceForDevice (m_node->GetDevice (index));
-            }
-          else
-            {
-              interfaceIndex = (m_ipv4)->GetInterfaceForDevice (oif);
-            }
-
-          NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
-
-          Ipv4InterfaceAddress ifAddr = m_ipv4->GetAddress (interfaceIndex, 0);
-
-          // start filling in the Ipv4Route info
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetSource (ifAddr.GetLocal ());
-
-          rtentry->SetGateway (gatewayIp);
-          rtentry->SetDestination (header.GetDestination ());
-
-          if (!oif)
-            {
-              rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIndex));
-            }
-          else
-            {
-              rtentry->SetOutputDevice (oif);
-            }
-
-          sockerr = Socket::ERROR_NOTERROR;
-
-          // add rtentry to cache
-          m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
-        }
+      rtentry = GetIpv4Route (header.GetDestination (), nodeIndex, oif);
+      sockerr = Socket::ERROR_NOTERROR;
 
       NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
 
@@ -617,8 +725,6 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  CheckCacheStateAndFlush ();
-
   NS_ASSERT (m_ipv4 != 0);
   // Check if input device supports IP
   NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
@@ -661,27 +767,7 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
   uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
   uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
 
-  rtentry = GetIpv4RouteInCache (header.GetDestination ());
-  // not in cache
-  if (!rtentry)
-    {
-      NS_LOG_LOGIC ("Ipv4Route not in cache, build: ");
-      Ipv4Address gatewayIp;
-      uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
-      uint32_t interfaceIndex = (m_ipv4)->GetInterfaceForDevice (m_node->GetDevice (index));
-      Ipv4InterfaceAddress ifAddr = m_ipv4->GetAddress (interfaceIndex, 0);
-
-      // start filling in the Ipv4Route info
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetSource (ifAddr.GetLocal ());
-
-      rtentry->SetGateway (gatewayIp);
-      rtentry->SetDestination (header.GetDestination ());
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIndex));
-
-      // add rtentry to cache
-      m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
-    }
+  rtentry = GetIpv4Route (header.GetDestination (), nodeIndex, 0);
 
   NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
                 " bits from Nix-vector: " << nixVector << " : " << *nixVector);
@@ -698,9 +784,6 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
 void
 Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
 {
-
-  CheckCacheStateAndFlush ();
-
   std::ostream* os = stream->GetStream ();
 
   *os << "Node: " << m_ipv4->GetObject<Node> ()->GetId ()
@@ -708,39 +791,62 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::
       << ", Local time: " << GetObject<Node> ()->GetLocalTime ().As (unit)
       << ", Nix Routing" << std::endl;
 
+  // print the valid entries, by destination
+  std::map<Ipv4Address, const CacheEntry *> entries;
+  for (CacheEntries_t::iterator it = m_nixCache.entries.begin (); it != m_nixCache.entries.end (); it++)
+    {
+      if (IsValid (it->second))
+        {
+          entries[it->first] = &it->second;
+        }
+    }
   *os << "NixCache:" << std::endl;
-  if (m_nixCache.size () > 0)
+  if (entries.size () > 0)
     {
       *os << "Destination     NixVector" << std::endl;
-      for (NixMap_t::const_iterator it = m_nixCache.begin (); it != m_nixCache.end (); it++)
+      for (std::map<Ipv4Address, const CacheEntry *>::const_iterator it = entries.begin (); it != entries.end (); it++)
         {
           std::ostringstream dest;
           dest << it->first;
           *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
-          *os << *(it->second) << std::endl;
+          if (it->second->nixVector)
+            {
+              *os << *(it->second->nixVector);
+            }
+          *os << std::endl;
+        }
+    }
+
+  entries.clear ();
+  for (CacheEntries_t::iterator it = m_ipv4RouteCache.entries.begin (); it != m_ipv4RouteCache.entries.end (); it++)
+    {
+      if (IsValid (it->second))
+        {
+          entries[it->first] = &it->second;
         }
     }
   *os << "Ipv4RouteCache:" << std::endl;
-  if (m_ipv4RouteCache.size () > 0)
+  if (entries.size () > 0)
     {
       *os << "Destination     Gateway         Source            OutputDevice" << std::endl;
-      for (Ipv4RouteMap_t::const_iterator it = m_ipv4RouteCache.begin (); it != m_ipv4RouteCache.end (); it++)
+      for (std::map<Ipv4Address, const CacheEntry *>::const_iterator it = entries.begin (); it != entries.end (); it++)
         {
+          Ptr<Ipv4Route> route = it->second->route;
           std::ostringstream dest, gw, src;
-          dest << it->second->GetDestination ();
+          dest << route->GetDestination ();
           *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
-          gw << it->second->GetGateway ();
+          gw << route->GetGateway ();
           *os << std::setiosflags (std::ios::left) << std::setw (16) << gw.str ();
-          src << it->second->GetSource ();
+          src << route->GetSource ();
           *os << std::setiosflags (std::ios::left) << std::setw (16) << src.str ();
           *os << "  ";
-          if (Names::FindName (it->second->GetOutputDevice ()) != "")
+          if (Names::FindName (route->GetOutputDevice ()) != "")
             {
-              *os << Names::FindName (it->second->GetOutputDevice ());
+              *os << Names::FindName (route->GetOutputDevice ());
             }
           else
             {
-              *os << it->second->GetOutputDevice ()->GetIfIndex ();
+              *os << route->GetOutputDevice ()->GetIfIndex ();
             }
           *os << std::endl;
         }
@@ -752,178 +858,223 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
-  g_isCacheDirty = true;
+  InvalidateAllPaths ();
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
-  g_isCacheDirty = true;
+  InvalidatePathsThrough ();
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-  g_isCacheDirty = true;
+  m_nodeIdsStale = true;
+  InvalidateAllPaths ();
 }
 void
 Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-  g_isCacheDirty = true;
+  InvalidatePathsThrough ();
 }
 
 bool
-Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source, 
-                           Ptr<Node> dest, std::vector< Ptr<Node> > & parentVector,
-                           Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::IsUp (Ptr<Ipv4> ipv4, Ptr<NetDevice> device)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  if (ipv4)
+    {
+      uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (device);
+      if (!(ipv4->IsUp (interfaceIndex)))
+        {
+          NS_LOG_LOGIC ("Ipv4Interface is down");
+          return false;
+        }
+    }
+  if (!(device->IsLinkUp ()))
+    {
+      NS_LOG_LOGIC ("Link is down.");
+      return false;
+    }
+  return true;
+}
 
-  NS_LOG_LOGIC ("Going from Node " << source->GetId () << " to Node " << dest->GetId ());
-  std::queue< Ptr<Node> > greyNodeList;  // discovered nodes with unexplored children
+void
+Ipv4NixVectorRouting::GetNeighbors (Ptr<Node> node, bool reverse, Ptr<Node> source, Ptr<NetDevice> oif,
+                                    std::vector< Ptr<Node> > & neighbors)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
 
-  // reset the parent vector
-  parentVector.assign (numberOfNodes, 0); // initialize to 0
+  // Iterate over the node's adjacent vertices
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      // Get a net device from the node
+      // as well as the channel, and figure
+      // out the adjacent net device
+      Ptr<NetDevice> localNetDevice = node->GetDevice (i);
 
-  // Add the source node to the queue, set its parent to itself 
-  greyNodeList.push (source);
-  parentVector.at (source->GetId ()) = source;
+      // if a specific output interface was given, the
+      // source can only send through it
+      if (!reverse && node == source && oif && localNetDevice != oif)
+        {
+          continue;
+        }
 
-  // BFS loop
-  while (greyNodeList.size () != 0)
-    {
-      Ptr<Node> currNode = greyNodeList.front ();
-      Ptr<Ipv4> ipv4 = currNode->GetObject<Ipv4> ();
- 
-      if (currNode == dest) 
+      // make sure that we can go this way
+      if (!IsUp (ipv4, localNetDevice))
         {
-          NS_LOG_LOGIC ("Made it to Node " << currNode->GetId ());
-          return true;
+          continue;
+        }
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        { 
+          continue;
         }
 
-      // if this is the first iteration of the loop and a 
-      // specific output interface was given, make sure 
-      // we go this way
-      if (currNode == source && oif)
+      // this function takes in the local net dev, and channel, and
+      // writes to the netDeviceContainer the adjacent net devs
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
         {
-          // make sure that we can go this way
-          if (ipv4)
+          Ptr<Node> remoteNode = (*iter)->GetNode ();
+
+          if (reverse && remoteNode == source && oif && *iter != oif)
             {
-              uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (oif);
-              if (!(ipv4->IsUp (interfaceIndex)))
-                {
-                  NS_LOG_LOGIC ("Ipv4Interface is down");
-                  return false;
-                }
+              continue;
             }
-          if (!(oif->IsLinkUp ()))
+          // the remote end of the link must be up as well,
+          // so the links are usable both ways
+          if (!IsUp (remoteNode->GetObject<Ipv4> (), *iter))
             {
-              NS_LOG_LOGIC ("Link is down.");
-              return false;
-            }
-          Ptr<Channel> channel = oif->GetChannel ();
-          if (channel == 0)
-            { 
-              return false;
+              continue;
             }
+          neighbors.push_back (remoteNode);
+        }
+    }
+}
 
-          // this function takes in the local net dev, and channel, and
-          // writes to the netDeviceContainer the adjacent net devs
-          NetDeviceContainer netDeviceContainer;
-          GetAdjacentNetDevices (oif, channel, netDeviceContainer);
+bool
+Ipv4NixVectorRouting::BFS (Ptr<Node> source, Ptr<Node> dest,
+                           std::vector< Ptr<Node> > & path,
+                           Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
-          // Finally we can get the adjacent nodes
-          // and scan through them.  We push them
-          // to the greyNode queue, if they aren't 
-          // already there.
-          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
-            {
-              Ptr<Node> remoteNode = (*iter)->GetNode ();
+  NS_LOG_LOGIC ("Going from Node " << source->GetId () << " to Node " << dest->GetId ());
 
-              // check to see if this node has been pushed before
-              // by checking to see if it has a parent
-              // if it doesn't (null or 0), then set its parent and 
-              // push to the queue
-              if (parentVector.at (remoteNode->GetId ()) == 0)
-                {
-                  parentVector.at (remoteNode->GetId ()) = currNode;
-                  greyNodeList.push (remoteNode);
-                }
-            }
+  path.clear ();
+  if (source == dest)
+    {
+      path.push_back (source);
+      return true;
+    }
+
+  // The parent of each node discovered from the source, and the
+  // distance to the destination of each node discovered from the
+  // destination.  Only the visited nodes are stored, not the whole
+  // node list.
+  std::unordered_map<uint32_t, Ptr<Node> > parents;
+  std::unordered_map<uint32_t, uint32_t> distances;
+  parents[source->GetId ()] = source;
+  distances[dest->GetId ()] = 0;
+
+  std::vector< Ptr<Node> > forward (1, source);
+  std::vector< Ptr<Node> > backward (1, dest);
+  std::vector< Ptr<Node> > next;
+  std::vector< Ptr<Node> > neighbors;
+  uint32_t backwardDistance = 0;
+  bool met = false;
+
+  // Expand a whole level of the smaller frontier at a time, until the
+  // searches meet.  The forward search discovers the nodes in the
+  // order of a plain breadth first search from the source, and gives
+  // them the same parents.
+  while (!met && !forward.empty () && !backward.empty ())
+    {
+      bool reverse = backward.size () < forward.size ();
+      std::vector< Ptr<Node> > &frontier = reverse ? backward : forward;
+      if (reverse)
+        {
+          backwardDistance++;
         }
-      else
+
+      next.clear ();
+      for (std::vector< Ptr<Node> >::const_iterator i = frontier.begin (); i != frontier.end (); ++i)
         {
-          // Iterate over the current node's adjacent vertices
-          // and push them into the queue
-          for (uint32_t i = 0; i < (currNode->GetNDevices ()); i++)
+          neighbors.clear ();
+          GetNeighbors (*i, reverse, source, oif, neighbors);
+          for (std::vector< Ptr<Node> >::const_iterator j = neighbors.begin (); j != neighbors.end (); ++j)
             {
-              // Get a net device from the node
-              // as well as the channel, and figure
-              // out the adjacent net device
-              Ptr<NetDevice> localNetDevice = currNode->GetDevice (i);
-
-              // make sure that we can go this way
-              if (ipv4)
+              uint32_t id = (*j)->GetId ();
+              if (reverse)
                 {
-                  uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (currNode->GetDevice (i));
-                  if (!(ipv4->IsUp (interfaceIndex)))
+                  if (!distances.insert (std::make_pair (id, backwardDistance)).second)
                     {
-                      NS_LOG_LOGIC ("Ipv4Interface is down");
                       continue;
                     }
+                  met = met || parents.find (id) != parents.end ();
                 }
-              if (!(localNetDevice->IsLinkUp ()))
+              else
                 {
-                  NS_LOG_LOGIC ("Link is down.");
-                  continue;
-                }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
-                { 
-                  continue;
-                }
-
-              // this function takes in the local net dev, and channel, and
-              // writes to the netDeviceContainer the adjacent net devs
-              NetDeviceContainer netDeviceContainer;
-              GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
-              // Finally we can get the adjacent nodes
-              // and scan through them.  We push them
-              // to the greyNode queue, if they aren't 
-              // already there.
-              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
-                {
-                  Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-                  // check to see if this node has been pushed before
-                  // by checking to see if it has a parent
-                  // if it doesn't (null or 0), then set its parent and 
-                  // push to the queue
-                  if (parentVector.at (remoteNode->GetId ()) == 0)
+                  if (!parents.insert (std::make_pair (id, *i)).second)
                     {
-                      parentVector.at (remoteNode->GetId ()) = currNode;
-                      greyNodeList.push (remoteNode);
+                      continue;
                     }
+                  met = met || distances.find (id) != distances.end ();
                 }
+              next.push_back (*j);
             }
         }
+      frontier.swap (next);
+    }
 
-      // Pop off the head grey node.  We have all its children.
-      // It is now black.
-      greyNodeList.pop ();
+  if (!met)
+    {
+      // Didn't find the dest...
+      return false;
     }
 
-  // Didn't find the dest...
-  return false;
-}
+  // The nodes found by both searches are all in the last level of the
+  // forward search, at the same distance of the destination.  A plain
+  // breadth first search would reach the destination through the first
+  // of them in the order of discovery, and then through the first
+  // neighbor one hop closer to the destination at each hop.
+  Ptr<Node> node;
+  for (std::vector< Ptr<Node> >::const_iterator i = forward.begin (); node == 0; ++i)
+    {
+      NS_ASSERT (i != forward.end ());
+      if (distances.find ((*i)->GetId ()) != distances.end ())
+        {
+          node = *i;
+        }
+    }
 
-void 
-Ipv4NixVectorRouting::CheckCacheStateAndFlush (void) const
-{
-  if (g_isCacheDirty)
+  NS_LOG_LOGIC ("Searches met at Node " << node->GetId ());
+  for (Ptr<Node> n = node; n != source; n = parents[n->GetId ()])
+    {
+      path.push_back (n);
+    }
+  path.push_back (source);
+  std::reverse (path.begin (), path.end ());
+  while (node != dest)
     {
-      FlushGlobalNixRoutingCache ();
-      g_isCacheDirty = false;
+      uint32_t distance = distances[node->GetId ()];
+      neighbors.clear ();
+      GetNeighbors (node, false, source, oif, neighbors);
+      std::vector< Ptr<Node> >::const_iterator j = neighbors.begin ();
+      for (; j != neighbors.end (); ++j)
+        {
+          std::unordered_map<uint32_t, uint32_t>::const_iterator k = distances.find ((*j)->GetId ());
+          if (k != distances.end () && k->second + 1 == distance)
+            {
+              break;
+            }
+        }
+      NS_ASSERT (j != neighbors.end ());
+      node = *j;
+      path.push_back (node);
     }
+  return true;
 }
 
 } // namespace ns3
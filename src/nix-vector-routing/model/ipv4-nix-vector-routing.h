@@ -21,7 +21,10 @@
 #ifndef IPV4_NIX_VECTOR_ROUTING_H
 #define IPV4_NIX_VECTOR_ROUTING_H
 
+#include <list>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -56,6 +59,26 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * The nix-vectors and the Ipv4Routes are computed on demand and cached
+ * per destination, in caches which can be bounded (attributes
+ * NixCacheSize and RouteCacheSize) and evict their least recently used
+ * entries.  A cached entry remembers the nodes its path goes through: a
+ * change which can only break paths (interface down, address removed)
+ * invalidates the entries going through the changed node, while a change
+ * which can create paths (interface up, address added) invalidates all
+ * of them.  The entries are checked lazily, when they are used.
+ *
+ * The node addresses are looked up in an index shared by all the
+ * nodes, which is rebuilt when an address is not found and nodes or
+ * addresses were added since it was built.  The addresses added to the
+ * nodes which do not use this protocol are only found once a node was
+ * added or FlushGlobalNixRoutingCache was called.
+ *
+ * The index, the caches and the topology epochs are shared by all the
+ * nodes without synchronization: this protocol is not supported by the
+ * simulator implementations running the nodes in several threads, such
+ * as MultithreadedSimulatorImpl.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
@@ -81,6 +104,10 @@ public:
    * which iterates through the node list and flushes any
    * nix vector caches
    *
+   * The topology changes notified to the routing protocol only
+   * invalidate the cached entries depending on the changed node, so
+   * this is not needed after them.
+   *
    * \internal
    * \c const is used here due to need to potentially flush the cache
    * in const methods such as PrintRoutingTable.  Caches are stored in
@@ -90,6 +117,28 @@ public:
 
 private:
 
+  /** \brief A cached nix-vector or Ipv4Route, to a destination. */
+  struct CacheEntry
+  {
+    Ptr<NixVector> nixVector;    //!< The nix-vector, in the nix-vector cache.
+    Ptr<Ipv4Route> route;        //!< The route, in the route cache.
+    uint32_t neighborIndex;      //!< The neighbor index the route was built for.
+    Ptr<NetDevice> oif;          //!< The output interface requested, if any.
+    std::vector<uint32_t> path;  //!< Ids of the nodes whose changes invalidate the entry.
+    uint64_t epoch;              //!< The topology epoch the entry was last known valid at.
+    std::list<Ipv4Address>::iterator position; //!< The position of the entry in the use order.
+  };
+
+  /** Cache entries, by destination */
+  typedef std::unordered_map<Ipv4Address, CacheEntry, Ipv4AddressHash> CacheEntries_t;
+
+  /** \brief A cache evicting its least recently used entries. */
+  struct Cache
+  {
+    CacheEntries_t entries;       //!< The entries, by destination.
+    std::list<Ipv4Address> order; //!< The destinations, most recently used first.
+  };
+
   /**
    * Flushes the cache which stores nix-vector based on
    * destination IP
@@ -114,26 +163,63 @@ private:
    * BFS, accounting for any output interface specified, and finally
    * BuildNixVector to return the built nix-vector
    *
-   * \param source Source node
-   * \param dest Destination node address
-   * \param oif Preferred output interface
+   * \param [in] source Source node
+   * \param [in] dest Destination node address
+   * \param [in] oif Preferred output interface
+   * \param [out] path the ids of the nodes of the path found
    * \returns The NixVector to be used in routing.
    */
-  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif);
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif,
+                               std::vector<uint32_t> & path);
 
   /**
-   * Checks the cache based on dest IP for the nix-vector
-   * \param address Address to check
-   * \returns The NixVector to be used in routing.
+   * Checks the route cache for an Ipv4Route to a destination through
+   * a neighbor, and builds it if needed
+   * \param dest the destination address
+   * \param nodeIndex the nix index of the neighbor
+   * \param oif the output interface to use, if not null
+   * \returns The route.
    */
-  Ptr<NixVector> GetNixVectorInCache (Ipv4Address address);
+  Ptr<Ipv4Route> GetIpv4Route (Ipv4Address dest, uint32_t nodeIndex, Ptr<NetDevice> oif);
 
   /**
-   * Checks the cache based on dest IP for the Ipv4Route
-   * \param address Address to check
-   * \returns The cached route.
+   * Finds a valid entry in a cache, and marks it as the most recently
+   * used one.  An invalid entry found is removed.
+   * \param cache the cache
+   * \param dest the destination address
+   * \returns the entry, or null if not found
    */
-  Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address address);
+  static CacheEntry * FindInCache (Cache & cache, Ipv4Address dest);
+
+  /**
+   * Adds an entry to a cache, evicting the least recently used entry
+   * if the cache is full
+   * \param cache the cache, not holding an entry for \p dest
+   * \param dest the destination address
+   * \param maxSize the maximum number of entries, 0 for no limit
+   * \returns the new entry
+   */
+  static CacheEntry & AddToCache (Cache & cache, Ipv4Address dest, uint32_t maxSize);
+
+  /**
+   * Checks that no change of the topology invalidated an entry
+   * since it was last checked
+   * \param entry the entry
+   * \returns true if the entry is still valid
+   */
+  static bool IsValid (CacheEntry & entry);
+
+  /**
+   * Invalidates the cached entries of all the nodes which depend on
+   * this node, after a change which can only remove paths
+   */
+  void InvalidatePathsThrough (void) const;
+
+  /**
+   * Invalidates the cached entries of all the nodes, after a change
+   * which can create new paths
+   */
+  static void InvalidateAllPaths (void);
 
   /**
    * Given a net-device returns all the adjacent net-devices,
@@ -145,22 +231,20 @@ private:
   void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
 
   /**
-   * Iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address
+   * Finds the node corresponding to the given Ipv4Address, in an
+   * index of the addresses of all the nodes
    * \param dest destination node IP
    * \return The node with the specified IP.
    */
   Ptr<Node> GetNodeByIp (Ipv4Address dest);
 
   /**
-   * Recurses the parent vector, created by BFS and actually builds the nixvector
-   * \param [in] parentVector Parent vector for retracing routes
-   * \param [in] source Source Node index
-   * \param [in] dest Destination Node index
+   * Walks a path found by BFS and builds the nixvector
+   * \param [in] path the nodes of the path, from the source to the destination
    * \param [out] nixVector the NixVector to be used for routing
    * \returns true on success, false otherwise.
    */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
+  bool BuildNixVector (const std::vector< Ptr<Node> > & path, Ptr<NixVector> nixVector);
 
   /**
    * Special variation of BuildNixVector for when a node is sending to itself
@@ -189,23 +273,49 @@ private:
    * derived from this
    * \param [in] nodeIndex Nix Node index
    * \param [out] gatewayIp IP address of the gateway
+   * \param [out] gatewayNode the gateway node
    * \returns the index of the NetDevice in the node.
    */
-  uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
+  uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp, Ptr<Node> & gatewayNode);
 
   /**
-   * \brief Breadth first search algorithm.
-   * \param [in] numberOfNodes total number of nodes
+   * Determine if a device of a node can send and receive packets
+   * \param ipv4 the Ipv4 of the node, if any
+   * \param device the device
+   * \returns true if the interface and the link of the device are up
+   */
+  static bool IsUp (Ptr<Ipv4> ipv4, Ptr<NetDevice> device);
+
+  /**
+   * Lists the neighbors a node is linked to by a link up at both ends
+   * \param [in] node the node
+   * \param [in] reverse whether the links are used toward \p node
+   * \param [in] source Source Node
+   * \param [in] oif specific output interface to use from source node, if not null
+   * \param [out] neighbors the neighbors, appended
+   */
+  void GetNeighbors (Ptr<Node> node, bool reverse, Ptr<Node> source, Ptr<NetDevice> oif,
+                     std::vector< Ptr<Node> > & neighbors);
+
+  /**
+   * \brief Bidirectional breadth first search algorithm.
+   *
+   * The search alternately expands the smaller frontier of a search
+   * from the source and of a search backward from the destination,
+   * until they meet, so it only visits the nodes within about half the
+   * path length of the two ends.  Among the shortest paths, it returns
+   * the one a plain breadth first search from the source would find,
+   * which reaches each node through the first node discovering it.
+   *
    * \param [in] source Source Node
    * \param [in] dest Destination Node
-   * \param [out] parentVector Parent vector for retracing routes
+   * \param [out] path the nodes of a shortest path, from the source to the destination
    * \param [in] oif specific output interface to use from source node, if not null
    * \returns false if dest not found, true o.w.
    */
-  bool BFS (uint32_t numberOfNodes,
-            Ptr<Node> source,
+  bool BFS (Ptr<Node> source,
             Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
+            std::vector< Ptr<Node> > & path,
             Ptr<NetDevice> oif);
 
   void DoDispose (void);
@@ -222,22 +332,32 @@ private:
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
  
-  /**
-   * Flushes routing caches if required.
-   */
-  void CheckCacheStateAndFlush (void) const;
+  /** The topology epoch, incremented at each change */
+  static uint64_t m_epoch;
 
-  /**
-   * Flag to mark when caches are dirty and need to be flushed.  
-   * Used for lazy cleanup of caches when there are many topology changes.
-   */
-  static bool g_isCacheDirty;
+  /** The epoch of the last change invalidating all the cached entries */
+  static uint64_t m_flushEpoch;
+
+  /** The epoch of the last change of each node, by node id */
+  static std::vector<uint64_t> m_nodeEpochs;
+
+  /** The node ids by address */
+  static std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_nodeIds;
+
+  /** Whether addresses were added since m_nodeIds was built */
+  static bool m_nodeIdsStale;
+
+  /** The number of nodes when m_nodeIds was built */
+  static uint32_t m_nNodesIndexed;
 
   /** Cache stores nix-vectors based on destination ip */
-  mutable NixMap_t m_nixCache;
+  mutable Cache m_nixCache;
 
   /** Cache stores Ipv4Routes based on destination ip */
-  mutable Ipv4RouteMap_t m_ipv4RouteCache;
+  mutable Cache m_ipv4RouteCache;
+
+  uint32_t m_nixCacheSize;   //!< Maximum number of cached nix-vectors, 0 for no limit.
+  uint32_t m_routeCacheSize; //!< Maximum number of cached Ipv4Routes, 0 for no limit.
 
   Ptr<Ipv4> m_ipv4; //!< IPv4 object
   Ptr<Node> m_node; //!< Node object
@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <queue>
+#include <sstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * Compare the nix-vectors with those of the paths found by a plain
+ * breadth first search from the source, on topologies with several
+ * shortest paths between the nodes
+ */
+class Ipv4NixVectorRoutingPathTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the topology
+   * \param nNodes the number of nodes
+   * \param links the pairs of nodes linked, in the order of creation
+   */
+  Ipv4NixVectorRoutingPathTestCase (std::string name, uint32_t nNodes,
+                                    std::vector<std::pair<uint32_t, uint32_t> > links);
+  virtual ~Ipv4NixVectorRoutingPathTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Find the neighbors of a node, in the order of its devices
+   * \param node the node
+   * \return the neighbors
+   */
+  static std::vector<Ptr<Node> > GetNeighbors (Ptr<Node> node);
+
+  /**
+   * Build the nix-vector of the path found by a breadth first search
+   * \param source the source node
+   * \param dest the destination node
+   * \return the nix-vector, or null if there is no path
+   */
+  static Ptr<NixVector> GetReferenceNixVector (Ptr<Node> source, Ptr<Node> dest);
+
+  uint32_t m_nNodes;                                    //!< the number of nodes
+  std::vector<std::pair<uint32_t, uint32_t> > m_links;  //!< the links
+};
+
+Ipv4NixVectorRoutingPathTestCase::Ipv4NixVectorRoutingPathTestCase (std::string name, uint32_t nNodes,
+                                                                    std::vector<std::pair<uint32_t, uint32_t> > links)
+  : TestCase ("Check the nix-vectors against a breadth first search on a " + name),
+    m_nNodes (nNodes),
+    m_links (links)
+{
+}
+
+Ipv4NixVectorRoutingPathTestCase::~Ipv4NixVectorRoutingPathTestCase ()
+{
+}
+
+std::vector<Ptr<Node> >
+Ipv4NixVectorRoutingPathTestCase::GetNeighbors (Ptr<Node> node)
+{
+  std::vector<Ptr<Node> > neighbors;
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      Ptr<Channel> channel = device->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      for (std::size_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          if (channel->GetDevice (j) != device)
+            {
+              neighbors.push_back (channel->GetDevice (j)->GetNode ());
+            }
+        }
+    }
+  return neighbors;
+}
+
+Ptr<NixVector>
+Ipv4NixVectorRoutingPathTestCase::GetReferenceNixVector (Ptr<Node> source, Ptr<Node> dest)
+{
+  // breadth first search, each node keeping the first node discovering it as parent
+  std::vector<Ptr<Node> > parents (NodeList::GetNNodes ());
+  std::queue<Ptr<Node> > queue;
+  parents[source->GetId ()] = source;
+  queue.push (source);
+  while (!queue.empty () && parents[dest->GetId ()] == 0)
+    {
+      Ptr<Node> node = queue.front ();
+      queue.pop ();
+      std::vector<Ptr<Node> > neighbors = GetNeighbors (node);
+      for (std::vector<Ptr<Node> >::const_iterator i = neighbors.begin (); i != neighbors.end (); ++i)
+        {
+          if (parents[(*i)->GetId ()] == 0)
+            {
+              parents[(*i)->GetId ()] = node;
+              queue.push (*i);
+            }
+        }
+    }
+  if (parents[dest->GetId ()] == 0)
+    {
+      return 0;
+    }
+
+  // the nix-vector holds the neighbor index of each hop, the last hop first
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  for (Ptr<Node> node = dest; node != source; node = parents[node->GetId ()])
+    {
+      std::vector<Ptr<Node> > neighbors = GetNeighbors (parents[node->GetId ()]);
+      uint32_t index = std::find (neighbors.begin (), neighbors.end (), node) - neighbors.begin ();
+      nixVector->AddNeighborIndex (index, nixVector->BitCount (neighbors.size ()));
+    }
+  return nixVector;
+}
+
+void
+Ipv4NixVectorRoutingPathTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_nNodes);
+
+  Ipv4NixVectorHelper nixRouting;
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.Install (nodes);
+
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      NetDeviceContainer devices = simple.Install (NodeContainer (nodes.Get (i->first), nodes.Get (i->second)));
+      address.Assign (devices);
+      address.NewNetwork ();
+    }
+
+  for (uint32_t s = 0; s < m_nNodes; s++)
+    {
+      Ptr<Ipv4> ipv4 = nodes.Get (s)->GetObject<Ipv4> ();
+      if (ipv4->GetNInterfaces () < 2)
+        {
+          continue;
+        }
+      for (uint32_t d = 0; d < m_nNodes; d++)
+        {
+          Ptr<Ipv4> destIpv4 = nodes.Get (d)->GetObject<Ipv4> ();
+          if (d == s || destIpv4->GetNInterfaces () < 2)
+            {
+              continue;
+            }
+          Ipv4Header header;
+          header.SetDestination (destIpv4->GetAddress (1, 0).GetLocal ());
+          Ptr<Packet> p = Create<Packet> ();
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, 0, sockerr);
+
+          Ptr<NixVector> reference = GetReferenceNixVector (nodes.Get (s), nodes.Get (d));
+          if (reference == 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (route, 0, "unexpected route from node " << s << " to node " << d);
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_NE (route, 0, "no route from node " << s << " to node " << d);
+          NS_TEST_ASSERT_MSG_NE (p->GetNixVector (), 0, "no nix-vector from node " << s << " to node " << d);
+          std::ostringstream expected;
+          std::ostringstream found;
+          expected << *reference;
+          found << *p->GetNixVector ();
+          NS_TEST_ASSERT_MSG_EQ (found.str (), expected.str (), "unexpected path from node " << s << " to node " << d);
+        }
+    }
+
+  Simulator::Destroy ();
+  Ipv4AddressGenerator::Reset ();
+}
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * Ipv4NixVectorRouting test suite
+ */
+class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite ();
+};
+
+Ipv4NixVectorRoutingTestSuite::Ipv4NixVectorRoutingTestSuite ()
+  : TestSuite ("ipv4-nix-vector-routing", UNIT)
+{
+  typedef std::vector<std::pair<uint32_t, uint32_t> > Links;
+
+  // two paths of two hops between the nodes 0 and 3, whose links are
+  // created in a different order at each end
+  Links diamond;
+  diamond.push_back (std::make_pair (0, 1));
+  diamond.push_back (std::make_pair (2, 3));
+  diamond.push_back (std::make_pair (0, 2));
+  diamond.push_back (std::make_pair (1, 3));
+  AddTestCase (new Ipv4NixVectorRoutingPathTestCase ("diamond", 4, diamond), TestCase::QUICK);
+
+  // a 6x6 grid, the vertical links created first
+  Links grid;
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      grid.push_back (std::make_pair (i + 6, i));
+    }
+  for (uint32_t i = 0; i < 36; i++)
+    {
+      if (i % 6 != 5)
+        {
+          grid.push_back (std::make_pair (i, i + 1));
+        }
+    }
+  AddTestCase (new Ipv4NixVectorRoutingPathTestCase ("grid", 36, grid), TestCase::QUICK);
+
+  // pseudo-random links between 60 nodes, some of them isolated
+  Links randomLinks;
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < 90; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint32_t a = (seed >> 16) % 60;
+      seed = seed * 1103515245 + 12345;
+      uint32_t b = (seed >> 16) % 60;
+      bool known = (a == b);
+      for (Links::const_iterator j = randomLinks.begin (); !known && j != randomLinks.end (); ++j)
+        {
+          known = (*j == std::make_pair (a, b) || *j == std::make_pair (b, a));
+        }
+      if (!known)
+        {
+          randomLinks.push_back (std::make_pair (a, b));
+        }
+    }
+  AddTestCase (new Ipv4NixVectorRoutingPathTestCase ("random topology", 60, randomLinks), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static Ipv4NixVectorRoutingTestSuite g_ipv4NixVectorRoutingTestSuite;
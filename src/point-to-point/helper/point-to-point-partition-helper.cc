@@ -0,0 +1,560 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/object-factory.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+
+#include "point-to-point-partition-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointPartitionHelper");
+
+/**
+ * \param parents the union-find parents
+ * \param x an element
+ * \return the representative of the set of \p x
+ */
+static uint32_t
+FindSet (std::vector<uint32_t> &parents, uint32_t x)
+{
+  while (parents[x] != x)
+    {
+      parents[x] = parents[parents[x]];
+      x = parents[x];
+    }
+  return x;
+}
+
+/**
+ * \param parents the union-find parents
+ * \param x an element
+ * \param y another element
+ *
+ * Merge the sets of \p x and \p y.
+ */
+static void
+UnionSets (std::vector<uint32_t> &parents, uint32_t x, uint32_t y)
+{
+  x = FindSet (parents, x);
+  y = FindSet (parents, y);
+  if (x != y)
+    {
+      parents[std::max (x, y)] = std::min (x, y);
+    }
+}
+
+PointToPointPartitionHelper::PointToPointPartitionHelper ()
+  : m_maxImbalance (1.1),
+    m_systemCount (0),
+    m_cutSize (0),
+    m_lookAhead (Time::Max ())
+{
+}
+
+void
+PointToPointPartitionHelper::SetNodeWeight (Ptr<Node> node, double weight)
+{
+  NS_LOG_FUNCTION (this << node << weight);
+  NS_ABORT_MSG_UNLESS (weight > 0, "the weight of a node must be positive");
+  m_weights[node->GetId ()] = weight;
+}
+
+void
+PointToPointPartitionHelper::SetMaxImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  NS_ABORT_MSG_UNLESS (imbalance >= 1, "the imbalance must be at least 1");
+  m_maxImbalance = imbalance;
+}
+
+void
+PointToPointPartitionHelper::BuildGraph (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes = nodes;
+  m_index.clear ();
+  m_load.clear ();
+  m_links.clear ();
+  m_together.clear ();
+
+  uint32_t n = nodes.GetN ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      m_index[node->GetId ()] = i;
+      m_together.push_back (i);
+      std::map<uint32_t, double>::const_iterator weight = m_weights.find (node->GetId ());
+      if (weight != m_weights.end ())
+        {
+          m_load.push_back (weight->second);
+        }
+      else
+        {
+          m_load.push_back (1.0 + node->GetNDevices () + node->GetNApplications ());
+        }
+    }
+
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          Ptr<PointToPointNetDevice> p2pDevice = DynamicCast<PointToPointNetDevice> (device);
+          if (p2pDevice != 0 && DynamicCast<PointToPointChannel> (channel) != 0
+              && channel->GetNDevices () == 2)
+            {
+              // Each link is seen from both ends: keep it once.
+              if (channel->GetDevice (0) != device)
+                {
+                  continue;
+                }
+              Ptr<PointToPointNetDevice> peer = DynamicCast<PointToPointNetDevice> (channel->GetDevice (1));
+              std::map<uint32_t, uint32_t>::const_iterator k = m_index.find (peer->GetNode ()->GetId ());
+              if (k == m_index.end ())
+                {
+                  continue;
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              Link link;
+              link.a = i;
+              link.b = k->second;
+              link.delay = delay.Get ().GetTimeStep ();
+              link.devA = p2pDevice;
+              link.devB = peer;
+              m_links.push_back (link);
+              continue;
+            }
+          // Other channels cannot be split: keep all their nodes together.
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<Node> peer = channel->GetDevice (k)->GetNode ();
+              std::map<uint32_t, uint32_t>::const_iterator other = m_index.find (peer->GetId ());
+              if (other != m_index.end ())
+                {
+                  UnionSets (m_together, i, other->second);
+                }
+            }
+        }
+    }
+  NS_LOG_LOGIC (n << " nodes, " << m_links.size () << " point-to-point links");
+}
+
+uint32_t
+PointToPointPartitionHelper::Contract (int64_t threshold, std::vector<uint32_t> &groups) const
+{
+  std::vector<uint32_t> parents = m_together;
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (l->delay < threshold)
+        {
+          UnionSets (parents, l->a, l->b);
+        }
+    }
+  uint32_t n = parents.size ();
+  std::vector<uint32_t> index (n, n);
+  uint32_t count = 0;
+  groups.resize (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t root = FindSet (parents, i);
+      if (index[root] == n)
+        {
+          index[root] = count++;
+        }
+      groups[i] = index[root];
+    }
+  return count;
+}
+
+std::vector<uint32_t>
+PointToPointPartitionHelper::Split (const std::vector<uint32_t> &groups, uint32_t nGroups,
+                                    uint32_t systemCount) const
+{
+  const uint32_t NONE = systemCount;
+
+  std::vector<double> groupLoad (nGroups, 0);
+  double total = 0;
+  for (uint32_t i = 0; i < groups.size (); ++i)
+    {
+      groupLoad[groups[i]] += m_load[i];
+      total += m_load[i];
+    }
+  // The number of links between each pair of groups.
+  std::vector<std::map<uint32_t, uint32_t> > adjacent (nGroups);
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      uint32_t ga = groups[l->a];
+      uint32_t gb = groups[l->b];
+      if (ga != gb)
+        {
+          adjacent[ga][gb]++;
+          adjacent[gb][ga]++;
+        }
+    }
+
+  double target = total / systemCount;
+  double maxLoad = m_maxImbalance * target;
+  std::vector<uint32_t> part (nGroups, NONE);
+  std::vector<double> partLoad (systemCount, 0);
+  std::vector<uint32_t> partSize (systemCount, 0);
+  uint32_t unassigned = nGroups;
+
+  // Grow the partitions one after the other, absorbing the group with
+  // the most links to the partition first.
+  std::vector<uint32_t> connection (nGroups, 0);
+  for (uint32_t p = 0; p + 1 < systemCount && unassigned > 0; ++p)
+    {
+      std::fill (connection.begin (), connection.end (), 0);
+      std::set<uint32_t> frontier;
+      while (partLoad[p] < target && unassigned > systemCount - 1 - p)
+        {
+          uint32_t best = NONE;
+          for (std::set<uint32_t>::const_iterator g = frontier.begin (); g != frontier.end (); ++g)
+            {
+              if (partLoad[p] + groupLoad[*g] > maxLoad)
+                {
+                  continue;
+                }
+              if (best == NONE || connection[*g] > connection[best]
+                  || (connection[*g] == connection[best] && groupLoad[*g] < groupLoad[best]))
+                {
+                  best = *g;
+                }
+            }
+          if (best == NONE)
+            {
+              // New seed: the heaviest group which fits.
+              for (uint32_t g = 0; g < nGroups; ++g)
+                {
+                  if (part[g] == NONE && (partSize[p] == 0 || partLoad[p] + groupLoad[g] <= maxLoad)
+                      && (best == NONE || groupLoad[g] > groupLoad[best]))
+                    {
+                      best = g;
+                    }
+                }
+              if (best == NONE)
+                {
+                  break;
+                }
+            }
+          part[best] = p;
+          partLoad[p] += groupLoad[best];
+          partSize[p]++;
+          unassigned--;
+          frontier.erase (best);
+          for (std::map<uint32_t, uint32_t>::const_iterator h = adjacent[best].begin ();
+               h != adjacent[best].end (); ++h)
+            {
+              if (part[h->first] == NONE)
+                {
+                  connection[h->first] += h->second;
+                  frontier.insert (h->first);
+                }
+            }
+        }
+    }
+  for (uint32_t g = 0; g < nGroups; ++g)
+    {
+      if (part[g] == NONE)
+        {
+          part[g] = systemCount - 1;
+          partLoad[systemCount - 1] += groupLoad[g];
+          partSize[systemCount - 1]++;
+        }
+    }
+
+  // Refine: move the groups whose move reduces the cut, or the load of
+  // an overloaded partition.
+  std::vector<int64_t> links (systemCount);
+  for (uint32_t pass = 0; pass < 16; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t g = 0; g < nGroups; ++g)
+        {
+          uint32_t from = part[g];
+          if (partSize[from] == 1)
+            {
+              continue;
+            }
+          std::fill (links.begin (), links.end (), 0);
+          for (std::map<uint32_t, uint32_t>::const_iterator h = adjacent[g].begin ();
+               h != adjacent[g].end (); ++h)
+            {
+              links[part[h->first]] += h->second;
+            }
+          bool overloaded = partLoad[from] > maxLoad;
+          uint32_t best = NONE;
+          int64_t bestGain = 0;
+          for (uint32_t q = 0; q < systemCount; ++q)
+            {
+              if (q == from || partLoad[q] + groupLoad[g] > maxLoad)
+                {
+                  continue;
+                }
+              int64_t gain = links[q] - links[from];
+              bool balances = partLoad[q] + groupLoad[g] < partLoad[from];
+              if (gain > 0 || (gain == 0 && balances) || overloaded)
+                {
+                  if (best == NONE || gain > bestGain)
+                    {
+                      best = q;
+                      bestGain = gain;
+                    }
+                }
+            }
+          if (best != NONE)
+            {
+              part[g] = best;
+              partLoad[from] -= groupLoad[g];
+              partLoad[best] += groupLoad[g];
+              partSize[from]--;
+              partSize[best]++;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+  return part;
+}
+
+void
+PointToPointPartitionHelper::Partition (NodeContainer nodes, uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "at least one partition is needed");
+  BuildGraph (nodes);
+  m_systemCount = systemCount;
+
+  uint32_t n = m_nodes.GetN ();
+  double total = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      total += m_load[i];
+    }
+  double maxLoad = m_maxImbalance * total / systemCount;
+
+  // Keep together the nodes of the links shorter than the largest
+  // delay for which the groups still fit in the partitions.
+  std::vector<int64_t> delays;
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (l->delay > 0)
+        {
+          delays.push_back (l->delay);
+        }
+    }
+  std::sort (delays.begin (), delays.end ());
+  delays.erase (std::unique (delays.begin (), delays.end ()), delays.end ());
+
+  std::vector<uint32_t> groups;
+  int64_t threshold = 1;
+  std::size_t low = 0;
+  std::size_t high = delays.size ();
+  while (low < high)
+    {
+      // Feasibility decreases with the threshold: find the largest one.
+      std::size_t middle = (low + high + 1) / 2;
+      uint32_t nGroups = Contract (delays[middle - 1], groups);
+      std::vector<double> groupLoad (nGroups, 0);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          groupLoad[groups[i]] += m_load[i];
+        }
+      if (nGroups >= systemCount
+          && *std::max_element (groupLoad.begin (), groupLoad.end ()) <= maxLoad)
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle - 1;
+        }
+    }
+  if (low > 0)
+    {
+      threshold = delays[low - 1];
+    }
+  uint32_t nGroups = Contract (threshold, groups);
+  NS_LOG_LOGIC ("links shorter than " << TimeStep (threshold) << " kept: " << nGroups << " groups");
+
+  std::vector<uint32_t> part = Split (groups, nGroups, systemCount);
+
+  m_systemIds.resize (n);
+  m_systemLoad.assign (systemCount, 0);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_systemIds[i] = part[groups[i]];
+      m_systemLoad[m_systemIds[i]] += m_load[i];
+    }
+  m_cutSize = 0;
+  m_lookAhead = Time::Max ();
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (m_systemIds[l->a] != m_systemIds[l->b])
+        {
+          m_cutSize++;
+          m_lookAhead = std::min (m_lookAhead, TimeStep (l->delay));
+        }
+    }
+}
+
+void
+PointToPointPartitionHelper::Assign (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_systemIds.size () != m_nodes.GetN () || m_nodes.GetN () == 0,
+                   "Partition must be called before Assign");
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      m_nodes.Get (i)->SetAttribute ("SystemId", UintegerValue (m_systemIds[i]));
+    }
+
+  // Same rule as PointToPointHelper::Install
+  bool enabled = MpiInterface::IsEnabled ();
+  uint32_t current = MpiInterface::GetSystemId ();
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      bool remote = enabled && (m_systemIds[l->a] != current || m_systemIds[l->b] != current);
+      bool isRemote = DynamicCast<PointToPointRemoteChannel> (l->devA->GetChannel ()) != 0;
+      if (remote != isRemote)
+        {
+          Reconnect (l->devA, l->devB, remote);
+        }
+    }
+}
+
+void
+PointToPointPartitionHelper::Reconnect (Ptr<PointToPointNetDevice> dev, Ptr<PointToPointNetDevice> peer,
+                                        bool remote)
+{
+  NS_LOG_FUNCTION (dev << peer << remote);
+  Ptr<PointToPointChannel> old = DynamicCast<PointToPointChannel> (dev->GetChannel ());
+  ObjectFactory factory;
+  factory.SetTypeId (remote ? "ns3::PointToPointRemoteChannel" : "ns3::PointToPointChannel");
+  TimeValue delay;
+  old->GetAttribute ("Delay", delay);
+  factory.Set ("Delay", delay);
+  Ptr<PointToPointChannel> channel = factory.Create<PointToPointChannel> ();
+
+  if (remote)
+    {
+      Ptr<PointToPointNetDevice> devices[2] = { dev, peer };
+      for (uint32_t i = 0; i < 2; ++i)
+        {
+          if (devices[i]->GetObject<MpiReceiver> () == 0)
+            {
+              Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+              receiver->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devices[i]));
+              devices[i]->AggregateObject (receiver);
+            }
+        }
+    }
+  // The old channel stays in the ChannelList: it must not refer to the
+  // devices any more.
+  old->Detach ();
+  dev->Attach (channel);
+  peer->Attach (channel);
+}
+
+uint32_t
+PointToPointPartitionHelper::GetSystemId (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator i = m_index.find (node->GetId ());
+  NS_ABORT_MSG_IF (i == m_index.end () || i->second >= m_systemIds.size (),
+                   "node " << node->GetId () << " was not partitioned");
+  return m_systemIds[i->second];
+}
+
+Time
+PointToPointPartitionHelper::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+uint32_t
+PointToPointPartitionHelper::GetCutSize (void) const
+{
+  return m_cutSize;
+}
+
+double
+PointToPointPartitionHelper::GetImbalance (void) const
+{
+  double total = 0;
+  double largest = 0;
+  for (std::vector<double>::const_iterator load = m_systemLoad.begin (); load != m_systemLoad.end (); ++load)
+    {
+      total += *load;
+      largest = std::max (largest, *load);
+    }
+  return total > 0 ? largest * m_systemLoad.size () / total : 1;
+}
+
+void
+PointToPointPartitionHelper::Print (std::ostream &os) const
+{
+  std::vector<uint32_t> sizes (m_systemCount, 0);
+  for (std::vector<uint32_t>::const_iterator i = m_systemIds.begin (); i != m_systemIds.end (); ++i)
+    {
+      sizes[*i]++;
+    }
+  os << "Partition of " << m_systemIds.size () << " nodes into " << m_systemCount
+     << " systems" << std::endl;
+  for (uint32_t s = 0; s < m_systemCount; ++s)
+    {
+      os << "  system " << s << ": " << sizes[s] << " nodes, load " << m_systemLoad[s] << std::endl;
+    }
+  os << "  imbalance: " << GetImbalance () << std::endl;
+  os << "  links cut: " << m_cutSize << " of " << m_links.size () << std::endl;
+  os << "  predicted lookahead: ";
+  if (m_cutSize == 0)
+    {
+      os << "unlimited";
+    }
+  else
+    {
+      os << m_lookAhead.As (Time::MS);
+    }
+  os << std::endl;
+}
+
+} // namespace ns3
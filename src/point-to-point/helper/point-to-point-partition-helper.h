@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef POINT_TO_POINT_PARTITION_HELPER_H
+#define POINT_TO_POINT_PARTITION_HELPER_H
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class PointToPointNetDevice;
+
+/**
+ * \brief Split a topology into partitions for a parallel simulation
+ * along its point-to-point links, and assign the node system ids.
+ *
+ * The partitions are computed on the graph of the nodes of a
+ * NodeContainer, whose edges are the point-to-point links built by
+ * PointToPointHelper.  The nodes attached to any other channel (CSMA,
+ * wifi, ...) are always kept in the same partition, as are the nodes
+ * of zero-delay links.
+ *
+ * The lookahead of a parallel run is the smallest delay of the links
+ * cut between partitions.  Partition() first looks for the largest
+ * delay such that the nodes connected by shorter links can still be
+ * spread over the partitions within the allowed imbalance, and keeps
+ * those nodes together.  It then splits the remaining groups with a
+ * minimum cut heuristic: the partitions are grown one after the other
+ * from a seed, absorbing the most connected neighbors first, and the
+ * result is refined by moving the boundary groups which reduce the
+ * number of cut links.
+ *
+ * The partitions are balanced by the estimated event load of their
+ * nodes.  By default the load of a node is 1 plus its number of
+ * devices and applications; it can be set with SetNodeWeight().
+ *
+ * Assign() sets the SystemId of the nodes, and replaces the channels
+ * of the links which must now be remote by PointToPointRemoteChannel
+ * objects (and the reverse), following the rule of
+ * PointToPointHelper::Install.  It must be called after
+ * MpiInterface::Enable and before Ipv4GlobalRoutingHelper::PopulateRoutingTables
+ * and Simulator::Run.
+ *
+ * \code
+ *   PointToPointPartitionHelper partition;
+ *   partition.Partition (NodeContainer::GetGlobal (), MpiInterface::GetSize ());
+ *   partition.Print (std::cout);
+ *   partition.Assign ();
+ * \endcode
+ */
+class PointToPointPartitionHelper
+{
+public:
+  /**
+   * Create a PointToPointPartitionHelper.
+   */
+  PointToPointPartitionHelper ();
+
+  /**
+   * \param node a node
+   * \param weight the estimated event load of the node, > 0
+   *
+   * Override the default load of a node.
+   */
+  void SetNodeWeight (Ptr<Node> node, double weight);
+
+  /**
+   * \param imbalance the maximum ratio of the load of a partition to
+   *        the mean load of the partitions, >= 1; 1.1 by default
+   */
+  void SetMaxImbalance (double imbalance);
+
+  /**
+   * \param nodes the nodes to partition
+   * \param systemCount the number of partitions
+   *
+   * Compute the partition of the nodes.  The system ids of the nodes
+   * are not changed until Assign() is called.
+   */
+  void Partition (NodeContainer nodes, uint32_t systemCount);
+
+  /**
+   * Set the system id of the partitioned nodes, and make the channels
+   * of the links between partitions remote.
+   */
+  void Assign (void) const;
+
+  /**
+   * \param node a partitioned node
+   * \return the system id computed for the node
+   */
+  uint32_t GetSystemId (Ptr<Node> node) const;
+
+  /**
+   * \return the predicted lookahead: the smallest delay of the links
+   *         between partitions, or the maximum time if there is none
+   */
+  Time GetLookAhead (void) const;
+
+  /**
+   * \return the number of point-to-point links between partitions
+   */
+  uint32_t GetCutSize (void) const;
+
+  /**
+   * \return the ratio of the largest partition load to the mean
+   *         partition load
+   */
+  double GetImbalance (void) const;
+
+  /**
+   * \param os the output stream
+   *
+   * Print the partition sizes and loads, the cut size and the
+   * predicted lookahead.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** A point-to-point link between two partitioned nodes. */
+  struct Link
+  {
+    uint32_t a;                      //!< Index of the first node.
+    uint32_t b;                      //!< Index of the second node.
+    int64_t delay;                   //!< The link delay, in time steps.
+    Ptr<PointToPointNetDevice> devA; //!< The device of the first node.
+    Ptr<PointToPointNetDevice> devB; //!< The device of the second node.
+  };
+
+  /**
+   * \param nodes the nodes to partition
+   *
+   * Build the node, link and always-together groups of the graph.
+   */
+  void BuildGraph (NodeContainer nodes);
+
+  /**
+   * \param threshold the links shorter than this must not be cut
+   * \param groups [out] the group of each node
+   * \return the number of groups
+   */
+  uint32_t Contract (int64_t threshold, std::vector<uint32_t> &groups) const;
+
+  /**
+   * \param groups the group of each node
+   * \param nGroups the number of groups
+   * \param systemCount the number of partitions
+   * \return the partition of each group
+   */
+  std::vector<uint32_t> Split (const std::vector<uint32_t> &groups, uint32_t nGroups,
+                               uint32_t systemCount) const;
+
+  /**
+   * \param dev the first device of the link
+   * \param peer the second device of the link
+   * \param remote whether the link must use a remote channel
+   *
+   * Replace the channel of a link by a channel of the other kind.
+   */
+  static void Reconnect (Ptr<PointToPointNetDevice> dev, Ptr<PointToPointNetDevice> peer,
+                         bool remote);
+
+  std::map<uint32_t, double> m_weights; //!< Node load overrides, by node id.
+  double m_maxImbalance;                //!< The allowed imbalance.
+
+  NodeContainer m_nodes;                //!< The partitioned nodes.
+  std::map<uint32_t, uint32_t> m_index; //!< Index of each node, by node id.
+  std::vector<double> m_load;           //!< Load of each node.
+  std::vector<Link> m_links;            //!< The point-to-point links.
+  std::vector<uint32_t> m_together;     //!< Union-find parents for the nodes which must stay together.
+
+  uint32_t m_systemCount;               //!< The number of partitions.
+  std::vector<uint32_t> m_systemIds;    //!< System id of each node.
+  std::vector<double> m_systemLoad;     //!< Load of each partition.
+  uint32_t m_cutSize;                   //!< Number of links cut.
+  Time m_lookAhead;                     //!< Smallest delay of the links cut.
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_PARTITION_HELPER_H */
@@ -83,6 +83,17 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
     }
 }
 
+void
+PointToPointChannel::Detach (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::size_t i = 0; i < N_DEVICES; ++i)
+    {
+      m_link[i] = Link ();
+    }
+  m_nDevices = 0;
+}
+
 bool
 PointToPointChannel::TransmitStart (
   Ptr<const Packet> p,
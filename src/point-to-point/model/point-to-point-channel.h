@@ -69,7 +69,15 @@ public:
    * \brief Attach a given netdevice to this channel
    * \param device pointer to the netdevice to attach to the channel
    */
-  void Attach (Ptr<PointToPointNetDevice> device);
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Detach the devices from this channel
+   *
+   * The channel no longer refers to its devices, which must be attached
+   * to another channel.
+   */
+  virtual void Detach (void);
 
   /**
    * \brief Transmit a packet over this channel
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/segment-offload-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -248,7 +249,15 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  // A segmentation-offload super-segment is serialized as the burst of its
+  // segments, each one with a copy of the headers
+  uint32_t wireSize = p->GetSize ();
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      wireSize = offloadTag.GetWireSize (wireSize);
+    }
+  Time txTime = m_bps.CalculateBytesTxTime (wireSize);
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -605,6 +614,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSegmentOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
@@ -189,6 +189,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentOffload (void) const;
 
 protected:
   /**
@@ -258,7 +259,9 @@ private:
    * the channel.  The corresponding method is called on the channel to let
    * it know that the physical device this class represents has virtually
    * started sending signals.  An event is scheduled for the time at which
-   * the bits have been completely transmitted.
+   * the bits have been completely transmitted.  A packet carrying a
+   * SegmentOffloadTag is transmitted in the time of the burst of its
+   * segments.
    *
    * \see PointToPointChannel::TransmitStart ()
    * \see TransmitComplete()
@@ -25,6 +25,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/mpi-interface.h"
 
 namespace ns3 {
@@ -45,7 +46,8 @@ PointToPointRemoteChannel::GetTypeId (void)
 }
 
 PointToPointRemoteChannel::PointToPointRemoteChannel ()
-  : PointToPointChannel ()
+  : PointToPointChannel (),
+    m_cached (false)
 {
 }
 
@@ -53,6 +55,45 @@ PointToPointRemoteChannel::~PointToPointRemoteChannel ()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  PointToPointChannel::Attach (device);
+  CacheLinks ();
+}
+
+void
+PointToPointRemoteChannel::Detach (void)
+{
+  NS_LOG_FUNCTION (this);
+  PointToPointChannel::Detach ();
+  m_cached = false;
+}
+
+bool
+PointToPointRemoteChannel::CacheLinks (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNDevices () < 2)
+    {
+      return false;
+    }
+  for (uint32_t wire = 0; wire < 2; ++wire)
+    {
+      Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+      if (dst->GetNode () == 0)
+        {
+          return false;
+        }
+      m_src[wire] = PeekPointer (GetSource (wire));
+      m_dstNode[wire] = dst->GetNode ()->GetId ();
+      m_dstIfIndex[wire] = dst->GetIfIndex ();
+    }
+  m_cached = true;
+  return true;
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart (
   Ptr<const Packet> p,
@@ -63,17 +104,17 @@ PointToPointRemoteChannel::TransmitStart (
   NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
 
   IsInitialized ();
+  if (!m_cached)
+    {
+      // the devices were attached before being added to their nodes
+      NS_ABORT_MSG_UNLESS (CacheLinks (), "Remote channel devices must be installed on nodes");
+    }
 
-  uint32_t wire = src == GetSource (0) ? 0 : 1;
-  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+  uint32_t wire = PeekPointer (src) == m_src[0] ? 0 : 1;
 
-#ifdef NS3_MPI
   // Calculate the rxTime (absolute)
   Time rxTime = Simulator::Now () + txTime + GetDelay ();
-  MpiInterface::SendPacket (p->Copy (), rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  MpiInterface::SendPacket (p->Copy (), rxTime, m_dstNode[wire], m_dstIfIndex[wire]);
   return true;
 }
 
@@ -20,7 +20,7 @@
 
 // This object connects two point-to-point net devices where at least one
 // is not local to this simulator object.  It simply over-rides the transmit
-// method and uses an MPI Send operation instead.
+// method and uses the parallel communication interface instead.
 
 #ifndef POINT_TO_POINT_REMOTE_CHANNEL_H
 #define POINT_TO_POINT_REMOTE_CHANNEL_H
@@ -36,7 +36,12 @@ namespace ns3 {
  * 
  * This object connects two point-to-point net devices where at least one
  * is not local to this simulator object. It simply override the transmit
- * method and uses an MPI Send operation instead.
+ * method and uses an MPI Send operation instead, or an in-memory queue
+ * when the partitions are run as threads of a single process.
+ *
+ * The identifiers of the destination node and device of each direction
+ * are recorded when the second device is attached, so that transmitting
+ * never touches the remote device, which may be owned by another thread.
  */
 class PointToPointRemoteChannel : public PointToPointChannel
 {
@@ -58,6 +63,9 @@ public:
    */
   ~PointToPointRemoteChannel ();
 
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
+  virtual void Detach (void);
+
   /**
    * \brief Transmit the packet
    *
@@ -68,6 +76,23 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+private:
+  /**
+   * \brief Record the source device and the destination node and device
+   * of each direction.
+   * \returns true if both devices are attached and installed on a node
+   */
+  bool CacheLinks (void);
+
+  /** Whether the links have been recorded. */
+  bool m_cached;
+  /** The source device of each direction. */
+  const PointToPointNetDevice *m_src[2];
+  /** The destination node id of each direction. */
+  uint32_t m_dstNode[2];
+  /** The destination device index of each direction. */
+  uint32_t m_dstIfIndex[2];
 };
 
 } // namespace ns3
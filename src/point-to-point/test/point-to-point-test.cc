@@ -23,7 +23,22 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/channel-list.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/node-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-partition-helper.h"
+#include "ns3/string.h"
+#include "ns3/data-rate.h"
+#include "ns3/segment-offload-tag.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <set>
 
 using namespace ns3;
 
@@ -94,6 +109,410 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for PointToPointPartitionHelper
+ *
+ * Two stars of short links joined by a long link between their hubs
+ * must be split on the long link, unless more partitions than stars
+ * are requested.
+ */
+class PointToPointPartitionTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPartitionTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+};
+
+PointToPointPartitionTest::PointToPointPartitionTest ()
+  : TestCase ("PointToPointPartition")
+{
+}
+
+void
+PointToPointPartitionTest::DoRun (void)
+{
+  NodeContainer hubs;
+  hubs.Create (2);
+  NodeContainer leaves[2];
+  PointToPointHelper shortLink;
+  shortLink.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper longLink;
+  longLink.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  longLink.Install (hubs);
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      leaves[i].Create (3);
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+          shortLink.Install (hubs.Get (i), leaves[i].Get (j));
+        }
+    }
+  NodeContainer all (hubs, leaves[0], leaves[1]);
+
+  PointToPointPartitionHelper partition;
+  partition.Partition (all, 2);
+  NS_TEST_EXPECT_MSG_EQ (partition.GetCutSize (), 1, "only the link between the hubs is cut");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MilliSeconds (10), "lookahead of the long link");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetImbalance (), 1, "both stars have the same load");
+  NS_TEST_EXPECT_MSG_NE (partition.GetSystemId (hubs.Get (0)), partition.GetSystemId (hubs.Get (1)),
+                         "the hubs are in different partitions");
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (leaves[i].Get (j)), partition.GetSystemId (hubs.Get (i)),
+                                 "a leaf is in the partition of its hub");
+        }
+    }
+
+  partition.Assign ();
+  for (uint32_t i = 0; i < all.GetN (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (all.Get (i)->GetSystemId (), partition.GetSystemId (all.Get (i)),
+                             "system id assigned");
+    }
+
+  // More partitions than stars: the short links must be cut too.
+  partition.Partition (all, 4);
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MilliSeconds (1), "lookahead of the short links");
+  NS_TEST_EXPECT_MSG_GT (partition.GetCutSize (), 1, "short links cut");
+
+  // With the remote links enabled, the link between the hubs must be
+  // replaced by a remote link, and the replaced channels must not refer
+  // to the devices any more.
+  TypeId tid;
+  if (TypeId::LookupByNameFailSafe ("ns3::MultithreadedSimulatorImpl", &tid))
+    {
+      StringValue type;
+      GlobalValue::GetValueByName ("SimulatorImplementationType", type);
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+      MpiInterface::Enable (0, 0);
+      GlobalValue::Bind ("SimulatorImplementationType", type);
+
+      partition.Partition (all, 2);
+      partition.Assign ();
+      NS_TEST_EXPECT_MSG_NE (DynamicCast<PointToPointRemoteChannel> (hubs.Get (0)->GetDevice (0)->GetChannel ()), 0,
+                             "remote link between the hubs");
+      for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+        {
+          for (std::size_t j = 0; j < (*i)->GetNDevices (); ++j)
+            {
+              NS_TEST_EXPECT_MSG_EQ ((*i)->GetDevice (j)->GetChannel (), *i, "replaced channel still attached");
+            }
+        }
+      MpiInterface::Disable ();
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for the segmentation offload of PointToPointNetDevice
+ *
+ * A super-segment must take the time of the burst of its segments, each one
+ * with a copy of the headers of the super-segment.
+ */
+class PointToPointOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointOffloadTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a super-segment to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendSuperSegment (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Time m_rxTime; //!< Time of the reception
+};
+
+PointToPointOffloadTest::PointToPointOffloadTest ()
+  : TestCase ("PointToPointOffload")
+{
+}
+
+void
+PointToPointOffloadTest::SendSuperSegment (Ptr<PointToPointNetDevice> device)
+{
+  // 4 segments of 1000 bytes behind 40 bytes of headers
+  Ptr<Packet> p = Create<Packet> (4040);
+  p->AddPacketTag (SegmentOffloadTag (1000, 4000));
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointOffloadTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_rxTime = Simulator::Now ();
+  return true;
+}
+
+void
+PointToPointOffloadTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointOffloadTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointOffloadTest::SendSuperSegment, this, devA);
+
+  Simulator::Run ();
+
+  // Each of the 4 segments carries the 40 bytes of headers and the 2 bytes of
+  // the PPP header: 4168 bytes at 1 byte per microsecond
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_rxTime, Seconds (1.0) + MicroSeconds (4168), NanoSeconds (1),
+                             "burst time of the super-segment");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for the remote links of MultithreadedSimulatorImpl
+ *
+ * Packets are forwarded both ways along a chain of four nodes, whose
+ * halves are run by two threads and joined by a remote link, over two
+ * calls to Simulator::Run.  The packets must be received at the same
+ * times as with DefaultSimulatorImpl, the runs must be deterministic,
+ * and the uids of the packets and of the events must be unique.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /// The time and size of the packets received, by node
+  typedef std::vector<std::vector<std::pair<int64_t, uint32_t> > > Receptions;
+
+  /**
+   * \brief Run the chain of nodes
+   *
+   * \param simulatorType the simulator implementation
+   * \param receptions [out] the packets received
+   * \param packetUids [out] the uids of the packets received by the ends of the chain
+   * \param eventUids [out] the uids of the events scheduled by the ends of the chain
+   */
+  void RunChain (std::string simulatorType, Receptions &receptions,
+                 std::vector<uint64_t> &packetUids, std::vector<uint32_t> &eventUids);
+
+  /**
+   * \brief Send a packet, and schedule the next one
+   *
+   * \param device the sending device
+   * \param size the packet size
+   */
+  void Send (Ptr<NetDevice> device, uint32_t size);
+
+  /**
+   * \brief Receive a packet, and forward it in the middle of the chain
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Receptions m_receptions;                          //!< The packets received, by node
+  std::vector<std::vector<uint64_t> > m_packetUids; //!< The uids of the packets received, by node
+  std::vector<std::vector<uint32_t> > m_eventUids;  //!< The uids of the events scheduled, by node
+  uint32_t m_firstUid;                              //!< The packet uid counter of the main thread at the start
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPointMultithreaded")
+{
+}
+
+void
+PointToPointMultithreadedTest::Send (Ptr<NetDevice> device, uint32_t size)
+{
+  // Each node is only used by the thread of its partition.
+  uint32_t node = device->GetNode ()->GetId ();
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+  EventId next = Simulator::Schedule (MilliSeconds (node == 0 ? 3 : 7), &PointToPointMultithreadedTest::Send,
+                                      this, device, 100 + (size * 7) % 1400);
+  m_eventUids[node].push_back (next.GetUid ());
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  Ptr<Node> node = device->GetNode ();
+  m_receptions[node->GetId ()].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), p->GetSize ()));
+  if (node->GetNDevices () == 2)
+    {
+      Ptr<NetDevice> out = node->GetDevice (1 - device->GetIfIndex ());
+      out->Send (p->Copy (), out->GetBroadcast (), protocol);
+    }
+  else
+    {
+      // The uid counter of the main thread, which runs the system id 0,
+      // is not reset between the simulations.
+      uint64_t uid = p->GetUid ();
+      m_packetUids[node->GetId ()].push_back ((uid >> 32) == 0 ? uid - m_firstUid : uid);
+    }
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::RunChain (std::string simulatorType, Receptions &receptions,
+                                         std::vector<uint64_t> &packetUids, std::vector<uint32_t> &eventUids)
+{
+  bool multithreaded = simulatorType == "ns3::MultithreadedSimulatorImpl";
+  ObjectFactory factory;
+  factory.SetTypeId (simulatorType);
+  if (multithreaded)
+    {
+      factory.Set ("ThreadCount", UintegerValue (2));
+    }
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  if (multithreaded)
+    {
+      // MpiInterface::Enable selects the interface of the simulator type.
+      StringValue type;
+      GlobalValue::GetValueByName ("SimulatorImplementationType", type);
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue (simulatorType));
+      MpiInterface::Enable (0, 0);
+      GlobalValue::Bind ("SimulatorImplementationType", type);
+    }
+
+  m_receptions.assign (4, Receptions::value_type ());
+  m_packetUids.assign (4, std::vector<uint64_t> ());
+  m_firstUid = Packet::GetUidCounter ();
+  m_eventUids.assign (4, std::vector<uint32_t> ());
+
+  NodeContainer nodes;
+  nodes.Create (2, 0);
+  nodes.Create (2, 1);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      p2p.SetChannelAttribute ("Delay", StringValue (i == 1 ? "5ms" : "1ms"));
+      NetDeviceContainer devices = p2p.Install (nodes.Get (i), nodes.Get (i + 1));
+      devices.Get (0)->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+      devices.Get (1)->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+    }
+  Simulator::ScheduleWithContext (0, MicroSeconds (100), &PointToPointMultithreadedTest::Send,
+                                  this, nodes.Get (0)->GetDevice (0), 500);
+  Simulator::ScheduleWithContext (3, MicroSeconds (1300), &PointToPointMultithreadedTest::Send,
+                                  this, nodes.Get (3)->GetDevice (0), 1000);
+
+  Simulator::Stop (Seconds (0.2));
+  Simulator::Run ();
+  Simulator::Stop (Seconds (0.2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  if (multithreaded)
+    {
+      MpiInterface::Disable ();
+    }
+
+  receptions = m_receptions;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      // Only the order of simultaneous receptions may differ.
+      std::sort (receptions[i].begin (), receptions[i].end ());
+    }
+  packetUids = m_packetUids[0];
+  packetUids.insert (packetUids.end (), m_packetUids[3].begin (), m_packetUids[3].end ());
+  eventUids = m_eventUids[0];
+  eventUids.insert (eventUids.end (), m_eventUids[3].begin (), m_eventUids[3].end ());
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::MultithreadedSimulatorImpl", &tid))
+    {
+      // Built without thread support.
+      return;
+    }
+
+  Receptions expected;
+  std::vector<uint64_t> expectedPacketUids;
+  std::vector<uint32_t> expectedEventUids;
+  RunChain ("ns3::DefaultSimulatorImpl", expected, expectedPacketUids, expectedEventUids);
+  NS_TEST_ASSERT_MSG_GT (expected[0].size (), 50, "packets received by node 0");
+  NS_TEST_ASSERT_MSG_GT (expected[3].size (), 100, "packets received by node 3");
+
+  Receptions first;
+  std::vector<uint64_t> firstPacketUids;
+  std::vector<uint32_t> firstEventUids;
+  RunChain ("ns3::MultithreadedSimulatorImpl", first, firstPacketUids, firstEventUids);
+  Receptions second;
+  std::vector<uint64_t> secondPacketUids;
+  std::vector<uint32_t> secondEventUids;
+  RunChain ("ns3::MultithreadedSimulatorImpl", second, secondPacketUids, secondEventUids);
+
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((first[i] == expected[i]), true,
+                             "packets received by node " << i << " differ from DefaultSimulatorImpl");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((second == first), true, "the packets received differ between two runs");
+  NS_TEST_EXPECT_MSG_EQ ((secondPacketUids == firstPacketUids), true, "the packet uids differ between two runs");
+  NS_TEST_EXPECT_MSG_EQ ((secondEventUids == firstEventUids), true, "the event uids differ between two runs");
+
+  std::set<uint64_t> packetUids (firstPacketUids.begin (), firstPacketUids.end ());
+  NS_TEST_EXPECT_MSG_EQ (packetUids.size (), firstPacketUids.size (), "duplicate packet uids");
+  std::set<uint32_t> eventUids (firstEventUids.begin (), firstEventUids.end ());
+  NS_TEST_EXPECT_MSG_EQ (eventUids.size (), firstEventUids.size (), "duplicate event uids");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +529,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPartitionTest, TestCase::QUICK);
+  AddTestCase (new PointToPointOffloadTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -94,6 +95,64 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+double
+PropagationLossModel::GetMaxRxPower (double txPowerDbm, double distance) const
+{
+  double self = DoGetMaxRxPower (txPowerDbm, distance);
+  if (m_next != 0)
+    {
+      self = m_next->GetMaxRxPower (self, distance);
+    }
+  return self;
+}
+
+double
+PropagationLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
+double
+PropagationLossModel::GetRange (double txPowerDbm, double rxPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << txPowerDbm << rxPowerDbm);
+  // keep a margin with the given power, so that the rounding errors of
+  // CalcRxPower can not bring a node beyond the range above it
+  double threshold = rxPowerDbm - 1e-6;
+  const double maxRange = 1e9;
+  if (!(GetMaxRxPower (txPowerDbm, maxRange) < threshold))
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (GetMaxRxPower (txPowerDbm, 0) < threshold)
+    {
+      return 0;
+    }
+  // the bound does not increase with the distance: double the distance
+  // until the bound is below the threshold, then bisect
+  double low = 0;
+  double high = 1;
+  while (!(GetMaxRxPower (txPowerDbm, high) < threshold))
+    {
+      low = high;
+      high *= 2;
+    }
+  while (high - low > 1e-6 * high)
+    {
+      double middle = (low + high) / 2;
+      if (GetMaxRxPower (txPowerDbm, middle) < threshold)
+        {
+          high = middle;
+        }
+      else
+        {
+          low = middle;
+        }
+    }
+  NS_LOG_DEBUG ("range=" << high << "m");
+  return high;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -277,6 +336,20 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  // the loss of DoCalcRxPower increases with the distance
+  if (distance <= 0)
+    {
+      return txPowerDbm - m_minLoss;
+    }
+  double numerator = m_lambda * m_lambda;
+  double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+  double lossDb = -10 * log10 (numerator / denominator);
+  return txPowerDbm - std::max (lossDb, m_minLoss);
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -540,6 +613,22 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  if (m_exponent < 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (distance <= m_referenceDistance)
+    {
+      return txPowerDbm - m_referenceLoss;
+    }
+  double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+  double rxc = -m_referenceLoss - pathLossDb;
+  return txPowerDbm + rxc;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +731,45 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  // the loss of DoCalcRxPower increases with the distance only with
+  // ordered fields, positive exponents and a positive reference loss
+  if (m_referenceLoss < 0 || m_exponent0 < 0 || m_exponent1 < 0 || m_exponent2 < 0
+      || m_distance0 > m_distance1 || m_distance1 > m_distance2)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+
+  double pathLossDb;
+
+  if (distance < m_distance0)
+    {
+      pathLossDb = 0;
+    }
+  else if (distance < m_distance1)
+    {
+      pathLossDb = m_referenceLoss
+        + 10 * m_exponent0 * std::log10 (distance / m_distance0);
+    }
+  else if (distance < m_distance2)
+    {
+      pathLossDb = m_referenceLoss
+        + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0)
+        + 10 * m_exponent1 * std::log10 (distance / m_distance1);
+    }
+  else
+    {
+      pathLossDb = m_referenceLoss
+        + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0)
+        + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1)
+        + 10 * m_exponent2 * std::log10 (distance / m_distance2);
+    }
+
+  return txPowerDbm - pathLossDb;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -804,6 +932,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FixedRssLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  return m_rss;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -930,6 +1064,19 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRxPower (double txPowerDbm, double distance) const
+{
+  if (distance <= m_range)
+    {
+      return txPowerDbm;
+    }
+  else
+    {
+      return -1000;
+    }
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
@@ -106,6 +106,21 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns a distance beyond which the Rx power computed by CalcRxPower
+   * is lower than the given power, whatever the positions of the nodes.
+   *
+   * Channels use it to skip the receivers which are out of the range of
+   * a transmitter without computing their Rx power.  The range is infinite
+   * when one of the chained models does not bound its Rx power (e.g., the
+   * models with random fading).
+   *
+   * \param txPowerDbm the transmission power (in dBm)
+   * \param rxPowerDbm the reception power (in dBm)
+   * \returns the range (in meters), possibly infinite
+   */
+  double GetRange (double txPowerDbm, double rxPowerDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +155,31 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns an upper bound of the Rx power taking into account all the
+   * PropagationLossModel(s) chained to the current one, for the nodes at
+   * the given distance or beyond.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance between the nodes (in meters)
+   * \returns the upper bound of the reception power (in dBm)
+   */
+  double GetMaxRxPower (double txPowerDbm, double distance) const;
+
+  /**
+   * Returns an upper bound of the Rx power taking into account only the
+   * particular PropagationLossModel, for the nodes at the given distance
+   * or beyond.  The bound must not increase with the distance, nor
+   * decrease with the transmission power.
+   *
+   * The default implementation returns infinity, i.e., no bound.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the distance between the nodes (in meters)
+   * \returns the upper bound of the reception power (in dBm)
+   */
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +362,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +571,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +655,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -747,6 +790,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -852,6 +896,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRxPower (double txPowerDbm, double distance) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
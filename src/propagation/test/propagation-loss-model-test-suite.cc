@@ -24,6 +24,7 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
+#include <limits>
 
 using namespace ns3;
 
@@ -436,6 +437,89 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class PropagationLossModelRangeTestCase : public TestCase
+{
+public:
+  PropagationLossModelRangeTestCase ();
+  virtual ~PropagationLossModelRangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the Rx power is below the threshold just beyond the range,
+   * and above it just within the range.
+   * \param lossModel the loss model
+   * \param txPowerDbm the Tx power
+   * \param rxPowerDbm the threshold
+   */
+  void CheckRange (Ptr<PropagationLossModel> lossModel, double txPowerDbm, double rxPowerDbm);
+};
+
+PropagationLossModelRangeTestCase::PropagationLossModelRangeTestCase ()
+  : TestCase ("Test the range of the chains of propagation loss models")
+{
+}
+
+PropagationLossModelRangeTestCase::~PropagationLossModelRangeTestCase ()
+{
+}
+
+void
+PropagationLossModelRangeTestCase::CheckRange (Ptr<PropagationLossModel> lossModel,
+                                               double txPowerDbm, double rxPowerDbm)
+{
+  double range = lossModel->GetRange (txPowerDbm, rxPowerDbm);
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (range * 1.0001, 0, 0));
+  NS_TEST_EXPECT_MSG_LT (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "Rx power too high beyond the range " << range);
+  b->SetPosition (Vector (range * 0.999, 0, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (lossModel->CalcRxPower (txPowerDbm, a, b), rxPowerDbm, "Rx power too low within the range " << range);
+}
+
+void
+PropagationLossModelRangeTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  CheckRange (friis, 16.0206, -96);
+
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  CheckRange (logDistance, 16.0206, -101);
+  CheckRange (logDistance, 0, -90);
+
+  Ptr<ThreeLogDistancePropagationLossModel> threeLogDistance = CreateObject<ThreeLogDistancePropagationLossModel> ();
+  CheckRange (threeLogDistance, 20, -94);
+
+  // the models of a chain add their losses
+  Ptr<FriisPropagationLossModel> chain = CreateObject<FriisPropagationLossModel> ();
+  chain->SetNext (CreateObject<LogDistancePropagationLossModel> ());
+  CheckRange (chain, 20, -150);
+  NS_TEST_EXPECT_MSG_LT (chain->GetRange (20, -150), friis->GetRange (20, -150), "The chain should have a smaller range");
+
+  // the signal is lost beyond the range of a RangePropagationLossModel
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  range->SetAttribute ("MaxRange", DoubleValue (127.2));
+  NS_TEST_EXPECT_MSG_EQ_TOL (range->GetRange (-80, -100), 127.2, 1e-3, "Wrong range");
+  NS_TEST_EXPECT_MSG_EQ (range->GetRange (-80, -2000), std::numeric_limits<double>::infinity (), "The Rx power of -1000 dBm is above the threshold");
+
+  // the fading models do not bound the Rx power, but a model after them may
+  Ptr<NakagamiPropagationLossModel> nakagami = CreateObject<NakagamiPropagationLossModel> ();
+  NS_TEST_EXPECT_MSG_EQ (nakagami->GetRange (20, -100), std::numeric_limits<double>::infinity (), "Nakagami should not have a range");
+  logDistance->SetNext (nakagami);
+  NS_TEST_EXPECT_MSG_EQ (logDistance->GetRange (20, -100), std::numeric_limits<double>::infinity (), "The chain should not have a range");
+  nakagami->SetNext (range);
+  NS_TEST_EXPECT_MSG_EQ_TOL (logDistance->GetRange (20, -100), 127.2, 1e-3, "Wrong range of the chain");
+
+  // a fixed Rx power is within or beyond all the ranges
+  Ptr<FixedRssLossModel> fixedRss = CreateObject<FixedRssLossModel> ();
+  fixedRss->SetRss (-80);
+  NS_TEST_EXPECT_MSG_EQ (fixedRss->GetRange (20, -90), std::numeric_limits<double>::infinity (), "Wrong range with a fixed Rx power");
+  NS_TEST_EXPECT_MSG_EQ (fixedRss->GetRange (20, -70), 0, "Wrong range with a fixed Rx power");
+
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +534,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new PropagationLossModelRangeTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iostream>
 #include <utility>
+#include <limits>
 #include <ns3/object.h>
 #include <ns3/simulator.h>
 #include <ns3/log.h>
@@ -69,7 +70,8 @@ std::ostream& operator<< (std::ostream& lhs, TxSpectrumModelInfoMap_t& rhs)
 }
 
 TxSpectrumModelInfo::TxSpectrumModelInfo (Ptr<const SpectrumModel> txSpectrumModel)
-  : m_txSpectrumModel (txSpectrumModel)
+  : m_txSpectrumModel (txSpectrumModel),
+    m_maxConvertedPsds (16)
 {
 }
 
@@ -90,6 +92,8 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_indexedPhys.clear ();
+  m_index.Clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -116,6 +120,9 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
+  // the SpectrumPhy instances are indexed again at the next transmission
+  m_indexedPhys.clear ();
+
   // remove a previous entry of this phy if it exists
   // we need to scan for all rxSpectrumModel values since we don't
   // know which spectrum model the phy had when it was previously added
@@ -144,25 +151,8 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       ret = m_rxSpectrumModelInfoMap.insert (std::make_pair (rxSpectrumModelUid, RxSpectrumModelInfo (rxSpectrumModel)));
       NS_ASSERT (ret.second);
       // also add the phy to the newly created set of SpectrumPhy for this RxSpectrumModel
+      // (the converters from the TX spectrum models are created when they are first needed)
       ret.first->second.m_rxPhys.push_back (phy);
-
-      // and create the necessary converters for all the TX spectrum models that we know of
-      for (TxSpectrumModelInfoMap_t::iterator txInfoIterator = m_txSpectrumModelInfoMap.begin ();
-           txInfoIterator != m_txSpectrumModelInfoMap.end ();
-           ++txInfoIterator)
-        {
-          Ptr<const SpectrumModel> txSpectrumModel = txInfoIterator->second.m_txSpectrumModel;
-          SpectrumModelUid_t txSpectrumModelUid = txSpectrumModel->GetUid ();
-
-          if (rxSpectrumModelUid != txSpectrumModelUid && !txSpectrumModel->IsOrthogonal (*rxSpectrumModel))
-            {
-              NS_LOG_LOGIC ("Creating converter between SpectrumModelUid " << txSpectrumModel->GetUid () << " and " << rxSpectrumModelUid);
-              SpectrumConverter converter (txSpectrumModel, rxSpectrumModel);
-              std::pair<SpectrumConverterMap_t::iterator, bool> ret2;
-              ret2 = txInfoIterator->second.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid, converter));
-              NS_ASSERT (ret2.second);
-            }
-        }
     }
   else
     {
@@ -171,7 +161,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
     }
 }
 
-TxSpectrumModelInfoMap_t::const_iterator
+TxSpectrumModelInfoMap_t::iterator
 MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel)
 {
   NS_LOG_FUNCTION (this << txSpectrumModel);
@@ -186,31 +176,86 @@ MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const Spectr
       ret = m_txSpectrumModelInfoMap.insert (std::make_pair (txSpectrumModelUid, TxSpectrumModelInfo (txSpectrumModel)));
       NS_ASSERT (ret.second);
       txInfoIterator = ret.first;
+      // the converters to the RX SpectrumModels are created when they are first needed
+    }
+  else
+    {
+      NS_LOG_LOGIC ("SpectrumModelUid " << txSpectrumModelUid << " already present");
+    }
+  return txInfoIterator;
+}
 
-      // and we create the converters for all the RX SpectrumModels that we know of
-      for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
-           rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
-           ++rxInfoIterator)
-        {
-          Ptr<const SpectrumModel> rxSpectrumModel = rxInfoIterator->second.m_rxSpectrumModel;
-          SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
+const SpectrumConverter *
+MultiModelSpectrumChannel::GetConverter (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumModel> rxSpectrumModel)
+{
+  NS_LOG_FUNCTION (this << rxSpectrumModel);
+  SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
+  SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfo.m_spectrumConverterMap.find (rxSpectrumModelUid);
+  if (rxConverterIterator != txInfo.m_spectrumConverterMap.end ())
+    {
+      return &rxConverterIterator->second;
+    }
+  if (txInfo.m_orthogonalRxSpectrumModels.find (rxSpectrumModelUid) != txInfo.m_orthogonalRxSpectrumModels.end ())
+    {
+      return 0;
+    }
+  if (txInfo.m_txSpectrumModel->IsOrthogonal (*rxSpectrumModel))
+    {
+      NS_LOG_LOGIC ("SpectrumModelUid " << txInfo.m_txSpectrumModel->GetUid () << " is orthogonal to " << rxSpectrumModelUid);
+      txInfo.m_orthogonalRxSpectrumModels.insert (rxSpectrumModelUid);
+      return 0;
+    }
+  NS_LOG_LOGIC ("Creating converter between SpectrumModelUid " << txInfo.m_txSpectrumModel->GetUid () << " and " << rxSpectrumModelUid);
+  std::pair<SpectrumConverterMap_t::iterator, bool> ret;
+  ret = txInfo.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid,
+                                                              SpectrumConverter (txInfo.m_txSpectrumModel, rxSpectrumModel)));
+  NS_ASSERT (ret.second);
+  return &ret.first->second;
+}
 
-          if (rxSpectrumModelUid != txSpectrumModelUid && !txSpectrumModel->IsOrthogonal (*rxSpectrumModel))
+Ptr<SpectrumValue>
+MultiModelSpectrumChannel::ConvertTxPsd (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumValue> txPsd,
+                                         SpectrumModelUid_t rxSpectrumModelUid, const SpectrumConverter &converter)
+{
+  NS_LOG_FUNCTION (this << txPsd << rxSpectrumModelUid);
+  ConvertedPsdInfoMap_t::iterator psdIterator = txInfo.m_convertedPsdInfoMap.find (txPsd);
+  if (psdIterator == txInfo.m_convertedPsdInfoMap.end ())
+    {
+      if (txInfo.m_convertedPsdInfoMap.size () >= txInfo.m_maxConvertedPsds)
+        {
+          // remove the PSDs which are only referenced by this map, hence
+          // which cannot be transmitted again
+          for (ConvertedPsdInfoMap_t::iterator it = txInfo.m_convertedPsdInfoMap.begin ();
+               it != txInfo.m_convertedPsdInfoMap.end (); )
             {
-              NS_LOG_LOGIC ("Creating converter between SpectrumModelUid " << txSpectrumModelUid << " and " << rxSpectrumModelUid);
-
-              SpectrumConverter converter (txSpectrumModel, rxSpectrumModel);
-              std::pair<SpectrumConverterMap_t::iterator, bool> ret2;
-              ret2 = txInfoIterator->second.m_spectrumConverterMap.insert (std::make_pair (rxSpectrumModelUid, converter));
-              NS_ASSERT (ret2.second);
+              if (it->first->GetReferenceCount () == 1)
+                {
+                  txInfo.m_convertedPsdInfoMap.erase (it++);
+                }
+              else
+                {
+                  ++it;
+                }
             }
+          txInfo.m_maxConvertedPsds = std::max<std::size_t> (16, 2 * txInfo.m_convertedPsdInfoMap.size ());
         }
+      psdIterator = txInfo.m_convertedPsdInfoMap.insert (std::make_pair (txPsd, ConvertedPsdInfo ())).first;
+      psdIterator->second.m_values.assign (txPsd->ConstValuesBegin (), txPsd->ConstValuesEnd ());
     }
-  else
+  else if (!std::equal (txPsd->ConstValuesBegin (), txPsd->ConstValuesEnd (), psdIterator->second.m_values.begin ()))
     {
-      NS_LOG_LOGIC ("SpectrumModelUid " << txSpectrumModelUid << " already present");
+      // the PSD was modified since it was converted
+      psdIterator->second.m_values.assign (txPsd->ConstValuesBegin (), txPsd->ConstValuesEnd ());
+      psdIterator->second.m_convertedPsds.clear ();
     }
-  return txInfoIterator;
+
+  Ptr<SpectrumValue> &convertedPsd = psdIterator->second.m_convertedPsds[rxSpectrumModelUid];
+  if (convertedPsd == 0)
+    {
+      NS_LOG_LOGIC ("converting txPowerSpectrum SpectrumModelUids " << txPsd->GetSpectrumModelUid () << " --> " << rxSpectrumModelUid);
+      convertedPsd = converter.Convert (txPsd);
+    }
+  return convertedPsd;
 }
 
 void
@@ -228,21 +273,40 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("txSpectrumModelUid " << txSpectrumModelUid);
 
   //
-  TxSpectrumModelInfoMap_t::const_iterator txInfoIteratorerator = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
+  TxSpectrumModelInfoMap_t::iterator txInfoIteratorerator = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
   NS_ASSERT (txInfoIteratorerator != m_txSpectrumModelInfoMap.end ());
 
   NS_LOG_LOGIC ("converter map for TX SpectrumModel with Uid " << txInfoIteratorerator->first);
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
-  NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  FindReceivers (txParams, txMobility);
+  // the receivers of each RX SpectrumModel have consecutive indices in
+  // m_indexedPhys, starting from firstIndex
+  std::vector<uint32_t>::const_iterator receiverIterator = m_receivers.begin ();
+  uint32_t firstIndex = 0;
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
-       ++rxInfoIterator)
+       firstIndex += rxInfoIterator->second.m_rxPhys.size (), ++rxInfoIterator)
     {
+      std::vector<uint32_t>::const_iterator firstReceiver = receiverIterator;
+      while (receiverIterator != m_receivers.end ()
+             && *receiverIterator < firstIndex + rxInfoIterator->second.m_rxPhys.size ())
+        {
+          ++receiverIterator;
+        }
+      if (firstReceiver == receiverIterator)
+        {
+          // no receiver within range
+          continue;
+        }
+
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC ("rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      // the PSD is converted once a receiver of this RX SpectrumModel is
+      // found within range
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
+      const SpectrumConverter *converter = 0;
       if (txSpectrumModelUid == rxSpectrumModelUid)
         {
           NS_LOG_LOGIC ("no spectrum conversion needed");
@@ -250,31 +314,24 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
       else
         {
-          NS_LOG_LOGIC ("converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          if (rxConverterIterator == txInfoIteratorerator->second.m_spectrumConverterMap.end ())
+          converter = GetConverter (txInfoIteratorerator->second, rxInfoIterator->second.m_rxSpectrumModel);
+          if (converter == 0)
             {
               // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
               continue;
             }
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
         }
 
-      for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
-           ++rxPhyIterator)
+      for (std::vector<uint32_t>::const_iterator it = firstReceiver; it != receiverIterator; ++it)
         {
+          auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin () + (*it - firstIndex);
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
                          "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC ("copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              double pathGainLinear = 1;
 
               if (txMobility && receiverMobility)
                 {
@@ -282,10 +339,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   double rxAntennaGain = 0;
                   double propagationGainDb = 0;
                   double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
+                  if (txParams->txAntenna != 0)
                     {
                       Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+                      txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
                       NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                       pathLossDb -= txAntennaGain;
                     }
@@ -313,8 +370,22 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                       // beyond range
                       continue;
                     }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
+                  pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+                }
+
+              if (convertedTxPowerSpectrum == 0)
+                {
+                  convertedTxPowerSpectrum = ConvertTxPsd (txInfoIteratorerator->second, txParams->psd,
+                                                           rxSpectrumModelUid, *converter);
+                }
+              NS_LOG_LOGIC ("copying signal parameters " << txParams);
+              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+              Time delay = MicroSeconds (0);
+
+              if (txMobility && receiverMobility)
+                {
+                  *(rxParams->psd) *= pathGainLinear;
 
                   if (m_spectrumPropagationLoss)
                     {
@@ -348,6 +419,48 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+void
+MultiModelSpectrumChannel::FindReceivers (Ptr<const SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility)
+{
+  NS_LOG_FUNCTION (this << txParams << txMobility);
+  if (m_indexedPhys.size () != m_numDevices)
+    {
+      m_indexedPhys.clear ();
+      m_index.Clear ();
+      for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+           rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+           ++rxInfoIterator)
+        {
+          m_indexedPhys.insert (m_indexedPhys.end (), rxInfoIterator->second.m_rxPhys.begin (),
+                                rxInfoIterator->second.m_rxPhys.end ());
+        }
+    }
+  double range = std::numeric_limits<double>::infinity ();
+  if (txMobility)
+    {
+      range = GetMaxRange (txParams, m_indexedPhys);
+    }
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      m_receivers.resize (m_indexedPhys.size ());
+      for (uint32_t i = 0; i < m_indexedPhys.size (); ++i)
+        {
+          m_receivers[i] = i;
+        }
+      return;
+    }
+  if (m_index.GetN () != m_indexedPhys.size ())
+    {
+      // index the SpectrumPhy instances when they are used, once they have their mobility model
+      for (std::vector<Ptr<SpectrumPhy> >::const_iterator it = m_indexedPhys.begin (); it != m_indexedPhys.end (); ++it)
+        {
+          m_index.Add ((*it)->GetMobility ());
+        }
+    }
+  m_index.GetNeighbors (txMobility->GetPosition (), range, m_receivers);
+  NS_LOG_LOGIC (m_receivers.size () << " of " << m_indexedPhys.size () << " receivers within " << range << "m");
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
@@ -27,9 +27,12 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/spatial-index.h>
 #include <map>
 #include <set>
 
+class MultiModelSpectrumChannelConvertedPsdTestCase;
+
 namespace ns3 {
 
 
@@ -39,10 +42,31 @@ namespace ns3 {
  */
 typedef std::map<SpectrumModelUid_t, SpectrumConverter> SpectrumConverterMap_t;
 
+/**
+ * \ingroup spectrum
+ * The conversions of a transmitted power spectral density.
+ */
+struct ConvertedPsdInfo
+{
+  Values m_values;  //!< Values of the PSD when it was converted.
+  std::map<SpectrumModelUid_t, Ptr<SpectrumValue> > m_convertedPsds;  //!< Converted PSD, by Rx Spectrum model.
+};
+
+/**
+ * \ingroup spectrum
+ * Container: transmitted PSD, ConvertedPsdInfo
+ */
+typedef std::map<Ptr<const SpectrumValue>, ConvertedPsdInfo> ConvertedPsdInfoMap_t;
+
 /**
  * \ingroup spectrum
  * The Tx spectrum model information. This class is used to convert
  * one spectrum model into another one.
+ *
+ * The converters are created the first time a signal of the Tx spectrum
+ * model reaches a receiver of each Rx spectrum model, and the conversions
+ * of each transmitted PSD are kept as long as the PSD is transmitted
+ * again with the same values.
  */
 class TxSpectrumModelInfo
 {
@@ -55,6 +79,9 @@ public:
 
   Ptr<const SpectrumModel> m_txSpectrumModel;     //!< Tx Spectrum model.
   SpectrumConverterMap_t m_spectrumConverterMap;  //!< Spectrum converter.
+  std::set<SpectrumModelUid_t> m_orthogonalRxSpectrumModels;  //!< Rx Spectrum models orthogonal to the Tx Spectrum model.
+  ConvertedPsdInfoMap_t m_convertedPsdInfoMap;    //!< Conversions of the transmitted PSDs.
+  std::size_t m_maxConvertedPsds;                 //!< Number of PSDs in m_convertedPsdInfoMap above which the PSDs not in use are removed.
 };
 
 
@@ -105,6 +132,8 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
+  /// allow MultiModelSpectrumChannelConvertedPsdTestCase class access
+  friend class ::MultiModelSpectrumChannelConvertedPsdTestCase;
 
 public:
   MultiModelSpectrumChannel ();
@@ -139,7 +168,32 @@ private:
    *
    * \return An iterator pointing to the corresponding entry in m_txSpectrumModelInfoMap
    */
-  TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
+  TxSpectrumModelInfoMap_t::iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
+
+  /**
+   * Return the converter from a TX SpectrumModel to a RX SpectrumModel,
+   * creating it the first time this pair of models is used.
+   *
+   * \param txInfo the information of the TX SpectrumModel
+   * \param rxSpectrumModel the RX SpectrumModel
+   *
+   * \return the converter, or 0 if the spectrum models are orthogonal
+   */
+  const SpectrumConverter * GetConverter (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumModel> rxSpectrumModel);
+
+  /**
+   * Convert a transmitted PSD to a RX SpectrumModel, or return its
+   * previous conversion if the same PSD was converted with the same values.
+   *
+   * \param txInfo the information of the TX SpectrumModel of the PSD
+   * \param txPsd the transmitted PSD
+   * \param rxSpectrumModelUid the uid of the RX SpectrumModel
+   * \param converter the converter to the RX SpectrumModel
+   *
+   * \return the converted PSD, which must not be modified
+   */
+  Ptr<SpectrumValue> ConvertTxPsd (TxSpectrumModelInfo &txInfo, Ptr<const SpectrumValue> txPsd,
+                                   SpectrumModelUid_t rxSpectrumModelUid, const SpectrumConverter &converter);
 
   /**
    * Used internally to reschedule transmission after the propagation delay.
@@ -149,6 +203,15 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Find the SpectrumPhy instances which may be within the range of a
+   * transmitter, and store their index in m_receivers.
+   *
+   * \param txParams the parameters of the signal being transmitted
+   * \param txMobility the mobility model of the transmitter, possibly null
+   */
+  void FindReceivers (Ptr<const SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility);
+
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
    * converters to any RX SpectrumModel, and all the corresponding
@@ -169,6 +232,22 @@ private:
    */
   std::size_t m_numDevices;
 
+  /**
+   * The SpectrumPhy instances of m_rxSpectrumModelInfoMap, in order,
+   * or an empty list if some were added since the last transmission.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_indexedPhys;
+
+  /**
+   * Positions of the SpectrumPhy instances, by index in m_indexedPhys.
+   */
+  SpatialIndex m_index;
+
+  /**
+   * Indices in m_indexedPhys of the receivers found by FindReceivers.
+   */
+  std::vector<uint32_t> m_receivers;
+
 };
 
 
@@ -33,6 +33,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <limits>
 
 
 #include "single-model-spectrum-channel.h"
@@ -54,6 +55,7 @@ SingleModelSpectrumChannel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_index.Clear ();
   m_spectrumModel = 0;
   SpectrumChannel::DoDispose ();
 }
@@ -106,10 +108,12 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
 
-  for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
-       rxPhyIterator != m_phyList.end ();
-       ++rxPhyIterator)
+  FindReceivers (txParams, senderMobility);
+  for (std::vector<uint32_t>::const_iterator receiverIterator = m_receivers.begin ();
+       receiverIterator != m_receivers.end ();
+       ++receiverIterator)
     {
+      PhyList::const_iterator rxPhyIterator = m_phyList.begin () + *receiverIterator;
       if ((*rxPhyIterator) != txParams->txPhy)
         {
           Time delay  = MicroSeconds (0);
@@ -187,6 +191,37 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
     }
 }
 
+void
+SingleModelSpectrumChannel::FindReceivers (Ptr<const SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility)
+{
+  NS_LOG_FUNCTION (this << txParams << txMobility);
+  double range = std::numeric_limits<double>::infinity ();
+  if (txMobility)
+    {
+      range = GetMaxRange (txParams, m_phyList);
+    }
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      m_receivers.resize (m_phyList.size ());
+      for (uint32_t i = 0; i < m_phyList.size (); ++i)
+        {
+          m_receivers[i] = i;
+        }
+      return;
+    }
+  if (m_index.GetN () != m_phyList.size ())
+    {
+      // index the SpectrumPhy instances when they are used, once they have their mobility model
+      m_index.Clear ();
+      for (PhyList::const_iterator it = m_phyList.begin (); it != m_phyList.end (); ++it)
+        {
+          m_index.Add ((*it)->GetMobility ());
+        }
+    }
+  m_index.GetNeighbors (txMobility->GetPosition (), range, m_receivers);
+  NS_LOG_LOGIC (m_receivers.size () << " of " << m_phyList.size () << " receivers within " << range << "m");
+}
+
 void
 SingleModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
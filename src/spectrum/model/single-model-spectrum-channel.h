@@ -25,6 +25,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/traced-callback.h>
+#include <ns3/spatial-index.h>
 
 namespace ns3 {
 
@@ -72,11 +73,30 @@ private:
    */
   void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Find the SpectrumPhy instances which may be within the range of a
+   * transmitter, and store their index in m_receivers.
+   *
+   * \param txParams the parameters of the signal being transmitted
+   * \param txMobility the mobility model of the transmitter, possibly null
+   */
+  void FindReceivers (Ptr<const SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility);
+
   /**
    * List of SpectrumPhy instances attached to the channel.
    */
   PhyList m_phyList;
 
+  /**
+   * Positions of the SpectrumPhy instances, by index in m_phyList.
+   */
+  SpatialIndex m_index;
+
+  /**
+   * Indices of the receivers found by FindReceivers.
+   */
+  std::vector<uint32_t> m_receivers;
+
   /**
    * SpectrumModel that this channel instance is supporting.
    */
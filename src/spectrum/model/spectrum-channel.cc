@@ -21,6 +21,9 @@
 #include <ns3/log.h>
 #include <ns3/double.h>
 #include <ns3/pointer.h>
+#include <ns3/antenna-model.h>
+#include <algorithm>
+#include <limits>
 
 #include "spectrum-channel.h"
 
@@ -149,5 +152,32 @@ SpectrumChannel::GetSpectrumPropagationLossModel (void)
   return m_spectrumPropagationLoss;
 }
 
+double
+SpectrumChannel::GetMaxRange (Ptr<const SpectrumSignalParameters> params,
+                              const std::vector<Ptr<SpectrumPhy> > &receivers) const
+{
+  NS_LOG_FUNCTION (this << params);
+  // the traces report the loss of all the receivers
+  if (m_propagationLoss == 0 || !m_gainTrace.IsEmpty () || !m_pathLossTrace.IsEmpty ())
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double txAntennaGainDb = 0;
+  if (params->txAntenna != 0)
+    {
+      txAntennaGainDb = params->txAntenna->GetMaxGainDb ();
+    }
+  double rxAntennaGainDb = 0;
+  for (std::vector<Ptr<SpectrumPhy> >::const_iterator it = receivers.begin (); it != receivers.end (); ++it)
+    {
+      Ptr<AntennaModel> rxAntenna = (*it)->GetRxAntenna ();
+      if (rxAntenna != 0)
+        {
+          rxAntennaGainDb = std::max (rxAntennaGainDb, rxAntenna->GetMaxGainDb ());
+        }
+    }
+  return m_propagationLoss->GetRange (0, -m_maxLossDb - txAntennaGainDb - rxAntennaGainDb);
+}
+
 
 } // namespace
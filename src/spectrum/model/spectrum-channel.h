@@ -154,6 +154,19 @@ public:
 
 protected:
 
+  /**
+   * Get the distance beyond which the receivers do not get a signal, because
+   * its loss, net of the antenna gains, is larger than m_maxLossDb.
+   *
+   * \param params the parameters of the signal
+   * \param receivers the receivers
+   * \return the distance (in meters), infinite when the receivers can not be
+   * skipped, e.g., when the Gain or PathLoss trace sources are connected or
+   * when the PropagationLossModel does not bound its loss
+   */
+  double GetMaxRange (Ptr<const SpectrumSignalParameters> params,
+                      const std::vector<Ptr<SpectrumPhy> > &receivers) const;
+
   /**
    * The `PathLoss` trace source. Exporting the pointers to the Tx and Rx
    * SpectrumPhy and a pathloss value, in dB.
@@ -22,6 +22,7 @@
 #include <ns3/assert.h>
 #include <ns3/log.h>
 #include <algorithm>
+#include <limits>
 
 
 
@@ -39,12 +40,29 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
   m_fromSpectrumModel = fromSpectrumModel;
   m_toSpectrumModel = toSpectrumModel;
 
+  // the "from" bands overlapping a "to" band are found by a sweep over
+  // the bands when those of both models are sorted (as those built from
+  // center frequencies are), and by a scan of all of them otherwise
+  bool sorted = IsSorted (fromSpectrumModel) && IsSorted (toSpectrumModel);
+  Bands::const_iterator first = fromSpectrumModel->Begin ();
   size_t rowPtr = 0;
   for (Bands::const_iterator toit = toSpectrumModel->Begin (); toit != toSpectrumModel->End (); ++toit)
     {
-      size_t colInd = 0;
-      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit)
+      Bands::const_iterator fromit = fromSpectrumModel->Begin ();
+      if (sorted)
         {
+          while (first != fromSpectrumModel->End () && first->fh <= toit->fl)
+            {
+              ++first;
+            }
+          fromit = first;
+        }
+      for (; fromit != fromSpectrumModel->End (); ++fromit)
+        {
+          if (sorted && fromit->fl >= toit->fh)
+            {
+              break;
+            }
           double c = GetCoefficient (*fromit, *toit);
           NS_LOG_LOGIC ("(" << fromit->fl << ","  << fromit->fh << ")"
                             << " --> " <<
@@ -53,10 +71,9 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
           if (c > 0)
             {
               m_conversionMatrix.push_back (c);
-              m_conversionColInd.push_back (colInd);
+              m_conversionColInd.push_back (fromit - fromSpectrumModel->Begin ());
               rowPtr++;
             }
-          colInd++;
         }
       m_conversionRowPtr.push_back (rowPtr);
     }
@@ -64,6 +81,22 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
 }
 
 
+bool
+SpectrumConverter::IsSorted (Ptr<const SpectrumModel> model)
+{
+  double previousFh = -std::numeric_limits<double>::infinity ();
+  for (Bands::const_iterator it = model->Begin (); it != model->End (); ++it)
+    {
+      if (it->fl < previousFh || it->fh <= it->fl)
+        {
+          return false;
+        }
+      previousFh = it->fh;
+    }
+  return true;
+}
+
+
 double SpectrumConverter::GetCoefficient (const BandInfo& from, const BandInfo& to) const
 {
   NS_LOG_FUNCTION (this);
@@ -82,6 +115,7 @@ SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
 
   Ptr<SpectrumValue> tvvf = Create<SpectrumValue> (m_toSpectrumModel);
 
+  Values::const_iterator fromValues = fvvf->ConstValuesBegin ();
   Values::iterator tvit = tvvf->ValuesBegin ();
   size_t i = 0; // Index of conversion coefficient
 
@@ -90,10 +124,9 @@ SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
        ++convIt)
     {
       double sum = 0;
-      while (i < *convIt)
+      for (; i < *convIt; ++i)
         {
-          sum += (*fvvf)[m_conversionColInd.at (i)] * m_conversionMatrix.at (i);
-          i++;
+          sum += fromValues[m_conversionColInd[i]] * m_conversionMatrix[i];
         }
       *tvit = sum;
       ++tvit;
@@ -78,6 +78,17 @@ private:
    */
   double GetCoefficient (const BandInfo& from, const BandInfo& to) const;
 
+  /**
+   * Check whether the bands of a SpectrumModel are sorted by frequency
+   * without overlapping
+   *
+   * @param model the SpectrumModel
+   *
+   * @return true if each band is not empty and starts at or after the end
+   * of the previous one
+   */
+  static bool IsSorted (Ptr<const SpectrumModel> model);
+
   std::vector<double> m_conversionMatrix; //!< matrix of conversion coefficients stored in Compressed Row Storage format
   std::vector<size_t> m_conversionRowPtr; //!< offset of rows in m_conversionMatrix
   std::vector<size_t> m_conversionColInd; //!< column of each non-zero element in m_conversionMatrix
@@ -106,17 +106,13 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -124,12 +120,10 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,17 +132,13 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -164,17 +154,13 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -182,12 +168,10 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,17 +181,13 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -216,12 +196,24 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] /= s;
+    }
+}
 
-  while (it1 != m_values.end ())
+
+void
+SpectrumValue::DivideInto (const SpectrumValue& x)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] = w[i] / v[i];
     }
 }
 
@@ -231,12 +223,10 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -280,12 +270,10 @@ void
 SpectrumValue::Pow (double exp)
 {
   NS_LOG_FUNCTION (this << exp);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = std::pow (*it1, exp);
-      ++it1;
+      v[i] = std::pow (v[i], exp);
     }
 }
 
@@ -294,12 +282,10 @@ void
 SpectrumValue::Exp (double base)
 {
   NS_LOG_FUNCTION (this << base);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = std::pow (base, *it1);
-      ++it1;
+      v[i] = std::pow (base, v[i]);
     }
 }
 
@@ -308,12 +294,10 @@ void
 SpectrumValue::Log10 ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = std::log10 (*it1);
-      ++it1;
+      v[i] = std::log10 (v[i]);
     }
 }
 
@@ -321,12 +305,10 @@ void
 SpectrumValue::Log2 ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = log2 (*it1);
-      ++it1;
+      v[i] = log2 (v[i]);
     }
 }
 
@@ -335,12 +317,10 @@ void
 SpectrumValue::Log ()
 {
   NS_LOG_FUNCTION (this);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 = std::log (*it1);
-      ++it1;
+      v[i] = std::log (v[i]);
     }
 }
 
@@ -408,9 +388,7 @@ Integral (const SpectrumValue& arg)
 Ptr<SpectrumValue>
 SpectrumValue::Copy () const
 {
-  Ptr<SpectrumValue> p = Create<SpectrumValue> (m_spectrumModel);
-  *p = *this;
-  return p;
+  return Create<SpectrumValue> (*this);
 
   //  return Copy<SpectrumValue> (*this)
 }
@@ -464,6 +442,38 @@ operator+ (double lhs, const SpectrumValue& rhs)
 }
 
 
+SpectrumValue
+operator+ (SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+  lhs.Add (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator+ (const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+  rhs.Add (lhs);
+  return std::move (rhs);
+}
+
+
+SpectrumValue
+operator+ (SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+  lhs.Add (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator+ (SpectrumValue&& lhs, double rhs)
+{
+  lhs.Add (rhs);
+  return std::move (lhs);
+}
+
+
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -492,6 +502,39 @@ operator- (double lhs, const SpectrumValue& rhs)
   return res;
 }
 
+
+SpectrumValue
+operator- (SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+  lhs.Subtract (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator- (const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+  rhs.ChangeSign ();
+  rhs.Add (lhs);
+  return std::move (rhs);
+}
+
+
+SpectrumValue
+operator- (SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+  lhs.Subtract (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator- (SpectrumValue&& lhs, double rhs)
+{
+  lhs.Subtract (rhs);
+  return std::move (lhs);
+}
+
 SpectrumValue
 operator* (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -519,6 +562,38 @@ operator* (double lhs, const SpectrumValue& rhs)
 }
 
 
+SpectrumValue
+operator* (SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+  lhs.Multiply (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator* (const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+  rhs.Multiply (lhs);
+  return std::move (rhs);
+}
+
+
+SpectrumValue
+operator* (SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+  lhs.Multiply (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator* (SpectrumValue&& lhs, double rhs)
+{
+  lhs.Multiply (rhs);
+  return std::move (lhs);
+}
+
+
 SpectrumValue
 operator/ (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
@@ -546,6 +621,38 @@ operator/ (double lhs, const SpectrumValue& rhs)
 }
 
 
+SpectrumValue
+operator/ (SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+  lhs.Divide (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator/ (const SpectrumValue& lhs, SpectrumValue&& rhs)
+{
+  rhs.DivideInto (lhs);
+  return std::move (rhs);
+}
+
+
+SpectrumValue
+operator/ (SpectrumValue&& lhs, SpectrumValue&& rhs)
+{
+  lhs.Divide (rhs);
+  return std::move (lhs);
+}
+
+
+SpectrumValue
+operator/ (SpectrumValue&& lhs, double rhs)
+{
+  lhs.Divide (rhs);
+  return std::move (lhs);
+}
+
+
 SpectrumValue
 operator+ (const SpectrumValue& rhs)
 {
@@ -560,6 +667,13 @@ operator- (const SpectrumValue& rhs)
   return res;
 }
 
+SpectrumValue
+operator- (SpectrumValue&& rhs)
+{
+  rhs.ChangeSign ();
+  return std::move (rhs);
+}
+
 
 SpectrumValue
 Pow (double lhs, const SpectrumValue& rhs)
@@ -579,6 +693,14 @@ Pow (const SpectrumValue& lhs, double rhs)
 }
 
 
+SpectrumValue
+Pow (SpectrumValue&& lhs, double rhs)
+{
+  lhs.Pow (rhs);
+  return std::move (lhs);
+}
+
+
 SpectrumValue
 Log10 (const SpectrumValue& arg)
 {
@@ -587,6 +709,13 @@ Log10 (const SpectrumValue& arg)
   return res;
 }
 
+SpectrumValue
+Log10 (SpectrumValue&& arg)
+{
+  arg.Log10 ();
+  return std::move (arg);
+}
+
 SpectrumValue
 Log2 (const SpectrumValue& arg)
 {
@@ -595,6 +724,13 @@ Log2 (const SpectrumValue& arg)
   return res;
 }
 
+SpectrumValue
+Log2 (SpectrumValue&& arg)
+{
+  arg.Log2 ();
+  return std::move (arg);
+}
+
 SpectrumValue
 Log (const SpectrumValue& arg)
 {
@@ -603,6 +739,13 @@ Log (const SpectrumValue& arg)
   return res;
 }
 
+SpectrumValue
+Log (SpectrumValue&& arg)
+{
+  arg.Log ();
+  return std::move (arg);
+}
+
 SpectrumValue&
 SpectrumValue::operator+= (const SpectrumValue& rhs)
 {
@@ -674,6 +817,20 @@ SpectrumValue::operator= (double rhs)
   return *this;
 }
 
+SpectrumValue&
+SpectrumValue::AddScaled (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] += w[i] * s;
+    }
+  return *this;
+}
+
 
 
 SpectrumValue
@@ -50,6 +50,10 @@ typedef std::vector<double> Values;
  * Space.
  * Mathematical operations are defined in this Function Space; these
  * operations are implemented by means of operator overloading.
+ * The operators whose operands are temporaries compute their result
+ * in the storage of one of them, so that an expression such as
+ * a / (b - a + c) creates a single Values vector.  The compound
+ * assignment operators and AddScaled create none.
  *
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
@@ -190,6 +194,46 @@ public:
    */
   friend SpectrumValue operator+ (double lhs, const SpectrumValue& rhs);
 
+  /**
+   * addition operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs + rhs
+   */
+  friend SpectrumValue operator+ (SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+  /**
+   * addition operator reusing the storage of the temporary Right Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs + rhs
+   */
+  friend SpectrumValue operator+ (const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+  /**
+   * addition operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs + rhs
+   */
+  friend SpectrumValue operator+ (SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+  /**
+   * addition operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs + rhs
+   */
+  friend SpectrumValue operator+ (SpectrumValue&& lhs, double rhs);
+
 
   /**
    *  subtraction operator
@@ -221,6 +265,46 @@ public:
    */
   friend SpectrumValue operator- (double lhs, const SpectrumValue& rhs);
 
+  /**
+   * subtraction operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs - rhs
+   */
+  friend SpectrumValue operator- (SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+  /**
+   * subtraction operator reusing the storage of the temporary Right Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs - rhs
+   */
+  friend SpectrumValue operator- (const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+  /**
+   * subtraction operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs - rhs
+   */
+  friend SpectrumValue operator- (SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+  /**
+   * subtraction operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs - rhs
+   */
+  friend SpectrumValue operator- (SpectrumValue&& lhs, double rhs);
+
   /**
    *  multiplication component-by-component (Schur product)
    *
@@ -251,6 +335,46 @@ public:
    */
   friend SpectrumValue operator* (double lhs, const SpectrumValue& rhs);
 
+  /**
+   * multiplication operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs * rhs
+   */
+  friend SpectrumValue operator* (SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+  /**
+   * multiplication operator reusing the storage of the temporary Right Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs * rhs
+   */
+  friend SpectrumValue operator* (const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+  /**
+   * multiplication operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs * rhs
+   */
+  friend SpectrumValue operator* (SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+  /**
+   * multiplication operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs * rhs
+   */
+  friend SpectrumValue operator* (SpectrumValue&& lhs, double rhs);
+
   /**
    *  division component-by-component
    *
@@ -281,6 +405,46 @@ public:
    */
   friend SpectrumValue operator/ (double lhs, const SpectrumValue& rhs);
 
+  /**
+   * division operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs / rhs
+   */
+  friend SpectrumValue operator/ (SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+  /**
+   * division operator reusing the storage of the temporary Right Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs / rhs
+   */
+  friend SpectrumValue operator/ (const SpectrumValue& lhs, SpectrumValue&& rhs);
+
+  /**
+   * division operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs / rhs
+   */
+  friend SpectrumValue operator/ (SpectrumValue&& lhs, SpectrumValue&& rhs);
+
+  /**
+   * division operator reusing the storage of the temporary Left Hand Side
+   *
+   * @param lhs Left Hand Side of the operator
+   * @param rhs Right Hand Side of the operator
+   *
+   * @return the value of lhs / rhs
+   */
+  friend SpectrumValue operator/ (SpectrumValue&& lhs, double rhs);
+
   /**
    * unary plus operator
    *
@@ -297,6 +461,14 @@ public:
    */
   friend SpectrumValue operator- (const SpectrumValue& rhs);
 
+  /**
+   * unary minus operator reusing the storage of the temporary operand
+   *
+   * @param rhs Right Hand Side of the operator
+   * @return the value of - rhs
+   */
+  friend SpectrumValue operator- (SpectrumValue&& rhs);
+
 
   /**
    * left shift operator
@@ -409,6 +581,18 @@ public:
    */
   SpectrumValue& operator= (double rhs);
 
+  /**
+   * Add the values of x multiplied by s to *this, component by
+   * component, i.e., *this += x * s without the temporary SpectrumValue
+   * of x * s
+   *
+   * @param x the SpectrumValue to add
+   * @param s the factor of x
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddScaled (const SpectrumValue& x, double s);
+
 
 
   /**
@@ -460,6 +644,14 @@ public:
    */
   friend SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
 
+  /**
+   * @param lhs the base, whose storage is reused
+   * @param rhs the exponent
+   *
+   * @return each value in base raised to the exponent
+   */
+  friend SpectrumValue Pow (SpectrumValue&& lhs, double rhs);
+
   /**
    *
    *
@@ -469,6 +661,13 @@ public:
    */
   friend SpectrumValue Log10 (const SpectrumValue&  arg);
 
+  /**
+   * @param arg the argument, whose storage is reused
+   *
+   * @return the logarithm in base 10 of all values in the argument
+   */
+  friend SpectrumValue Log10 (SpectrumValue&& arg);
+
 
   /**
    *
@@ -479,6 +678,13 @@ public:
    */
   friend SpectrumValue Log2 (const SpectrumValue&  arg);
 
+  /**
+   * @param arg the argument, whose storage is reused
+   *
+   * @return the logarithm in base 2 of all values in the argument
+   */
+  friend SpectrumValue Log2 (SpectrumValue&& arg);
+
   /**
    *
    *
@@ -488,6 +694,13 @@ public:
    */
   friend SpectrumValue Log (const SpectrumValue&  arg);
 
+  /**
+   * @param arg the argument, whose storage is reused
+   *
+   * @return the logarithm in base e of all values in the argument
+   */
+  friend SpectrumValue Log (SpectrumValue&& arg);
+
   /**
    *
    *
@@ -555,6 +768,12 @@ private:
    * \param s flat value
    */
   void Divide (double s);
+  /**
+   * Divides a SpectrumValue by the current elements (element by element
+   * division), and stores the result in the current elements
+   * \param x SpectrumValue
+   */
+  void DivideInto (const SpectrumValue& x);
   /**
    * Change the values sign
    */
@@ -615,9 +834,13 @@ double Sum (const SpectrumValue& x);
 double Prod (const SpectrumValue& x);
 SpectrumValue Pow (const SpectrumValue& lhs, double rhs);
 SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
+SpectrumValue Pow (SpectrumValue&& lhs, double rhs);
 SpectrumValue Log10 (const SpectrumValue& arg);
 SpectrumValue Log2 (const SpectrumValue& arg);
 SpectrumValue Log (const SpectrumValue& arg);
+SpectrumValue Log10 (SpectrumValue&& arg);
+SpectrumValue Log2 (SpectrumValue&& arg);
+SpectrumValue Log (SpectrumValue&& arg);
 double Integral (const SpectrumValue& arg);
 
 
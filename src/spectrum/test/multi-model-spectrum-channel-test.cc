@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/object.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/mobility-model.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <algorithm>
+
+using namespace ns3;
+
+#define TOLERANCE 1e-6
+
+/**
+ * \ingroup spectrum
+ * \ingroup tests
+ *
+ * SpectrumPhy without mobility nor device, which records the PSD
+ * of the last signal it received
+ */
+class MultiModelSpectrumChannelTestPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param rxSpectrumModel the RX spectrum model
+   */
+  MultiModelSpectrumChannelTestPhy (Ptr<const SpectrumModel> rxSpectrumModel);
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  Ptr<const SpectrumValue> m_rxPsd; //!< the PSD of the last signal received
+
+private:
+  Ptr<const SpectrumModel> m_rxSpectrumModel; //!< the RX spectrum model
+};
+
+MultiModelSpectrumChannelTestPhy::MultiModelSpectrumChannelTestPhy (Ptr<const SpectrumModel> rxSpectrumModel)
+  : m_rxSpectrumModel (rxSpectrumModel)
+{
+}
+
+void
+MultiModelSpectrumChannelTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+MultiModelSpectrumChannelTestPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+MultiModelSpectrumChannelTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+}
+
+Ptr<MobilityModel>
+MultiModelSpectrumChannelTestPhy::GetMobility ()
+{
+  return 0;
+}
+
+void
+MultiModelSpectrumChannelTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+MultiModelSpectrumChannelTestPhy::GetRxSpectrumModel () const
+{
+  return m_rxSpectrumModel;
+}
+
+Ptr<AntennaModel>
+MultiModelSpectrumChannelTestPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+MultiModelSpectrumChannelTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_rxPsd = params->psd;
+}
+
+/**
+ * \ingroup spectrum
+ * \ingroup tests
+ *
+ * Test that the conversions of the transmitted PSDs kept by
+ * MultiModelSpectrumChannel follow the changes of the PSDs which are
+ * transmitted again, and are removed once the PSDs are released
+ */
+class MultiModelSpectrumChannelConvertedPsdTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumChannelConvertedPsdTestCase ();
+  virtual ~MultiModelSpectrumChannelConvertedPsdTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Transmit a PSD on the channel and run the simulation
+   * \param psd the PSD
+   */
+  void Transmit (Ptr<SpectrumValue> psd);
+
+  /**
+   * \return the number of transmitted PSDs whose conversions are kept by the channel
+   */
+  std::size_t GetNConvertedPsds (void) const;
+
+  Ptr<MultiModelSpectrumChannel> m_channel;    //!< the channel
+  Ptr<MultiModelSpectrumChannelTestPhy> m_txPhy; //!< the transmitter
+};
+
+MultiModelSpectrumChannelConvertedPsdTestCase::MultiModelSpectrumChannelConvertedPsdTestCase ()
+  : TestCase ("Test the conversions of the transmitted PSDs kept by MultiModelSpectrumChannel")
+{
+}
+
+MultiModelSpectrumChannelConvertedPsdTestCase::~MultiModelSpectrumChannelConvertedPsdTestCase ()
+{
+}
+
+void
+MultiModelSpectrumChannelConvertedPsdTestCase::Transmit (Ptr<SpectrumValue> psd)
+{
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->duration = MilliSeconds (1);
+  params->psd = psd;
+  params->txPhy = m_txPhy;
+  m_channel->StartTx (params);
+  Simulator::Run ();
+}
+
+std::size_t
+MultiModelSpectrumChannelConvertedPsdTestCase::GetNConvertedPsds (void) const
+{
+  std::size_t n = 0;
+  for (TxSpectrumModelInfoMap_t::const_iterator it = m_channel->m_txSpectrumModelInfoMap.begin ();
+       it != m_channel->m_txSpectrumModelInfoMap.end (); ++it)
+    {
+      n += it->second.m_convertedPsdInfoMap.size ();
+    }
+  return n;
+}
+
+void
+MultiModelSpectrumChannelConvertedPsdTestCase::DoRun (void)
+{
+  // four TX bands of 1 MHz, and two RX bands of 2 MHz over the same range
+  std::vector<double> txFrequencies;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      txFrequencies.push_back (2.4005e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> txModel = Create<SpectrumModel> (txFrequencies);
+  std::vector<double> rxFrequencies;
+  rxFrequencies.push_back (2.401e9);
+  rxFrequencies.push_back (2.403e9);
+  Ptr<SpectrumModel> rxModel = Create<SpectrumModel> (rxFrequencies);
+
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+  m_txPhy = CreateObject<MultiModelSpectrumChannelTestPhy> (txModel);
+  Ptr<MultiModelSpectrumChannelTestPhy> rxPhy1 = CreateObject<MultiModelSpectrumChannelTestPhy> (rxModel);
+  Ptr<MultiModelSpectrumChannelTestPhy> rxPhy2 = CreateObject<MultiModelSpectrumChannelTestPhy> (rxModel);
+  m_channel->AddRx (m_txPhy);
+  m_channel->AddRx (rxPhy1);
+  m_channel->AddRx (rxPhy2);
+
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (txModel);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      (*psd)[i] = i + 1;
+    }
+  Transmit (psd);
+  NS_TEST_ASSERT_MSG_NE (rxPhy1->m_rxPsd, 0, "the first receiver got no signal");
+  NS_TEST_ASSERT_MSG_NE (rxPhy2->m_rxPsd, 0, "the second receiver got no signal");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy1->m_rxPsd)[0], 1.5, TOLERANCE, "wrong PSD in the first RX band");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy1->m_rxPsd)[1], 3.5, TOLERANCE, "wrong PSD in the second RX band");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy2->m_rxPsd)[1], 3.5, TOLERANCE, "wrong PSD in the second RX band");
+  NS_TEST_ASSERT_MSG_EQ (GetNConvertedPsds (), 1, "the conversion of the PSD must be kept");
+
+  // transmit the same PSD after modifying it in place
+  (*psd)[0] = 5;
+  (*psd)[3] = 0;
+  Transmit (psd);
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy1->m_rxPsd)[0], 3.5, TOLERANCE, "the modified PSD was not converted again");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy1->m_rxPsd)[1], 1.5, TOLERANCE, "the modified PSD was not converted again");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy2->m_rxPsd)[0], 3.5, TOLERANCE, "the modified PSD was not converted again");
+  NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy2->m_rxPsd)[1], 1.5, TOLERANCE, "the modified PSD was not converted again");
+  NS_TEST_ASSERT_MSG_EQ (GetNConvertedPsds (), 1, "the PSD must be kept once");
+
+  // transmit many PSDs which are released after their transmission, while
+  // the first one is still referenced
+  for (uint32_t n = 0; n < 100; n++)
+    {
+      Ptr<SpectrumValue> other = Create<SpectrumValue> (txModel);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          (*other)[i] = n;
+        }
+      Transmit (other);
+      NS_TEST_ASSERT_MSG_EQ_TOL ((*rxPhy1->m_rxPsd)[0], n, TOLERANCE, "wrong PSD received");
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (GetNConvertedPsds (), 16, "the released PSDs must be removed");
+  NS_TEST_ASSERT_MSG_EQ (psd->GetReferenceCount (), 2, "the PSD still referenced must be kept");
+
+  // the first PSD is removed too once released: all the PSDs kept are
+  // removed at once when the limit is reached
+  psd = 0;
+  std::size_t minConvertedPsds = GetNConvertedPsds ();
+  for (uint32_t n = 0; n < 16; n++)
+    {
+      Transmit (Create<SpectrumValue> (txModel));
+      minConvertedPsds = std::min (minConvertedPsds, GetNConvertedPsds ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (minConvertedPsds, 1, "the released PSDs must be removed");
+
+  m_channel->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup spectrum
+ * \ingroup tests
+ *
+ * MultiModelSpectrumChannel test suite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumChannelConvertedPsdTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite;
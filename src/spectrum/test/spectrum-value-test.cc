@@ -25,6 +25,7 @@
 #include <ns3/test.h>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 #include "spectrum-test.h"
 
@@ -242,6 +243,33 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
 
+  // the operators reusing the storage of the temporaries give the values
+  // of the operators on named values
+  SpectrumValue tv11 (f), v11 (f), v12 (f), tv12 (f), v13 (f), tv13 (f);
+  SpectrumValue interference = v2;
+  interference -= v1;
+  interference += v3;
+  v11 = v1;
+  v11 /= interference;
+  tv11 = v1 / (v2 - v1 + v3);
+  AddTestCase (new SpectrumValueTestCase (tv11, v11, "tv11 = v1 div (v2 - v1 + v3)"), TestCase::QUICK);
+
+  SpectrumValue product = v2;
+  product *= v3;
+  v12 = v1;
+  v12 -= product;
+  v12 *= -doubleValue;
+  tv12 = -(v1 - v2 * v3) * doubleValue;
+  AddTestCase (new SpectrumValueTestCase (tv12, v12, "tv12 = -(v1 - v2 * v3) * doubleValue"), TestCase::QUICK);
+
+  v13 = v2;
+  v13 *= doubleValue;
+  v13 += v1;
+  tv13 = v1;
+  tv13.AddScaled (v2, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv13, v13, "tv13 = v1 + v2 * doubleValue"), TestCase::QUICK);
+
+
 }
 
 
@@ -328,6 +356,18 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 //   NS_LOG_LOGIC(*res);
   AddTestCase (new SpectrumValueTestCase (t21b, *res, ""), TestCase::QUICK);
 
+  // the bands which are not sorted by frequency are converted as well
+  Bands reversedBands (sof1->Begin (), sof1->End ());
+  std::reverse (reversedBands.begin (), reversedBands.end ());
+  Ptr<SpectrumModel> sof1r = Create<SpectrumModel> (reversedBands);
+  SpectrumConverter c21r (sof2, sof1r);
+  res = c21r.Convert (v2b);
+  SpectrumValue t21r (sof1r);
+  t21r[0] = t21b[2];
+  t21r[1] = t21b[1];
+  t21r[2] = t21b[0];
+  AddTestCase (new SpectrumValueTestCase (t21r, *res, "unsorted bands"), TestCase::QUICK);
+
 
 }
 
@@ -22,6 +22,7 @@
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/fq-codel-queue-disc.h"
+#include "ns3/codel-queue-disc.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-packet-filter.h"
 #include "ns3/ipv4-queue-disc-item.h"
@@ -33,6 +34,11 @@
 #include "ns3/udp-header.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include <deque>
+#include <list>
+#include <map>
 
 using namespace ns3;
 
@@ -120,12 +126,12 @@ FqCoDelQueueDiscNoSuitableFilter::DoRun (void)
   Address dest;
   item = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Header);
   queueDisc->Enqueue (item);
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 0, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNFlowQueues (), 0, "no flow queue should have been created");
 
   p = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello, world"), 12);
   item = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Header);
   queueDisc->Enqueue (item);
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 0, "no flow queue should have been created");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNFlowQueues (), 0, "no flow queue should have been created");
 
   Simulator::Destroy ();
 }
@@ -181,20 +187,20 @@ FqCoDelQueueDiscIPFlowsSeparationAndPacketLimit::DoRun (void)
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the flow queue");
 
   // Add two packets from the second flow
   hdr.SetDestination (Ipv4Address ("10.10.1.7"));
   // Add the first packet
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the flow queue");
   // Add the second packet that causes two packets to be dropped from the fat flow (max backlog = 300, threshold = 150)
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 2, "unexpected number of packets in the flow queue");
 
   Simulator::Destroy ();
 }
@@ -248,82 +254,80 @@ FqCoDelQueueDiscDeficit::DoRun (void)
   // Add a packet from the first flow
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 1, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  Ptr<FqCoDelFlow> flow1 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (0));
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the first flow must equal the quantum");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::NEW_FLOW, "the first flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the first flow must equal the quantum");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::NEW_FLOW, "the first flow must be in the list of new queues");
   // Dequeue a packet
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 0, "unexpected number of packets in the first flow queue");
   // the deficit for the first flow becomes 90 - (100+20) = -30
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -30, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), -30, "unexpected deficit for the first flow");
 
   // Add two packets from the first flow
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 2, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::NEW_FLOW, "the first flow must still be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::NEW_FLOW, "the first flow must still be in the list of new queues");
 
   // Add two packets from the second flow
   hdr.SetDestination (Ipv4Address ("10.10.1.10"));
   AddPacket (queueDisc, hdr);
   AddPacket (queueDisc, hdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the second flow queue");
-  Ptr<FqCoDelFlow> flow2 = StaticCast<FqCoDelFlow> (queueDisc->GetQueueDiscClass (1));
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the second flow must equal the quantum");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 2, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), static_cast<int32_t> (queueDisc->GetQuantum ()), "the deficit of the second flow must equal the quantum");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::NEW_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the second flow, as the first flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
   // the first flow got a quantum of deficit (-30+90=60) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 60, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), 60, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow has a negative deficit (-30) and is still in the list of new queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), -30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::NEW_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), -30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::NEW_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the first flow, as the second flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 2, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
   // the first flow has a negative deficit (60-(100+20)= -60) and stays in the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -60, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), -60, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow got a quantum of deficit (-30+90=60) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 60, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), 60, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the second flow, as the first flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 1, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 1, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 0, "unexpected number of packets in the second flow queue");
   // the first flow got a quantum of deficit (-60+90=30) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 30, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), 30, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow has a negative deficit (60-(100+20)= -60)
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), -60, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), -60, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet (from the first flow, as the second flow has a negative deficit)
   queueDisc->Dequeue ();
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 0, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 0, "unexpected number of packets in the second flow queue");
   // the first flow has a negative deficit (30-(100+20)= -90)
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), -90, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::OLD_FLOW, "the first flow must be in the list of old queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), -90, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::OLD_FLOW, "the first flow must be in the list of old queues");
   // the second flow got a quantum of deficit (-60+90=30) and has been moved to the end of the list of old queues
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::OLD_FLOW, "the second flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), 30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::OLD_FLOW, "the second flow must be in the list of new queues");
 
   // Dequeue a packet
   queueDisc->Dequeue ();
@@ -333,10 +337,95 @@ FqCoDelQueueDiscDeficit::DoRun (void)
   // reconsidered, but it has a null deficit, hence it gets another quantum of deficit (0+90=90). Then, the first
   // flow is reconsidered again, now it has a positive deficit and hence it is selected. But, it is empty and
   // therefore is set to inactive, too.
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetDeficit (), 90, "unexpected deficit for the first flow");
-  NS_TEST_ASSERT_MSG_EQ (flow1->GetStatus (), FqCoDelFlow::INACTIVE, "the first flow must be inactive");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetDeficit (), 30, "unexpected deficit for the second flow");
-  NS_TEST_ASSERT_MSG_EQ (flow2->GetStatus (), FqCoDelFlow::INACTIVE, "the second flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), 90, "unexpected deficit for the first flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::INACTIVE, "the first flow must be inactive");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (1), 30, "unexpected deficit for the second flow");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (1), FqCoDelQueueDisc::INACTIVE, "the second flow must be inactive");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the flow queues are reused and that the fat flow
+ * is found wherever it is in the lists of flows
+ */
+class FqCoDelQueueDiscFlowsReuse : public TestCase
+{
+public:
+  FqCoDelQueueDiscFlowsReuse ();
+  virtual ~FqCoDelQueueDiscFlowsReuse ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr);
+};
+
+FqCoDelQueueDiscFlowsReuse::FqCoDelQueueDiscFlowsReuse ()
+  : TestCase ("Test the reuse of the flow queues and the fat flow drop")
+{
+}
+
+FqCoDelQueueDiscFlowsReuse::~FqCoDelQueueDiscFlowsReuse ()
+{
+}
+
+void
+FqCoDelQueueDiscFlowsReuse::AddPacket (Ptr<FqCoDelQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+FqCoDelQueueDiscFlowsReuse::DoRun (void)
+{
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> ("MaxSize", StringValue ("4p"));
+
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (100);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Serve the first flow until it becomes inactive
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_NE (queueDisc->Dequeue (), 0, "the packet of the first flow must be dequeued");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->Dequeue (), 0, "no packet must be dequeued");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::INACTIVE, "the first flow must be inactive");
+
+  // A new packet of the first flow reuses its flow queue
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNFlowQueues (), 1, "the flow queue must be reused");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelQueueDisc::NEW_FLOW, "the first flow must be in the list of new queues");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), 1500, "the deficit of the first flow must equal the quantum");
+
+  // Make the second flow the fat one
+  hdr.SetDestination (Ipv4Address ("10.10.1.7"));
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
+
+  // Exceed the limit with the first flow: two packets are dropped from the second one
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
+
+  // Many flows share the buckets
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      hdr.SetDestination (Ipv4Address (0x0b000000 + i));
+      AddPacket (queueDisc, hdr);
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (queueDisc->GetNFlowQueues (), 1024, "more flow queues than buckets");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
 
   Simulator::Destroy ();
 }
@@ -397,32 +486,32 @@ FqCoDelQueueDiscTCPFlowsSeparation::DoRun (void)
   AddPacket (queueDisc, hdr, tcpHdr);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
 
   // Add a packet from the second flow
   tcpHdr.SetSourcePort (8);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
 
   // Add a packet from the third flow
   tcpHdr.SetDestinationPort (28);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 5, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (2), 1, "unexpected number of packets in the third flow queue");
 
   // Add two packets from the fourth flow
   tcpHdr.SetSourcePort (7);
   AddPacket (queueDisc, hdr, tcpHdr);
   AddPacket (queueDisc, hdr, tcpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 7, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (3)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (2), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (3), 2, "unexpected number of packets in the third flow queue");
 
   Simulator::Destroy ();
 }
@@ -483,32 +572,330 @@ FqCoDelQueueDiscUDPFlowsSeparation::DoRun (void)
   AddPacket (queueDisc, hdr, udpHdr);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
 
   // Add a packet from the second flow
   udpHdr.SetSourcePort (8);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
 
   // Add a packet from the third flow
   udpHdr.SetDestinationPort (28);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 5, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (2), 1, "unexpected number of packets in the third flow queue");
 
   // Add two packets from the fourth flow
   udpHdr.SetSourcePort (7);
   AddPacket (queueDisc, hdr, udpHdr);
   AddPacket (queueDisc, hdr, udpHdr);
   NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 7, "unexpected number of packets in the queue disc");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 3, "unexpected number of packets in the first flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the third flow queue");
-  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (3)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (2), 1, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (3), 2, "unexpected number of packets in the third flow queue");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class compares the packets dequeued along a random sequence of
+ * enqueues and dequeues with those of a reference deficit round robin
+ * scheduler of the flow queues, written after the lists of flows of
+ * the earlier FqCoDelQueueDisc
+ */
+class FqCoDelQueueDiscRandomTrace : public TestCase
+{
+public:
+  FqCoDelQueueDiscRandomTrace ();
+  virtual ~FqCoDelQueueDiscRandomTrace ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A flow of the reference scheduler
+  struct RefFlow
+  {
+    RefFlow () : m_deficit (0), m_status (FqCoDelQueueDisc::INACTIVE) {}
+    std::deque<uint64_t> m_uids;            //!< the uids of the queued packets
+    int32_t m_deficit;                      //!< the deficit of the flow
+    FqCoDelQueueDisc::FlowStatus m_status;       //!< the status of the flow
+  };
+
+  /**
+   * Dequeue a packet from the reference scheduler
+   * \param uid the uid of the dequeued packet
+   * \param size the size of the dequeued packet
+   * \return false if no packet is queued
+   */
+  bool RefDequeue (uint64_t &uid, uint32_t &size);
+
+  std::map<uint32_t, RefFlow> m_refFlows;          //!< the reference flows, by bucket
+  std::list<uint32_t> m_refNewFlows;               //!< the reference list of new flows
+  std::list<uint32_t> m_refOldFlows;               //!< the reference list of old flows
+  std::map<uint64_t, uint32_t> m_refSizes;         //!< the sizes of the queued packets
+  uint32_t m_quantum;                              //!< the quantum
+};
+
+FqCoDelQueueDiscRandomTrace::FqCoDelQueueDiscRandomTrace ()
+  : TestCase ("Test the scheduling of the flows along a random sequence of enqueues and dequeues"),
+    m_quantum (300)
+{
+}
+
+FqCoDelQueueDiscRandomTrace::~FqCoDelQueueDiscRandomTrace ()
+{
+}
+
+bool
+FqCoDelQueueDiscRandomTrace::RefDequeue (uint64_t &uid, uint32_t &size)
+{
+  while (true)
+    {
+      uint32_t bucket;
+      bool fromNew = false;
+      bool found = false;
+
+      while (!found && !m_refNewFlows.empty ())
+        {
+          RefFlow &flow = m_refFlows[m_refNewFlows.front ()];
+          if (flow.m_deficit <= 0)
+            {
+              flow.m_deficit += m_quantum;
+              flow.m_status = FqCoDelQueueDisc::OLD_FLOW;
+              m_refOldFlows.push_back (m_refNewFlows.front ());
+              m_refNewFlows.pop_front ();
+            }
+          else
+            {
+              bucket = m_refNewFlows.front ();
+              fromNew = true;
+              found = true;
+            }
+        }
+
+      while (!found && !m_refOldFlows.empty ())
+        {
+          RefFlow &flow = m_refFlows[m_refOldFlows.front ()];
+          if (flow.m_deficit <= 0)
+            {
+              flow.m_deficit += m_quantum;
+              m_refOldFlows.push_back (m_refOldFlows.front ());
+              m_refOldFlows.pop_front ();
+            }
+          else
+            {
+              bucket = m_refOldFlows.front ();
+              found = true;
+            }
+        }
+
+      if (!found)
+        {
+          return false;
+        }
+
+      RefFlow &flow = m_refFlows[bucket];
+      if (flow.m_uids.empty ())
+        {
+          if (fromNew)
+            {
+              // the old flows are not looked at while a new flow has a positive deficit
+              flow.m_status = FqCoDelQueueDisc::OLD_FLOW;
+              m_refOldFlows.push_back (bucket);
+              m_refNewFlows.pop_front ();
+            }
+          else
+            {
+              flow.m_status = FqCoDelQueueDisc::INACTIVE;
+              m_refOldFlows.pop_front ();
+            }
+          continue;
+        }
+
+      uid = flow.m_uids.front ();
+      flow.m_uids.pop_front ();
+      size = m_refSizes[uid];
+      m_refSizes.erase (uid);
+      flow.m_deficit -= size;
+      return true;
+    }
+}
+
+void
+FqCoDelQueueDiscRandomTrace::DoRun (void)
+{
+  // The time does not advance, hence CoDel drops no packet, and the
+  // limit is never reached
+  Ptr<FqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FqCoDelQueueDisc> ("MaxSize", StringValue ("100000p"),
+                                                                                  "Flows", UintegerValue (16));
+  queueDisc->SetQuantum (m_quantum);
+  queueDisc->Initialize ();
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetProtocol (7);
+
+  uint32_t nDequeued = 0;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      // enqueue more than dequeue in the first half, then drain the queue disc
+      double enqueueProbability = (i < 10000 ? 0.55 : 0.4);
+      if (random->GetValue () < enqueueProbability)
+        {
+          uint32_t size = random->GetInteger (1, 1500);
+          hdr.SetPayloadSize (size);
+          hdr.SetDestination (Ipv4Address (0x0a0a0200 + random->GetInteger (1, 40)));
+          Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (Create<Packet> (size), Address (), 0, hdr);
+
+          uint32_t bucket = item->Hash (0) % 16;
+          RefFlow &flow = m_refFlows[bucket];
+          if (flow.m_status == FqCoDelQueueDisc::INACTIVE)
+            {
+              flow.m_status = FqCoDelQueueDisc::NEW_FLOW;
+              flow.m_deficit = m_quantum;
+              m_refNewFlows.push_back (bucket);
+            }
+          flow.m_uids.push_back (item->GetPacket ()->GetUid ());
+          m_refSizes[item->GetPacket ()->GetUid ()] = item->GetSize ();
+
+          NS_TEST_ASSERT_MSG_EQ (queueDisc->Enqueue (item), true, "the packet must be enqueued");
+        }
+      else
+        {
+          uint64_t uid;
+          uint32_t size;
+          Ptr<QueueDiscItem> item = queueDisc->Dequeue ();
+          if (RefDequeue (uid, size))
+            {
+              NS_TEST_ASSERT_MSG_NE (item, 0, "a packet must be dequeued at step " << i);
+              NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->GetUid (), uid, "unexpected packet dequeued at step " << i);
+              NS_TEST_ASSERT_MSG_EQ (item->GetSize (), size, "unexpected packet size at step " << i);
+              nDequeued++;
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (item, 0, "no packet must be dequeued at step " << i);
+            }
+        }
+    }
+
+  uint64_t uid;
+  uint32_t size;
+  while (RefDequeue (uid, size))
+    {
+      Ptr<QueueDiscItem> item = queueDisc->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item, 0, "a packet must be dequeued");
+      NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->GetUid (), uid, "unexpected packet dequeued");
+      nDequeued++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->Dequeue (), 0, "no packet must be left in the queue disc");
+  NS_TEST_ASSERT_MSG_GT (nDequeued, 5000, "too few packets dequeued");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class checks that the CoDel algorithm run on a flow queue drops and
+ * dequeues the same packets as a CoDel queue disc fed with the same packets
+ */
+class FqCoDelQueueDiscCoDelAlgorithm : public TestCase
+{
+public:
+  FqCoDelQueueDiscCoDelAlgorithm ();
+  virtual ~FqCoDelQueueDiscCoDelAlgorithm ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet into both queue discs
+   * \param fqCoDel the FqCoDel queue disc
+   * \param coDel the CoDel queue disc
+   */
+  void Enqueue (Ptr<FqCoDelQueueDisc> fqCoDel, Ptr<CoDelQueueDisc> coDel);
+  /**
+   * Dequeue a packet from both queue discs and compare them
+   * \param fqCoDel the FqCoDel queue disc
+   * \param coDel the CoDel queue disc
+   */
+  void Dequeue (Ptr<FqCoDelQueueDisc> fqCoDel, Ptr<CoDelQueueDisc> coDel);
+};
+
+FqCoDelQueueDiscCoDelAlgorithm::FqCoDelQueueDiscCoDelAlgorithm ()
+  : TestCase ("Test the CoDel algorithm run on the flow queues")
+{
+}
+
+FqCoDelQueueDiscCoDelAlgorithm::~FqCoDelQueueDiscCoDelAlgorithm ()
+{
+}
+
+void
+FqCoDelQueueDiscCoDelAlgorithm::Enqueue (Ptr<FqCoDelQueueDisc> fqCoDel, Ptr<CoDelQueueDisc> coDel)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (1000);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // the copy of the packet has the same uid
+  Ptr<Packet> p = Create<Packet> (1000);
+  fqCoDel->Enqueue (Create<Ipv4QueueDiscItem> (p, Address (), 0, hdr));
+  coDel->Enqueue (Create<Ipv4QueueDiscItem> (p->Copy (), Address (), 0, hdr));
+}
+
+void
+FqCoDelQueueDiscCoDelAlgorithm::Dequeue (Ptr<FqCoDelQueueDisc> fqCoDel, Ptr<CoDelQueueDisc> coDel)
+{
+  Ptr<QueueDiscItem> item = fqCoDel->Dequeue ();
+  Ptr<QueueDiscItem> expected = coDel->Dequeue ();
+  if (!expected)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item, 0, "no packet must be dequeued at " << Simulator::Now ());
+      return;
+    }
+  NS_TEST_EXPECT_MSG_NE (item, 0, "a packet must be dequeued at " << Simulator::Now ());
+  if (item)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->GetUid (), expected->GetPacket ()->GetUid (),
+                             "unexpected packet dequeued at " << Simulator::Now ());
+    }
+}
+
+void
+FqCoDelQueueDiscCoDelAlgorithm::DoRun (void)
+{
+  Ptr<FqCoDelQueueDisc> fqCoDel = CreateObjectWithAttributes<FqCoDelQueueDisc> ("MaxSize", StringValue ("1000p"));
+  fqCoDel->SetQuantum (1500);
+  fqCoDel->Initialize ();
+  Ptr<CoDelQueueDisc> coDel = CreateObjectWithAttributes<CoDelQueueDisc> ("MaxSize", StringValue ("1000p"));
+  coDel->Initialize ();
+
+  // The packets arrive faster than they are served, so that the sojourn
+  // time exceeds the target for more than an interval, several times
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &FqCoDelQueueDiscCoDelAlgorithm::Enqueue, this, fqCoDel, coDel);
+    }
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (500 + 1500 * i), &FqCoDelQueueDiscCoDelAlgorithm::Dequeue, this, fqCoDel, coDel);
+    }
+  Simulator::Run ();
+
+  uint32_t nDropped = coDel->GetStats ().GetNDroppedPackets (CoDelQueueDisc::TARGET_EXCEEDED_DROP);
+  NS_TEST_EXPECT_MSG_GT (nDropped, 10, "too few packets dropped by CoDel");
+  NS_TEST_EXPECT_MSG_EQ (fqCoDel->GetStats ().GetNDroppedPackets (FqCoDelQueueDisc::TARGET_EXCEEDED_DROP), nDropped,
+                         "the flow queue and the CoDel queue disc must drop the same packets");
+  NS_TEST_EXPECT_MSG_EQ (fqCoDel->QueueDisc::GetNPackets (), coDel->QueueDisc::GetNPackets (), "unexpected number of packets in the queue disc");
 
   Simulator::Destroy ();
 }
@@ -525,6 +912,9 @@ FqCoDelQueueDiscTestSuite::FqCoDelQueueDiscTestSuite ()
   AddTestCase (new FqCoDelQueueDiscNoSuitableFilter, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscIPFlowsSeparationAndPacketLimit, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscDeficit, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscFlowsReuse, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscRandomTrace, TestCase::QUICK);
+  AddTestCase (new FqCoDelQueueDiscCoDelAlgorithm, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscTCPFlowsSeparation, TestCase::QUICK);
   AddTestCase (new FqCoDelQueueDiscUDPFlowsSeparation, TestCase::QUICK);
 }
@@ -0,0 +1,310 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/segment-offload-tag.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpSegmentOffloadTest");
+
+/**
+ * \ingroup tests
+ *
+ * \brief Segmentation offload over a device without offload support
+ *
+ * A bulk transfer with segmentation offload runs over a point-to-point
+ * link, whose devices transmit the super-segments, followed by a CSMA
+ * link, whose devices do not: the router hands the CSMA device the
+ * segments of the super-segments, each one fitting in the MTU, instead of
+ * their IP fragments.
+ */
+class Ns3TcpSegmentOffloadTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param useIpv6 Use IPv6 instead of IPv4.
+   */
+  Ns3TcpSegmentOffloadTestCase (bool useIpv6);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Server: handle connection created.
+   * \param s The socket.
+   * \param addr The other party address.
+   */
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  /**
+   * \brief Server: receive data.
+   * \param sock The socket.
+   */
+  void ServerHandleRecv (Ptr<Socket> sock);
+  /**
+   * \brief Client: send data.
+   * \param sock The socket.
+   * \param available Unused in the test.
+   */
+  void SourceHandleSend (Ptr<Socket> sock, uint32_t available);
+  /**
+   * \brief Trace of the packets sent by the point-to-point device of the client
+   * \param p The packet.
+   */
+  void PointToPointTx (Ptr<const Packet> p);
+  /**
+   * \brief Trace of the frames sent by the CSMA device of the router
+   * \param p The frame.
+   */
+  void CsmaTx (Ptr<const Packet> p);
+
+  bool m_useIpv6;           //!< Use IPv6 instead of IPv4.
+  uint32_t m_totalBytes;    //!< Total stream size (in bytes).
+  uint32_t m_txBytes;       //!< Bytes sent by the client.
+  uint32_t m_rxBytes;       //!< Bytes received by the server.
+  bool m_rxCorrupted;       //!< Whether the server received unexpected data.
+  uint32_t m_superSegments; //!< Super-segments sent on the point-to-point link.
+  uint32_t m_csmaPackets;   //!< Packets sent on the CSMA link.
+  uint32_t m_csmaTagged;    //!< Packets sent on the CSMA link with a SegmentOffloadTag.
+  uint32_t m_csmaFragments; //!< IP fragments sent on the CSMA link.
+  uint32_t m_csmaMaxSize;   //!< Largest IP packet sent on the CSMA link.
+};
+
+Ns3TcpSegmentOffloadTestCase::Ns3TcpSegmentOffloadTestCase (bool useIpv6)
+  : TestCase (useIpv6 ? "Segmentation offload followed by a CSMA link, IPv6"
+                      : "Segmentation offload followed by a CSMA link, IPv4"),
+    m_useIpv6 (useIpv6),
+    m_totalBytes (500000),
+    m_txBytes (0),
+    m_rxBytes (0),
+    m_rxCorrupted (false),
+    m_superSegments (0),
+    m_csmaPackets (0),
+    m_csmaTagged (0),
+    m_csmaFragments (0),
+    m_csmaMaxSize (0)
+{
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  s->SetRecvCallback (MakeCallback (&Ns3TcpSegmentOffloadTestCase::ServerHandleRecv, this));
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::ServerHandleRecv (Ptr<Socket> sock)
+{
+  Ptr<Packet> p;
+  while ((p = sock->Recv ()))
+    {
+      uint8_t *buf = new uint8_t [p->GetSize ()];
+      p->CopyData (buf, p->GetSize ());
+      for (uint32_t i = 0; i < p->GetSize (); ++i)
+        {
+          if (buf[i] != static_cast<uint8_t> ((m_rxBytes + i) % 251))
+            {
+              m_rxCorrupted = true;
+            }
+        }
+      delete [] buf;
+      m_rxBytes += p->GetSize ();
+    }
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::SourceHandleSend (Ptr<Socket> sock, uint32_t available)
+{
+  uint8_t buf[1000];
+  while (sock->GetTxAvailable () > 0 && m_txBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_txBytes, sock->GetTxAvailable ());
+      toSend = std::min<uint32_t> (toSend, sizeof (buf));
+      for (uint32_t i = 0; i < toSend; ++i)
+        {
+          buf[i] = static_cast<uint8_t> ((m_txBytes + i) % 251);
+        }
+      int sent = sock->Send (buf, toSend, 0);
+      NS_TEST_ASSERT_MSG_EQ ((sent > 0), true, "Error during send");
+      m_txBytes += sent;
+    }
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::PointToPointTx (Ptr<const Packet> p)
+{
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      ++m_superSegments;
+    }
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::CsmaTx (Ptr<const Packet> p)
+{
+  ++m_csmaPackets;
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      ++m_csmaTagged;
+    }
+  // The device traces the frame, with its Ethernet header and trailer
+  Ptr<Packet> ip = p->Copy ();
+  EthernetHeader ethernetHeader;
+  EthernetTrailer ethernetTrailer;
+  ip->RemoveHeader (ethernetHeader);
+  ip->RemoveTrailer (ethernetTrailer);
+  m_csmaMaxSize = std::max (m_csmaMaxSize, ip->GetSize ());
+  if (m_useIpv6)
+    {
+      Ipv6Header header;
+      ip->PeekHeader (header);
+      if (header.GetNextHeader () == Ipv6Header::IPV6_EXT_FRAGMENTATION)
+        {
+          ++m_csmaFragments;
+        }
+    }
+  else
+    {
+      Ipv4Header header;
+      ip->PeekHeader (header);
+      if (header.IsLastFragment () == false || header.GetFragmentOffset () != 0)
+        {
+          ++m_csmaFragments;
+        }
+    }
+}
+
+void
+Ns3TcpSegmentOffloadTestCase::DoRun (void)
+{
+  // client -- point-to-point -- router -- CSMA -- server
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer p2pDevices = p2p.Install (nodes.Get (0), nodes.Get (1));
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer csmaDevices = csma.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Address serverLocal;
+  Address serverRemote;
+  uint16_t port = 50000;
+  if (m_useIpv6)
+    {
+      Ipv6AddressHelper ipv6;
+      ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer p2pInterfaces = ipv6.Assign (p2pDevices);
+      p2pInterfaces.SetForwarding (1, true);
+      p2pInterfaces.SetDefaultRouteInAllNodes (1);
+      ipv6.SetBase (Ipv6Address ("2001:2::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer csmaInterfaces = ipv6.Assign (csmaDevices);
+      csmaInterfaces.SetForwarding (0, true);
+      csmaInterfaces.SetDefaultRouteInAllNodes (0);
+      serverLocal = Inet6SocketAddress (Ipv6Address::GetAny (), port);
+      serverRemote = Inet6SocketAddress (csmaInterfaces.GetAddress (1, 1), port);
+    }
+  else
+    {
+      Ipv4AddressHelper ipv4;
+      ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+      ipv4.Assign (p2pDevices);
+      ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+      Ipv4InterfaceContainer csmaInterfaces = ipv4.Assign (csmaDevices);
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+      serverLocal = InetSocketAddress (Ipv4Address::GetAny (), port);
+      serverRemote = InetSocketAddress (csmaInterfaces.GetAddress (1), port);
+    }
+
+  p2pDevices.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&Ns3TcpSegmentOffloadTestCase::PointToPointTx, this));
+  csmaDevices.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&Ns3TcpSegmentOffloadTestCase::CsmaTx, this));
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (2), TcpSocketFactory::GetTypeId ());
+  server->SetAttribute ("SegmentSize", UintegerValue (1400));
+  server->SetAttribute ("RcvBufSize", UintegerValue (1000000));
+  server->Bind (serverLocal);
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                             MakeCallback (&Ns3TcpSegmentOffloadTestCase::ServerHandleConnectionCreated, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  source->SetAttribute ("SegmentSize", UintegerValue (1400));
+  source->SetAttribute ("SndBufSize", UintegerValue (1000000));
+  source->SetAttribute ("SegmentOffloadSize", UintegerValue (64000));
+  source->SetSendCallback (MakeCallback (&Ns3TcpSegmentOffloadTestCase::SourceHandleSend, this));
+  Simulator::Schedule (Seconds (0.1), &Socket::Connect, source, serverRemote);
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, m_totalBytes, "Server did not receive all the bytes");
+  NS_TEST_EXPECT_MSG_EQ (m_rxCorrupted, false, "Server received unexpected data");
+  NS_TEST_EXPECT_MSG_GT (m_superSegments, 0, "No super-segment sent on the point-to-point link");
+  NS_TEST_EXPECT_MSG_GT (m_csmaPackets, m_totalBytes / 1400, "The segments were not sent on the CSMA link");
+  NS_TEST_EXPECT_MSG_EQ (m_csmaTagged, 0, "Super-segment sent on the CSMA link");
+  NS_TEST_EXPECT_MSG_EQ (m_csmaFragments, 0, "Fragment sent on the CSMA link");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_csmaMaxSize, csmaDevices.Get (0)->GetMtu (), "Packet larger than the MTU sent on the CSMA link");
+}
+
+/**
+ * \ingroup tests
+ *
+ * \brief TestSuite for segmentation offload over a device without offload support
+ */
+class Ns3TcpSegmentOffloadTestSuite : public TestSuite
+{
+public:
+  Ns3TcpSegmentOffloadTestSuite ()
+    : TestSuite ("ns3-tcp-segment-offload", SYSTEM)
+  {
+    AddTestCase (new Ns3TcpSegmentOffloadTestCase (false), TestCase::QUICK);
+    AddTestCase (new Ns3TcpSegmentOffloadTestCase (true), TestCase::QUICK);
+  }
+};
+
+static Ns3TcpSegmentOffloadTestSuite g_ns3TcpSegmentOffloadTestSuite; //!< Static variable for test initialization
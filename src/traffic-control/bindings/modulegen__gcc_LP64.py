@@ -347,12 +347,10 @@ def register_types(module):
     module.add_class('ExponentialRandomVariable', import_from_module='ns.core', parent=root_module['ns3::RandomVariableStream'])
     ## fifo-queue-disc.h (module 'traffic-control'): ns3::FifoQueueDisc [class]
     module.add_class('FifoQueueDisc', parent=root_module['ns3::QueueDisc'])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelFlow [class]
-    module.add_class('FqCoDelFlow', parent=root_module['ns3::QueueDiscClass'])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelFlow::FlowStatus [enumeration]
-    module.add_enum('FlowStatus', ['INACTIVE', 'NEW_FLOW', 'OLD_FLOW'], outer_class=root_module['ns3::FqCoDelFlow'])
     ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc [class]
     module.add_class('FqCoDelQueueDisc', parent=root_module['ns3::QueueDisc'])
+    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc::FlowStatus [enumeration]
+    module.add_enum('FlowStatus', ['INACTIVE', 'NEW_FLOW', 'OLD_FLOW'], outer_class=root_module['ns3::FqCoDelQueueDisc'])
     ## random-variable-stream.h (module 'core'): ns3::GammaRandomVariable [class]
     module.add_class('GammaRandomVariable', import_from_module='ns.core', parent=root_module['ns3::RandomVariableStream'])
     ## integer.h (module 'core'): ns3::IntegerValue [class]
@@ -717,7 +715,6 @@ def register_methods(root_module):
     register_Ns3EventImpl_methods(root_module, root_module['ns3::EventImpl'])
     register_Ns3ExponentialRandomVariable_methods(root_module, root_module['ns3::ExponentialRandomVariable'])
     register_Ns3FifoQueueDisc_methods(root_module, root_module['ns3::FifoQueueDisc'])
-    register_Ns3FqCoDelFlow_methods(root_module, root_module['ns3::FqCoDelFlow'])
     register_Ns3FqCoDelQueueDisc_methods(root_module, root_module['ns3::FqCoDelQueueDisc'])
     register_Ns3GammaRandomVariable_methods(root_module, root_module['ns3::GammaRandomVariable'])
     register_Ns3IntegerValue_methods(root_module, root_module['ns3::IntegerValue'])
@@ -3539,6 +3536,16 @@ def register_Ns3QueueDisc_methods(root_module, cls):
                    'void', 
                    [param('ns3::Ptr< ns3::QueueDiscItem const >', 'item'), param('char const *', 'reason')], 
                    visibility='protected')
+    ## queue-disc.h (module 'traffic-control'): void ns3::QueueDisc::PacketEnqueued(ns3::Ptr<const ns3::QueueDiscItem> item) [member function]
+    cls.add_method('PacketEnqueued', 
+                   'void', 
+                   [param('ns3::Ptr< ns3::QueueDiscItem const >', 'item')], 
+                   visibility='protected')
+    ## queue-disc.h (module 'traffic-control'): void ns3::QueueDisc::PacketDequeued(ns3::Ptr<const ns3::QueueDiscItem> item) [member function]
+    cls.add_method('PacketDequeued', 
+                   'void', 
+                   [param('ns3::Ptr< ns3::QueueDiscItem const >', 'item')], 
+                   visibility='protected')
     ## queue-disc.h (module 'traffic-control'): void ns3::QueueDisc::DropBeforeEnqueue(ns3::Ptr<const ns3::QueueDiscItem> item, char const * reason) [member function]
     cls.add_method('DropBeforeEnqueue', 
                    'void', 
@@ -5294,40 +5301,6 @@ def register_Ns3FifoQueueDisc_methods(root_module, cls):
                    visibility='private', is_virtual=True)
     return
 
-def register_Ns3FqCoDelFlow_methods(root_module, cls):
-    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelFlow::FqCoDelFlow(ns3::FqCoDelFlow const & arg0) [constructor]
-    cls.add_constructor([param('ns3::FqCoDelFlow const &', 'arg0')])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelFlow::FqCoDelFlow() [constructor]
-    cls.add_constructor([])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): int32_t ns3::FqCoDelFlow::GetDeficit() const [member function]
-    cls.add_method('GetDeficit', 
-                   'int32_t', 
-                   [], 
-                   is_const=True)
-    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelFlow::FlowStatus ns3::FqCoDelFlow::GetStatus() const [member function]
-    cls.add_method('GetStatus', 
-                   'ns3::FqCoDelFlow::FlowStatus', 
-                   [], 
-                   is_const=True)
-    ## fq-codel-queue-disc.h (module 'traffic-control'): static ns3::TypeId ns3::FqCoDelFlow::GetTypeId() [member function]
-    cls.add_method('GetTypeId', 
-                   'ns3::TypeId', 
-                   [], 
-                   is_static=True)
-    ## fq-codel-queue-disc.h (module 'traffic-control'): void ns3::FqCoDelFlow::IncreaseDeficit(int32_t deficit) [member function]
-    cls.add_method('IncreaseDeficit', 
-                   'void', 
-                   [param('int32_t', 'deficit')])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): void ns3::FqCoDelFlow::SetDeficit(uint32_t deficit) [member function]
-    cls.add_method('SetDeficit', 
-                   'void', 
-                   [param('uint32_t', 'deficit')])
-    ## fq-codel-queue-disc.h (module 'traffic-control'): void ns3::FqCoDelFlow::SetStatus(ns3::FqCoDelFlow::FlowStatus status) [member function]
-    cls.add_method('SetStatus', 
-                   'void', 
-                   [param('ns3::FqCoDelFlow::FlowStatus', 'status')])
-    return
-
 def register_Ns3FqCoDelQueueDisc_methods(root_module, cls):
     ## fq-codel-queue-disc.h (module 'traffic-control'): static ns3::TypeId ns3::FqCoDelQueueDisc::GetTypeId() [member function]
     cls.add_method('GetTypeId', 
@@ -5345,10 +5318,32 @@ def register_Ns3FqCoDelQueueDisc_methods(root_module, cls):
                    'uint32_t', 
                    [], 
                    is_const=True)
+    ## fq-codel-queue-disc.h (module 'traffic-control'): uint32_t ns3::FqCoDelQueueDisc::GetNFlowQueues() const [member function]
+    cls.add_method('GetNFlowQueues', 
+                   'uint32_t', 
+                   [], 
+                   is_const=True)
+    ## fq-codel-queue-disc.h (module 'traffic-control'): uint32_t ns3::FqCoDelQueueDisc::GetFlowQueueNPackets(uint32_t i) const [member function]
+    cls.add_method('GetFlowQueueNPackets', 
+                   'uint32_t', 
+                   [param('uint32_t', 'i')], 
+                   is_const=True)
+    ## fq-codel-queue-disc.h (module 'traffic-control'): int32_t ns3::FqCoDelQueueDisc::GetFlowQueueDeficit(uint32_t i) const [member function]
+    cls.add_method('GetFlowQueueDeficit', 
+                   'int32_t', 
+                   [param('uint32_t', 'i')], 
+                   is_const=True)
+    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc::FlowStatus ns3::FqCoDelQueueDisc::GetFlowQueueStatus(uint32_t i) const [member function]
+    cls.add_method('GetFlowQueueStatus', 
+                   'ns3::FqCoDelQueueDisc::FlowStatus', 
+                   [param('uint32_t', 'i')], 
+                   is_const=True)
     ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc::UNCLASSIFIED_DROP [variable]
     cls.add_static_attribute('UNCLASSIFIED_DROP', 'char const * const', is_const=True)
     ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc::OVERLIMIT_DROP [variable]
     cls.add_static_attribute('OVERLIMIT_DROP', 'char const * const', is_const=True)
+    ## fq-codel-queue-disc.h (module 'traffic-control'): ns3::FqCoDelQueueDisc::TARGET_EXCEEDED_DROP [variable]
+    cls.add_static_attribute('TARGET_EXCEEDED_DROP', 'char const * const', is_const=True)
     ## fq-codel-queue-disc.h (module 'traffic-control'): bool ns3::FqCoDelQueueDisc::DoEnqueue(ns3::Ptr<ns3::QueueDiscItem> item) [member function]
     cls.add_method('DoEnqueue', 
                    'bool', 
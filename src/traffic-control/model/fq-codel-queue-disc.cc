@@ -21,7 +21,8 @@
 
 #include "ns3/log.h"
 #include "ns3/string.h"
-#include "ns3/queue.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 #include "fq-codel-queue-disc.h"
 #include "codel-queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
@@ -30,68 +31,67 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FqCoDelQueueDisc");
 
-NS_OBJECT_ENSURE_REGISTERED (FqCoDelFlow);
-
-TypeId FqCoDelFlow::GetTypeId (void)
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+static inline uint32_t ReciprocalDivide (uint32_t A, uint32_t R)
 {
-  static TypeId tid = TypeId ("ns3::FqCoDelFlow")
-    .SetParent<QueueDiscClass> ()
-    .SetGroupName ("TrafficControl")
-    .AddConstructor<FqCoDelFlow> ()
-  ;
-  return tid;
+  return (uint32_t)(((uint64_t)A * R) >> 32);
 }
 
-FqCoDelFlow::FqCoDelFlow ()
-  : m_deficit (0),
-    m_status (INACTIVE)
+/**
+ * Translates a time in CoDel time representation
+ * \param t the time
+ * \return the time in CoDel time representation
+ */
+static inline uint32_t Time2CoDel (Time t)
 {
-  NS_LOG_FUNCTION (this);
+  return static_cast<uint32_t>(t.GetNanoSeconds () >> CODEL_SHIFT);
 }
 
-FqCoDelFlow::~FqCoDelFlow ()
+/**
+ * Check if CoDel time a is successive to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than b
+ */
+static inline bool CoDelTimeAfter (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this);
+  return  ((int)(a) - (int)(b) > 0);
 }
 
-void
-FqCoDelFlow::SetDeficit (uint32_t deficit)
+/**
+ * Check if CoDel time a is successive or equal to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than or equal to b
+ */
+static inline bool CoDelTimeAfterEq (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this << deficit);
-  m_deficit = deficit;
+  return ((int)(a) - (int)(b) >= 0);
 }
 
-int32_t
-FqCoDelFlow::GetDeficit (void) const
+/**
+ * Check if CoDel time a is preceding b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is less than b
+ */
+static inline bool CoDelTimeBefore (uint32_t a, uint32_t b)
 {
-  NS_LOG_FUNCTION (this);
-  return m_deficit;
-}
-
-void
-FqCoDelFlow::IncreaseDeficit (int32_t deficit)
-{
-  NS_LOG_FUNCTION (this << deficit);
-  m_deficit += deficit;
-}
-
-void
-FqCoDelFlow::SetStatus (FlowStatus status)
-{
-  NS_LOG_FUNCTION (this);
-  m_status = status;
-}
-
-FqCoDelFlow::FlowStatus
-FqCoDelFlow::GetStatus (void) const
-{
-  NS_LOG_FUNCTION (this);
-  return m_status;
+  return  ((int)(a) - (int)(b) < 0);
 }
 
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
+const uint32_t FqCoDelQueueDisc::NO_FLOW;
+const uint32_t FqCoDelQueueDisc::NO_ITEM;
+
 TypeId FqCoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCoDelQueueDisc")
@@ -135,9 +135,16 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
 
 FqCoDelQueueDisc::FqCoDelQueueDisc ()
   : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
-    m_quantum (0)
+    m_quantum (0),
+    m_codelInterval (0),
+    m_codelTarget (0),
+    m_minBytes (0),
+    m_nFlowQueues (0),
+    m_freeItem (NO_ITEM)
 {
   NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NO_FLOW;
+  m_oldFlows.head = m_oldFlows.tail = NO_FLOW;
 }
 
 FqCoDelQueueDisc::~FqCoDelQueueDisc ()
@@ -145,6 +152,47 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NO_FLOW;
+  m_oldFlows.head = m_oldFlows.tail = NO_FLOW;
+  m_flowsIndices.clear ();
+  m_flowTable.clear ();
+  m_nFlowQueues = 0;
+  m_items.clear ();
+  m_nextItem.clear ();
+  m_freeItem = NO_ITEM;
+  QueueDisc::DoDispose ();
+}
+
+void
+FqCoDelQueueDisc::PushBack (FlowList &list, uint32_t index)
+{
+  m_flowTable[index].next = NO_FLOW;
+  if (list.tail == NO_FLOW)
+    {
+      list.head = index;
+    }
+  else
+    {
+      m_flowTable[list.tail].next = index;
+    }
+  list.tail = index;
+}
+
+void
+FqCoDelQueueDisc::PopFront (FlowList &list)
+{
+  NS_ASSERT (list.head != NO_FLOW);
+  list.head = m_flowTable[list.head].next;
+  if (list.head == NO_FLOW)
+    {
+      list.tail = NO_FLOW;
+    }
+}
+
 void
 FqCoDelQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -158,6 +206,96 @@ FqCoDelQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
+uint32_t
+FqCoDelQueueDisc::GetNFlowQueues (void) const
+{
+  return m_nFlowQueues;
+}
+
+uint32_t
+FqCoDelQueueDisc::GetFlowQueueNPackets (uint32_t i) const
+{
+  NS_ASSERT (i < m_nFlowQueues);
+  return m_flowTable[i].nPackets;
+}
+
+int32_t
+FqCoDelQueueDisc::GetFlowQueueDeficit (uint32_t i) const
+{
+  NS_ASSERT (i < m_nFlowQueues);
+  return m_flowTable[i].deficit;
+}
+
+FqCoDelQueueDisc::FlowStatus
+FqCoDelQueueDisc::GetFlowQueueStatus (uint32_t i) const
+{
+  NS_ASSERT (i < m_nFlowQueues);
+  return m_flowTable[i].status;
+}
+
+void
+FqCoDelQueueDisc::FlowEnqueue (FlowQueue &flow, Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (m_freeItem == NO_ITEM)
+    {
+      // the packet pool is sized after the limit at initialization time,
+      // hence it only grows if the limit is raised afterwards
+      m_freeItem = m_items.size ();
+      m_items.push_back (0);
+      m_nextItem.push_back (NO_ITEM);
+    }
+  uint32_t slot = m_freeItem;
+  m_freeItem = m_nextItem[slot];
+
+  m_items[slot] = item;
+  m_nextItem[slot] = NO_ITEM;
+  if (flow.tail == NO_ITEM)
+    {
+      flow.head = slot;
+    }
+  else
+    {
+      m_nextItem[flow.tail] = slot;
+    }
+  flow.tail = slot;
+  flow.nPackets++;
+  flow.nBytes += item->GetSize ();
+
+  // the time stamp is needed by CoDel and by the dequeue traces even if
+  // the packet is dropped before DoEnqueue returns
+  item->SetTimeStamp (Simulator::Now ());
+  PacketEnqueued (item);
+}
+
+Ptr<QueueDiscItem>
+FqCoDelQueueDisc::FlowDequeue (FlowQueue &flow)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (flow.head == NO_ITEM)
+    {
+      return 0;
+    }
+
+  uint32_t slot = flow.head;
+  Ptr<QueueDiscItem> item = m_items[slot];
+  m_items[slot] = 0;
+  flow.head = m_nextItem[slot];
+  if (flow.head == NO_ITEM)
+    {
+      flow.tail = NO_ITEM;
+    }
+  m_nextItem[slot] = m_freeItem;
+  m_freeItem = slot;
+  flow.nPackets--;
+  flow.nBytes -= item->GetSize ();
+
+  PacketDequeued (item);
+  return item;
+}
+
 bool
 FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
@@ -185,33 +323,35 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         }
     }
 
-  Ptr<FqCoDelFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
+  NS_ASSERT (h < m_flowsIndices.size ());
+  uint32_t index = m_flowsIndices[h];
+  if (index == NO_FLOW)
     {
-      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
-      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
-      qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      AddQueueDiscClass (flow);
-
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
+      NS_LOG_DEBUG ("Using a new flow queue for bucket " << h);
+      index = m_nFlowQueues++;
+      m_flowsIndices[h] = index;
     }
-  else
+  FlowQueue &flow = m_flowTable[index];
+
+  if (flow.status == INACTIVE)
     {
-      flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      PushBack (m_newFlows, index);
     }
 
-  if (flow->GetStatus () == FqCoDelFlow::INACTIVE)
+  // As a CoDel queue disc, each flow queue is limited to the size of the
+  // whole queue disc
+  if (flow.nPackets + 1 > GetMaxSize ().GetValue ())
     {
-      flow->SetStatus (FqCoDelFlow::NEW_FLOW);
-      flow->SetDeficit (m_quantum);
-      m_newFlows.push_back (flow);
+      NS_LOG_LOGIC ("Flow queue full -- dropping pkt");
+      DropBeforeEnqueue (item, OVERLIMIT_DROP);
+      return false;
     }
 
-  flow->GetQueueDisc ()->Enqueue (item);
+  FlowEnqueue (flow, item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << index);
 
   if (GetCurrentSize () > GetMaxSize ())
     {
@@ -226,23 +366,24 @@ FqCoDelQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<FqCoDelFlow> flow;
+  FlowQueue *flow = 0;
   Ptr<QueueDiscItem> item;
 
   do
     {
       bool found = false;
 
-      while (!found && !m_newFlows.empty ())
+      while (!found && m_newFlows.head != NO_FLOW)
         {
-          flow = m_newFlows.front ();
+          uint32_t index = m_newFlows.head;
+          flow = &m_flowTable[index];
 
-          if (flow->GetDeficit () <= 0)
+          if (flow->deficit <= 0)
             {
-              flow->IncreaseDeficit (m_quantum);
-              flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              flow->deficit += m_quantum;
+              flow->status = OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
             }
           else
             {
@@ -251,15 +392,16 @@ FqCoDelQueueDisc::DoDequeue (void)
             }
         }
 
-      while (!found && !m_oldFlows.empty ())
+      while (!found && m_oldFlows.head != NO_FLOW)
         {
-          flow = m_oldFlows.front ();
+          uint32_t index = m_oldFlows.head;
+          flow = &m_flowTable[index];
 
-          if (flow->GetDeficit () <= 0)
+          if (flow->deficit <= 0)
             {
-              flow->IncreaseDeficit (m_quantum);
-              m_oldFlows.push_back (flow);
-              m_oldFlows.pop_front ();
+              flow->deficit += m_quantum;
+              PopFront (m_oldFlows);
+              PushBack (m_oldFlows, index);
             }
           else
             {
@@ -274,21 +416,22 @@ FqCoDelQueueDisc::DoDequeue (void)
           return 0;
         }
 
-      item = flow->GetQueueDisc ()->Dequeue ();
+      item = CoDelDequeue (*flow);
 
       if (!item)
         {
           NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
-          if (!m_newFlows.empty ())
+          if (m_newFlows.head != NO_FLOW)
             {
-              flow->SetStatus (FqCoDelFlow::OLD_FLOW);
-              m_oldFlows.push_back (flow);
-              m_newFlows.pop_front ();
+              uint32_t index = m_newFlows.head;
+              flow->status = OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
             }
           else
             {
-              flow->SetStatus (FqCoDelFlow::INACTIVE);
-              m_oldFlows.pop_front ();
+              flow->status = INACTIVE;
+              PopFront (m_oldFlows);
             }
         }
       else
@@ -297,7 +440,7 @@ FqCoDelQueueDisc::DoDequeue (void)
         }
     } while (item == 0);
 
-  flow->IncreaseDeficit (item->GetSize () * -1);
+  flow->deficit -= item->GetSize ();
 
   return item;
 }
@@ -347,12 +490,190 @@ FqCoDelQueueDisc::InitializeParams (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_flowFactory.SetTypeId ("ns3::FqCoDelFlow");
+  m_codelInterval = Time2CoDel (Time (m_interval));
+  m_codelTarget = Time2CoDel (Time (m_target));
+
+  // The flow queues used to be CoDel queue discs: keep using the minbytes
+  // parameter configured for them
+  TypeId::AttributeInformation info;
+  bool found = CoDelQueueDisc::GetTypeId ().LookupAttributeByName ("MinBytes", &info);
+  NS_ASSERT (found);
+  m_minBytes = DynamicCast<const UintegerValue> (info.initialValue)->Get ();
+
+  // The flow queues of all the buckets and the packet pool, which can hold
+  // as many packets as the limit plus the one being enqueued, are allocated
+  // once and for all
+  FlowQueue inactive;
+  inactive.deficit = 0;
+  inactive.status = INACTIVE;
+  inactive.next = NO_FLOW;
+  inactive.head = inactive.tail = NO_ITEM;
+  inactive.nPackets = inactive.nBytes = 0;
+  inactive.count = inactive.lastCount = 0;
+  inactive.dropping = false;
+  inactive.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+  inactive.firstAboveTime = inactive.dropNext = 0;
+
+  m_flowsIndices.assign (m_flows, NO_FLOW);
+  m_flowTable.assign (m_flows, inactive);
+  m_nFlowQueues = 0;
+
+  uint32_t nItems = GetMaxSize ().GetValue () + 1;
+  m_items.assign (nItems, 0);
+  m_nextItem.resize (nItems);
+  for (uint32_t i = 0; i < nItems; i++)
+    {
+      m_nextItem[i] = (i + 1 < nItems ? i + 1 : NO_ITEM);
+    }
+  m_freeItem = 0;
+}
+
+void
+FqCoDelQueueDisc::NewtonStep (FlowQueue &flow)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t invsqrt = ((uint32_t) flow.recInvSqrt) << REC_INV_SQRT_SHIFT;
+  uint32_t invsqrt2 = ((uint64_t) invsqrt * invsqrt) >> 32;
+  uint64_t val = (3ll << 32) - ((uint64_t) flow.count * invsqrt2);
+
+  val >>= 2; /* avoid overflow */
+  val = (val * invsqrt) >> (32 - 2 + 1);
+  flow.recInvSqrt = static_cast<uint16_t>(val >> REC_INV_SQRT_SHIFT);
+}
+
+uint32_t
+FqCoDelQueueDisc::ControlLaw (const FlowQueue &flow, uint32_t t)
+{
+  NS_LOG_FUNCTION (this);
+  return t + ReciprocalDivide (m_codelInterval, flow.recInvSqrt << REC_INV_SQRT_SHIFT);
+}
+
+bool
+FqCoDelQueueDisc::OkToDrop (FlowQueue &flow, Ptr<QueueDiscItem> item, uint32_t now)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!item)
+    {
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  Time delta = Simulator::Now () - item->GetTimeStamp ();
+  NS_LOG_INFO ("Sojourn time " << delta.ToDouble (Time::MS) << "ms");
+  uint32_t sojournTime = Time2CoDel (delta);
+
+  if (CoDelTimeBefore (sojournTime, m_codelTarget) || flow.nBytes < m_minBytes)
+    {
+      // went below so we'll stay below for at least q->interval
+      NS_LOG_LOGIC ("Sojourn time is below target or number of bytes in queue is less than minBytes; packet should not be dropped");
+      flow.firstAboveTime = 0;
+      return false;
+    }
+  bool okToDrop = false;
+  if (flow.firstAboveTime == 0)
+    {
+      /* just went above from below. If we stay above
+       * for at least q->interval we'll say it's ok to drop
+       */
+      NS_LOG_LOGIC ("Sojourn time has just gone above target from below, need to stay above for at least q->interval before packet can be dropped. ");
+      flow.firstAboveTime = now + m_codelInterval;
+    }
+  else if (CoDelTimeAfter (now, flow.firstAboveTime))
+    {
+      NS_LOG_LOGIC ("Sojourn time has been above target for at least q->interval; it's OK to (possibly) drop packet.");
+      okToDrop = true;
+    }
+  return okToDrop;
+}
+
+Ptr<QueueDiscItem>
+FqCoDelQueueDisc::CoDelDequeue (FlowQueue &flow)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item = FlowDequeue (flow);
+  if (!item)
+    {
+      // Leave dropping state when queue is empty
+      flow.dropping = false;
+      NS_LOG_LOGIC ("Flow queue empty");
+      return 0;
+    }
+  uint32_t now = Time2CoDel (Simulator::Now ());
+
+  // Determine if item should be dropped
+  bool okToDrop = OkToDrop (flow, item, now);
 
-  m_queueDiscFactory.SetTypeId ("ns3::CoDelQueueDisc");
-  m_queueDiscFactory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
-  m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
-  m_queueDiscFactory.Set ("Target", StringValue (m_target));
+  if (flow.dropping)
+    { // In the dropping state (sojourn time has gone above target and hasn't come down yet)
+      // Check if we can leave the dropping state or next drop should occur
+      if (!okToDrop)
+        {
+          /* sojourn time fell below target - leave dropping state */
+          NS_LOG_LOGIC ("Sojourn time goes below target, it's OK to leave dropping state.");
+          flow.dropping = false;
+        }
+      else if (CoDelTimeAfterEq (now, flow.dropNext))
+        {
+          while (flow.dropping && CoDelTimeAfterEq (now, flow.dropNext))
+            {
+              // It's time for the next drop. Drop the current packet and
+              // dequeue the next. The dequeue might take us out of dropping
+              // state. If not, schedule the next drop.
+              NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
+              DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+
+              ++flow.count;
+              NewtonStep (flow);
+              item = FlowDequeue (flow);
+
+              if (!OkToDrop (flow, item, now))
+                {
+                  /* leave dropping state */
+                  NS_LOG_LOGIC ("Leaving dropping state");
+                  flow.dropping = false;
+                }
+              else
+                {
+                  /* schedule the next drop */
+                  flow.dropNext = ControlLaw (flow, flow.dropNext);
+                  NS_LOG_LOGIC ("Scheduled next drop at " << (double)flow.dropNext / 1000000);
+                }
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      // Drop the first packet and enter dropping state unless the queue is empty
+      NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
+      DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+
+      item = FlowDequeue (flow);
+
+      OkToDrop (flow, item, now);
+      flow.dropping = true;
+      /*
+       * if min went above target close to when we last went below it
+       * assume that the drop rate that controlled the queue on the
+       * last cycle is a good starting point to control it now.
+       */
+      int delta = flow.count - flow.lastCount;
+      if (delta > 1 && CoDelTimeBefore (now - flow.dropNext, 16 * m_codelInterval))
+        {
+          flow.count = delta;
+          NewtonStep (flow);
+        }
+      else
+        {
+          flow.count = 1;
+          flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+      flow.lastCount = flow.count;
+      flow.dropNext = ControlLaw (flow, now);
+      NS_LOG_LOGIC ("Scheduled next drop at " << (double)flow.dropNext / 1000000 << " now " << (double)now / 1000000);
+    }
+  return item;
 }
 
 uint32_t
@@ -361,28 +682,32 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   NS_LOG_FUNCTION (this);
 
   uint32_t maxBacklog = 0, index = 0;
-  Ptr<QueueDisc> qd;
 
-  /* Queue is full! Find the fat flow and drop packet(s) from it */
-  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+  /* Queue is full! Find the fat flow and drop packet(s) from it. Only the
+   * flows in the lists may have a backlog: pick the one with the lowest
+   * index among those with the largest backlog */
+  const FlowList *lists[] = { &m_newFlows, &m_oldFlows };
+  for (uint32_t l = 0; l < 2; l++)
     {
-      qd = GetQueueDiscClass (i)->GetQueueDisc ();
-      uint32_t bytes = qd->GetNBytes ();
-      if (bytes > maxBacklog)
+      for (uint32_t i = lists[l]->head; i != NO_FLOW; i = m_flowTable[i].next)
         {
-          maxBacklog = bytes;
-          index = i;
+          uint32_t bytes = m_flowTable[i].nBytes;
+          if (bytes > maxBacklog || (bytes == maxBacklog && bytes > 0 && i < index))
+            {
+              maxBacklog = bytes;
+              index = i;
+            }
         }
     }
 
   /* Our goal is to drop half of this fat flow backlog */
   uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
-  qd = GetQueueDiscClass (index)->GetQueueDisc ();
+  FlowQueue &flow = m_flowTable[index];
   Ptr<QueueDiscItem> item;
 
   do
     {
-      item = qd->GetInternalQueue (0)->Dequeue ();
+      item = FlowDequeue (flow);
       DropAfterDequeue (item, OVERLIMIT_DROP);
       len += item->GetSize ();
     } while (++count < m_dropBatchSize && len < threshold);
@@ -23,19 +23,17 @@
 #define FQ_CODEL_QUEUE_DISC
 
 #include "ns3/queue-disc.h"
-#include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
 /**
  * \ingroup traffic-control
  *
- * \brief A flow queue used by the FqCoDel queue disc
+ * \brief A FqCoDel packet queue disc
  */
 
-class FqCoDelFlow : public QueueDiscClass {
+class FqCoDelQueueDisc : public QueueDisc {
 public:
   /**
    * \brief Get the type ID.
@@ -43,15 +41,29 @@ public:
    */
   static TypeId GetTypeId (void);
   /**
-   * \brief FqCoDelFlow constructor
+   * \brief FqCoDelQueueDisc constructor
    */
-  FqCoDelFlow ();
+  FqCoDelQueueDisc ();
 
-  virtual ~FqCoDelFlow ();
+  virtual ~FqCoDelQueueDisc ();
+
+   /**
+    * \brief Set the quantum value.
+    *
+    * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+    */
+   void SetQuantum (uint32_t quantum);
+
+   /**
+    * \brief Get the quantum value.
+    *
+    * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+    */
+   uint32_t GetQuantum (void) const;
 
   /**
    * \enum FlowStatus
-   * \brief Used to determine the status of this flow queue
+   * \brief Used to determine the status of a flow queue
    */
   enum FlowStatus
     {
@@ -61,80 +73,142 @@ public:
     };
 
   /**
-   * \brief Set the deficit for this flow
-   * \param deficit the deficit for this flow
+   * \brief Get the number of flow queues in use
+   *
+   * The flow queue of a bucket is in use since the first packet classified
+   * into the bucket. The flow queues are numbered in the order in which
+   * they came into use.
+   *
+   * \return the number of flow queues in use
    */
-  void SetDeficit (uint32_t deficit);
+  uint32_t GetNFlowQueues (void) const;
   /**
-   * \brief Get the deficit for this flow
-   * \return the deficit for this flow
+   * \brief Get the number of packets in a flow queue
+   * \param i the index of the flow queue
+   * \return the number of packets in the flow queue
    */
-  int32_t GetDeficit (void) const;
+  uint32_t GetFlowQueueNPackets (uint32_t i) const;
   /**
-   * \brief Increase the deficit for this flow
-   * \param deficit the amount by which the deficit is to be increased
+   * \brief Get the deficit of a flow queue
+   * \param i the index of the flow queue
+   * \return the deficit of the flow queue
    */
-  void IncreaseDeficit (int32_t deficit);
+  int32_t GetFlowQueueDeficit (uint32_t i) const;
   /**
-   * \brief Set the status for this flow
-   * \param status the status for this flow
+   * \brief Get the status of a flow queue
+   * \param i the index of the flow queue
+   * \return the status of the flow queue
    */
-  void SetStatus (FlowStatus status);
+  FlowStatus GetFlowQueueStatus (uint32_t i) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
+  static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+  static constexpr const char* TARGET_EXCEEDED_DROP = "Target exceeded drop";  //!< Sojourn time above target
+
+protected:
   /**
-   * \brief Get the status of this flow
-   * \return the status of this flow
+   * \brief Dispose of the object
    */
-  FlowStatus GetStatus (void) const;
+  virtual void DoDispose (void);
 
 private:
-  int32_t m_deficit;    //!< the deficit for this flow
-  FlowStatus m_status;  //!< the status of this flow
-};
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
 
+  static const uint32_t NO_FLOW = 0xffffffff;  //!< Index of no flow queue
+  static const uint32_t NO_ITEM = 0xffffffff;  //!< Index of no slot of the packet pool
 
-/**
- * \ingroup traffic-control
- *
- * \brief A FqCoDel packet queue disc
- */
-
-class FqCoDelQueueDisc : public QueueDisc {
-public:
   /**
-   * \brief Get the type ID.
-   * \return the object TypeId
+   * \brief A flow queue, held in the flow table
+   *
+   * The packets of the flow queue are linked through the slots of the
+   * packet pool, and the CoDel state is that of CoDelQueueDisc.
    */
-  static TypeId GetTypeId (void);
+  struct FlowQueue
+  {
+    int32_t deficit;          //!< the deficit of the flow queue
+    FlowStatus status;        //!< the status of the flow queue
+    uint32_t next;            //!< next flow queue in the list of new or old flows
+    uint32_t head;            //!< slot of the first packet, or NO_ITEM
+    uint32_t tail;            //!< slot of the last packet, or NO_ITEM
+    uint32_t nPackets;        //!< number of packets in the flow queue
+    uint32_t nBytes;          //!< number of bytes in the flow queue
+    uint32_t count;           //!< number of packets dropped since entering the dropping state
+    uint32_t lastCount;       //!< count when the dropping state was last entered
+    bool dropping;            //!< whether the flow queue is in the dropping state
+    uint16_t recInvSqrt;      //!< reciprocal inverse square root of count
+    uint32_t firstAboveTime;  //!< time above target since which packets can be dropped
+    uint32_t dropNext;        //!< time to drop the next packet
+  };
+
   /**
-   * \brief FqCoDelQueueDisc constructor
+   * \brief A FIFO list of flow queues, linked through FlowQueue::next
+   *
+   * The lists do not allocate: a flow queue belongs to at most one list,
+   * as told by its status, so a single link per flow queue is enough.
    */
-  FqCoDelQueueDisc ();
-
-  virtual ~FqCoDelQueueDisc ();
+  struct FlowList
+  {
+    uint32_t head;  //!< Index of the first flow queue, or NO_FLOW
+    uint32_t tail;  //!< Index of the last flow queue, or NO_FLOW
+  };
 
-   /**
-    * \brief Set the quantum value.
-    *
-    * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
-    */
-   void SetQuantum (uint32_t quantum);
-
-   /**
-    * \brief Get the quantum value.
-    *
-    * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
-    */
-   uint32_t GetQuantum (void) const;
+  /**
+   * \brief Append a flow queue to a list
+   * \param list the list
+   * \param index the index of the flow queue
+   */
+  void PushBack (FlowList &list, uint32_t index);
+  /**
+   * \brief Remove the first flow queue of a list
+   * \param list the list, which must not be empty
+   */
+  void PopFront (FlowList &list);
 
-  // Reasons for dropping packets
-  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
-  static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+  /**
+   * \brief Append a packet to a flow queue
+   * \param flow the flow queue
+   * \param item the packet
+   */
+  void FlowEnqueue (FlowQueue &flow, Ptr<QueueDiscItem> item);
+  /**
+   * \brief Remove the packet at the head of a flow queue
+   * \param flow the flow queue
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> FlowDequeue (FlowQueue &flow);
 
-private:
-  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
-  virtual Ptr<QueueDiscItem> DoDequeue (void);
-  virtual bool CheckConfig (void);
-  virtual void InitializeParams (void);
+  /**
+   * \brief Dequeue a packet from a flow queue through the CoDel algorithm,
+   *        as CoDelQueueDisc::DoDequeue does
+   * \param flow the flow queue
+   * \return the packet, or 0 if the flow queue is or becomes empty
+   */
+  Ptr<QueueDiscItem> CoDelDequeue (FlowQueue &flow);
+  /**
+   * \brief Check if a packet needs to be dropped due to its sojourn time,
+   *        as CoDelQueueDisc::OkToDrop does
+   * \param flow the flow queue
+   * \param item the packet dequeued from the flow queue
+   * \param now the time in CoDel time representation
+   * \return true if the packet can be dropped
+   */
+  bool OkToDrop (FlowQueue &flow, Ptr<QueueDiscItem> item, uint32_t now);
+  /**
+   * \brief Calculate the reciprocal square root of the count of a flow queue
+   * \param flow the flow queue
+   */
+  void NewtonStep (FlowQueue &flow);
+  /**
+   * \brief Determine the time for the next drop
+   * \param flow the flow queue
+   * \param t the current time in CoDel time representation
+   * \return the time for the next drop in CoDel time representation
+   */
+  uint32_t ControlLaw (const FlowQueue &flow, uint32_t t);
 
   /**
    * \brief Drop a packet from the head of the queue with the largest current byte count
@@ -149,13 +223,20 @@ private:
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
 
-  std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
-  std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
+  uint32_t m_codelInterval;  //!< CoDel interval in CoDel time representation
+  uint32_t m_codelTarget;    //!< CoDel target in CoDel time representation
+  uint32_t m_minBytes;       //!< CoDel minbytes parameter
+
+  FlowList m_newFlows;    //!< The list of new flows
+  FlowList m_oldFlows;    //!< The list of old flows
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  std::vector<uint32_t> m_flowsIndices;   //!< Index of the flow queue of each bucket, or NO_FLOW
+  std::vector<FlowQueue> m_flowTable;     //!< Flow queues, one per bucket
+  uint32_t m_nFlowQueues;                 //!< Number of flow queues in use
 
-  ObjectFactory m_flowFactory;         //!< Factory to create a new flow
-  ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
+  std::vector<Ptr<QueueDiscItem> > m_items;  //!< Packet pool, shared by the flow queues
+  std::vector<uint32_t> m_nextItem;          //!< Next slot in the flow queue or in the free list
+  uint32_t m_freeItem;                       //!< First free slot of the packet pool, or NO_ITEM
 };
 
 } // namespace ns3
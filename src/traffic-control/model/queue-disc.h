@@ -531,6 +531,26 @@ protected:
    */
   void DoInitialize (void);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet enqueue
+   *  \param item item that was enqueued
+   *  This method is called when an internal queue or a child queue disc
+   *  enqueues a packet, and must be called by subclasses which store
+   *  packets by other means
+   */
+  void PacketEnqueued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dequeue
+   *  \param item item that was dequeued
+   *  This method is called when an internal queue or a child queue disc
+   *  dequeues a packet, and must be called by subclasses which store
+   *  packets by other means
+   */
+  void PacketDequeued (Ptr<const QueueDiscItem> item);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet dropped before enqueue
@@ -666,20 +686,6 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
-  /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet enqueue
-   *  \param item item that was enqueued
-   */
-  void PacketEnqueued (Ptr<const QueueDiscItem> item);
-
-  /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet dequeue
-   *  \param item item that was dequeued
-   */
-  void PacketDequeued (Ptr<const QueueDiscItem> item);
-
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<InternalQueue> > m_queues;    //!< Internal queues
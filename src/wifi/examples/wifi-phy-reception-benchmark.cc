@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of the interference bookkeeping of a
+// Wi-Fi PHY in a dense BSS.
+//
+// As in the PHY reception tests, the frames are handed directly to the
+// PHY, without channel.  One frame is sent to the PHY in every slot, at
+// --rxPower, and --interferers weaker frames (between --minInterferencePower
+// and --maxInterferencePower) start at random times during the slot, each
+// lasting up to one slot.  The PHY receives the first frame and adds all
+// the others to its InterferenceHelper, which computes the SINR of the
+// received frame over all the chunks delimited by the interferers.
+//
+// By default, the frames are passed to a YansWifiPhy with their received
+// power, as YansWifiChannel does.  With --spectrum, they are passed to a
+// SpectrumWifiPhy with a power spectral density, which adds the cost of
+// the computation of the power in each band.
+//
+// The error rates are those of --errorRateModel, which may be
+// ns3::TabulatedErrorRateModel to interpolate those of NistErrorRateModel.
+//
+// The program reports the wall clock time spent for each received frame,
+// and the number of frames received with and without error, which depend
+// on the interference only (the random numbers are those of --run).
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/packet.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/spectrum-wifi-phy.h"
+#include "ns3/wifi-spectrum-value-helper.h"
+#include "ns3/wifi-spectrum-signal-parameters.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/wifi-phy-tag.h"
+#include "ns3/wifi-utils.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WifiPhyReceptionBenchmark");
+
+static const uint8_t CHANNEL_NUMBER = 36;
+static const uint32_t FREQUENCY = 5180; // MHz
+static const uint16_t CHANNEL_WIDTH = 20; // MHz
+static const uint16_t GUARD_WIDTH = CHANNEL_WIDTH; // MHz (expanded to channel width to model spectrum mask)
+
+static uint32_t g_rxSuccess = 0; //!< frames received without error
+static uint32_t g_rxFailure = 0; //!< frames received with errors
+
+/**
+ * Count the frames received without error.
+ * \param p the packet
+ * \param snr the SNR
+ * \param txVector the TXVECTOR
+ */
+static void
+RxSuccess (Ptr<Packet> p, double snr, WifiTxVector txVector)
+{
+  ++g_rxSuccess;
+}
+
+/**
+ * Count the frames received with errors.
+ * \param p the packet
+ */
+static void
+RxFailure (Ptr<Packet> p)
+{
+  ++g_rxFailure;
+}
+
+/**
+ * Send a frame to the PHY, the way the PHY reception tests do.
+ * \param phy the PHY, a YansWifiPhy or a SpectrumWifiPhy
+ * \param txPowerDbm the received power (dBm)
+ * \param size the size of the frame payload (bytes)
+ * \param duration the duration of the frame, or zero for the duration of a frame of this size
+ */
+static void
+SendPacket (Ptr<WifiPhy> phy, double txPowerDbm, uint32_t size, Time duration)
+{
+  WifiTxVector txVector = WifiTxVector (WifiPhy::GetHeMcs7 (), 0, WIFI_PREAMBLE_HE_SU, 800, 1, 1, 0, 20, false, false);
+  MpduType mpdutype = NORMAL_MPDU;
+
+  Ptr<Packet> pkt = Create<Packet> (size);
+  WifiMacHeader hdr;
+  WifiMacTrailer trailer;
+
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetQosTid (0);
+  uint32_t frameSize = pkt->GetSize () + hdr.GetSize () + trailer.GetSerializedSize ();
+  Time txDuration = phy->CalculateTxDuration (frameSize, txVector, phy->GetFrequency (), mpdutype, 0);
+  hdr.SetDuration (txDuration);
+
+  pkt->AddHeader (hdr);
+  pkt->AddTrailer (trailer);
+  WifiPhyTag tag (txVector, mpdutype, 1);
+  pkt->AddPacketTag (tag);
+  if (!duration.IsZero ())
+    {
+      txDuration = duration;
+    }
+
+  Ptr<SpectrumWifiPhy> spectrumPhy = DynamicCast<SpectrumWifiPhy> (phy);
+  if (spectrumPhy == 0)
+    {
+      phy->StartReceivePreamble (pkt, DbmToW (txPowerDbm), txDuration);
+      return;
+    }
+  Ptr<SpectrumValue> txPowerSpectrum = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (FREQUENCY, CHANNEL_WIDTH, DbmToW (txPowerDbm), GUARD_WIDTH);
+  Ptr<WifiSpectrumSignalParameters> txParams = Create<WifiSpectrumSignalParameters> ();
+  txParams->psd = txPowerSpectrum;
+  txParams->txPhy = 0;
+  txParams->duration = txDuration;
+  txParams->packet = pkt;
+
+  spectrumPhy->StartRx (txParams);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t frames = 10000;
+  uint32_t interferers = 20;
+  uint32_t size = 1500;
+  double rxPowerDbm = -50;
+  double minInterferencePowerDbm = -95;
+  double maxInterferencePowerDbm = -75;
+  bool spectrum = false;
+  std::string errorRateModel = "ns3::NistErrorRateModel";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the reception of Wi-Fi frames with many interferers");
+  cmd.AddValue ("frames", "number of frames received", frames);
+  cmd.AddValue ("interferers", "number of interfering frames during each frame", interferers);
+  cmd.AddValue ("size", "payload size of the frames (bytes)", size);
+  cmd.AddValue ("rxPower", "power of the received frames (dBm)", rxPowerDbm);
+  cmd.AddValue ("minInterferencePower", "minimum power of the interfering frames (dBm)", minInterferencePowerDbm);
+  cmd.AddValue ("maxInterferencePower", "maximum power of the interfering frames (dBm)", maxInterferencePowerDbm);
+  cmd.AddValue ("spectrum", "use a SpectrumWifiPhy instead of a YansWifiPhy", spectrum);
+  cmd.AddValue ("errorRateModel", "type of the error rate model", errorRateModel);
+  cmd.Parse (argc, argv);
+
+  Ptr<WifiPhy> phy;
+  if (spectrum)
+    {
+      phy = CreateObject<SpectrumWifiPhy> ();
+    }
+  else
+    {
+      phy = CreateObject<YansWifiPhy> ();
+    }
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+  ObjectFactory factory;
+  factory.SetTypeId (errorRateModel);
+  phy->SetErrorRateModel (factory.Create<ErrorRateModel> ());
+  phy->SetChannelNumber (CHANNEL_NUMBER);
+  phy->SetFrequency (FREQUENCY);
+  phy->SetReceiveOkCallback (MakeCallback (&RxSuccess));
+  phy->SetReceiveErrorCallback (MakeCallback (&RxFailure));
+  phy->AssignStreams (0);
+
+  // the frames are separated by a SIFS-like gap, so that the PHY is idle
+  // when each of them arrives
+  WifiTxVector txVector = WifiTxVector (WifiPhy::GetHeMcs7 (), 0, WIFI_PREAMBLE_HE_SU, 800, 1, 1, 0, 20, false, false);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  Time frameDuration = phy->CalculateTxDuration (size + hdr.GetSize () + WifiMacTrailer ().GetSerializedSize (),
+                                                 txVector, phy->GetFrequency (), NORMAL_MPDU, 0);
+  Time slot = frameDuration + MicroSeconds (16);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1000);
+  for (uint32_t i = 0; i < frames; ++i)
+    {
+      Time start = slot * i + MicroSeconds (1);
+      Simulator::Schedule (start, &SendPacket, phy, rxPowerDbm, size, Time ());
+      for (uint32_t j = 0; j < interferers; ++j)
+        {
+          Time offset = NanoSeconds (random->GetInteger (1, frameDuration.GetNanoSeconds ()));
+          Time duration = NanoSeconds (random->GetInteger (1, slot.GetNanoSeconds ()));
+          double powerDbm = random->GetValue (minInterferencePowerDbm, maxInterferencePowerDbm);
+          Simulator::Schedule (start + offset, &SendPacket, phy, powerDbm, size, duration);
+        }
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = std::max<int64_t> (clock.End (), 1);
+  Simulator::Destroy ();
+
+  uint32_t received = g_rxSuccess + g_rxFailure;
+  std::cout << "Received " << received << " frames (" << g_rxSuccess << " without error, "
+            << g_rxFailure << " with errors) with " << interferers << " interferers each in "
+            << elapsed << " ms, " << elapsed * 1e3 / std::max<uint32_t> (received, 1) << " us per frame"
+            << std::endl;
+
+  return 0;
+}
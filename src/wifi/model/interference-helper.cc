@@ -211,6 +211,10 @@ InterferenceHelper::AppendEvent (Ptr<Event> event)
       m_niChanges.erase (++(m_niChanges.begin ()),
                          GetNextPosition (event->GetStartTime ()));
     }
+  else
+    {
+      PruneNiChanges ();
+    }
   auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
   auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
   for (auto i = first; i != last; ++i)
@@ -930,6 +934,32 @@ InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change)
   return m_niChanges.insert (GetNextPosition (moment), std::make_pair (moment, change));
 }
 
+void
+InterferenceHelper::PruneNiChanges (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The signals still present are those whose NiChange of the end is not
+  // earlier than now; only the one being received may be evaluated later on
+  Time now = Simulator::Now ();
+  Time oldest = now;
+  for (auto it = m_niChanges.lower_bound (now); it != m_niChanges.end (); ++it)
+    {
+      Ptr<Event> event = it->second.GetEvent ();
+      if (event != 0 && event->GetStartTime () < oldest)
+        {
+          oldest = event->GetStartTime ();
+        }
+    }
+  // Always leave the first zero power noise event in the list
+  auto begin = m_niChanges.begin ();
+  auto end = m_niChanges.lower_bound (oldest);
+  if (begin != end && ++begin != end)
+    {
+      NS_LOG_DEBUG ("Erase the NiChanges before " << oldest);
+      m_niChanges.erase (begin, end);
+    }
+}
+
 void
 InterferenceHelper::NotifyRxStart ()
 {
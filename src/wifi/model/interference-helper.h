@@ -354,6 +354,12 @@ private:
    * \returns an iterator to the list of NiChanges
    */
   NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+  /**
+   * Erase the nichanges which are earlier than the start of the oldest
+   * signal which is still present, since no SNIR will be calculated over
+   * them, during a reception.
+   */
+  void PruneNiChanges (void);
 
   /**
    * Add NiChange to the list at the appropriate position and
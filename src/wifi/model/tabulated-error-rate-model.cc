@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "tabulated-error-rate-model.h"
+#include "wifi-tx-vector.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TabulatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TabulatedErrorRateModel);
+
+TypeId
+TabulatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TabulatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TabulatedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The model whose error rates are interpolated.",
+                   StringValue ("ns3::NistErrorRateModel"),
+                   MakePointerAccessor (&TabulatedErrorRateModel::SetErrorRateModel,
+                                        &TabulatedErrorRateModel::GetErrorRateModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR (dB) of the tables. The error rates of lower SNRs "
+                   "are not interpolated. Changing it does not affect the tables already computed.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR (dB) of the tables. The error rates of higher SNRs "
+                   "are not interpolated. Changing it does not affect the tables already computed.",
+                   DoubleValue (60.0),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Resolution",
+                   "The step (dB) between the SNRs of the tables. "
+                   "Changing it does not affect the tables already computed.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TabulatedErrorRateModel::m_resolutionDb),
+                   MakeDoubleChecker<double> (0.0001))
+  ;
+  return tid;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TabulatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TabulatedErrorRateModel::SetErrorRateModel (Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  m_tables.clear ();
+}
+
+Ptr<ErrorRateModel>
+TabulatedErrorRateModel::GetErrorRateModel (void) const
+{
+  return m_model;
+}
+
+const std::vector<double> &
+TabulatedErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector) const
+{
+  uint64_t key = (static_cast<uint64_t> (mode.GetUid ()) << 40)
+    | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 24)
+    | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 8)
+    | txVector.GetNss ();
+  std::map<uint64_t, std::vector<double> >::const_iterator it = m_tables.find (key);
+  if (it != m_tables.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t size = static_cast<uint32_t> ((m_maxSnrDb - m_minSnrDb) / m_resolutionDb) + 1;
+  NS_LOG_DEBUG ("Compute the error rates of " << mode << " at " << size << " SNRs");
+  std::vector<double> &table = m_tables[key];
+  table.reserve (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      double snr = std::pow (10.0, (m_minSnrDb + i * m_resolutionDb) / 10.0);
+      double ber = 1 - m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+      // the bit error rates which are too small to be represented are
+      // indistinguishable from 0 for any chunk
+      table.push_back (std::log (std::max (ber, 1e-300)));
+    }
+  return table;
+}
+
+double
+TabulatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+  const std::vector<double> &table = GetTable (mode, txVector);
+  double position = (10.0 * std::log10 (snr) - m_minSnrDb) / m_resolutionDb;
+  if (!(position >= 0) || position >= table.size () - 1)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  uint32_t index = static_cast<uint32_t> (position);
+  double logBer = table[index] + (position - index) * (table[index + 1] - table[index]);
+  return std::exp (nbits * std::log1p (-std::exp (logBer)));
+}
+
+} //namespace ns3
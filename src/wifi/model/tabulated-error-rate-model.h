@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include "error-rate-model.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A model for the error rate which interpolates the error rates of another
+ * model (by default, NistErrorRateModel), computed once on a grid of SNR.
+ *
+ * The analytic models evaluate complementary error functions and series
+ * for each chunk of each frame.  This model asks the other model for the
+ * success rate of a single bit, 1 - p, at each SNR of a grid (every
+ * Resolution dB, from MinSnr to MaxSnr) the first time a mode is used with
+ * a given channel width, guard interval and number of spatial streams, and
+ * then returns (1 - p)^nbits, where log (p) is linearly interpolated between
+ * the two closest SNRs of the grid.  The success rates of SNRs outside of
+ * the grid are asked to the other model.
+ *
+ * The other model must thus return success rates of the form (1 - p)^nbits,
+ * as NistErrorRateModel, YansErrorRateModel and DsssErrorRateModel do, and
+ * use the TXVECTOR only for the channel width, the guard interval and the
+ * number of spatial streams.  With the default resolution, the success rates
+ * differ from those of NistErrorRateModel and YansErrorRateModel by less
+ * than 1e-5.
+ */
+class TabulatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TabulatedErrorRateModel ();
+  virtual ~TabulatedErrorRateModel ();
+
+  /**
+   * Set the model whose error rates are interpolated, and discard the
+   * error rates computed so far.
+   *
+   * \param model the error rate model
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> model);
+  /**
+   * \return the model whose error rates are interpolated
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * Return the table of a mode and TXVECTOR, computing it if needed.
+   *
+   * \param mode the Wi-Fi mode
+   * \param txVector the TXVECTOR
+   *
+   * \return the logarithms of the bit error rates, at each SNR of the grid
+   */
+  const std::vector<double> & GetTable (WifiMode mode, WifiTxVector txVector) const;
+
+  Ptr<ErrorRateModel> m_model; //!< the model whose error rates are interpolated
+  double m_minSnrDb;           //!< the lowest SNR of the grid (dB)
+  double m_maxSnrDb;           //!< the highest SNR of the grid (dB)
+  double m_resolutionDb;       //!< the step of the grid (dB)
+  /// the tables, by mode, channel width, guard interval and number of spatial streams
+  mutable std::map<uint64_t, std::vector<double> > m_tables;
+};
+
+} //namespace ns3
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
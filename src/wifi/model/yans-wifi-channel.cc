@@ -30,6 +30,7 @@
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -87,23 +88,25 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  FindReceivers (senderMobility, txPowerDbm);
+  for (std::vector<uint32_t>::const_iterator i = m_receivers.begin (); i != m_receivers.end (); i++)
     {
-      if (sender != (*i))
+      Ptr<YansWifiPhy> receiver = m_phyList[*i];
+      if (sender != receiver)
         {
           //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
             {
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
           Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
+          Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
             {
@@ -116,9 +119,46 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+                                          receiver, copy, rxPowerDbm, duration);
+        }
+    }
+}
+
+void
+YansWifiChannel::FindReceivers (Ptr<MobilityModel> senderMobility, double txPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << senderMobility << txPowerDbm);
+  // Receive drops the signals below the sensitivity of the receiver
+  double rxPowerDbm = std::numeric_limits<double>::infinity ();
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      rxPowerDbm = std::min (rxPowerDbm, (*i)->GetRxSensitivity () - (*i)->GetRxGain ());
+    }
+  double range = std::numeric_limits<double>::infinity ();
+  if (m_loss != 0)
+    {
+      range = m_loss->GetRange (txPowerDbm, rxPowerDbm);
+    }
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      m_receivers.resize (m_phyList.size ());
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          m_receivers[i] = i;
+        }
+      return;
+    }
+  if (m_index.GetN () != m_phyList.size ())
+    {
+      // index the YansWifiPhys when they are used, once they have their mobility model
+      m_index.Clear ();
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          m_index.Add ((*i)->GetMobility ());
         }
     }
+  m_index.GetNeighbors (senderMobility->GetPosition (), range, m_receivers);
+  NS_LOG_DEBUG (m_receivers.size () << " of " << m_phyList.size () << " phys within " << range << "m");
 }
 
 void
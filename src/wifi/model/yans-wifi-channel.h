@@ -22,12 +22,14 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/spatial-index.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 class YansWifiPhy;
 class Packet;
 class Time;
@@ -83,6 +85,12 @@ public:
    * currently invoked only from YansWifiPhy::StartTx.  The channel
    * attempts to deliver the packet to all other YansWifiPhy objects
    * on the channel (except for the sender).
+   *
+   * When the PropagationLossModel bounds its loss with the distance
+   * (see PropagationLossModel::GetRange), the YansWifiPhy objects which
+   * are too far away to receive the packet above their sensitivity are
+   * skipped, with a spatial index of the positions of the YansWifiPhy
+   * objects.
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
 
@@ -116,9 +124,20 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
 
+  /**
+   * Find the YansWifiPhys which may receive a packet above their
+   * sensitivity, and store their index in m_receivers.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power associated to the packet (dBm)
+   */
+  void FindReceivers (Ptr<MobilityModel> senderMobility, double txPowerDbm) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  mutable SpatialIndex m_index;        //!< Positions of the YansWifiPhys, by index in m_phyList
+  mutable std::vector<uint32_t> m_receivers; //!< Indices of the receivers found by FindReceivers
 };
 
 } //namespace ns3
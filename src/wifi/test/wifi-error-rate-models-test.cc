@@ -21,8 +21,11 @@
 #include <cmath>
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
 #include "ns3/dsss-error-rate-model.h"
+#include "ns3/tabulated-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "ns3/wifi-phy.h"
 
 using namespace ns3;
 
@@ -291,6 +294,79 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Test Case Tabulated: the success rates
+ * interpolated by TabulatedErrorRateModel are those of the models it
+ * interpolates, within a small error.
+ */
+class WifiErrorRateModelsTestCaseTabulated : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseTabulated ();
+  virtual ~WifiErrorRateModelsTestCaseTabulated ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WifiErrorRateModelsTestCaseTabulated::WifiErrorRateModelsTestCaseTabulated ()
+  : TestCase ("WifiErrorRateModel test case tabulated")
+{
+}
+
+WifiErrorRateModelsTestCaseTabulated::~WifiErrorRateModelsTestCaseTabulated ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseTabulated::DoRun (void)
+{
+  Ptr<ErrorRateModel> models[] = {CreateObject<NistErrorRateModel> (), CreateObject<YansErrorRateModel> ()};
+  WifiMode modes[] = {WifiPhy::GetDsssRate1Mbps (), WifiPhy::GetDsssRate11Mbps (),
+                      WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate36Mbps (), WifiPhy::GetOfdmRate54Mbps (),
+                      WifiPhy::GetHtMcs1 (), WifiPhy::GetHtMcs5 (), WifiPhy::GetVhtMcs8 (),
+                      WifiPhy::GetHeMcs9 (), WifiPhy::GetHeMcs11 ()};
+  uint64_t sizes[] = {14 * 8, 1500 * 8, 65535 * 8}; // bits
+
+  for (uint32_t m = 0; m < sizeof (models) / sizeof (models[0]); ++m)
+    {
+      Ptr<TabulatedErrorRateModel> tabulated = CreateObject<TabulatedErrorRateModel> ();
+      tabulated->SetErrorRateModel (models[m]);
+      for (uint32_t i = 0; i < sizeof (modes) / sizeof (modes[0]); ++i)
+        {
+          WifiTxVector txVector;
+          txVector.SetMode (modes[i]);
+          txVector.SetChannelWidth (modes[i].GetModulationClass () == WIFI_MOD_CLASS_DSSS
+                                    || modes[i].GetModulationClass () == WIFI_MOD_CLASS_HR_DSSS ? 22 : 20);
+          txVector.SetGuardInterval (800);
+          txVector.SetNss (1);
+          // the SNRs are not those of the grid of the tables
+          for (double snrDb = -8.0; snrDb < 58.0; snrDb += 0.0731)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              for (uint32_t j = 0; j < sizeof (sizes) / sizeof (sizes[0]); ++j)
+                {
+                  double expected = models[m]->GetChunkSuccessRate (modes[i], txVector, snr, sizes[j]);
+                  double ps = tabulated->GetChunkSuccessRate (modes[i], txVector, snr, sizes[j]);
+                  NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 1e-5, "Wrong success rate of " << sizes[j] << " bits of "
+                                             << modes[i] << " at " << snrDb << " dB with " << models[m]->GetInstanceTypeId ());
+                }
+            }
+          // outside of the tables, the success rates are not interpolated
+          double snrs[] = {0, 1e-3, 1e7};
+          for (uint32_t j = 0; j < sizeof (snrs) / sizeof (snrs[0]); ++j)
+            {
+              NS_TEST_ASSERT_MSG_EQ (tabulated->GetChunkSuccessRate (modes[i], txVector, snrs[j], 1000),
+                                     models[m]->GetChunkSuccessRate (modes[i], txVector, snrs[j], 1000),
+                                     "Wrong success rate outside of the tables");
+            }
+        }
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +384,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseTabulated, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
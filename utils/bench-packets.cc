@@ -21,6 +21,10 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./waf --run 'bench-packets --n=10000'
+// With --compare, each benchmark is also run with the packet metadata
+// enabled, as needed for printing; these runs are done first in a child
+// process, since the metadata cannot be enabled once packets have been
+// created without it.
 
 #include "ns3/command-line.h"
 #include "ns3/system-wall-clock-ms.h"
@@ -30,6 +34,9 @@
 #include <sstream>
 #include <string>
 #include <stdlib.h> // for exit ()
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 #include <limits>
 #include <algorithm>
 
@@ -339,8 +346,8 @@ runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 }
 
 
-static void
-runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+static uint64_t
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
   for (uint32_t i = 0; i < minIterations; i++)
@@ -348,13 +355,73 @@ runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char con
       uint64_t delay = runBenchOneIteration(bench, n);
       minDelay = std::min(minDelay, delay);
     }
-  double ps = n;
-  ps *= 1000;
-  ps /= minDelay;
-  std::cout << ps << " packets/s"
-            << " (" << minDelay << " ms elapsed)\t"
-            << name
-            << std::endl;
+  return std::max (minDelay, (uint64_t)1);
+}
+
+/// A benchmark and its description.
+struct Bench
+{
+  void (*bench) (uint32_t); //!< The benchmark function.
+  char const *name;         //!< The benchmark description.
+};
+
+/// The benchmarks to run.
+static const Bench g_benches[] = {
+  { &benchA, "Copy packet, remove headers" },
+  { &benchB, "Just add headers" },
+  { &benchC, "Remove by func call" },
+  { &benchD, "Intermixed add/remove headers and tags" },
+  { &benchFragment, "Fragmentation and concatenation" },
+  { &benchByteTags, "Benchmark byte tags" },
+};
+/// The number of benchmarks.
+static const uint32_t g_nBenches = sizeof (g_benches) / sizeof (g_benches[0]);
+
+/**
+ * Run all the benchmarks with the packet metadata enabled, in a child
+ * process.
+ * \param n the number of packets
+ * \param minIterations the number of iterations
+ * \return the smallest iteration time of each benchmark, in ms
+ */
+static std::vector<uint64_t>
+runBenchesWithMetadata (uint32_t n, uint32_t minIterations)
+{
+  std::vector<uint64_t> delays (g_nBenches);
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      std::cerr << "Error-- cannot create a pipe" << std::endl;
+      exit (1);
+    }
+  std::cout.flush ();
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      close (fds[0]);
+      Packet::EnablePrinting ();
+      for (uint32_t i = 0; i < g_nBenches; i++)
+        {
+          delays[i] = runBench (g_benches[i].bench, n, minIterations);
+        }
+      uint32_t size = g_nBenches * sizeof (uint64_t);
+      _exit (write (fds[1], &delays[0], size) == (ssize_t)size ? 0 : 1);
+    }
+  close (fds[1]);
+  uint32_t size = g_nBenches * sizeof (uint64_t);
+  ssize_t bytes = pid > 0 ? read (fds[0], &delays[0], size) : 0;
+  close (fds[0]);
+  int status = 1;
+  if (pid > 0)
+    {
+      waitpid (pid, &status, 0);
+    }
+  if (bytes != (ssize_t)size || status != 0)
+    {
+      std::cerr << "Error-- cannot run the benchmarks with metadata" << std::endl;
+      exit (1);
+    }
+  return delays;
 }
 
 int main (int argc, char *argv[])
@@ -362,12 +429,14 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool compare = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("compare", "also run the benchmarks with packet printing enabled", compare);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -379,12 +448,35 @@ int main (int argc, char *argv[])
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
-  runBench (&benchA, n, minIterations, "Copy packet, remove headers");
-  runBench (&benchB, n, minIterations, "Just add headers");
-  runBench (&benchC, n, minIterations, "Remove by func call");
-  runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
-  runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
-  runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  std::vector<uint64_t> metadataDelays;
+  if (compare)
+    {
+      metadataDelays = runBenchesWithMetadata (n, minIterations);
+    }
+  else if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
+  for (uint32_t i = 0; i < g_nBenches; i++)
+    {
+      uint64_t minDelay = runBench (g_benches[i].bench, n, minIterations);
+      double ps = n;
+      ps *= 1000;
+      ps /= minDelay;
+      std::cout << ps << " packets/s"
+                << " (" << minDelay << " ms elapsed)\t";
+      if (compare)
+        {
+          double metadataPs = n;
+          metadataPs *= 1000;
+          metadataPs /= metadataDelays[i];
+          std::cout << metadataPs << " packets/s with metadata"
+                    << " (" << metadataDelays[i] << " ms elapsed)\t";
+        }
+      std::cout << g_benches[i].name
+                << std::endl;
+    }
 
   return 0;
 }
@@ -25,6 +25,12 @@
 #include <string.h>
 
 #include "ns3/core-module.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <list>
+#endif
 
 using namespace ns3;
 
@@ -145,6 +151,103 @@ Bench::Cb (void)
 }
 
 
+#ifdef HAVE_PTHREAD_H
+/// Bench of events scheduled from other threads
+class ContextBench
+{
+public:
+  /**
+   * constructor
+   * \param producers the number of scheduling threads
+   * \param total the total number of events to schedule
+   */
+  ContextBench (const uint32_t producers, const uint32_t total)
+    : m_producers (producers),
+      m_total (total),
+      m_count (0)
+  {
+  }
+
+  /// Run function
+  void RunBench (void);
+private:
+  /**
+   * Scheduling thread body
+   * \param bench the bench
+   */
+  static void Produce (ContextBench *bench);
+  /// callback function
+  void Cb (void);
+  /// Keep the simulator running until all events have been received
+  void Poll (void);
+
+  uint32_t m_producers; ///< number of scheduling threads
+  uint32_t m_total; ///< total
+  uint32_t m_count; ///< count
+};
+
+void
+ContextBench::RunBench (void)
+{
+  SystemWallClockMs time;
+  double simu;
+
+  m_count = 0;
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_producers; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&ContextBench::Produce, this)));
+    }
+  Simulator::Schedule (NanoSeconds (0), &ContextBench::Poll, this);
+
+  DEB ("running");
+  time.Start ();
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Run ();
+  simu = time.End ();
+  simu /= 1000;
+  DEB ("run took " << simu << "s");
+
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  LOG (std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_count / simu) <<
+       std::setw (g_fwidth) << (simu / m_count));
+}
+
+void
+ContextBench::Produce (ContextBench *bench)
+{
+  uint32_t n = bench->m_total / bench->m_producers;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Simulator::ScheduleWithContext (i, NanoSeconds (0), &ContextBench::Cb, bench);
+    }
+}
+
+void
+ContextBench::Cb (void)
+{
+  ++m_count;
+}
+
+void
+ContextBench::Poll (void)
+{
+  if (m_count < (m_total / m_producers) * m_producers)
+    {
+      Simulator::Schedule (NanoSeconds (1), &ContextBench::Poll, this);
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -205,12 +308,16 @@ int main (int argc, char *argv[])
 
   bool schedCal  = false;
   bool schedHeap = false;
+  bool schedDaryHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  uint32_t producers =    0;
   std::string filename = "";
 
   CommandLine cmd;
@@ -221,16 +328,30 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --all, the hold model is run in turn with each of the\n"
+             "Map, Heap, DaryHeap, Calendar and Ladder schedulers.  Use a\n"
+             "large --pop (1E6 or more) to compare them with many pending\n"
+             "events; run under 'perf stat -e cache-misses' to compare the\n"
+             "cache behaviour of the heaps.\n"
+             "\n"
+             "With --producers=N, measure instead the rate of events\n"
+             "scheduled with Simulator::ScheduleWithContext from N\n"
+             "threads other than the one running the simulation.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("dheap", "use DaryHeapScheduler",         schedDaryHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all schedulers but ListScheduler", schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("producers", "number of cross-thread scheduling threads (default 0: off)", producers);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -245,16 +366,79 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::HeapScheduler");
     }
+  if (schedDaryHeap)
+    {
+      factory.SetTypeId ("ns3::DaryHeapScheduler");
+    }
   if (schedList)
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
   Simulator::SetScheduler (factory);
 
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::DaryHeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      schedulers.push_back (factory.GetTypeId ().GetName ());
+    }
+
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+  if (producers > 0)
+    {
+#ifdef HAVE_PTHREAD_H
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+      LOGME ("producer threads: " << producers);
+      LOGME ("total events: " << total);
+      LOGME ("runs: " << runs);
+
+      ContextBench *contextBench = new ContextBench (producers, total);
+
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Cross-thread scheduling:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+      contextBench->RunBench ();
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+          contextBench->RunBench ();
+        }
+
+      LOG ("");
+      Simulator::Destroy ();
+      delete contextBench;
+      return 0;
+#else
+      LOGME ("threading is not enabled, --producers is ignored");
+#endif
+    }
+
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
@@ -262,41 +446,48 @@ int main (int argc, char *argv[])
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (uint32_t j = 0; j < schedulers.size (); j++)
     {
-      std::cout << std::setw (g_fwidth) << i;
-
+      factory.SetTypeId (schedulers[j]);
+      Simulator::SetScheduler (factory);
+
+      // table header
+      LOG ("");
+      LOGME ("scheduler: " << schedulers[j]);
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
+
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+
+          bench->RunBench ();
+        }
     }
 
   LOG ("");